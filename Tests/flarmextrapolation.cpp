@@ -0,0 +1,140 @@
+/*
+ * flarmextrapolation.cpp
+ *
+ *  Created on: 18.10.2026
+ *
+ *  Author: axel
+ *
+ *  Checks the extrapolation of Flarm targets between two PFLAA reports.
+ *
+ *  Build:
+ *
+ *  g++ -O2 -fPIC -I../cumulus flarmextrapolation.cpp ../cumulus/FlarmTraffic.cpp \
+ *      $(pkg-config --cflags --libs Qt5Core) -o flarmextrapolation
+ *
+ *  Usage:
+ *
+ *  flarmextrapolation
+ *
+ *  A target circling with 15 deg/s is reported once per second, while the
+ *  own glider flies straight north. After every report the target is
+ *  extrapolated 3s ahead and compared with its true relative position. The
+ *  mean error of the extrapolation is compared with the error of the held
+ *  last reported position.
+ *
+ *  The program exits with 1, if the mean extrapolation error is above
+ *  MAX_MEAN_ERROR or a true position is outside of the returned uncertainty.
+ */
+
+#include <cmath>
+#include <cstdio>
+
+#include "FlarmTraffic.h"
+
+// Turn rate of the target in degrees per second
+#define TURN_RATE 15.0
+
+// Radius of the target circle in m
+#define RADIUS 120.0
+
+// Own ground speed in m/s to the north
+#define OWN_SPEED 25.0
+
+// Extrapolation time in ms after the last report
+#define AHEAD 3000
+
+// Upper bound of the mean extrapolation error in m
+#define MAX_MEAN_ERROR 5.0
+
+// Lower bound of the mean error in m of the held position, to be sure that
+// the target really moves away from its reported position.
+#define MIN_HELD_ERROR 50.0
+
+/** True position of the target relative to the own glider at time t in ms. */
+static void truePosition( const qint64 t, double& north, double& east, double& track )
+{
+  double s = t / 1000.0;
+
+  track = fmod( TURN_RATE * s, 360.0 );
+
+  // The circle center is fixed on ground, on the right side of the track.
+  double side = (track - 90.0) * M_PI / 180.0;
+
+  north = 600.0 + RADIUS * cos( side ) - OWN_SPEED * s;
+  east  = 300.0 + RADIUS * sin( side );
+}
+
+int main()
+{
+  FlarmTraffic traffic;
+
+  double heldError = 0.0;
+  double extrapolationError = 0.0;
+  int samples = 0;
+  int outside = 0;
+
+  for( qint64 time = 1000; time <= 120000; time += 1000 )
+    {
+      double north, east, track;
+
+      truePosition( time, north, east, track );
+
+      // Flarm reports without turn rate, it is derived from the tracks.
+      FlarmBase::FlarmAcft acft;
+
+      acft.TimeStamp        = time;
+      acft.ID               = 0x3D2001;
+      acft.RelativeNorth    = qRound( north );
+      acft.RelativeEast     = qRound( east );
+      acft.RelativeVertical = 50;
+      acft.Track            = qRound( track ) % 360;
+      acft.GroundSpeed      = TURN_RATE * M_PI / 180.0 * RADIUS;
+      acft.ClimbRate        = 0.0;
+
+      traffic.update( acft );
+
+      if( time < 5000 )
+        {
+          // The velocity estimation needs a few reports.
+          continue;
+        }
+
+      double aheadNorth, aheadEast, aheadTrack;
+
+      truePosition( time + AHEAD, aheadNorth, aheadEast, aheadTrack );
+
+      FlarmBase::FlarmAcft extrapolated;
+
+      double uncertainty =
+        traffic.find( acft.ID )->extrapolate( time + AHEAD, extrapolated );
+
+      double eh = hypot( acft.RelativeNorth - aheadNorth, acft.RelativeEast - aheadEast );
+      double ee = hypot( extrapolated.RelativeNorth - aheadNorth,
+                         extrapolated.RelativeEast - aheadEast );
+
+      heldError += eh;
+      extrapolationError += ee;
+      samples++;
+
+      if( ee > uncertainty )
+        {
+          outside++;
+        }
+    }
+
+  heldError /= samples;
+  extrapolationError /= samples;
+
+  printf( "Extrapolation %dms ahead, %d samples\n", AHEAD, samples );
+  printf( "Mean error of the held position: %6.1fm\n", heldError );
+  printf( "Mean error of the extrapolation: %6.1fm\n", extrapolationError );
+  printf( "Positions outside the uncertainty: %d\n", outside );
+
+  bool ok = heldError >= MIN_HELD_ERROR &&
+            extrapolationError <= MAX_MEAN_ERROR &&
+            outside == 0;
+
+  printf( "%s\n", ok ? "ok" : "FAILED" );
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,210 @@
+/*
+ * flarmtraffic.cpp
+ *
+ *  Created on: 18.10.2026
+ *
+ *  Author: axel
+ *
+ *  Checks the Flarm traffic table with a large gaggle.
+ *
+ *  Build:
+ *
+ *  g++ -O2 -fPIC -I../cumulus flarmtraffic.cpp ../cumulus/FlarmTraffic.cpp \
+ *      $(pkg-config --cflags --libs Qt5Core) -o flarmtraffic
+ *
+ *  Usage:
+ *
+ *  flarmtraffic
+ *
+ *  A gaggle of GAGGLE_SIZE targets, more than the former table capacity of
+ *  64, circles in some thermals. Every target is reported once per second,
+ *  while the own glider flies straight north. It is checked that
+ *
+ *  - all targets are kept and build up their full track history,
+ *  - all targets are extrapolated 3s ahead within the error bound,
+ *  - the oldest target is replaced only, if the table is really full,
+ *  - all targets expire and cannot be found any more.
+ *
+ *  The program exits with 1, if a check fails.
+ */
+
+#include <cmath>
+#include <cstdio>
+
+#include "FlarmTraffic.h"
+
+// Number of targets, the maximum of the simulated gaggles
+#define GAGGLE_SIZE 100
+
+// Number of gliders sharing a thermal
+#define GLIDERS_PER_THERMAL 15
+
+// Radius of the target circles in m
+#define RADIUS 120.0
+
+// Turn rate of the targets in degrees per second
+#define TURN_RATE 15.0
+
+// Own ground speed in m/s to the north
+#define OWN_SPEED 25.0
+
+// Extrapolation time in ms after the last report
+#define AHEAD 3000
+
+// Upper bound of the mean extrapolation error in m
+#define MAX_MEAN_ERROR 5.0
+
+static int failures = 0;
+
+static void check( const bool ok, const char* what )
+{
+  printf( "%-60s %s\n", what, ok ? "ok" : "FAILED" );
+
+  if( ok == false )
+    {
+      failures++;
+    }
+}
+
+/** \return The Flarm ID of target i, spread over the hash index. */
+static uint id( const int i )
+{
+  return 0x3D0000 + i * 7919;
+}
+
+/** True position of target i relative to the own glider at time t in ms. */
+static void truePosition( const int i, const qint64 t,
+                          double& north, double& east, double& track )
+{
+  double s = t / 1000.0;
+
+  // The targets of a thermal are spread around the circle.
+  int thermal = i / GLIDERS_PER_THERMAL;
+
+  track = fmod( TURN_RATE * s + i * 360.0 / GLIDERS_PER_THERMAL, 360.0 );
+
+  double side = (track - 90.0) * M_PI / 180.0;
+
+  north = 800.0 * cos( thermal ) + RADIUS * cos( side ) - OWN_SPEED * s;
+  east  = 800.0 * sin( thermal ) + RADIUS * sin( side );
+}
+
+static FlarmBase::FlarmAcft report( const int i, const qint64 time )
+{
+  double north, east, track;
+
+  truePosition( i, time, north, east, track );
+
+  FlarmBase::FlarmAcft acft;
+
+  acft.TimeStamp        = time;
+  acft.ID               = id( i );
+  acft.RelativeNorth    = qRound( north );
+  acft.RelativeEast     = qRound( east );
+  acft.RelativeVertical = 50;
+  acft.Track            = qRound( track ) % 360;
+  acft.GroundSpeed      = TURN_RATE * M_PI / 180.0 * RADIUS;
+  acft.ClimbRate        = 0.0;
+
+  return acft;
+}
+
+int main()
+{
+  FlarmTraffic traffic;
+  FlarmTraffic::Snapshot snapshot;
+
+  qint64 time;
+
+  // 30 PFLAA sequences of the whole gaggle
+  for( time = 1000; time <= 30000; time += 1000 )
+    {
+      for( int i = 0; i < GAGGLE_SIZE; i++ )
+        {
+          traffic.update( report( i, time ) );
+        }
+    }
+
+  time -= 1000;
+
+  traffic.takeSnapshot( snapshot );
+
+  check( traffic.size() == GAGGLE_SIZE && snapshot.size() == GAGGLE_SIZE,
+         "all targets of the gaggle are kept" );
+
+  int fullTracks = 0;
+  double error = 0.0;
+
+  for( int i = 0; i < GAGGLE_SIZE; i++ )
+    {
+      const FlarmTraffic::Target* target = traffic.find( id( i ) );
+
+      if( target == 0 )
+        {
+          continue;
+        }
+
+      if( target->trackSize() == FlarmTraffic::TrackLength )
+        {
+          fullTracks++;
+        }
+
+      double north, east, track;
+
+      truePosition( i, time + AHEAD, north, east, track );
+
+      FlarmBase::FlarmAcft extrapolated;
+
+      target->extrapolate( time + AHEAD, extrapolated );
+
+      error += hypot( extrapolated.RelativeNorth - north,
+                      extrapolated.RelativeEast - east );
+    }
+
+  error /= GAGGLE_SIZE;
+
+  printf( "Mean error of the extrapolation %dms ahead: %.1fm\n", AHEAD, error );
+
+  check( fullTracks == GAGGLE_SIZE, "all targets have their full track history" );
+  check( error <= MAX_MEAN_ERROR, "all targets are extrapolated" );
+
+  // Fill the table with new targets, reported after the gaggle.
+  int added = 0;
+
+  time += 1000;
+
+  for( ; traffic.size() < FlarmTraffic::Capacity; added++ )
+    {
+      traffic.update( report( GAGGLE_SIZE + added, time ) );
+    }
+
+  bool kept = true;
+
+  for( int i = 0; i < GAGGLE_SIZE; i++ )
+    {
+      kept = kept && traffic.find( id( i ) ) != 0;
+    }
+
+  check( kept, "no target is replaced before the table is full" );
+
+  // One more target replaces the oldest one, which is the first of the gaggle.
+  traffic.update( report( GAGGLE_SIZE + added, time ) );
+
+  check( traffic.size() == FlarmTraffic::Capacity &&
+         traffic.find( id( 0 ) ) == 0 && traffic.find( id( 1 ) ) != 0 &&
+         traffic.find( id( GAGGLE_SIZE + added ) ) != 0,
+         "a full table replaces the oldest target" );
+
+  traffic.expire( time + 10000, 5000 );
+
+  bool found = false;
+
+  for( int i = 0; i <= GAGGLE_SIZE + added; i++ )
+    {
+      found = found || traffic.find( id( i ) ) != 0;
+    }
+
+  check( traffic.size() == 0 && found == false, "all targets expire" );
+
+  return failures > 0 ? 1 : 0;
+}
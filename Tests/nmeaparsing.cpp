@@ -0,0 +1,173 @@
+/*
+ * nmeaparsing.cpp
+ *
+ *  Created on: 18.10.2026
+ *
+ *  Author: axel
+ *
+ *  Micro benchmark of the NMEA sentence tokenizer used by GpsNmea.
+ *
+ *  Build:
+ *
+ *  g++ -O2 -fPIC -I../cumulus nmeaparsing.cpp ../cumulus/NmeaSentence.cpp \
+ *      $(pkg-config --cflags --libs Qt5Core) -o nmeaparsing
+ *
+ *  Usage:
+ *
+ *  nmeaparsing [nmea-log-file] [loops]
+ *
+ *  Without a log file a recorded mix of GPS and Flarm sentences is used.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <QtCore>
+
+#include "NmeaSentence.h"
+
+// Recorded mix of one second, a GNSS epoch with Flarm traffic.
+static const char* recordedMix[] =
+{
+  "$GPRMC,132217.000,A,5228.19856,N,01408.32249,E,47.100,267.38,300710,,,A*58\r\n",
+  "$GPGGA,132217.000,5228.19856,N,01408.32249,E,1,09,0.9,92.4,M,44.9,M,,*6E\r\n",
+  "$GPGSA,A,3,10,07,05,02,29,04,08,13,,,,,1.72,1.03,1.38*0A\r\n",
+  "$GPGSV,3,1,11,10,63,137,17,07,61,098,15,05,59,290,20,08,54,157,30*70\r\n",
+  "$GPGSV,3,2,11,02,39,223,19,13,28,070,17,26,23,252,,04,14,186,14*79\r\n",
+  "$GPGSV,3,3,11,29,09,301,24,16,09,020,,36,,,*76\r\n",
+  "$PGRMZ,1024,F,2*3B\r\n",
+  "$PFLAU,3,1,2,1,0,-30,0,0,1254*50\r\n",
+  "$PFLAA,0,-1547,69,444,2,444444,180,,30,1.4,1*4F\r\n",
+  "$PFLAA,1,347,-1669,1555,2,555555,270,,30,1.5,1*7C\r\n",
+  "$PFLAA,2,347,-69,2666,2,666666,66,,30,-1.6,1*52\r\n",
+  "$PFLAA,0,-2747,3669,-77,2,777777,359,,30,1.7,1*71\r\n",
+  "$PFLAA,0,-3,-5000,400,2,888888,199,,30,-1.8,1*43\r\n",
+  "$PFLAA,0,4747,-2,999,2,999999,245,,30,2.9,1*70\r\n",
+  "$LXWP0,Y,119.4,1717.6,0.02,0.02,0.02,0.02,0.02,0.02,,000,107.2*5B\r\n",
+  0
+};
+
+/** Old way of GpsNmea: split the sentence into a string list. */
+static int parseSplit( const QString& sentenceIn )
+{
+  QString sentence;
+
+  int idx = sentenceIn.lastIndexOf( QChar('*') );
+
+  if( idx != -1 )
+    {
+      sentence = sentenceIn.left( idx );
+    }
+  else
+    {
+      sentence = sentenceIn;
+    }
+
+  QStringList slst = sentence.split( ",", Qt::KeepEmptyParts );
+
+  int sum = 0;
+
+  for( int i = 1; i < slst.size(); i++ )
+    {
+      bool ok;
+      sum += int( slst[i].toDouble( &ok ) );
+    }
+
+  return sum;
+}
+
+/** New way of GpsNmea: tokenize into the reused sentence buffer. */
+static int parseTokenizer( NmeaSentence& nmea, const QString& sentenceIn )
+{
+  if( nmea.parse( sentenceIn ) == false )
+    {
+      return 0;
+    }
+
+  int sum = 0;
+
+  for( int i = 1; i < nmea.size(); i++ )
+    {
+      bool ok;
+      sum += int( nmea[i].toDouble( &ok ) );
+    }
+
+  return sum;
+}
+
+int main( int argc, char* argv[] )
+{
+  QStringList sentences;
+
+  if( argc > 1 )
+    {
+      QFile file( argv[1] );
+
+      if( file.open( QIODevice::ReadOnly | QIODevice::Text ) == false )
+        {
+          fprintf( stderr, "Cannot open %s\n", argv[1] );
+          return 1;
+        }
+
+      while( file.atEnd() == false )
+        {
+          QString line = QString::fromLatin1( file.readLine() );
+
+          if( line.startsWith( '$' ) || line.startsWith( '!' ) )
+            {
+              sentences.append( line );
+            }
+        }
+    }
+  else
+    {
+      for( int i = 0; recordedMix[i] != 0; i++ )
+        {
+          sentences.append( QString::fromLatin1( recordedMix[i] ) );
+        }
+    }
+
+  int loops = ( argc > 2 ) ? atoi( argv[2] ) : 100000;
+
+  if( sentences.isEmpty() || loops <= 0 )
+    {
+      fprintf( stderr, "No sentences to parse\n" );
+      return 1;
+    }
+
+  NmeaSentence nmea;
+  QElapsedTimer t;
+  int sum = 0;
+
+  t.start();
+
+  for( int l = 0; l < loops; l++ )
+    {
+      for( int i = 0; i < sentences.size(); i++ )
+        {
+          sum += parseSplit( sentences.at(i) );
+        }
+    }
+
+  qint64 splitNs = t.nsecsElapsed();
+
+  t.start();
+
+  for( int l = 0; l < loops; l++ )
+    {
+      for( int i = 0; i < sentences.size(); i++ )
+        {
+          sum -= parseTokenizer( nmea, sentences.at(i) );
+        }
+    }
+
+  qint64 tokenNs = t.nsecsElapsed();
+
+  double count = double( loops ) * sentences.size();
+
+  printf( "sentences=%d loops=%d check=%d\n", sentences.size(), loops, sum );
+  printf( "split:     %12.0f sentences/s\n", count / ( splitNs / 1e9 ) );
+  printf( "tokenizer: %12.0f sentences/s\n", count / ( tokenNs / 1e9 ) );
+
+  return 0;
+}
@@ -0,0 +1,300 @@
+/*
+ * nmeareceive.cpp
+ *
+ *  Created on: 18.10.2026
+ *
+ *  Author: axel
+ *
+ *  Throughput test of the NMEA receive buffer used by the gpsClient.
+ *
+ *  Build:
+ *
+ *  g++ -O2 -fPIC -I../gpsClient nmeareceive.cpp ../gpsClient/NmeaLineBuffer.cpp \
+ *      $(pkg-config --cflags --libs Qt5Core) -o nmeareceive
+ *
+ *  Usage:
+ *
+ *  nmeareceive [capture-file] [seconds]
+ *
+ *  Without a capture file a Flarm data stream at 115200 baud with full
+ *  traffic is generated. The capture is fed in read chunks of varying size
+ *  into the old receive method and into NmeaLineBuffer.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <QtCore>
+
+#include "NmeaLineBuffer.h"
+
+static uchar checkSum( const char* sentence )
+{
+  uchar sum = 0;
+
+  for( int i = 1; sentence[i] != '\0' && sentence[i] != '*'; i++ )
+    {
+      sum ^= (uchar) sentence[i];
+    }
+
+  return sum;
+}
+
+static void appendSentence( QByteArray& capture, const QString& body )
+{
+  QByteArray ba = body.toLatin1();
+
+  capture.append( ba );
+  capture.append( QString::asprintf( "*%02X\r\n", checkSum( ba.data() ) ).toLatin1() );
+}
+
+/**
+ * Generates a capture of a Flarm at 115200 baud. Every second contains the
+ * GNSS sentences and the maximum of Flarm traffic until the line is full.
+ */
+static QByteArray generateCapture( const int seconds )
+{
+  QByteArray capture;
+
+  const int bytesPerSecond = 115200 / 10;
+
+  for( int s = 0; s < seconds; s++ )
+    {
+      int start = capture.size();
+
+      QString time = QString::asprintf( "%02d%02d%02d.00",
+                                        12 + s / 3600, (s / 60) % 60, s % 60 );
+
+      appendSentence( capture, "$GPRMC," + time + ",A,5228.19856,N,01408.32249,E,47.100,267.38,300710,,,A" );
+      appendSentence( capture, "$GPGGA," + time + ",5228.19856,N,01408.32249,E,1,09,0.9,92.4,M,44.9,M,," );
+      appendSentence( capture, "$GPGSA,A,3,10,07,05,02,29,04,08,13,,,,,1.72,1.03,1.38" );
+      appendSentence( capture, "$PGRMZ,1024,F,2" );
+      appendSentence( capture, "$PFLAU,30,1,2,1,0,-30,0,0,1254" );
+
+      for( int i = 0; capture.size() - start < bytesPerSecond - 60; i++ )
+        {
+          appendSentence( capture,
+                          QString::asprintf( "$PFLAA,0,%d,%d,%d,2,%06X,%d,,30,%.1f,1",
+                                             (i * 137) % 5000 - 2500,
+                                             (i * 311) % 5000 - 2500,
+                                             (i * 17) % 600 - 300,
+                                             0x400000 + i, (i * 7) % 360,
+                                             (i % 50) / 10.0 - 2.5 ) );
+        }
+    }
+
+  return capture;
+}
+
+/** Old receive method of the gpsClient, record per malloc and memmove. */
+class OldReceiver
+{
+ public:
+
+  OldReceiver() : datapointer(databuffer), dbsize(0), lines(0)
+  {
+    databuffer[0] = '\0';
+  };
+
+  int feed( const char* data, int size )
+  {
+    int used = 0;
+
+    while( used < size )
+      {
+        int freeSpace = sizeof(databuffer) - dbsize;
+
+        if( freeSpace < 10 )
+          {
+            datapointer = databuffer;
+            dbsize = 0;
+          }
+
+        int bytes = qMin( size - used, int( sizeof(databuffer) - dbsize - 1 ) );
+
+        memcpy( datapointer, data + used, bytes );
+        used += bytes;
+
+        dbsize      += bytes;
+        datapointer += bytes;
+        databuffer[dbsize] = '\0';
+
+        readSentenceFromBuffer();
+      }
+
+    return lines;
+  };
+
+ private:
+
+  bool verifyCheckSum( const char *sentence )
+  {
+    if( sentence[0] != '$' && sentence[0] != '!' )
+      {
+        return false;
+      }
+
+    for( int i = strlen(sentence) - 1; i >= 0; i-- )
+      {
+        if( sentence[i] == '*' )
+          {
+            if( (strlen(sentence) - 1 - i) < 2 )
+              {
+                return false;
+              }
+
+            char checkBytes[3];
+            checkBytes[0] = sentence[i+1];
+            checkBytes[1] = sentence[i+2];
+            checkBytes[2] = '\0';
+
+            return (uchar) QString( checkBytes ).toUShort( 0, 16 ) == checkSum( sentence );
+          }
+      }
+
+    return false;
+  };
+
+  void readSentenceFromBuffer()
+  {
+    char *start = databuffer;
+    char *end   = 0;
+
+    while( strlen(start) )
+      {
+        if( ! (end = strchr( start, '\n' )) )
+          {
+            return;
+          }
+
+        if( start == end )
+          {
+            start++;
+            continue;
+          }
+
+        char *record = (char *) malloc( end-start + 2 );
+
+        memset( record, 0, end-start + 2 );
+        strncpy( record, start, end-start + 1 );
+
+        if( verifyCheckSum( record ) == true )
+          {
+            lines++;
+          }
+
+        free( record );
+
+        memmove( databuffer, end+1, databuffer + sizeof(databuffer)-1 - end );
+
+        datapointer -= (end+1 - databuffer);
+        dbsize -= ( end+1 - databuffer);
+        start = databuffer;
+      }
+  };
+
+  char* datapointer;
+  char  databuffer[1024];
+  int   dbsize;
+  int   lines;
+};
+
+/** New receive method, views into a circular buffer. */
+static int feedLineBuffer( NmeaLineBuffer& buffer, int& lines,
+                           const char* data, int size )
+{
+  int used = 0;
+
+  while( used < size )
+    {
+      int space = 0;
+      char* target = buffer.writeSpace( space );
+
+      int bytes = qMin( size - used, space );
+
+      memcpy( target, data + used, bytes );
+      buffer.commit( bytes );
+      used += bytes;
+
+      const char* line = 0;
+      int length = 0;
+
+      while( buffer.nextLine( line, length ) )
+        {
+          if( (line[0] == '$' || line[0] == '!') &&
+              NmeaLineBuffer::verifyCheckSum( line, length ) )
+            {
+              lines++;
+            }
+        }
+    }
+
+  return lines;
+}
+
+int main( int argc, char* argv[] )
+{
+  QByteArray capture;
+
+  int seconds = ( argc > 2 ) ? atoi( argv[2] ) : 600;
+
+  if( argc > 1 && strcmp( argv[1], "-" ) != 0 )
+    {
+      QFile file( argv[1] );
+
+      if( file.open( QIODevice::ReadOnly ) == false )
+        {
+          fprintf( stderr, "Cannot open %s\n", argv[1] );
+          return 1;
+        }
+
+      capture = file.readAll();
+    }
+  else
+    {
+      capture = generateCapture( seconds );
+    }
+
+  // Read chunk sizes as delivered by a serial device or a socket.
+  static const int chunks[] = { 1, 7, 32, 64, 100, 255, 512, 1000, 4096 };
+
+  printf( "capture: %d bytes\n", capture.size() );
+
+  for( uint c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++ )
+    {
+      QElapsedTimer t;
+
+      OldReceiver old;
+      int oldLines = 0;
+
+      t.start();
+
+      for( int i = 0; i < capture.size(); i += chunks[c] )
+        {
+          oldLines = old.feed( capture.data() + i, qMin( chunks[c], capture.size() - i ) );
+        }
+
+      qint64 oldNs = t.nsecsElapsed();
+
+      NmeaLineBuffer buffer;
+      int newLines = 0;
+
+      t.start();
+
+      for( int i = 0; i < capture.size(); i += chunks[c] )
+        {
+          feedLineBuffer( buffer, newLines, capture.data() + i,
+                          qMin( chunks[c], capture.size() - i ) );
+        }
+
+      qint64 newNs = t.nsecsElapsed();
+
+      printf( "chunk %4d: old %8.1f MB/s %d lines, new %8.1f MB/s %d lines\n",
+              chunks[c],
+              capture.size() / ( oldNs / 1e3 ), oldLines,
+              capture.size() / ( newNs / 1e3 ), newLines );
+    }
+
+  return 0;
+}
@@ -0,0 +1,238 @@
+/*
+ * thermaldetector.cpp
+ *
+ *  Created on: 18.10.2026
+ *
+ *  Author: axel
+ *
+ *  Checks the thermal detection from circling Flarm targets.
+ *
+ *  Build:
+ *
+ *  g++ -O2 -fPIC -I../cumulus thermaldetector.cpp ../cumulus/ThermalDetector.cpp \
+ *      ../cumulus/FlarmTraffic.cpp $(pkg-config --cflags --libs Qt5Core) \
+ *      -o thermaldetector
+ *
+ *  Usage:
+ *
+ *  thermaldetector
+ *
+ *  Synthetic targets are reported once per second. Glider A circles alone in
+ *  a thermal, later glider B joins it. Glider C flies straight and climbs in
+ *  a wave, glider D circles alone in another thermal 3 km away. It is checked
+ *  that
+ *
+ *  - only the circling gliders are detected,
+ *  - the samples of A and B are clustered into one hotspot near the thermal
+ *    center, which is confirmed only after B has joined,
+ *  - the hotspot of D alone is never confirmed,
+ *  - the hotspots expire after ThermalDetector::MaxAge without samples.
+ *
+ *  The program exits with 1, if a check fails.
+ */
+
+#include <cmath>
+#include <cstdio>
+
+#include "FlarmTraffic.h"
+#include "ThermalDetector.h"
+
+// KFLog coordinate units per meter along a meridian, as in ThermalDetector
+#define UNITS_PER_METER (600000.0 / 111195.0)
+
+// Radius of the thermal circles in m
+#define RADIUS 100.0
+
+// Turn rate of the circling gliders in degrees per second
+#define TURN_RATE 18.0
+
+// Own position, 52N 13E, and own altitude in m
+static const QPoint ownPosition( 52 * 600000, 13 * 600000 );
+static const int ownAltitude = 1000;
+
+static int failures = 0;
+
+static void check( const bool ok, const char* what )
+{
+  printf( "%-60s %s\n", what, ok ? "ok" : "FAILED" );
+
+  if( ok == false )
+    {
+      failures++;
+    }
+}
+
+/**
+ * Reports a glider circling right around the passed center, relative to the
+ * own position in m.
+ */
+static FlarmBase::FlarmAcft circling( const uint id, const qint64 time,
+                                      const double centerNorth,
+                                      const double centerEast,
+                                      const double climb )
+{
+  double s = time / 1000.0;
+  double track = fmod( TURN_RATE * s, 360.0 );
+
+  // The center is on the right side of the track.
+  double side = (track - 90.0) * M_PI / 180.0;
+
+  FlarmBase::FlarmAcft acft;
+
+  acft.TimeStamp        = time;
+  acft.ID               = id;
+  acft.RelativeNorth    = qRound( centerNorth + RADIUS * cos( side ) );
+  acft.RelativeEast     = qRound( centerEast + RADIUS * sin( side ) );
+  acft.RelativeVertical = qRound( climb * s );
+  acft.Track            = qRound( track ) % 360;
+  acft.GroundSpeed      = TURN_RATE * M_PI / 180.0 * RADIUS;
+  acft.ClimbRate        = climb;
+
+  return acft;
+}
+
+/** Reports a glider flying straight to the east. */
+static FlarmBase::FlarmAcft straight( const uint id, const qint64 time,
+                                      const double climb )
+{
+  double s = time / 1000.0;
+
+  FlarmBase::FlarmAcft acft;
+
+  acft.TimeStamp        = time;
+  acft.ID               = id;
+  acft.RelativeNorth    = 1000;
+  acft.RelativeEast     = qRound( -2000.0 + 30.0 * s );
+  acft.RelativeVertical = qRound( climb * s );
+  acft.Track            = 90;
+  acft.GroundSpeed      = 30.0;
+  acft.ClimbRate        = climb;
+
+  return acft;
+}
+
+/** \return The distance in m of the hotspot from the relative position. */
+static double distance( const ThermalDetector::Hotspot& hs,
+                        const double north, const double east )
+{
+  const double cosLat = cos( ownPosition.x() / 600000.0 * M_PI / 180.0 );
+
+  double dNorth = (hs.Latitude - ownPosition.x()) / UNITS_PER_METER - north;
+  double dEast  = (hs.Longitude - ownPosition.y()) * cosLat / UNITS_PER_METER - east;
+
+  return sqrt( dNorth * dNorth + dEast * dEast );
+}
+
+/** \return The index of the hotspot nearest to the relative position. */
+static int nearest( const ThermalDetector& detector,
+                    const double north, const double east )
+{
+  int index = -1;
+
+  for( int i = 0; i < detector.size(); i++ )
+    {
+      if( index == -1 ||
+          distance( detector.at(i), north, east ) <
+          distance( detector.at(index), north, east ) )
+        {
+          index = i;
+        }
+    }
+
+  return index;
+}
+
+/** \return The number of confirmed hotspots. */
+static int confirmed( const ThermalDetector& detector )
+{
+  int count = 0;
+
+  for( int i = 0; i < detector.size(); i++ )
+    {
+      if( detector.at(i).isConfirmed() )
+        {
+          count++;
+        }
+    }
+
+  return count;
+}
+
+int main()
+{
+  const uint idA = 0x3D1001, idB = 0x3D1002, idC = 0x3D1003, idD = 0x3D1004;
+
+  FlarmTraffic traffic;
+  FlarmTraffic::Snapshot snapshot;
+  ThermalDetector detector;
+
+  bool changedByB = false;
+  bool circlingA = false;
+  bool circlingC = false;
+  qint64 time = 0;
+
+  // Glider A circles alone for 60s, glider B joins it for another 60s.
+  for( time = 1000; time <= 120000; time += 1000 )
+    {
+      traffic.update( circling( idA, time, 500.0, 0.0, 2.0 ) );
+      traffic.update( straight( idC, time, 1.0 ) );
+      traffic.update( circling( idD, time, 500.0, 3000.0, 1.5 ) );
+
+      if( time > 60000 )
+        {
+          traffic.update( circling( idB, time, 540.0, 60.0, 2.5 ) );
+        }
+
+      traffic.takeSnapshot( snapshot );
+
+      bool changed = detector.update( snapshot, ownPosition, ownAltitude, time );
+
+      if( time == 60000 )
+        {
+          double turnRate;
+
+          circlingA = ThermalDetector::isCircling( *snapshot.find( idA ), turnRate );
+          circlingC = ThermalDetector::isCircling( *snapshot.find( idC ), turnRate );
+
+          check( circlingA && fabs( turnRate - TURN_RATE ) < 1.0,
+                 "circling glider is detected with its turn rate" );
+          check( circlingC == false, "straight glider is not circling" );
+          check( detector.size() == 2, "one hotspot per single circling glider" );
+          check( confirmed( detector ) == 0, "single glider does not confirm a hotspot" );
+        }
+
+      if( time > 60000 && changed )
+        {
+          changedByB = true;
+        }
+    }
+
+  check( changedByB, "joining glider reports a confirmed hotspot" );
+  check( detector.size() == 2, "samples of two gliders are clustered" );
+
+  int thermal = nearest( detector, 500.0, 0.0 );
+  int single  = nearest( detector, 500.0, 3000.0 );
+
+  check( thermal != -1 && distance( detector.at( thermal ), 520.0, 30.0 ) < 80.0,
+         "hotspot is at the thermal center" );
+  check( thermal != -1 && detector.at( thermal ).isConfirmed() &&
+         detector.at( thermal ).Gliders == 2,
+         "hotspot of two gliders is confirmed" );
+  check( thermal != -1 && detector.at( thermal ).Bottom >= ownAltitude &&
+         detector.at( thermal ).Top > detector.at( thermal ).Bottom,
+         "hotspot keeps the altitude band" );
+  check( single != -1 && single != thermal &&
+         detector.at( single ).isConfirmed() == false,
+         "hotspot of a single glider is not confirmed" );
+
+  // No more samples, the hotspots must expire after MaxAge.
+  const qint64 last = time - 1000;
+
+  check( detector.expire( last + ThermalDetector::MaxAge - 1000 ) == false &&
+         detector.size() == 2, "hotspots are kept within MaxAge" );
+
+  check( detector.expire( last + ThermalDetector::MaxAge + 1000 ) == true &&
+         detector.size() == 0, "hotspots expire after MaxAge" );
+
+  return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,300 @@
+/*
+ * variofilter.cpp
+ *
+ *  Created on: 18.10.2026
+ *
+ *  Author: axel
+ *
+ *  Compares the Kalman filter vario of Cumulus with the former vario, which
+ *  averaged the altitude differences over the integration time.
+ *
+ *  Build:
+ *
+ *  g++ -O2 -fPIC -I../cumulus variofilter.cpp ../cumulus/KalmanVario.cpp \
+ *      $(pkg-config --cflags Qt5Core) -o variofilter
+ *
+ *  Usage:
+ *
+ *  variofilter [seed]
+ *
+ *  A synthetic flight is replayed with GNSS, baro and acceleration data. The
+ *  flight sinks with 1 m/s, enters a 3 m/s thermal, crosses a varying
+ *  thermal and sinks with 1.5 m/s at the end. For every sensor setup the lag
+ *  of the step to 90% is measured with exact data and the noise in the
+ *  steady phases with noisy data.
+ *
+ *  The program exits with 1, if the Kalman vario is slower or noisier than
+ *  the former vario in any setup.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <random>
+
+#include "KalmanVario.h"
+
+// Integration time of the former vario in ms
+#define INT_TIME 3000
+
+// Duration of the replay in ms
+#define DURATION 240000
+
+// Time of the climb step in ms
+#define STEP_TIME 60000
+
+/** True climb rate in m/s at time t in ms. */
+static double trueClimb( const qint64 t )
+{
+  double s = t / 1000.0;
+
+  if( s < 60.0 )
+    {
+      return -1.0;
+    }
+
+  if( s < 61.0 )
+    {
+      // Entry into the thermal within one second
+      return -1.0 + 4.0 * (s - 60.0);
+    }
+
+  if( s < 120.0 )
+    {
+      return 3.0;
+    }
+
+  if( s < 180.0 )
+    {
+      return 2.0 + 1.5 * sin( 2.0 * M_PI * (s - 120.0) / 20.0 );
+    }
+
+  return -1.5;
+}
+
+/**
+ * The former vario. It averages the climb rates of adjacent altitude
+ * samples over the integration time.
+ */
+class WindowVario
+{
+ public:
+
+  WindowVario( const double limit ) : m_limit( limit ), m_climb( 0.0 )
+  {
+  };
+
+  void add( const qint64 time, const double altitude )
+  {
+    m_samples.push_front( std::make_pair( time, altitude ) );
+
+    while( m_samples.size() > 2 &&
+           m_samples.front().first - m_samples.back().first > INT_TIME )
+      {
+        m_samples.pop_back();
+      }
+
+    if( m_samples.size() < 2 )
+      {
+        return;
+      }
+
+    double sum = 0.0;
+
+    for( size_t i = 1; i < m_samples.size(); i++ )
+      {
+        double diff = (m_samples[i-1].second - m_samples[i].second) * 1000.0 /
+                      (m_samples[i-1].first - m_samples[i].first);
+
+        if( fabs( diff ) > m_limit )
+          {
+            sum += diff;
+          }
+      }
+
+    m_climb = sum / (m_samples.size() - 1);
+  };
+
+  double climb() const
+  {
+    return m_climb;
+  };
+
+ private:
+
+  double m_limit;
+  double m_climb;
+  std::deque< std::pair<qint64, double> > m_samples;
+};
+
+/** Statistics of one estimator. */
+class Result
+{
+ public:
+
+  Result() : stepTime( -1 ), sumSq( 0.0 ), count( 0 )
+  {
+  };
+
+  void add( const qint64 t, const double climb )
+  {
+    if( stepTime < 0 && t >= STEP_TIME && climb >= -1.0 + 0.9 * 4.0 )
+      {
+        stepTime = t - STEP_TIME;
+      }
+
+    // The steady phases, after the estimators have settled
+    if( (t >= 90000 && t < 120000) || (t >= 200000 && t < DURATION) )
+      {
+        double err = climb - trueClimb( t );
+        sumSq += err * err;
+        count++;
+      }
+  };
+
+  double rms() const
+  {
+    return count ? sqrt( sumSq / count ) : 0.0;
+  };
+
+  void print( const char* name ) const
+  {
+    printf( "%-28s %8.0f %10.3f\n", name,
+            stepTime < 0 ? -1.0 : double( stepTime ), rms() );
+  };
+
+  qint64 stepTime; // ms to 90% of the step
+  double sumSq;
+  int    count;
+};
+
+/**
+ * Replays the synthetic flight.
+ *
+ * \param gnssRate GNSS fixes per second, 0 = none
+ * \param baroRate Baro samples per second, 0 = none
+ * \param accel    Use the acceleration at the baro rate
+ * \param noisy    Add the sensor noise, otherwise the data are exact
+ */
+static void replay( const unsigned seed, const int gnssRate,
+                    const int baroRate, const bool accel, const bool noisy,
+                    Result& windowResult, Result& kalmanResult )
+{
+  std::mt19937 rnd( seed );
+  std::normal_distribution<double> gnssNoise( 0.0, noisy ? 2.0 : 0.0 );
+  std::normal_distribution<double> baroNoise( 0.0, noisy ? 0.3 : 0.0 );
+  std::normal_distribution<double> accelNoise( 0.0, noisy ? 0.2 : 0.0 );
+
+  // The GNSS altitude has another reference than the baro altitude.
+  const double gnssOffset = 42.0;
+
+  // Acceleration bias of the sensor in m/s²
+  const double accelBias = noisy ? 0.05 : 0.0;
+
+  WindowVario window( baroRate ? 0.35 : 0.0 );
+  KalmanVario kalman;
+
+  double altitude = 1000.0;
+  double climb = trueClimb( 0 );
+
+  for( qint64 t = 0; t < DURATION; t++ )
+    {
+      // Integrate the true flight in steps of 1 ms.
+      double newClimb = trueClimb( t );
+      double a = (newClimb - climb) * 1000.0;
+
+      altitude += (climb + newClimb) / 2.0 / 1000.0;
+      climb = newClimb;
+
+      bool sampled = false;
+
+      if( accel && t % (1000 / baroRate) == 0 )
+        {
+          // As the vario does with an AHRS
+          kalman.setAccelerationNoise( 0.5 );
+          kalman.setAcceleration( a + accelBias + accelNoise( rnd ) );
+        }
+
+      if( gnssRate && t % (1000 / gnssRate) == 0 )
+        {
+          double z = altitude + gnssOffset + gnssNoise( rnd );
+
+          kalman.updateGnss( t, z, 3.0 );
+
+          if( baroRate == 0 )
+            {
+              window.add( t, z );
+            }
+
+          sampled = true;
+        }
+
+      if( baroRate && t % (1000 / baroRate) == 0 )
+        {
+          double z = altitude + baroNoise( rnd );
+
+          kalman.updateBaro( t, z, 0.5 );
+          window.add( t, z );
+          sampled = true;
+        }
+
+      if( sampled )
+        {
+          windowResult.add( t, window.climb() );
+          kalmanResult.add( t, kalman.climb() );
+        }
+    }
+}
+
+/**
+ * Compares both varios for one sensor setup. The lag is taken from exact
+ * data, so that the noise cannot shorten it, the noise from noisy data.
+ *
+ * \return True, if the Kalman vario is neither slower nor noisier.
+ */
+static bool compare( const char* name, const unsigned seed, const int gnssRate,
+                     const int baroRate, const bool accel )
+{
+  Result windowExact, kalmanExact;
+  Result windowNoisy, kalmanNoisy;
+
+  replay( seed, gnssRate, baroRate, accel, false, windowExact, kalmanExact );
+  replay( seed, gnssRate, baroRate, accel, true, windowNoisy, kalmanNoisy );
+
+  windowNoisy.stepTime = windowExact.stepTime;
+  kalmanNoisy.stepTime = kalmanExact.stepTime;
+
+  printf( "%s\n", name );
+  windowNoisy.print( "  former vario" );
+  kalmanNoisy.print( "  Kalman vario" );
+
+  bool ok = kalmanExact.stepTime >= 0 &&
+            (windowExact.stepTime < 0 || kalmanExact.stepTime <= windowExact.stepTime) &&
+            kalmanNoisy.rms() <= windowNoisy.rms();
+
+  if( ! ok )
+    {
+      printf( "  FAILED: the Kalman vario is slower or noisier\n" );
+    }
+
+  return ok;
+}
+
+int main( int argc, char* argv[] )
+{
+  unsigned seed = argc > 1 ? atoi( argv[1] ) : 1;
+
+  printf( "%-28s %8s %10s\n", "Setup", "Lag [ms]", "Noise [m/s]" );
+
+  bool ok = true;
+
+  ok &= compare( "GNSS 1 Hz", seed, 1, 0, false );
+  ok &= compare( "GNSS 5 Hz", seed, 5, 0, false );
+  ok &= compare( "GNSS 10 Hz", seed, 10, 0, false );
+  ok &= compare( "Baro 10 Hz", seed, 0, 10, false );
+  ok &= compare( "Baro 10 Hz, GNSS 1 Hz", seed, 1, 10, false );
+  ok &= compare( "Baro 10 Hz, GNSS 1 Hz, AHRS", seed, 1, 10, true );
+
+  return ok ? 0 : 1;
+}
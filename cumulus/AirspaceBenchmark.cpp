@@ -0,0 +1,400 @@
+/***********************************************************************
+**
+**   AirspaceBenchmark.cpp
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include <QtCore>
+
+#include "airspace.h"
+#include "AirspaceBenchmark.h"
+#include "AirspaceHelper.h"
+#include "calculator.h"
+#include "generalconfig.h"
+#include "map.h"
+#include "mapcontents.h"
+#include "mapmatrix.h"
+#include "openairparser.h"
+
+extern MapContents* _globalMapContents;
+extern MapMatrix*   _globalMapMatrix;
+
+AirspaceBenchmark::AirspaceBenchmark( QObject *parent ) :
+  QObject( parent ),
+  m_seed( 4711 ),
+  m_state( 4711 ),
+  m_count( 5000 ),
+  m_loops( 10 ),
+  m_center( 52 * 600000, 13 * 600000 )
+{
+  setObjectName( "AirspaceBenchmark" );
+
+  // Take over the optional arguments of the command line.
+  QStringList args = QCoreApplication::arguments();
+
+  for( int i = 0; i < args.size(); i++ )
+    {
+      const QString& arg = args.at(i);
+
+      if( arg.startsWith( "lat=" ) || arg.startsWith( "lon=" ) )
+        {
+          // The center of the field is passed in decimal degrees.
+          bool ok = false;
+          double degrees = arg.section( '=', 1 ).toDouble( &ok );
+
+          if( ok && arg.startsWith( "lat=" ) && fabs( degrees ) <= 90.0 )
+            {
+              m_center.setX( qRound( degrees * 600000.0 ) );
+            }
+          else if( ok && arg.startsWith( "lon=" ) && fabs( degrees ) <= 180.0 )
+            {
+              m_center.setY( qRound( degrees * 600000.0 ) );
+            }
+
+          continue;
+        }
+
+      bool ok = false;
+      int value = arg.section( '=', 1 ).toInt( &ok );
+
+      if( ok == false || value <= 0 )
+        {
+          continue;
+        }
+
+      if( arg.startsWith( "seed=" ) )
+        {
+          m_seed = value;
+        }
+      else if( arg.startsWith( "count=" ) )
+        {
+          m_count = value;
+        }
+      else if( arg.startsWith( "loops=" ) )
+        {
+          m_loops = value;
+        }
+    }
+
+  m_state = m_seed;
+}
+
+AirspaceBenchmark::~AirspaceBenchmark()
+{
+}
+
+bool AirspaceBenchmark::isRequested()
+{
+  return QCoreApplication::arguments().contains( "--airspace-benchmark" );
+}
+
+quint32 AirspaceBenchmark::random()
+{
+  // xorshift32, the sequence is identical on all platforms.
+  m_state ^= m_state << 13;
+  m_state ^= m_state >> 17;
+  m_state ^= m_state << 5;
+  return m_state;
+}
+
+int AirspaceBenchmark::random( const int min, const int max )
+{
+  return min + int( random() % quint32( max - min + 1 ) );
+}
+
+QString AirspaceBenchmark::openAirCoordinate( const int lat, const int lon )
+{
+  // Decimal degrees are accepted by the OpenAir parser.
+  return QString( "%1%2 %3%4" )
+           .arg( qAbs(lat) / 600000.0, 0, 'f', 6 ).arg( lat < 0 ? 'S' : 'N' )
+           .arg( qAbs(lon) / 600000.0, 0, 'f', 6 ).arg( lon < 0 ? 'W' : 'E' );
+}
+
+bool AirspaceBenchmark::createOpenAirFile( const QString& fileName )
+{
+  QFile file( fileName );
+
+  if( file.open( QIODevice::WriteOnly | QIODevice::Text ) == false )
+    {
+      qWarning() << "ASB: Cannot open" << fileName << "for writing!";
+      return false;
+    }
+
+  QTextStream out( &file );
+
+  // The airspaces are spread over a region of about 200 x 200km around the
+  // center.
+  const QPoint& center = m_center;
+  const int latSpread = 600000;
+  const int lonSpread = 900000;
+
+  const char* classes[] = { "C", "D", "E", "R", "Q", "P", "CTR", "RMZ", "TMZ" };
+  const int classCount = sizeof(classes) / sizeof(classes[0]);
+
+  for( int i = 0; i < m_count; i++ )
+    {
+      int lat = center.x() + random( -latSpread, latSpread );
+      int lon = center.y() + random( -lonSpread, lonSpread );
+
+      int lower = (random() % 2) ? 0 : random( 1, 60 ) * 100;
+      int upper = lower + random( 10, 100 ) * 100;
+
+      out << "AC " << classes[random() % classCount] << "\n";
+      out << "AN Benchmark " << i << "\n";
+
+      if( lower == 0 )
+        {
+          out << "AL GND\n";
+        }
+      else
+        {
+          out << "AL " << lower << "ft MSL\n";
+        }
+
+      out << "AH " << upper << "ft MSL\n";
+
+      // Radius in NM
+      double radius = random( 10, 100 ) / 10.0;
+
+      switch( i % 3 )
+        {
+          case 0:
+            {
+              // Polygon with 5...24 corners around the center point.
+              int corners = random( 5, 24 );
+              int r = int( radius * 10000.0 );
+
+              for( int j = 0; j < corners; j++ )
+                {
+                  double phi = 2.0 * M_PI * j / corners;
+                  int plat = lat + int( cos( phi ) * r * random( 70, 100 ) / 100 );
+                  int plon = lon + int( sin( phi ) * r * 1.5 * random( 70, 100 ) / 100 );
+
+                  out << "DP " << openAirCoordinate( plat, plon ) << "\n";
+                }
+            }
+            break;
+
+          case 1:
+            // Circle
+            out << "V X=" << openAirCoordinate( lat, lon ) << "\n";
+            out << "DC " << radius << "\n";
+            break;
+
+          default:
+            {
+              // Sector with two arcs
+              int a1 = random( 0, 359 );
+              int a2 = (a1 + random( 30, 300 )) % 360;
+
+              out << "V X=" << openAirCoordinate( lat, lon ) << "\n";
+              out << "V D=+\n";
+              out << "DA " << radius << "," << a1 << "," << a2 << "\n";
+              out << "V D=-\n";
+              out << "DA " << radius / 2.0 << "," << a2 << "," << a1 << "\n";
+            }
+            break;
+        }
+
+      out << "\n";
+    }
+
+  out.flush();
+  file.close();
+  return true;
+}
+
+void AirspaceBenchmark::report( const QString& name, QVector<qint64>& nsecs )
+{
+  if( nsecs.isEmpty() )
+    {
+      return;
+    }
+
+  std::sort( nsecs.begin(), nsecs.end() );
+
+  qint64 sum = 0;
+
+  for( int i = 0; i < nsecs.size(); i++ )
+    {
+      sum += nsecs.at(i);
+    }
+
+  fprintf( stdout, "ASB %-24s n=%-5d min=%.3fms median=%.3fms mean=%.3fms max=%.3fms\n",
+           name.toLatin1().data(),
+           nsecs.size(),
+           nsecs.first() / 1e6,
+           nsecs.at( nsecs.size() / 2 ) / 1e6,
+           double(sum) / nsecs.size() / 1e6,
+           nsecs.last() / 1e6 );
+
+  fflush( stdout );
+}
+
+void AirspaceBenchmark::slotRun()
+{
+  Map* map = Map::getInstance();
+
+  if( map == 0 || _globalMapContents == 0 || calculator == 0 )
+    {
+      qWarning() << "ASB: Map is not initialized, benchmark aborted!";
+      QCoreApplication::exit( 1 );
+      return;
+    }
+
+  fprintf( stdout, "ASB version=%s qt=%s cpus=%d seed=%u count=%d loops=%d lat=%.6f lon=%.6f\n",
+           QCoreApplication::applicationVersion().toLatin1().data(),
+           qVersion(),
+           QThread::idealThreadCount(),
+           m_seed, m_count, m_loops,
+           m_center.x() / 600000.0, m_center.y() / 600000.0 );
+
+  QTemporaryDir tmpDir;
+
+  if( tmpDir.isValid() == false )
+    {
+      qWarning() << "ASB: Cannot create a temporary directory, benchmark aborted!";
+      QCoreApplication::exit( 1 );
+      return;
+    }
+
+  QString txtName = tmpDir.path() + "/benchmark.txt";
+  QString txcName = tmpDir.path() + "/benchmark.txc";
+
+  m_state = m_seed;
+
+  if( createOpenAirFile( txtName ) == false )
+    {
+      QCoreApplication::exit( 1 );
+      return;
+    }
+
+  QElapsedTimer t;
+  QVector<qint64> parse, compile, load, drawReset, draw, check;
+
+  // Parse the OpenAir source, circles and arcs are created by the parser.
+  QList<Airspace*> airspaceList;
+
+  for( int i = 0; i < m_loops; i++ )
+    {
+      qDeleteAll( airspaceList );
+      airspaceList.clear();
+
+      OpenAirParser oap;
+      t.start();
+      oap.parse( txtName, airspaceList, false );
+      parse.append( t.nsecsElapsed() );
+    }
+
+  for( int i = 0; i < m_loops; i++ )
+    {
+      t.start();
+      AirspaceHelper::createCompiledFile( txcName, airspaceList, 0 );
+      compile.append( t.nsecsElapsed() );
+    }
+
+  qDeleteAll( airspaceList );
+  airspaceList.clear();
+
+  // The compiled file is mapped, the airspaces are created on demand.
+  AirspaceStore* store = 0;
+
+  for( int i = 0; i < m_loops; i++ )
+    {
+      delete store;
+
+      t.start();
+      store = AirspaceHelper::openCompiledFile( txcName );
+      load.append( t.nsecsElapsed() );
+    }
+
+  if( store == 0 )
+    {
+      qWarning() << "ASB: Cannot open" << txcName << ", benchmark aborted!";
+      QCoreApplication::exit( 1 );
+      return;
+    }
+
+  fprintf( stdout, "ASB airspaces=%d\n", store->count() );
+
+  // The benchmark airspaces are swapped in, the loaded ones are restored at
+  // the end. The map is centered to the field.
+  SortableAirspaceList benchmarkList;
+  AirspaceStoreList benchmarkStores;
+  benchmarkStores.append( store );
+
+  _globalMapContents->swapAirspaces( benchmarkList, benchmarkStores );
+
+  const QPoint mapCenter = _globalMapMatrix->getMapCenter();
+
+  _globalMapMatrix->centerToLatLon( m_center );
+  _globalMapMatrix->createMatrix( map->size() );
+
+  for( int i = 0; i < m_loops; i++ )
+    {
+      t.start();
+      map->p_drawAirspaces( true );
+      drawReset.append( t.nsecsElapsed() );
+    }
+
+  for( int i = 0; i < m_loops; i++ )
+    {
+      t.start();
+      map->p_drawAirspaces( false );
+      draw.append( t.nsecsElapsed() );
+    }
+
+  // Fly a zigzag path through the region. Warning pop ups are disabled
+  // during that time.
+  GeneralConfig* conf = GeneralConfig::instance();
+  bool warningEnabled = conf->getAirspaceWarningEnabled();
+  conf->setAirspaceWarningEnabled( false );
+
+  const QPoint& center = m_center;
+  const int steps = 1000;
+
+  for( int i = 0; i < steps; i++ )
+    {
+      int lat = center.x() - 600000 + 1200000 * i / steps;
+      int phase = (i * 8) % (2 * steps);
+      int lon = center.y() - 900000 +
+                1800000 * (phase < steps ? phase : 2 * steps - phase) / steps;
+
+      t.start();
+      map->checkAirspace( QPoint( lat, lon ) );
+      check.append( t.nsecsElapsed() );
+    }
+
+  conf->setAirspaceWarningEnabled( warningEnabled );
+
+  // Restore the loaded airspaces and the map center.
+  _globalMapContents->swapAirspaces( benchmarkList, benchmarkStores );
+  qDeleteAll( benchmarkList );
+  qDeleteAll( benchmarkStores );
+
+  _globalMapMatrix->centerToLatLon( mapCenter );
+  _globalMapMatrix->createMatrix( map->size() );
+  map->scheduleRedraw();
+
+  report( "parse", parse );
+  report( "compile", compile );
+  report( "load", load );
+  report( "drawAirspaces(reset)", drawReset );
+  report( "drawAirspaces", draw );
+  report( "checkAirspace", check );
+
+  QCoreApplication::exit( 0 );
+}
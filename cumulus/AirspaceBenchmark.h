@@ -0,0 +1,117 @@
+/***********************************************************************
+**
+**   AirspaceBenchmark.h
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+/**
+ * \class AirspaceBenchmark
+ *
+ * \author Axel Pauli
+ *
+ * \brief Synthetic airspace stress benchmark.
+ *
+ * The benchmark generates a reproducible OpenAir file with polygons, circles
+ * and arcs spread over a region around a fixed center, 52N 13E by default.
+ * The file is parsed by the \ref OpenAirParser, so circles and arcs run
+ * through the normal addCircle and addArc paths. Afterwards the following
+ * steps are measured:
+ *
+ * <ul>
+ * <li>compilation and loading of the compiled file by \ref AirspaceHelper</li>
+ * <li>airspace drawing by Map::p_drawAirspaces</li>
+ * <li>Map::checkAirspace along a scripted zigzag flight path</li>
+ * </ul>
+ *
+ * The map is centered to the field and works on the benchmark airspaces only.
+ * The loaded airspaces and the map center are restored at the end.
+ *
+ * The benchmark is started with the command line option
+ *
+ * cumulus -platform offscreen --airspace-benchmark [seed=N] [count=N] [loops=N]
+ *   [lat=DEG] [lon=DEG]
+ *
+ * The center is passed in decimal degrees, south and west are negative.
+ *
+ * Results are written line by line to stdout, so that they can be compared
+ * between releases and hardware. Cumulus terminates after the run.
+ *
+ * \date 2026
+ *
+ * \version 1.0
+ */
+
+#pragma once
+
+#include <QList>
+#include <QObject>
+#include <QPoint>
+#include <QString>
+#include <QVector>
+
+class Airspace;
+
+class AirspaceBenchmark : public QObject
+{
+  Q_OBJECT
+
+ private:
+
+  Q_DISABLE_COPY ( AirspaceBenchmark )
+
+ public:
+
+  AirspaceBenchmark( QObject *parent=0 );
+
+  virtual ~AirspaceBenchmark();
+
+  /**
+   * \return True, if the benchmark was requested on the command line.
+   */
+  static bool isRequested();
+
+ public slots:
+
+  /**
+   * Runs the benchmark and terminates the application afterwards.
+   */
+  void slotRun();
+
+ private:
+
+  /**
+   * Creates the synthetic OpenAir file.
+   *
+   * \return true in case of success otherwise false
+   */
+  bool createOpenAirFile( const QString& fileName );
+
+  /** Returns the next pseudo random number of the reproducible generator. */
+  quint32 random();
+
+  /** Returns a pseudo random number in the range min...max. */
+  int random( const int min, const int max );
+
+  /** Formats a WGS coordinate in KFLog units as OpenAir coordinate. */
+  QString openAirCoordinate( const int lat, const int lon );
+
+  /** Prints the statistics of the passed measurements in milli seconds. */
+  void report( const QString& name, QVector<qint64>& nsecs );
+
+  quint32 m_seed;
+  quint32 m_state;
+  int     m_count;
+  int     m_loops;
+
+  /** Center of the airspace field in KFLog coordinates */
+  QPoint  m_center;
+};
@@ -0,0 +1,429 @@
+/***********************************************************************
+**
+**   AirspaceClearance.cpp
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include <QtCore>
+
+#include "airspace.h"
+#include "AirspaceClearance.h"
+#include "AirspaceFilters.h"
+#include "calculator.h"
+#include "flighttask.h"
+#include "generalconfig.h"
+#include "mapcalc.h"
+#include "mapcontents.h"
+#include "mapmatrix.h"
+
+extern MapContents* _globalMapContents;
+extern MapMatrix*   _globalMapMatrix;
+
+double AirspaceClearance::altitudeLoss( const int bearing, const double distance )
+{
+  if( calculator == 0 || distance <= 0.0 )
+    {
+      return 0.0;
+    }
+
+  Altitude arrival;
+  Speed speed;
+
+  // The glide path is calculated with an elevation of zero. The difference
+  // to the usable altitude is the altitude loss along the distance.
+  if( calculator->glidePath( bearing, Distance( distance ), Altitude( 0 ),
+                             arrival, speed ) == false )
+    {
+      // No glider defined, assume a level flight.
+      return 0.0;
+    }
+
+  double usable = calculator->getlastAltitude().getMeters() -
+                  GeneralConfig::instance()->getSafetyAltitude().getMeters();
+
+  return qMax( 0.0, usable - arrival.getMeters() );
+}
+
+void AirspaceClearance::clip( const double f0, const double f1,
+                              double& lo, double& hi )
+{
+  if( f0 >= 0.0 && f1 >= 0.0 )
+    {
+      return;
+    }
+
+  if( f0 < 0.0 && f1 < 0.0 )
+    {
+      // Empty interval
+      hi = lo - 1.0;
+      return;
+    }
+
+  double root = f0 / (f0 - f1);
+
+  if( f0 < 0.0 )
+    {
+      lo = qMax( lo, root );
+    }
+  else
+    {
+      hi = qMin( hi, root );
+    }
+}
+
+Altitude AirspaceClearance::checkLeg( const RoutePoint& from,
+                                      const RoutePoint& to,
+                                      const Altitude& startAltitude,
+                                      Leg& leg )
+{
+  QPoint p1 = from.position;
+  QPoint p2 = to.position;
+
+  QPair<double, double> db = MapCalc::distVinc( &p1, &p2 );
+
+  int bearing = static_cast<int>( rint( db.second * 180.0 / M_PI ) );
+
+  leg.from          = from.name;
+  leg.to            = to.name;
+  leg.length        = db.first;
+  leg.startAltitude = startAltitude;
+  leg.endAltitude   = Altitude( startAltitude.getMeters() -
+                                altitudeLoss( bearing, db.first * 1000.0 ) );
+  leg.crossings.clear();
+
+  if( _globalMapContents == 0 || _globalMapMatrix == 0 || p1 == p2 )
+    {
+      return leg.endAltitude;
+    }
+
+  const QPoint a = _globalMapMatrix->wgsToMap( p1 );
+  const QPoint b = _globalMapMatrix->wgsToMap( p2 );
+
+  QVector<Airspace*> candidates;
+
+  if( _globalMapContents->queryAirspacesOnLine( a, b, candidates ) == 0 )
+    {
+      return leg.endAltitude;
+    }
+
+  GeneralConfig* conf = GeneralConfig::instance();
+
+  const double a0 = leg.startAltitude.getMeters();
+  const double a1 = leg.endAltitude.getMeters();
+  const double g0 = from.elevation.getMeters();
+  const double g1 = to.elevation.getMeters();
+
+  const double dx = b.x() - a.x();
+  const double dy = b.y() - a.y();
+
+  QVector<double> params;
+
+  for( int i = 0; i < candidates.size(); i++ )
+    {
+      Airspace* as = candidates.at(i);
+
+      if( as->getTypeID() == BaseMapElement::AirFir ||
+          conf->getItemDrawingEnabled( as->getTypeID() ) == false ||
+          AirspaceFilters::isFiltered( as ) == true )
+        {
+          continue;
+        }
+
+      if( as->getTypeID() == BaseMapElement::AirFlarm )
+        {
+          // Filter out invalid and inactive Flarm alert zones
+          if( as->getFlarmAlertZone().isValid() == false ||
+              as->getFlarmAlertZone().isActive() == false )
+            {
+              continue;
+            }
+        }
+
+      const QPolygon& pg = as->getProjectedPolygon();
+
+      if( pg.size() < 3 )
+        {
+          continue;
+        }
+
+      // Intersection parameters of the leg line with the polygon edges.
+      params.clear();
+
+      for( int j = 0; j < pg.size(); j++ )
+        {
+          const QPoint& c = pg.at(j);
+          const QPoint& d = pg.at( (j + 1) % pg.size() );
+
+          double ex = d.x() - c.x();
+          double ey = d.y() - c.y();
+          double den = dx * ey - dy * ex;
+
+          if( den == 0.0 )
+            {
+              // parallel edge
+              continue;
+            }
+
+          double t = ( (c.x() - a.x()) * ey - (c.y() - a.y()) * ex ) / den;
+          double u = ( (c.x() - a.x()) * dy - (c.y() - a.y()) * dx ) / den;
+
+          if( t >= 0.0 && t <= 1.0 && u >= 0.0 && u < 1.0 )
+            {
+              params.append( t );
+            }
+        }
+
+      bool inside = pg.containsPoint( a, Qt::OddEvenFill );
+
+      if( params.isEmpty() && inside == false )
+        {
+          continue;
+        }
+
+      std::sort( params.begin(), params.end() );
+      params.append( 1.0 );
+
+      // Limits in meters MSL at the leg start and end.
+      double l0 = as->getLowerL();
+      double l1 = l0;
+      double u0 = as->getUpperL();
+      double u1 = u0;
+
+      if( as->getLowerT() == BaseMapElement::GND )
+        {
+          l0 += g0;
+          l1 += g1;
+        }
+
+      if( as->getUpperT() == BaseMapElement::GND )
+        {
+          u0 += g0;
+          u1 += g1;
+        }
+
+      double last = 0.0;
+
+      for( int j = 0; j < params.size(); j++ )
+        {
+          double t = params.at(j);
+
+          if( inside && t > last )
+            {
+              double lo = last;
+              double hi = t;
+
+              // Above the lower and below the upper limit.
+              clip( a0 - l0, a1 - l1, lo, hi );
+              clip( u0 - a0, u1 - a1, lo, hi );
+
+              if( lo <= hi )
+                {
+                  Crossing cr;
+                  cr.airspace      = as;
+                  cr.entryDistance = lo * leg.length;
+                  cr.exitDistance  = hi * leg.length;
+                  cr.entryAltitude = Altitude( a0 + (a1 - a0) * lo );
+                  cr.exitAltitude  = Altitude( a0 + (a1 - a0) * hi );
+                  leg.crossings.append( cr );
+                }
+            }
+
+          inside = ! inside;
+          last = t;
+        }
+    }
+
+  // Sort the crossings by their entry points.
+  for( int i = 1; i < leg.crossings.size(); i++ )
+    {
+      for( int j = i; j > 0 &&
+           leg.crossings.at(j).entryDistance < leg.crossings.at(j-1).entryDistance; j-- )
+        {
+          leg.crossings.swap( j, j-1 );
+        }
+    }
+
+  return leg.endAltitude;
+}
+
+QList<AirspaceClearance::Leg>
+AirspaceClearance::checkRoute( const QList<RoutePoint>& route,
+                               const Altitude& startAltitude,
+                               const bool continuous )
+{
+  QList<Leg> legs;
+
+  Altitude altitude = startAltitude;
+
+  for( int i = 0; i + 1 < route.size(); i++ )
+    {
+      if( route.at(i).position == route.at(i+1).position )
+        {
+          continue; // points are equal, we ignore them
+        }
+
+      Leg leg;
+      Altitude end = checkLeg( route.at(i), route.at(i+1),
+                               continuous ? altitude : startAltitude, leg );
+      legs.append( leg );
+
+      altitude = end;
+    }
+
+  return legs;
+}
+
+QList<AirspaceClearance::Leg>
+AirspaceClearance::checkTask( const QList<TaskPoint>& tpList,
+                              const Altitude& startAltitude )
+{
+  QList<RoutePoint> route;
+
+  for( int i = 0; i < tpList.size(); i++ )
+    {
+      RoutePoint rp;
+      rp.name      = tpList.at(i).getWPName();
+      rp.position  = tpList.at(i).getWGSPosition();
+      rp.elevation = Altitude( tpList.at(i).getElevation() );
+      route.append( rp );
+    }
+
+  return checkRoute( route, startAltitude, false );
+}
+
+Altitude AirspaceClearance::planningAltitude( const QList<TaskPoint>& tpList )
+{
+  double altitude = 0.0;
+
+  if( calculator != 0 )
+    {
+      altitude = calculator->getlastAltitude().getMeters();
+    }
+
+  if( tpList.isEmpty() == false )
+    {
+      altitude = qMax( altitude, tpList.first().getElevation() + 1000.0 );
+    }
+
+  return Altitude( altitude );
+}
+
+QList<AirspaceClearance::Leg> AirspaceClearance::checkFinalGlide()
+{
+  QList<Leg> legs;
+
+  if( calculator == 0 || calculator->getTargetWp() == 0 )
+    {
+      return legs;
+    }
+
+  const Waypoint* target = calculator->getTargetWp();
+
+  QList<RoutePoint> route;
+
+  RoutePoint rp;
+  rp.name      = QObject::tr("Position");
+  rp.position  = calculator->getlastPosition();
+  rp.elevation = Altitude( 0 );
+
+  if( _globalMapContents != 0 )
+    {
+      rp.elevation = Altitude( _globalMapContents->findElevation( rp.position ) );
+    }
+
+  route.append( rp );
+
+  FlightTask* task = ( _globalMapContents != 0 ) ?
+                       _globalMapContents->getCurrentTask() : 0;
+
+  if( task != 0 && target->taskPointIndex >= 0 &&
+      target->taskPointIndex < task->getTpList().size() )
+    {
+      // Glide along the remaining task points.
+      QList<TaskPoint>& tpList = task->getTpList();
+
+      for( int i = target->taskPointIndex; i < tpList.size(); i++ )
+        {
+          rp.name      = tpList.at(i).getWPName();
+          rp.position  = tpList.at(i).getWGSPosition();
+          rp.elevation = Altitude( tpList.at(i).getElevation() );
+          route.append( rp );
+        }
+    }
+  else
+    {
+      rp.name      = target->name;
+      rp.position  = target->wgsPoint;
+      rp.elevation = Altitude( target->elevation );
+      route.append( rp );
+    }
+
+  return checkRoute( route, calculator->getlastAltitude(), true );
+}
+
+int AirspaceClearance::crossingCount( const QList<Leg>& legs )
+{
+  int count = 0;
+
+  for( int i = 0; i < legs.size(); i++ )
+    {
+      count += legs.at(i).crossings.size();
+    }
+
+  return count;
+}
+
+QString AirspaceClearance::createReport( const QList<Leg>& legs )
+{
+  QString report = "<html>";
+
+  if( crossingCount( legs ) == 0 )
+    {
+      report += QObject::tr("No airspaces are touched.") + "</html>";
+      return report;
+    }
+
+  for( int i = 0; i < legs.size(); i++ )
+    {
+      const Leg& leg = legs.at(i);
+
+      if( leg.crossings.isEmpty() )
+        {
+          continue;
+        }
+
+      report += QString( "<b>%1 - %2</b> (%3, %4 - %5)<br>" )
+                  .arg( leg.from ).arg( leg.to )
+                  .arg( Distance::getText( leg.length * 1000.0, true, 1 ) )
+                  .arg( leg.startAltitude.getText( true, 0 ) )
+                  .arg( leg.endAltitude.getText( true, 0 ) );
+
+      for( int j = 0; j < leg.crossings.size(); j++ )
+        {
+          const Crossing& cr = leg.crossings.at(j);
+
+          report += QString( "&nbsp;&nbsp;%1 %2: %3 %4 - %5 %6<br>" )
+                      .arg( Airspace::getTypeName( cr.airspace->getTypeID() ) )
+                      .arg( cr.airspace->getName() )
+                      .arg( Distance::getText( cr.entryDistance * 1000.0, true, 1 ) )
+                      .arg( cr.entryAltitude.getText( true, 0 ) )
+                      .arg( Distance::getText( cr.exitDistance * 1000.0, true, 1 ) )
+                      .arg( cr.exitAltitude.getText( true, 0 ) );
+        }
+    }
+
+  report += "</html>";
+  return report;
+}
@@ -0,0 +1,155 @@
+/***********************************************************************
+**
+**   AirspaceClearance.h
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+/**
+ * \class AirspaceClearance
+ *
+ * \author Axel Pauli
+ *
+ * \brief Airspace clearance check along task legs and the final glide.
+ *
+ * Every leg is checked as a 3D corridor. The leg line is intersected with the
+ * horizontal airspace borders, afterwards the inside intervals are clipped
+ * against the vertical airspace limits using the planned glide altitude along
+ * the leg. The candidate airspaces are fetched from the airspace index of
+ * \ref MapContents, so only a few airspaces per leg are tested.
+ *
+ * The glide altitude profile is derived from Calculator::glidePath, so the
+ * current glider polar, wind and MacCready setting are considered. Without a
+ * selected glider the leg is assumed to be flown at constant altitude.
+ *
+ * Ground related airspace limits are converted to MSL with the elevation of
+ * the leg end points, interpolated along the leg.
+ *
+ * \date 2026
+ *
+ * \version 1.0
+ */
+
+#pragma once
+
+#include <QList>
+#include <QPoint>
+#include <QString>
+
+#include "altitude.h"
+#include "taskpoint.h"
+
+class Airspace;
+class FlightTask;
+
+class AirspaceClearance
+{
+ public:
+
+  /**
+   * Passage of a leg through an airspace. Distances are in km from the
+   * leg start.
+   */
+  struct Crossing
+  {
+    Airspace* airspace;
+    double    entryDistance;
+    double    exitDistance;
+    Altitude  entryAltitude;
+    Altitude  exitAltitude;
+  };
+
+  /**
+   * Check result of a single leg. The length is in km.
+   */
+  struct Leg
+  {
+    QString  from;
+    QString  to;
+    double   length;
+    Altitude startAltitude;
+    Altitude endAltitude;
+    QList<Crossing> crossings;
+  };
+
+  /**
+   * Point of a checked route in WGS coordinates.
+   */
+  struct RoutePoint
+  {
+    QString  name;
+    QPoint   position;
+    Altitude elevation;
+  };
+
+  /**
+   * Checks a single leg starting at the passed altitude.
+   *
+   * \return The altitude at the end of the leg.
+   */
+  static Altitude checkLeg( const RoutePoint& from,
+                            const RoutePoint& to,
+                            const Altitude& startAltitude,
+                            Leg& leg );
+
+  /**
+   * Checks all legs of a route. If continuous is true, the whole route is
+   * glided down from the start altitude, otherwise every leg starts at the
+   * start altitude.
+   */
+  static QList<Leg> checkRoute( const QList<RoutePoint>& route,
+                                const Altitude& startAltitude,
+                                const bool continuous );
+
+  /**
+   * Checks all legs of the passed task point list. Climbs are not known to
+   * the planner, therefore every leg starts at the planning altitude.
+   */
+  static QList<Leg> checkTask( const QList<TaskPoint>& tpList,
+                               const Altitude& startAltitude );
+
+  /**
+   * \return The default planning altitude for the passed task point list,
+   * that is the current altitude but at least 1000m above the first point.
+   */
+  static Altitude planningAltitude( const QList<TaskPoint>& tpList );
+
+  /**
+   * Checks the final glide line from the current position and altitude to
+   * the selected target. If the target is a task point, the remaining task
+   * points are included.
+   */
+  static QList<Leg> checkFinalGlide();
+
+  /**
+   * \return The number of crossings of all passed legs.
+   */
+  static int crossingCount( const QList<Leg>& legs );
+
+  /**
+   * Creates a HTML report of the passed legs, suitable for a message box.
+   */
+  static QString createReport( const QList<Leg>& legs );
+
+ private:
+
+  /**
+   * \return The altitude loss in meters along the passed distance in meters
+   * in the passed bearing in degrees.
+   */
+  static double altitudeLoss( const int bearing, const double distance );
+
+  /**
+   * Clips the interval lo...hi to the part, where the linear function with
+   * the values f0 at 0 and f1 at 1 is not negative.
+   */
+  static void clip( const double f0, const double f1, double& lo, double& hi );
+};
@@ -28,6 +28,8 @@ QHash<QString, QMultiHash<QString, QString> > AirspaceFilters::countryHash;
 
 QMutex AirspaceFilters::mutex;
 
+QAtomicInt AirspaceFilters::generation( 1 );
+
 /**
  * Constructor
  */
@@ -461,6 +463,7 @@ void AirspaceFilters::slot_Ok()
         }
     }
 
+  mutex.lock();
   countryHash.clear(); // Clear country hash
 
   // Save all activated filters to country hash
@@ -493,6 +496,10 @@ void AirspaceFilters::slot_Ok()
         }
     }
 
+  // All airspace filter states must be evaluated again.
+  generation.fetchAndAddOrdered( 1 );
+  mutex.unlock();
+
   saveData2File(); // Save all data from the table into the file
   emit airspaceFiltersChanged( Map::airspaces );
   slot_Close();
@@ -665,10 +672,86 @@ bool AirspaceFilters::loadFilterData()
       qDebug() << "Key=" << keys.at(i) << " Value=" << countryHash[keys.at(i)];
     }
 
+  // All airspace filter states must be evaluated again.
+  generation.fetchAndAddOrdered( 1 );
   mutex.unlock();
   return true;
 }
 
+bool AirspaceFilters::evaluateFilters( const Airspace* as )
+{
+  QMutexLocker locker( &mutex );
+
+  if( countryHash.isEmpty() )
+    {
+      return false;
+    }
+
+  // Key of AS Hash is country. Value is a multi hash where key is
+  // AS-Type and value is AS-Name
+  QString asCountry = as->getCountry();
+
+  if( asCountry.isEmpty() == true )
+    {
+      // Country is not set. In this case we use * as country selector.
+      // That is a workaround for openair files, which have no county
+      // definitions inside.
+      asCountry = "*";
+    }
+
+  QHash<QString, QMultiHash<QString, QString> >::const_iterator cit =
+    countryHash.constFind( asCountry );
+
+  if( cit == countryHash.constEnd() )
+    {
+      // No country filter is defined
+      return false;
+    }
+
+  // get AS-Type as string
+  QString asType = Airspace::getTypeName( as->getTypeID() );
+
+  // map back displayed airspace type to stored airspace type.
+  if( asType == "Restricted" )
+    {
+      asType = "AR";
+    }
+  else if( asType == "Danger" )
+    {
+      asType = "AD";
+    }
+  else if( asType == "Prohibited" )
+    {
+      asType = "AP";
+    }
+  else if( asType == "AS-E low" )
+    {
+      asType = "AS-El";
+    }
+  else if( asType == "AS-E high" )
+    {
+      asType = "AS-Eh";
+    }
+
+  // Look, if airspace should be filtered out.
+  const QString& asName = as->getName();
+
+  QMultiHash<QString, QString>::const_iterator it = cit.value().constFind( asType );
+
+  while( it != cit.value().constEnd() && it.key() == asType )
+    {
+      if( asName.startsWith( it.value() ) == true )
+        {
+          qDebug() << "Filter out AS " << asType << ": " << asName;
+          return true;
+        }
+
+      ++it;
+    }
+
+  return false;
+}
+
 void AirspaceFilters::slot_scrollerBoxToggled( int state )
 {
   if( m_enableScroller == 0 )
@@ -31,16 +31,17 @@
 
 #pragma once
 
+#include <QAtomicInt>
 #include <QWidget>
 #include <QHash>
 #include <QMultiHash>
 #include <QMutex>
 
+#include "airspace.h"
 #include "map.h"
 
 class QCheckBox;
 class QPushButton;
-class QString;
 class QTableWidget;
 class RowDelegate;
 
@@ -64,19 +65,30 @@ public:
    */
   virtual ~AirspaceFilters();
 
+  /** Loads the filter data from the related file into the alias hash. */
+  static bool loadFilterData();
+
   /**
-   * @return countryHash copy to the caller.
+   * Checks, if the passed airspace is filtered out. The filter strings are
+   * only evaluated once per airspace after a filter load or edit, the result
+   * is stored in the airspace object.
+   *
+   * @return true, if the airspace shall be ignored.
    */
-  static QHash<QString, QMultiHash<QString, QString> > getAirspaceFilters()
+  static bool isFiltered( const Airspace* as )
   {
-    mutex.lock();
-    QHash<QString, QMultiHash<QString, QString> > ch = countryHash;
-    mutex.unlock();
-    return ch;
-  };
+    // The generation is read before the evaluation. A change during it
+    // leaves an outdated generation in the airspace, which is evaluated
+    // again at the next call.
+    const quint32 current = generation.loadAcquire();
 
-  /** Loads the filter data from the related file into the alias hash. */
-  static bool loadFilterData();
+    if( as->getFilterGeneration() != current )
+      {
+        as->setFilterState( current, evaluateFilters( as ) );
+      }
+
+    return as->isFilteredOut();
+  };
 
 private:
 
@@ -89,6 +101,9 @@ private:
   /** Returns the airspace filters filename. */
   static QString getFilterFileName();
 
+  /** Matches the passed airspace against the filter strings. */
+  static bool evaluateFilters( const Airspace* as );
+
 protected:
 
   void showEvent( QShowEvent *event );
@@ -153,5 +168,12 @@ private:
 
   /** Mutex used for filter data file load and save. */
   static QMutex mutex;
+
+  /**
+   * Generation of the filter data. It is incremented, when the filters are
+   * loaded or edited. That invalidates the filter states of all airspaces.
+   * It is read without locking the mutex, therefore it is atomic.
+   */
+  static QAtomicInt generation;
 };
 
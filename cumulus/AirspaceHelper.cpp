@@ -18,6 +18,7 @@
 #include <QtCore>
 
 #include "AirspaceHelper.h"
+#include "AirspaceStore.h"
 #include "filetools.h"
 #include "Frequency.h"
 #include "generalconfig.h"
@@ -38,7 +39,9 @@ QMap<quint16, BaseMapElement::objectType> AirspaceHelper::m_icaoClassMap;
 
 QMutex AirspaceHelper::m_mutex;
 
-int AirspaceHelper::loadAirspaces( QList<Airspace*>& list, bool readSource )
+int AirspaceHelper::loadAirspaces( QList<Airspace*>& list,
+                                   AirspaceStoreList& stores,
+                                   bool readSource )
 {
   // Set a global lock during execution to avoid calls in parallel.
   QMutexLocker locker( &m_mutex );
@@ -165,8 +168,11 @@ int AirspaceHelper::loadAirspaces( QList<Airspace*>& list, bool readSource )
               continue;
             }
 
-          if( AirspaceHelper::readCompiledFile( aicName, list ) )
+          AirspaceStore* store = openCompiledFile( aicName );
+
+          if( store != 0 )
             {
+              stores.append( store );
               loadCounter++;
               // Remove the source file from the list, if we had read the compiled file.
               preselect.removeAt( 0 );
@@ -184,6 +190,7 @@ int AirspaceHelper::loadAirspaces( QList<Airspace*>& list, bool readSource )
           preselect.removeAt(0);
 
           bool ok = false;
+          int listBegin = list.size();
 
           if( aipName.endsWith( ".txt") )
             {
@@ -199,12 +206,33 @@ int AirspaceHelper::loadAirspaces( QList<Airspace*>& list, bool readSource )
           if( ok )
             {
               loadCounter++;
+
+              // The parser has written the compiled file. It is used instead
+              // of the parsed objects, if it can be mapped.
+              AirspaceStore* store = openCompiledFile( aicName );
+
+              if( store != 0 )
+                {
+                  stores.append( store );
+
+                  while( list.size() > listBegin )
+                    {
+                      delete list.takeLast();
+                    }
+                }
             }
          }
     } // End of While
 
-  qDebug( "ASH: %d Airspace file(s) with %d items loaded in %lldms",
-          loadCounter, list.size(), t.elapsed() );
+  int mapped = 0;
+
+  for( int i = 0; i < stores.size(); i++ )
+    {
+      mapped += stores.at(i)->count();
+    }
+
+  qDebug( "ASH: %d Airspace file(s) with %d mapped and %d parsed items loaded in %lldms",
+          loadCounter, mapped, list.size(), t.elapsed() );
 
 //    for(int i=0; i < list.size(); i++ )
 //      {
@@ -218,223 +246,34 @@ bool AirspaceHelper::createCompiledFile( QString& fileName,
                                          QList<Airspace*>& airspaceList,
                                          int airspaceListStart )
 {
-  if( airspaceList.size() == 0 || airspaceList.size() < airspaceListStart )
-    {
-      return false;
-    }
-
-  QFile file( fileName );
-  QDataStream out( &file );
-
-  out.setVersion( QDataStream::Qt_4_7 );
-
-  if( file.open(QIODevice::WriteOnly) == false )
-    {
-      qWarning( "ASH: Can't open airspace file %s for writing!"
-                " Aborting ...",
-                fileName.toLatin1().data() );
-
-      return false;
-    }
-
-  // create compiled binary version
-  out << quint32( KFLOG_FILE_MAGIC );
-  out << QByteArray( FILE_TYPE_AIRSPACE_C );
-  out << quint16( FILE_VERSION_AIRSPACE_C );
-  out << QDateTime::currentDateTime();
-  SaveProjection( out, _globalMapMatrix->getProjection() );
-
-  // write number of airspace records to be stored
-  out << quint32( airspaceList.size() - airspaceListStart );
-
-  // Storing starts at the given index.
-  for( int i = airspaceListStart; i < airspaceList.size(); i++ )
-    {
-      Airspace* as = airspaceList[i];
-
-      const char* country = "\0\0";
-
-      if( as->getCountry().left(2).size() == 2 )
-        {
-          country = as->getCountry().left(2).toLatin1().data();
-        }
-
-      // Normalize Flight Level altitudes to its original value before storing.
-      float uAlt = as->getUpperAltitude().getFeet();
-      float lAlt = as->getLowerAltitude().getFeet();
-
-      if( as->getUpperT() == Airspace::FL )
-        {
-          uAlt /= 100.0;
-        }
-
-      if( as->getLowerT() == Airspace::FL )
-        {
-          lAlt /= 100.0;
-        }
-
-      ShortSave( out, as->getName() );
-      out.writeRawData( country, 2 );
-      out << quint8( as->getIcaoClass() );
-      out << quint8( as->getOpenAipType() );
-
-      // The frequency list is saved.
-      Frequency::saveFrequencies( out, as->getFrequencyList() );
-
-      out << quint8( as->getActivity() );
-      out << as->isByNotam();
-      out << quint8( as->getTypeID() );
-      out << quint8( as->getLowerT() );
-      out << float( lAlt );
-      out << quint8( as->getUpperT() );
-      out << float( uAlt );
-      ShortSave( out, as->getProjectedPolygon() );
-    }
-
-  file.close();
-  return true;
+  // The compiled file is a flat, memory mappable file, see AirspaceStore.
+  return AirspaceStore::write( fileName,
+                               airspaceList,
+                               airspaceListStart,
+                               _globalMapMatrix->getProjection() );
 }
 
-/**
- * Read the content of a compiled file and put it into the passed list.
- *
- * @param path Full name with path of OpenAir binary file
- * @param list All airspace objects have to be stored in this list
- * @returns true (success) or false (error occurred)
- */
-bool AirspaceHelper::readCompiledFile( QString &path, QList<Airspace*>& list )
+AirspaceStore* AirspaceHelper::openCompiledFile( QString &path )
 {
   QElapsedTimer t;
   t.start();
 
-  QFile inFile(path);
+  // The file is mapped into the memory and stays mapped. The airspace
+  // objects are created later on, when a query of the map needs them.
+  AirspaceStore* store = new AirspaceStore;
 
-  if ( !inFile.open(QIODevice::ReadOnly) )
+  if( store->open( path ) == false )
     {
-      qWarning("ASH: Cannot open airspace file %s!", path.toLatin1().data());
-      return false;
+      delete store;
+      return static_cast<AirspaceStore *> (0);
     }
 
-  QDataStream in(&inFile);
-  in.setVersion( QDataStream::Qt_4_7 );
-
-  quint32 magic;
-  QByteArray fileType;
-  quint16 fileVersion;
-  QDateTime creationDateTime;
-
-#ifdef BOUNDING_BOX
-  QRect boundingBox;
-#endif
-
-  ProjectionBase *projectionFromFile;
-  quint32 noOfAirspaces;
-
-  in >> magic;
-
-  if ( magic != KFLOG_FILE_MAGIC )
-    {
-      qWarning() << "ASH: wrong magic key" << magic << "read! Aborting ...";
-      inFile.close();
-      return false;
-    }
-
-  in >> fileType;
-
-  if ( fileType != FILE_TYPE_AIRSPACE_C )
-    {
-      qWarning() <<  "ASH: Wrong file type" <<  fileType << "read! Aborting ...";
-      inFile.close();
-      return false;
-    }
-
-  in >> fileVersion;
-
-  if ( fileVersion != FILE_VERSION_AIRSPACE_C )
-    {
-      qWarning( "ASH: Wrong file version %x read! Aborting ...", fileVersion );
-      inFile.close();
-      return false;
-    }
-
-  in >> creationDateTime;
-
-  projectionFromFile = LoadProjection(in);
-
-  // projectionFromFile is allocated dynamically, we don't need it
-  // here. Therefore it is immediately deleted to avoid memory leaks.
-  delete projectionFromFile;
-  projectionFromFile = 0;
-
-#ifdef BOUNDING_BOX
-  in >> boundingBox;
-#endif
-
-  // Read at first the number of airspaces contained in the compiled file.
-  // We have to read it and make a preallocation in the airspace list.
-  in >> noOfAirspaces;
-
-  list.reserve( list.size() + noOfAirspaces );
-
-  uint counter = 0;
-
-  while ( ! in.atEnd() )
-    {
-      QString name;
-      QList<Frequency> fqList;
-      quint8 icaoClass;
-      quint8 activity;
-      bool byNotam;
-      quint8 type;
-      quint8 openAipType;
-      quint8 lowerType;
-      float lower;
-      quint8 upperType;
-      float upper;
-      QPolygon pa;
-      QByteArray utf8_temp;
-      char country[3] = { 0, 0, 0 };
-
-      ShortLoad( in, name );
-      in.readRawData( country, 2 );
-      in >> icaoClass;
-      in >> openAipType;
-
-      // The frequency list is loaded.
-      Frequency::loadFrequencies( in, fqList );
-
-      in >> activity;
-      in >> byNotam;
-      in >> type;
-      in >> lowerType;
-      in >> lower;
-      in >> upperType;
-      in >> upper;
-      ShortLoad( in, pa );
-
-      Airspace *a = new Airspace( name,
-                                  (BaseMapElement::objectType) type,
-                                  openAipType,
-                                  pa,
-                                  upper, (BaseMapElement::elevationType) upperType,
-                                  lower, (BaseMapElement::elevationType) lowerType,
-                                  fqList,
-                                  icaoClass,
-                                  QString(country),
-                                  activity,
-                                  byNotam );
-      list.append(a);
-      counter++;
-    }
-
-  inFile.close();
-
   QFileInfo fi( path );
 
-  qDebug( "ASH: %d airspace objects read from file %s in %lldms",
-          counter, fi.fileName().toLatin1().data(), t.elapsed() );
+  qDebug( "ASH: %d airspace records mapped from file %s in %lldms",
+          store->count(), fi.fileName().toLatin1().data(), t.elapsed() );
 
-  return true;
+  return store;
 }
 
 /**
@@ -453,57 +292,17 @@ bool AirspaceHelper::readHeaderData( QString &path,
                                      QDateTime& creationDateTime,
                                      ProjectionBase** projection )
 {
-  quint32 h_magic = 0;
-  QByteArray h_fileType;
-  quint16 h_fileVersion = 0;
-
-  QFile inFile(path);
-
-  if ( !inFile.open( QIODevice::ReadOnly) )
-    {
-      qWarning("ASH: Cannot open airspace file %s!", path.toLatin1().data());
-      return false;
-    }
+  AirspaceStore store;
 
-  QDataStream in(&inFile);
-  in.setVersion( QDataStream::Qt_4_7 );
-
-  in >> h_magic;
-
-  if ( h_magic != KFLOG_FILE_MAGIC )
+  if( store.open( path ) == false )
     {
-      qWarning( "ASH: wrong magic key %x read! Aborting ...", h_magic );
-      inFile.close();
       return false;
     }
 
-  in >> h_fileType;
-
-  if ( h_fileType != FILE_TYPE_AIRSPACE_C )
-    {
-      qWarning( "ASH: wrong file type '%s' read! Aborting ...", h_fileType.data() );
-      inFile.close();
-      return false;
-    }
-
-  in >> h_fileVersion;
-
-  if ( h_fileVersion != FILE_VERSION_AIRSPACE_C )
-    {
-      qWarning( "ASH: wrong file version %x read! Aborting ...", h_fileVersion );
-      inFile.close();
-      return false;
-    }
-
-  in >> creationDateTime;
-
-  *projection = LoadProjection(in);
-
-#ifdef BOUNDING_BOX
-  in >> h_boundingBox;
-#endif
+  creationDateTime = store.creationDateTime();
+  *projection = store.projection();
 
-  inFile.close();
+  store.close();
   return true;
 }
 
@@ -725,19 +524,20 @@ void AirspaceHelperThread::run()
   pthread_sigmask( SIG_SETMASK, &sigset, 0 );
 
   // Check is signal is connected to a slot.
-  if( receivers( SIGNAL( loadedList( int, SortableAirspaceList* )) ) == 0 )
+  if( receivers( SIGNAL( loadedList( int, SortableAirspaceList*, AirspaceStoreList* )) ) == 0 )
     {
       qWarning() << "AirspaceHelperThread: No Slot connection to Signal loadedList!";
       return;
     }
 
   SortableAirspaceList* airspaceList = new SortableAirspaceList;
+  AirspaceStoreList* storeList = new AirspaceStoreList;
 
-  int ok = AirspaceHelper::loadAirspaces( *airspaceList, m_readSource );
+  int ok = AirspaceHelper::loadAirspaces( *airspaceList, *storeList, m_readSource );
 
   /* It is expected that a receiver slot is connected to this signal. The
    * receiver is responsible to delete the passed lists. Otherwise a big
    * memory leak will occur.
    */
-  emit loadedList( ok, airspaceList );
+  emit loadedList( ok, airspaceList, storeList );
 }
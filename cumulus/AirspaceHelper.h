@@ -45,6 +45,7 @@
 #include <QString>
 
 #include "airspace.h"
+#include "AirspaceStore.h"
 #include "basemapelement.h"
 
 class ProjectionBase;
@@ -71,25 +72,30 @@ class AirspaceHelper
    * Searches on default places for OpenAir and OpenAip airspace files.
    * That can be source files or compiled versions of them.
    *
+   * A read source file is compiled and its compiled file is mapped too. Only
+   * if the compiled file cannot be written, the parsed Airspace objects are
+   * kept in the list.
+   *
    * @returns The number of successfully loaded files
    *
-   * @param list The list where the Airspace objects should be added from the
-   *        read files.
+   * @param list The list where the Airspace objects should be added, which
+   *        have no mapped compiled file.
+   * @param stores The list where the mapped compiled files are added.
    * @param readSource If true the source files have to be read instead of
    *         compiled sources.
    *
    */
-  static int loadAirspaces( QList<Airspace*>& list, bool readSource=false );
+  static int loadAirspaces( QList<Airspace*>& list,
+                            AirspaceStoreList& stores,
+                            bool readSource=false );
 
   /**
-   * Read the content of a compiled file and put it into the passed
-   * list.
+   * Maps a compiled file into the memory. No airspace object is created.
    *
    * @param path Full name with path of OpenAir binary file
-   * @param list All airspace objects have to be stored in this list
-   * @return true (success) or false (error occurred)
+   * @return The mapped store, owned by the caller, or 0 in case of an error.
    */
-  static bool readCompiledFile( QString &path, QList<Airspace*>& list );
+  static AirspaceStore* openCompiledFile( QString &path );
 
   /**
    * Creates a compiled file from the passed airspace list beginning at the
@@ -288,10 +294,12 @@ class AirspaceHelperThread : public QThread
   * responsible to delete the dynamic allocated list in every case.
   *
   * \param loadedLists     The number of loaded lists
-  * \param airspaceList    The list with the airspace data
+  * \param airspaceList    The list with the airspace data without a mapped file
+  * \param storeList       The list with the mapped compiled files
   *
   */
-  void loadedList( int loadedLists, SortableAirspaceList* airspaceList );
+  void loadedList( int loadedLists, SortableAirspaceList* airspaceList,
+                   AirspaceStoreList* storeList );
 
  private:
 
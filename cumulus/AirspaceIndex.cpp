@@ -0,0 +1,288 @@
+/***********************************************************************
+**
+**   AirspaceIndex.cpp
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <cmath>
+
+#include <QtCore>
+
+#include "airspace.h"
+#include "AirspaceIndex.h"
+
+AirspaceIndex::AirspaceIndex() :
+  m_columns(1),
+  m_rows(1),
+  m_cellWidth(1),
+  m_cellHeight(1),
+  m_stamp(0)
+{
+  m_cells.resize( 1 );
+}
+
+AirspaceIndex::~AirspaceIndex()
+{
+}
+
+void AirspaceIndex::clear()
+{
+  m_bounds     = QRect();
+  m_columns    = 1;
+  m_rows       = 1;
+  m_cellWidth  = 1;
+  m_cellHeight = 1;
+  m_stamp      = 0;
+
+  m_cells = QVector<QVector<int> >( 1 );
+  m_airspaces.clear();
+  m_boxes.clear();
+  m_freeSlots.clear();
+  m_slotOf.clear();
+  m_marks.clear();
+}
+
+void AirspaceIndex::build( const QList<Airspace*>& list )
+{
+  clear();
+
+  m_airspaces.reserve( list.size() );
+  m_boxes.reserve( list.size() );
+
+  for( int i = 0; i < list.size(); i++ )
+    {
+      Airspace* as = list.at(i);
+
+      if( as == 0 || m_slotOf.contains( as ) )
+        {
+          continue;
+        }
+
+      QRect bb = as->getProjectedPolygon().boundingRect();
+
+      m_bounds = m_bounds.isNull() ? bb : m_bounds.united( bb );
+      m_slotOf.insert( as, m_airspaces.size() );
+      m_airspaces.append( as );
+      m_boxes.append( bb );
+    }
+
+  if( m_airspaces.isEmpty() )
+    {
+      return;
+    }
+
+  // The grid size is derived from the number of airspaces, to get a few
+  // airspaces per cell.
+  int dim = qBound( 1, int( sqrt( double(m_airspaces.size()) / 2.0 ) ), 256 );
+
+  m_columns    = dim;
+  m_rows       = dim;
+  m_cellWidth  = qMax( 1, (m_bounds.width() + dim - 1) / dim );
+  m_cellHeight = qMax( 1, (m_bounds.height() + dim - 1) / dim );
+
+  m_cells = QVector<QVector<int> >( m_columns * m_rows );
+  m_marks.fill( 0, m_airspaces.size() );
+
+  for( int i = 0; i < m_airspaces.size(); i++ )
+    {
+      addToCells( i );
+    }
+}
+
+void AirspaceIndex::insert( Airspace* as )
+{
+  if( as == 0 )
+    {
+      return;
+    }
+
+  QHash<Airspace*, int>::const_iterator it = m_slotOf.constFind( as );
+
+  if( it != m_slotOf.constEnd() )
+    {
+      // Update the cells of an already known airspace.
+      int slot = it.value();
+      removeFromCells( slot );
+      m_boxes[slot] = as->getProjectedPolygon().boundingRect();
+      addToCells( slot );
+      return;
+    }
+
+  int slot;
+
+  if( m_freeSlots.isEmpty() == false )
+    {
+      slot = m_freeSlots.takeLast();
+      m_airspaces[slot] = as;
+      m_boxes[slot] = as->getProjectedPolygon().boundingRect();
+    }
+  else
+    {
+      slot = m_airspaces.size();
+      m_airspaces.append( as );
+      m_boxes.append( as->getProjectedPolygon().boundingRect() );
+      m_marks.append( 0 );
+    }
+
+  m_slotOf.insert( as, slot );
+  addToCells( slot );
+}
+
+void AirspaceIndex::remove( Airspace* as )
+{
+  QHash<Airspace*, int>::iterator it = m_slotOf.find( as );
+
+  if( it == m_slotOf.end() )
+    {
+      return;
+    }
+
+  int slot = it.value();
+  m_slotOf.erase( it );
+
+  removeFromCells( slot );
+  m_airspaces[slot] = 0;
+  m_boxes[slot] = QRect();
+  m_freeSlots.append( slot );
+}
+
+void AirspaceIndex::addToCells( const int slot )
+{
+  const QRect& bb = m_boxes.at( slot );
+
+  for( int r = row( bb.top() ); r <= row( bb.bottom() ); r++ )
+    {
+      for( int c = column( bb.left() ); c <= column( bb.right() ); c++ )
+        {
+          m_cells[r * m_columns + c].append( slot );
+        }
+    }
+}
+
+void AirspaceIndex::removeFromCells( const int slot )
+{
+  const QRect& bb = m_boxes.at( slot );
+
+  for( int r = row( bb.top() ); r <= row( bb.bottom() ); r++ )
+    {
+      for( int c = column( bb.left() ); c <= column( bb.right() ); c++ )
+        {
+          QVector<int>& cell = m_cells[r * m_columns + c];
+          int idx = cell.indexOf( slot );
+
+          if( idx >= 0 )
+            {
+              // Order in a cell is not relevant.
+              cell[idx] = cell.last();
+              cell.removeLast();
+            }
+        }
+    }
+}
+
+quint32 AirspaceIndex::nextStamp() const
+{
+  if( ++m_stamp == 0 )
+    {
+      // Stamp overflow, reset all marks.
+      m_marks.fill( 0 );
+      m_stamp = 1;
+    }
+
+  return m_stamp;
+}
+
+void AirspaceIndex::collect( const int c, const int r, const QRect& area,
+                             QVector<Airspace*>& result ) const
+{
+  const QVector<int>& cell = m_cells.at( r * m_columns + c );
+
+  for( int i = 0; i < cell.size(); i++ )
+    {
+      int slot = cell.at(i);
+
+      // Only found airspaces are marked, a line query checks an airspace
+      // against several pieces.
+      if( m_marks.at( slot ) == m_stamp ||
+          m_boxes.at( slot ).intersects( area ) == false )
+        {
+          continue;
+        }
+
+      m_marks[slot] = m_stamp;
+      result.append( m_airspaces.at( slot ) );
+    }
+}
+
+int AirspaceIndex::query( const QRect& area, QVector<Airspace*>& result ) const
+{
+  result.clear();
+
+  if( m_slotOf.isEmpty() )
+    {
+      return 0;
+    }
+
+  nextStamp();
+
+  for( int r = row( area.top() ); r <= row( area.bottom() ); r++ )
+    {
+      for( int c = column( area.left() ); c <= column( area.right() ); c++ )
+        {
+          collect( c, r, area, result );
+        }
+    }
+
+  return result.size();
+}
+
+int AirspaceIndex::queryLine( const QPoint& p1, const QPoint& p2,
+                              QVector<Airspace*>& result ) const
+{
+  result.clear();
+
+  if( m_slotOf.isEmpty() )
+    {
+      return 0;
+    }
+
+  nextStamp();
+
+  // The line is divided into pieces not longer than a half cell. Every piece
+  // is checked with its bounding box.
+  double dx = p2.x() - p1.x();
+  double dy = p2.y() - p1.y();
+
+  int steps = qMax( 1, int( qMax( fabs(dx) / m_cellWidth,
+                                  fabs(dy) / m_cellHeight ) * 2.0 ) + 1 );
+
+  QPoint last = p1;
+
+  for( int i = 1; i <= steps; i++ )
+    {
+      QPoint next( p1.x() + int( dx * i / steps ), p1.y() + int( dy * i / steps ) );
+
+      QRect piece = QRect( last, next ).normalized();
+
+      for( int r = row( piece.top() ); r <= row( piece.bottom() ); r++ )
+        {
+          for( int c = column( piece.left() ); c <= column( piece.right() ); c++ )
+            {
+              collect( c, r, piece, result );
+            }
+        }
+
+      last = next;
+    }
+
+  return result.size();
+}
@@ -0,0 +1,151 @@
+/***********************************************************************
+**
+**   AirspaceIndex.h
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+/**
+ * \class AirspaceIndex
+ *
+ * \author Axel Pauli
+ *
+ * \brief Spatial grid index over the projected airspace bounding boxes.
+ *
+ * The index divides the area covered by the airspaces into a uniform grid.
+ * Every cell contains the airspaces, whose bounding box overlaps the cell.
+ * Area and line queries return only airspaces, whose bounding box touches the
+ * query area, without scanning the whole airspace list.
+ *
+ * Airspaces can be inserted and removed after the index has been built.
+ * Airspaces outside of the initial grid area are put into the border cells.
+ *
+ * The index does not take the ownership of the airspace objects. It must be
+ * rebuilt, if the airspace list or the map projection is changed.
+ *
+ * \date 2026
+ *
+ * \version 1.0
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QPoint>
+#include <QRect>
+#include <QVector>
+
+class Airspace;
+
+class AirspaceIndex
+{
+ public:
+
+  AirspaceIndex();
+
+  virtual ~AirspaceIndex();
+
+  /**
+   * Builds the index from the passed airspace list. A former index content
+   * is removed.
+   */
+  void build( const QList<Airspace*>& list );
+
+  /**
+   * Removes all airspaces from the index.
+   */
+  void clear();
+
+  /**
+   * Inserts an airspace into the index. If the airspace is already contained,
+   * its bounding box is updated.
+   */
+  void insert( Airspace* as );
+
+  /**
+   * Removes an airspace from the index.
+   */
+  void remove( Airspace* as );
+
+  /**
+   * \return The number of indexed airspaces.
+   */
+  int size() const
+  {
+    return m_slotOf.size();
+  };
+
+  /**
+   * Collects all airspaces, whose bounding box intersects the passed area
+   * in projected coordinates. The result list is cleared before.
+   *
+   * \return The number of found airspaces.
+   */
+  int query( const QRect& area, QVector<Airspace*>& result ) const;
+
+  /**
+   * Collects all airspaces, whose bounding box touches one of the grid cells
+   * along the line from p1 to p2 in projected coordinates. The result list
+   * is cleared before.
+   *
+   * \return The number of found airspaces.
+   */
+  int queryLine( const QPoint& p1, const QPoint& p2, QVector<Airspace*>& result ) const;
+
+ private:
+
+  /** Adds the airspace in the passed slot to all cells of its bounding box. */
+  void addToCells( const int slot );
+
+  /** Removes the airspace in the passed slot from all its cells. */
+  void removeFromCells( const int slot );
+
+  /** Collects the airspaces of one cell into the result list. */
+  void collect( const int c, const int r, const QRect& area,
+                QVector<Airspace*>& result ) const;
+
+  int column( const int x ) const
+  {
+    return qBound( 0, (x - m_bounds.left()) / m_cellWidth, m_columns - 1 );
+  };
+
+  int row( const int y ) const
+  {
+    return qBound( 0, (y - m_bounds.top()) / m_cellHeight, m_rows - 1 );
+  };
+
+  /** Starts a new query and returns its stamp. */
+  quint32 nextStamp() const;
+
+  QRect m_bounds;
+  int   m_columns;
+  int   m_rows;
+  int   m_cellWidth;
+  int   m_cellHeight;
+
+  /** Grid cells, every cell contains slot numbers. */
+  QVector<QVector<int> > m_cells;
+
+  /** Airspace and bounding box of every slot. */
+  QVector<Airspace*> m_airspaces;
+  QVector<QRect>     m_boxes;
+
+  /** Free slots to be reused by inserts. */
+  QVector<int> m_freeSlots;
+
+  /** Slot number of every indexed airspace. */
+  QHash<Airspace*, int> m_slotOf;
+
+  /** Per slot query marks to avoid duplicates in a query result. */
+  mutable QVector<quint32> m_marks;
+  mutable quint32 m_stamp;
+};
@@ -0,0 +1,874 @@
+/***********************************************************************
+**
+**   AirspaceStore.cpp
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <cmath>
+#include <cstring>
+
+#include <QtCore>
+#include <QSaveFile>
+
+#include "airspace.h"
+#include "AirspaceStore.h"
+#include "Frequency.h"
+#include "projectionbase.h"
+#include "resource.h"
+
+// Byte order marker of the compiled file.
+#define AS_BYTE_ORDER 0x0102
+
+// All sections of the compiled file are aligned to this value.
+#define AS_ALIGNMENT 8
+
+namespace
+{
+  /**
+   * Helper class to collect a section of the compiled file and to intern
+   * strings in the string pool.
+   */
+  class StringPool
+  {
+   public:
+
+    quint32 intern( const QByteArray& string )
+    {
+      if( string.isEmpty() )
+        {
+          return 0;
+        }
+
+      QHash<QByteArray, quint32>::const_iterator it = m_index.constFind( string );
+
+      if( it != m_index.constEnd() )
+        {
+          return it.value();
+        }
+
+      quint32 offset = m_pool.size();
+      m_pool.append( string );
+      m_index.insert( string, offset );
+      return offset;
+    };
+
+    const QByteArray& pool() const
+    {
+      return m_pool;
+    };
+
+   private:
+
+    QByteArray m_pool;
+    QHash<QByteArray, quint32> m_index;
+  };
+
+  quint32 align( const quint32 value )
+  {
+    return (value + AS_ALIGNMENT - 1) & ~quint32(AS_ALIGNMENT - 1);
+  }
+
+  /**
+   * Appends a section to the file data and returns its aligned offset.
+   */
+  quint32 appendSection( QByteArray& data, const char* section, const int size )
+  {
+    data.append( QByteArray( align( data.size() ) - data.size(), '\0' ) );
+
+    quint32 offset = data.size();
+
+    if( size > 0 )
+      {
+        data.append( section, size );
+      }
+
+    return offset;
+  }
+
+  /**
+   * Converts a list of lists into a CSR layout with a start table of
+   * size + 1 elements and a flat item table.
+   */
+  void buildCsr( const QVector<QVector<quint32> >& lists,
+                 QVector<quint32>& start,
+                 QVector<quint32>& items )
+  {
+    start.resize( lists.size() + 1 );
+    items.clear();
+
+    for( int i = 0; i < lists.size(); i++ )
+      {
+        start[i] = items.size();
+        items += lists.at(i);
+      }
+
+    start[lists.size()] = items.size();
+  }
+
+  /**
+   * Checks, that a CSR start table is ascending and ends inside of its item
+   * table and that all items are valid record numbers.
+   */
+  bool checkCsr( const quint32* start, const quint32 size,
+                 const quint32* items, const quint32 itemCount,
+                 const quint32 recordCount )
+  {
+    if( start[0] != 0 || start[size] != itemCount )
+      {
+        return false;
+      }
+
+    for( quint32 i = 0; i < size; i++ )
+      {
+        if( start[i] > start[i + 1] )
+          {
+            return false;
+          }
+      }
+
+    for( quint32 i = 0; i < itemCount; i++ )
+      {
+        if( items[i] >= recordCount )
+          {
+            return false;
+          }
+      }
+
+    return true;
+  }
+}
+
+AirspaceStore::AirspaceStore() :
+  m_data(0),
+  m_header(0),
+  m_records(0),
+  m_coords(0),
+  m_frequencies(0),
+  m_strings(0),
+  m_gridStart(0),
+  m_gridItems(0),
+  m_bandStart(0),
+  m_bandItems(0),
+  m_stamp(0)
+{
+}
+
+AirspaceStore::~AirspaceStore()
+{
+  close();
+}
+
+bool AirspaceStore::open( const QString& path )
+{
+  close();
+
+  m_file.setFileName( path );
+
+  if( m_file.open( QIODevice::ReadOnly ) == false )
+    {
+      qWarning( "ASS: Cannot open airspace file %s!", path.toLatin1().data() );
+      return false;
+    }
+
+  qint64 fileSize = m_file.size();
+
+  if( fileSize < qint64( sizeof(Header) ) )
+    {
+      qWarning( "ASS: Airspace file %s is too short!", path.toLatin1().data() );
+      m_file.close();
+      return false;
+    }
+
+  m_data = m_file.map( 0, fileSize );
+
+  if( m_data == 0 )
+    {
+      qWarning( "ASS: Cannot map airspace file %s!", path.toLatin1().data() );
+      m_file.close();
+      return false;
+    }
+
+  m_header = reinterpret_cast<const Header *> (m_data);
+
+  if( checkLayout( fileSize ) == false )
+    {
+      qWarning( "ASS: Airspace file %s is corrupted!", path.toLatin1().data() );
+      close();
+      return false;
+    }
+
+  m_records     = reinterpret_cast<const Record *> (m_data + m_header->recordOffset);
+  m_coords      = reinterpret_cast<const qint32 *> (m_data + m_header->coordOffset);
+  m_frequencies = reinterpret_cast<const FrequencyRecord *> (m_data + m_header->frequencyOffset);
+  m_strings     = reinterpret_cast<const char *> (m_data + m_header->stringOffset);
+  m_gridStart   = reinterpret_cast<const quint32 *> (m_data + m_header->gridStartOffset);
+  m_gridItems   = reinterpret_cast<const quint32 *> (m_data + m_header->gridItemOffset);
+  m_bandStart   = reinterpret_cast<const quint32 *> (m_data + m_header->bandStartOffset);
+  m_bandItems   = reinterpret_cast<const quint32 *> (m_data + m_header->bandItemOffset);
+
+  if( checkRecords() == false )
+    {
+      qWarning( "ASS: Airspace file %s is corrupted!", path.toLatin1().data() );
+      close();
+      return false;
+    }
+
+  m_airspaces.fill( 0, m_header->recordCount );
+  m_marks.fill( 0, m_header->recordCount );
+  m_stamp = 0;
+
+  return true;
+}
+
+void AirspaceStore::close()
+{
+  qDeleteAll( m_airspaces );
+  m_airspaces = QVector<Airspace*>();
+  m_marks = QVector<quint32>();
+
+  if( m_data != 0 )
+    {
+      m_file.unmap( m_data );
+    }
+
+  if( m_file.isOpen() )
+    {
+      m_file.close();
+    }
+
+  m_data        = 0;
+  m_header      = 0;
+  m_records     = 0;
+  m_coords      = 0;
+  m_frequencies = 0;
+  m_strings     = 0;
+  m_gridStart   = 0;
+  m_gridItems   = 0;
+  m_bandStart   = 0;
+  m_bandItems   = 0;
+}
+
+bool AirspaceStore::checkLayout( const qint64 fileSize ) const
+{
+  const Header* h = m_header;
+
+  if( h->magic != KFLOG_FILE_MAGIC || h->byteOrder != AS_BYTE_ORDER )
+    {
+      qWarning() << "ASS: wrong magic key or byte order read! Aborting ...";
+      return false;
+    }
+
+  if( qstrncmp( h->fileType, FILE_TYPE_AIRSPACE_C, sizeof(h->fileType) ) != 0 )
+    {
+      qWarning() << "ASS: wrong file type read! Aborting ...";
+      return false;
+    }
+
+  if( h->version != FILE_VERSION_AIRSPACE_C || h->headerSize != sizeof(Header) )
+    {
+      qWarning( "ASS: wrong file version %x read! Aborting ...", h->version );
+      return false;
+    }
+
+  // Every section must be aligned and must lay completely inside of the file.
+  // All sizes are calculated in 64 bit to avoid overflows.
+  struct Section { qint64 offset; qint64 size; } sections[] =
+    {
+      { h->recordOffset,     qint64(h->recordCount) * qint64(sizeof(Record)) },
+      { h->coordOffset,      qint64(h->coordCount) * 2 * qint64(sizeof(qint32)) },
+      { h->frequencyOffset,  qint64(h->frequencyCount) * qint64(sizeof(FrequencyRecord)) },
+      { h->stringOffset,     qint64(h->stringPoolSize) },
+      { h->gridStartOffset,  (qint64(h->gridColumns) * qint64(h->gridRows) + 1) * qint64(sizeof(quint32)) },
+      { h->gridItemOffset,   qint64(h->gridItemCount) * qint64(sizeof(quint32)) },
+      { h->bandStartOffset,  (qint64(h->bandCount) + 1) * qint64(sizeof(quint32)) },
+      { h->bandItemOffset,   qint64(h->bandItemCount) * qint64(sizeof(quint32)) },
+      { h->projectionOffset, qint64(h->projectionSize) }
+    };
+
+  for( uint i = 0; i < sizeof(sections) / sizeof(sections[0]); i++ )
+    {
+      if( sections[i].offset % AS_ALIGNMENT ||
+          sections[i].offset < qint64(sizeof(Header)) ||
+          sections[i].offset + sections[i].size > fileSize )
+        {
+          qWarning( "ASS: section %d is corrupted! Aborting ...", i );
+          return false;
+        }
+    }
+
+  // The grid has at most 256 x 256 cells, the bands are limited by MaxBands.
+  if( h->gridColumns == 0 || h->gridColumns > 256 ||
+      h->gridRows == 0 || h->gridRows > 256 ||
+      h->gridCellWidth <= 0 || h->gridCellHeight <= 0 ||
+      h->bandCount == 0 || h->bandCount > MaxBands || h->bandHeight <= 0 )
+    {
+      qWarning() << "ASS: index dimensions are corrupted! Aborting ...";
+      return false;
+    }
+
+  return true;
+}
+
+bool AirspaceStore::checkRecords() const
+{
+  const qint64 coordCount = m_header->coordCount;
+  const qint64 fqCount    = m_header->frequencyCount;
+  const qint64 poolSize   = m_header->stringPoolSize;
+
+  for( quint32 i = 0; i < m_header->recordCount; i++ )
+    {
+      const Record& r = m_records[i];
+
+      if( qint64(r.coordIndex) + qint64(r.coordCount) > coordCount ||
+          qint64(r.nameOffset) + qint64(r.nameLength) > poolSize ||
+          qint64(r.frequencyIndex) + qint64(r.frequencyCount) > fqCount )
+        {
+          qWarning( "ASS: airspace record %u is corrupted! Aborting ...", i );
+          return false;
+        }
+    }
+
+  for( quint32 i = 0; i < m_header->frequencyCount; i++ )
+    {
+      const FrequencyRecord& f = m_frequencies[i];
+
+      if( qint64(f.userTypeOffset) + qint64(f.userTypeLength) > poolSize ||
+          qint64(f.callSignOffset) + qint64(f.callSignLength) > poolSize )
+        {
+          qWarning( "ASS: frequency record %u is corrupted! Aborting ...", i );
+          return false;
+        }
+    }
+
+  const Header* h = m_header;
+
+  if( checkCsr( m_gridStart, h->gridColumns * h->gridRows,
+                m_gridItems, h->gridItemCount, h->recordCount ) == false ||
+      checkCsr( m_bandStart, h->bandCount,
+                m_bandItems, h->bandItemCount, h->recordCount ) == false )
+    {
+      qWarning() << "ASS: index tables are corrupted! Aborting ...";
+      return false;
+    }
+
+  return true;
+}
+
+QPolygon AirspaceStore::polygon( const int index ) const
+{
+  const Record& r = m_records[index];
+  const qint32* c = m_coords + 2 * r.coordIndex;
+
+  QPolygon pg( r.coordCount );
+
+  for( uint i = 0; i < r.coordCount; i++, c += 2 )
+    {
+      pg.setPoint( i, c[0], c[1] );
+    }
+
+  return pg;
+}
+
+Airspace* AirspaceStore::createAirspace( const int index ) const
+{
+  const Record& r = m_records[index];
+
+  QList<Frequency> fqList;
+  fqList.reserve( r.frequencyCount );
+
+  for( int i = 0; i < r.frequencyCount; i++ )
+    {
+      const FrequencyRecord& f = m_frequencies[r.frequencyIndex + i];
+
+      fqList.append( Frequency( f.value,
+                                f.unit,
+                                f.type,
+                                QString::fromUtf8( m_strings + f.userTypeOffset,
+                                                   f.userTypeLength ),
+                                f.primary,
+                                f.publicUse,
+                                QString::fromUtf8( m_strings + f.callSignOffset,
+                                                   f.callSignLength ) ) );
+    }
+
+  QString country;
+
+  if( r.country[0] != '\0' )
+    {
+      country = QString::fromLatin1( r.country, 2 );
+    }
+
+  return new Airspace( name( index ),
+                       (BaseMapElement::objectType) r.typeID,
+                       r.openAipType,
+                       polygon( index ),
+                       r.upper, (BaseMapElement::elevationType) r.upperType,
+                       r.lower, (BaseMapElement::elevationType) r.lowerType,
+                       fqList,
+                       r.icaoClass,
+                       country,
+                       r.activity,
+                       r.byNotam );
+}
+
+Airspace* AirspaceStore::airspace( const int index )
+{
+  Airspace* as = m_airspaces.at( index );
+
+  if( as == 0 )
+    {
+      as = createAirspace( index );
+      m_airspaces[index] = as;
+    }
+
+  return as;
+}
+
+void AirspaceStore::nextStamp() const
+{
+  if( ++m_stamp == 0 )
+    {
+      // Stamp overflow, reset all marks.
+      m_marks.fill( 0 );
+      m_stamp = 1;
+    }
+}
+
+void AirspaceStore::collect( const quint32 index, const QRect& area,
+                             const int lower, const int upper,
+                             QVector<int>& result ) const
+{
+  if( m_marks.at( index ) == m_stamp )
+    {
+      return;
+    }
+
+  m_marks[index] = m_stamp;
+
+  const Record& r = m_records[index];
+
+  if( r.bbLeft > area.right() || r.bbRight < area.left() ||
+      r.bbTop > area.bottom() || r.bbBottom < area.top() ||
+      r.lowerMeters > upper || r.upperMeters < lower )
+    {
+      return;
+    }
+
+  result.append( index );
+}
+
+int AirspaceStore::query( const QRect& area, const int lower, const int upper,
+                          QVector<int>& result ) const
+{
+  result.clear();
+
+  if( isOpen() == false || m_header->recordCount == 0 || lower > upper )
+    {
+      return 0;
+    }
+
+  const int c1 = column( area.left() );
+  const int c2 = column( area.right() );
+  const int r1 = row( area.top() );
+  const int r2 = row( area.bottom() );
+  const int b1 = band( lower );
+  const int b2 = band( upper );
+
+  // The bands are stored one after the other, so their items are contiguous.
+  const quint32 bandItems = m_bandStart[b2 + 1] - m_bandStart[b1];
+
+  qint64 gridItems = 0;
+
+  for( int r = r1; r <= r2; r++ )
+    {
+      int cell = r * m_header->gridColumns;
+
+      gridItems += m_gridStart[cell + c2 + 1] - m_gridStart[cell + c1];
+    }
+
+  nextStamp();
+
+  if( bandItems < gridItems )
+    {
+      // Wide area, narrow altitude range
+      for( quint32 i = m_bandStart[b1]; i < m_bandStart[b2 + 1]; i++ )
+        {
+          collect( m_bandItems[i], area, lower, upper, result );
+        }
+
+      return result.size();
+    }
+
+  for( int r = r1; r <= r2; r++ )
+    {
+      int cell = r * m_header->gridColumns;
+
+      for( quint32 i = m_gridStart[cell + c1]; i < m_gridStart[cell + c2 + 1]; i++ )
+        {
+          collect( m_gridItems[i], area, lower, upper, result );
+        }
+    }
+
+  return result.size();
+}
+
+int AirspaceStore::queryLine( const QPoint& p1, const QPoint& p2,
+                              QVector<int>& result ) const
+{
+  result.clear();
+
+  if( isOpen() == false || m_header->recordCount == 0 )
+    {
+      return 0;
+    }
+
+  nextStamp();
+
+  // The line is divided into pieces not longer than a half cell. Every piece
+  // is checked with its bounding box.
+  double dx = p2.x() - p1.x();
+  double dy = p2.y() - p1.y();
+
+  int steps = qMax( 1, int( qMax( fabs(dx) / m_header->gridCellWidth,
+                                  fabs(dy) / m_header->gridCellHeight ) * 2.0 ) + 1 );
+
+  QPoint last = p1;
+
+  for( int i = 1; i <= steps; i++ )
+    {
+      QPoint next( p1.x() + int( dx * i / steps ), p1.y() + int( dy * i / steps ) );
+
+      QRect piece = QRect( last, next ).normalized();
+
+      for( int r = row( piece.top() ); r <= row( piece.bottom() ); r++ )
+        {
+          int cell = r * m_header->gridColumns;
+
+          for( quint32 j = m_gridStart[cell + column( piece.left() )];
+               j < m_gridStart[cell + column( piece.right() ) + 1]; j++ )
+            {
+              // Only found records are marked, a record is checked against
+              // several pieces.
+              quint32 idx = m_gridItems[j];
+              const Record& rec = m_records[idx];
+
+              if( m_marks.at( idx ) == m_stamp ||
+                  rec.bbLeft > piece.right() || rec.bbRight < piece.left() ||
+                  rec.bbTop > piece.bottom() || rec.bbBottom < piece.top() )
+                {
+                  continue;
+                }
+
+              m_marks[idx] = m_stamp;
+              result.append( idx );
+            }
+        }
+
+      last = next;
+    }
+
+  return result.size();
+}
+
+QDateTime AirspaceStore::creationDateTime() const
+{
+  if( isOpen() == false )
+    {
+      return QDateTime();
+    }
+
+  return QDateTime::fromMSecsSinceEpoch( m_header->creationTime );
+}
+
+ProjectionBase* AirspaceStore::projection() const
+{
+  if( isOpen() == false || m_header->projectionSize == 0 )
+    {
+      return static_cast<ProjectionBase *> (0);
+    }
+
+  QByteArray ba = QByteArray::fromRawData( reinterpret_cast<const char *>
+                                             (m_data + m_header->projectionOffset),
+                                           m_header->projectionSize );
+  QDataStream in( ba );
+  in.setVersion( QDataStream::Qt_4_7 );
+
+  return LoadProjection( in );
+}
+
+bool AirspaceStore::write( const QString& fileName,
+                           QList<Airspace*>& airspaceList,
+                           const int airspaceListStart,
+                           ProjectionBase* projection )
+{
+  if( airspaceList.size() == 0 || airspaceList.size() < airspaceListStart )
+    {
+      return false;
+    }
+
+  const int recordCount = airspaceList.size() - airspaceListStart;
+
+  QVector<Record> records( recordCount );
+  QVector<qint32> coords;
+  QVector<FrequencyRecord> frequencies;
+  StringPool strings;
+
+  QRect bounds;
+  int maxMeters = 0;
+
+  for( int i = 0; i < recordCount; i++ )
+    {
+      Airspace* as = airspaceList[airspaceListStart + i];
+      Record& r = records[i];
+
+      memset( &r, 0, sizeof(Record) );
+
+      const QPolygon& pg = as->getProjectedPolygon();
+      QRect bb = pg.boundingRect();
+
+      r.bbLeft     = bb.left();
+      r.bbTop      = bb.top();
+      r.bbRight    = bb.right();
+      r.bbBottom   = bb.bottom();
+      r.coordIndex = coords.size() / 2;
+
+      bounds = bounds.isNull() ? bb : bounds.united( bb );
+      r.coordCount = pg.size();
+
+      for( int j = 0; j < pg.size(); j++ )
+        {
+          coords.append( pg.at(j).x() );
+          coords.append( pg.at(j).y() );
+        }
+
+      QByteArray name = as->getName().toUtf8().left( 0xffff );
+      r.nameOffset = strings.intern( name );
+      r.nameLength = name.size();
+
+      QByteArray country = as->getCountry().left(2).toLatin1();
+
+      if( country.size() == 2 )
+        {
+          r.country[0] = country.at(0);
+          r.country[1] = country.at(1);
+        }
+
+      // Normalize Flight Level altitudes to its original value before storing.
+      float uAlt = as->getUpperAltitude().getFeet();
+      float lAlt = as->getLowerAltitude().getFeet();
+
+      if( as->getUpperT() == Airspace::FL )
+        {
+          uAlt /= 100.0;
+        }
+
+      if( as->getLowerT() == Airspace::FL )
+        {
+          lAlt /= 100.0;
+        }
+
+      r.lower       = lAlt;
+      r.upper       = uAlt;
+      r.lowerType   = quint8( as->getLowerT() );
+      r.upperType   = quint8( as->getUpperT() );
+      r.lowerMeters = as->getLowerL();
+      r.upperMeters = as->getUpperL();
+
+      if( r.upperMeters < r.lowerMeters ||
+          as->getUpperT() == BaseMapElement::UNLTD ||
+          as->getUpperT() == BaseMapElement::NotSet )
+        {
+          // Unlimited upper borders are not always normalized.
+          r.upperMeters = Unlimited;
+        }
+
+      maxMeters = qMax( maxMeters, int(r.lowerMeters) );
+
+      if( r.upperMeters != Unlimited )
+        {
+          maxMeters = qMax( maxMeters, int(r.upperMeters) );
+        }
+
+      r.typeID      = quint8( as->getTypeID() );
+      r.openAipType = as->getOpenAipType();
+      r.icaoClass   = as->getIcaoClass();
+      r.activity    = as->getActivity();
+      r.byNotam     = as->isByNotam() ? 1 : 0;
+
+      const QList<Frequency>& fqList = as->getFrequencyList();
+      int fqCount = qMin( fqList.size(), 255 );
+
+      if( fqList.size() > 255 )
+        {
+          qWarning() << "ASS: Frequency list is too big, cutting it to 255 elements.";
+        }
+
+      r.frequencyIndex = frequencies.size();
+      r.frequencyCount = fqCount;
+
+      for( int j = 0; j < fqCount; j++ )
+        {
+          const Frequency& fq = fqList.at(j);
+          FrequencyRecord f;
+
+          memset( &f, 0, sizeof(FrequencyRecord) );
+
+          QByteArray userType = fq.getUserType().toUtf8().left( 0xffff );
+          QByteArray callSign = fq.getCallSign().toUtf8().left( 0xffff );
+
+          f.value          = fq.getValue();
+          f.unit           = fq.getUnit();
+          f.type           = fq.getType();
+          f.primary        = fq.isPrimary() ? 1 : 0;
+          f.publicUse      = fq.isPublicUse() ? 1 : 0;
+          f.userTypeOffset = strings.intern( userType );
+          f.userTypeLength = userType.size();
+          f.callSignOffset = strings.intern( callSign );
+          f.callSignLength = callSign.size();
+
+          frequencies.append( f );
+        }
+    }
+
+  // Build the bounding box grid index. The grid size is derived from the
+  // number of records, to get a few records per cell.
+  int gridDim = qBound( 1, int( sqrt( double(recordCount) / 2.0 ) ), 256 );
+
+  if( bounds.isNull() )
+    {
+      bounds = QRect( 0, 0, 1, 1 );
+    }
+
+  qint32 cellWidth  = qMax( 1, (bounds.width() + gridDim - 1) / gridDim );
+  qint32 cellHeight = qMax( 1, (bounds.height() + gridDim - 1) / gridDim );
+
+  QVector<QVector<quint32> > cells( gridDim * gridDim );
+
+  for( int i = 0; i < recordCount; i++ )
+    {
+      const Record& r = records.at(i);
+
+      int c1 = qBound( 0, (r.bbLeft - bounds.left()) / cellWidth, gridDim - 1 );
+      int c2 = qBound( 0, (r.bbRight - bounds.left()) / cellWidth, gridDim - 1 );
+      int r1 = qBound( 0, (r.bbTop - bounds.top()) / cellHeight, gridDim - 1 );
+      int r2 = qBound( 0, (r.bbBottom - bounds.top()) / cellHeight, gridDim - 1 );
+
+      for( int row = r1; row <= r2; row++ )
+        {
+          for( int col = c1; col <= c2; col++ )
+            {
+              cells[row * gridDim + col].append( i );
+            }
+        }
+    }
+
+  // Build the altitude band index. All above the highest limited border is
+  // put into the last band.
+  int bandCount = qBound( 1, maxMeters / BandHeight + 1, int(MaxBands) );
+
+  QVector<QVector<quint32> > bands( bandCount );
+
+  for( int i = 0; i < recordCount; i++ )
+    {
+      const Record& r = records.at(i);
+
+      int b1 = qBound( 0, r.lowerMeters / BandHeight, bandCount - 1 );
+      int b2 = qBound( 0, r.upperMeters / BandHeight, bandCount - 1 );
+
+      for( int b = b1; b <= b2; b++ )
+        {
+          bands[b].append( i );
+        }
+    }
+
+  QVector<quint32> gridStart, gridItems, bandStart, bandItems;
+
+  buildCsr( cells, gridStart, gridItems );
+  buildCsr( bands, bandStart, bandItems );
+
+  QByteArray projectionData;
+  QDataStream ps( &projectionData, QIODevice::WriteOnly );
+  ps.setVersion( QDataStream::Qt_4_7 );
+  SaveProjection( ps, projection );
+
+  // Assemble the file data.
+  Header h;
+  memset( &h, 0, sizeof(Header) );
+
+  QByteArray data( sizeof(Header), '\0' );
+
+  h.recordOffset     = appendSection( data, reinterpret_cast<const char *>(records.constData()),
+                                      records.size() * sizeof(Record) );
+  h.coordOffset      = appendSection( data, reinterpret_cast<const char *>(coords.constData()),
+                                      coords.size() * sizeof(qint32) );
+  h.frequencyOffset  = appendSection( data, reinterpret_cast<const char *>(frequencies.constData()),
+                                      frequencies.size() * sizeof(FrequencyRecord) );
+  h.stringOffset     = appendSection( data, strings.pool().constData(),
+                                      strings.pool().size() );
+  h.gridStartOffset  = appendSection( data, reinterpret_cast<const char *>(gridStart.constData()),
+                                      gridStart.size() * sizeof(quint32) );
+  h.gridItemOffset   = appendSection( data, reinterpret_cast<const char *>(gridItems.constData()),
+                                      gridItems.size() * sizeof(quint32) );
+  h.bandStartOffset  = appendSection( data, reinterpret_cast<const char *>(bandStart.constData()),
+                                      bandStart.size() * sizeof(quint32) );
+  h.bandItemOffset   = appendSection( data, reinterpret_cast<const char *>(bandItems.constData()),
+                                      bandItems.size() * sizeof(quint32) );
+  h.projectionOffset = appendSection( data, projectionData.constData(),
+                                      projectionData.size() );
+
+  h.magic          = KFLOG_FILE_MAGIC;
+  qstrncpy( h.fileType, FILE_TYPE_AIRSPACE_C, sizeof(h.fileType) );
+  h.version        = FILE_VERSION_AIRSPACE_C;
+  h.byteOrder      = AS_BYTE_ORDER;
+  h.headerSize     = sizeof(Header);
+  h.creationTime   = QDateTime::currentDateTime().toMSecsSinceEpoch();
+  h.recordCount    = recordCount;
+  h.coordCount     = coords.size() / 2;
+  h.frequencyCount = frequencies.size();
+  h.stringPoolSize = strings.pool().size();
+  h.gridLeft       = bounds.left();
+  h.gridTop        = bounds.top();
+  h.gridCellWidth  = cellWidth;
+  h.gridCellHeight = cellHeight;
+  h.gridColumns    = gridDim;
+  h.gridRows       = gridDim;
+  h.gridItemCount  = gridItems.size();
+  h.bandHeight     = BandHeight;
+  h.bandCount      = bandCount;
+  h.bandItemCount  = bandItems.size();
+  h.projectionSize = projectionData.size();
+
+  memcpy( data.data(), &h, sizeof(Header) );
+
+  // Write the file at once. QSaveFile replaces the old file only in case of
+  // success, a still mapped old file is not touched by that.
+  QSaveFile file( fileName );
+
+  if( file.open( QIODevice::WriteOnly ) == false )
+    {
+      qWarning( "ASS: Can't open airspace file %s for writing!"
+                " Aborting ...",
+                fileName.toLatin1().data() );
+
+      return false;
+    }
+
+  if( file.write( data ) != data.size() || file.commit() == false )
+    {
+      qWarning( "ASS: Can't write airspace file %s! Aborting ...",
+                fileName.toLatin1().data() );
+
+      return false;
+    }
+
+  return true;
+}
@@ -0,0 +1,362 @@
+/***********************************************************************
+**
+**   AirspaceStore.h
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+/**
+ * \class AirspaceStore
+ *
+ * \author Axel Pauli
+ *
+ * \brief Memory mapped compiled airspace file.
+ *
+ * A compiled airspace file consists of a fixed header followed by flat,
+ * naturally aligned sections, which can be used directly from the mapped
+ * file without any deserialization step:
+ *
+ * <ul>
+ * <li>a fixed size record table, one record per airspace</li>
+ * <li>a flat array of projected polygon coordinates</li>
+ * <li>a frequency record table</li>
+ * <li>an interned UTF-8 string pool for names, call signs and user types</li>
+ * <li>a bounding box grid index in CSR layout</li>
+ * <li>an altitude band index in CSR layout</li>
+ * <li>the serialized map projection, used for the validity check</li>
+ * </ul>
+ *
+ * The store stays mapped as long as its airspaces are loaded. Queries are
+ * answered from the mapped indexes and records. An \ref Airspace object is
+ * only created for a record, when a query has returned it, and is owned by
+ * the store afterwards. The queries and the airspace objects must be used
+ * from one thread only.
+ *
+ * The file is written in native byte order. A file written on a machine with
+ * another byte order is rejected and must be recompiled from its source.
+ * Every offset and count in the file is checked against its section before
+ * the file is used, a truncated or corrupted file is rejected as a whole.
+ *
+ * \date 2026
+ *
+ * \version 1.0
+ */
+
+#pragma once
+
+#include <QDateTime>
+#include <QFile>
+#include <QList>
+#include <QPolygon>
+#include <QRect>
+#include <QString>
+#include <QVector>
+
+class Airspace;
+class ProjectionBase;
+
+class AirspaceStore
+{
+ private:
+
+  /**
+   * Don't allow copies and assignments.
+   */
+  AirspaceStore( const AirspaceStore& );
+  AirspaceStore& operator=( const AirspaceStore& );
+
+ public:
+
+  /**
+   * File header of a compiled airspace file.
+   */
+  struct Header
+  {
+    quint32 magic;
+    char    fileType[20];
+    quint16 version;
+    quint16 byteOrder;
+    quint32 headerSize;
+    qint64  creationTime;   // milliseconds since epoch
+
+    quint32 recordCount;
+    quint32 coordCount;
+    quint32 frequencyCount;
+    quint32 stringPoolSize;
+
+    qint32  gridLeft;
+    qint32  gridTop;
+    qint32  gridCellWidth;
+    qint32  gridCellHeight;
+    quint32 gridColumns;
+    quint32 gridRows;
+    quint32 gridItemCount;
+
+    qint32  bandHeight;     // meters
+    quint32 bandCount;
+    quint32 bandItemCount;
+
+    quint32 projectionSize;
+
+    quint32 recordOffset;
+    quint32 coordOffset;
+    quint32 frequencyOffset;
+    quint32 stringOffset;
+    quint32 gridStartOffset;
+    quint32 gridItemOffset;
+    quint32 bandStartOffset;
+    quint32 bandItemOffset;
+    quint32 projectionOffset;
+    quint32 reserved;
+  };
+
+  /**
+   * Fixed size airspace record.
+   */
+  struct Record
+  {
+    qint32  bbLeft;
+    qint32  bbTop;
+    qint32  bbRight;
+    qint32  bbBottom;
+    quint32 coordIndex;
+    quint32 coordCount;
+    quint32 nameOffset;
+    quint32 frequencyIndex;
+    float   lower;          // feet or flight level as read from the source
+    float   upper;          // feet or flight level as read from the source
+    qint32  lowerMeters;    // limit in meters of its reference
+    qint32  upperMeters;    // limit in meters of its reference or Unlimited
+    quint16 nameLength;
+    quint8  frequencyCount;
+    quint8  typeID;
+    quint8  openAipType;
+    quint8  icaoClass;
+    quint8  activity;
+    quint8  byNotam;
+    quint8  lowerType;
+    quint8  upperType;
+    char    country[2];
+    quint32 reserved;
+  };
+
+  /**
+   * Fixed size frequency record.
+   */
+  struct FrequencyRecord
+  {
+    float   value;
+    quint32 userTypeOffset;
+    quint32 callSignOffset;
+    quint16 userTypeLength;
+    quint16 callSignLength;
+    quint8  unit;
+    quint8  type;
+    quint8  primary;
+    quint8  publicUse;
+  };
+
+  AirspaceStore();
+
+  virtual ~AirspaceStore();
+
+  /**
+   * Maps the compiled file into memory and checks its header.
+   *
+   * \param path Full name with path of the compiled file
+   *
+   * \return true in case of success otherwise false
+   */
+  bool open( const QString& path );
+
+  /**
+   * Unmaps and closes the compiled file.
+   */
+  void close();
+
+  bool isOpen() const
+  {
+    return m_header != 0;
+  };
+
+  /**
+   * \return The number of airspace records in the file.
+   */
+  int count() const
+  {
+    return m_header ? int(m_header->recordCount) : 0;
+  };
+
+  const Record& record( const int index ) const
+  {
+    return m_records[index];
+  };
+
+  /**
+   * \return The name of the airspace record.
+   */
+  QString name( const int index ) const
+  {
+    const Record& r = m_records[index];
+    return QString::fromUtf8( m_strings + r.nameOffset, r.nameLength );
+  };
+
+  /**
+   * \return A pointer to the first x,y pair of the airspace polygon. The
+   * polygon consists of record(index).coordCount pairs.
+   */
+  const qint32* coordinates( const int index ) const
+  {
+    return m_coords + 2 * m_records[index].coordIndex;
+  };
+
+  /**
+   * \return The projected polygon of the airspace record.
+   */
+  QPolygon polygon( const int index ) const;
+
+  /**
+   * \return The airspace object of the record. It is created at the first
+   * call and is owned by the store.
+   */
+  Airspace* airspace( const int index );
+
+  /**
+   * Collects all records, whose bounding box intersects the passed projected
+   * area and whose vertical extension intersects lower...upper meters. The
+   * limits of a record are compared in the reference, they are given in.
+   * The index with less candidates is scanned, the other condition is
+   * checked at the record. The result list is cleared before.
+   *
+   * \return The number of found records.
+   */
+  int query( const QRect& area, const int lower, const int upper,
+             QVector<int>& result ) const;
+
+  /**
+   * Collects all records, whose bounding box touches one of the grid cells
+   * along the line from p1 to p2 in projected coordinates. The result list
+   * is cleared before.
+   *
+   * \return The number of found records.
+   */
+  int queryLine( const QPoint& p1, const QPoint& p2, QVector<int>& result ) const;
+
+  /**
+   * \return The creation date and time of the file.
+   */
+  QDateTime creationDateTime() const;
+
+  /**
+   * \return A new projection object as stored in the file. The caller takes
+   * the ownership of the returned object.
+   */
+  ProjectionBase* projection() const;
+
+  /**
+   * Writes a compiled file from the passed airspace list beginning at the
+   * given start position and ending at the end of the list.
+   *
+   * \param fileName Name of the compiled file
+   *
+   * \param airspaceList List with airspace records
+   *
+   * \param airspaceListStart Begin index in passed list
+   *
+   * \param projection Current map projection to be stored in the file
+   *
+   * \return true in case of success otherwise false
+   */
+  static bool write( const QString& fileName,
+                     QList<Airspace*>& airspaceList,
+                     const int airspaceListStart,
+                     ProjectionBase* projection );
+
+  /** Upper limit in meters of an unlimited airspace record. */
+  static const int Unlimited = 99999;
+
+  /** Height of one altitude band in meters. */
+  static const int BandHeight = 500;
+
+  /** Maximum number of altitude bands, all above is put in the last one. */
+  static const int MaxBands = 64;
+
+ private:
+
+  /**
+   * Creates a new airspace object from the airspace record. The caller
+   * takes the ownership of the returned object.
+   */
+  Airspace* createAirspace( const int index ) const;
+
+  /** Starts a new query, the records found before are unmarked. */
+  void nextStamp() const;
+
+  /**
+   * Appends the record to the result list, if it is not yet marked and
+   * lies in the area and the altitude range.
+   */
+  void collect( const quint32 index, const QRect& area, const int lower,
+                const int upper, QVector<int>& result ) const;
+
+  int column( const int x ) const
+  {
+    return qBound( 0, (x - m_header->gridLeft) / m_header->gridCellWidth,
+                   int(m_header->gridColumns) - 1 );
+  };
+
+  int row( const int y ) const
+  {
+    return qBound( 0, (y - m_header->gridTop) / m_header->gridCellHeight,
+                   int(m_header->gridRows) - 1 );
+  };
+
+  int band( const int meters ) const
+  {
+    return qBound( 0, meters / m_header->bandHeight, int(m_header->bandCount) - 1 );
+  };
+
+  /** Checks the header and the section borders against the file size. */
+  bool checkLayout( const qint64 fileSize ) const;
+
+  /**
+   * Checks the offsets and counts of all airspace and frequency records and
+   * of the index tables against the sections, they refer to.
+   */
+  bool checkRecords() const;
+
+  QFile m_file;
+
+  uchar* m_data;
+
+  const Header*          m_header;
+  const Record*          m_records;
+  const qint32*          m_coords;
+  const FrequencyRecord* m_frequencies;
+  const char*            m_strings;
+  const quint32*         m_gridStart;
+  const quint32*         m_gridItems;
+  const quint32*         m_bandStart;
+  const quint32*         m_bandItems;
+
+  /** Airspace objects of the records, created on demand. */
+  QVector<Airspace*> m_airspaces;
+
+  /** Per record query marks to avoid duplicates in a query result. */
+  mutable QVector<quint32> m_marks;
+  mutable quint32 m_stamp;
+};
+
+/**
+ * List of the mapped airspace stores, which is passed from the loader
+ * thread to the GUI thread.
+ */
+typedef QList<AirspaceStore*> AirspaceStoreList;
@@ -0,0 +1,112 @@
+/***********************************************************************
+**
+**   FlarmAlertZones.cpp
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <algorithm>
+
+#include <QtCore>
+
+#include "FlarmAlertZones.h"
+
+FlarmAlertZones::FlarmAlertZones( AirspaceIndex& index ) :
+  m_index( index )
+{
+}
+
+FlarmAlertZones::~FlarmAlertZones()
+{
+  qDeleteAll( takeAll() );
+}
+
+void FlarmAlertZones::commit( Airspace* as )
+{
+  FlarmBase::FlarmAlertZone& faz = as->getFlarmAlertZone();
+
+  if( m_limits.contains( as ) )
+    {
+      // Known zone, its limits can be changed.
+      m_list.removeOne( as );
+      m_expiry.remove( m_limits.take( as ), as );
+    }
+  else
+    {
+      m_keys.insert( faz.Key, as );
+    }
+
+  // Keep the list sorted from top to bottom without sorting it again.
+  SortableAirspaceList::iterator it =
+    std::upper_bound( m_list.begin(), m_list.end(), as, CompareAirspaces() );
+
+  m_list.insert( it, as );
+
+  quint64 limit = faz.ActivityLimit;
+
+  m_limits.insert( as, limit );
+
+  if( limit > 0 )
+    {
+      m_expiry.insert( limit, as );
+    }
+
+  // Inserts a new zone or updates the bounding box of a known one.
+  m_index.insert( as );
+}
+
+QList<Airspace*> FlarmAlertZones::takeExpired( const quint64 nowUtc )
+{
+  QList<Airspace*> expired;
+
+  while( m_expiry.isEmpty() == false && m_expiry.firstKey() < nowUtc )
+    {
+      Airspace* as = m_expiry.first();
+
+      take( as );
+      expired.append( as );
+    }
+
+  return expired;
+}
+
+QList<Airspace*> FlarmAlertZones::takeAll()
+{
+  QList<Airspace*> all = m_list;
+
+  for( int i = 0; i < all.size(); i++ )
+    {
+      m_index.remove( all.at(i) );
+    }
+
+  m_list.clear();
+  m_keys.clear();
+  m_expiry.clear();
+  m_limits.clear();
+
+  return all;
+}
+
+void FlarmAlertZones::reindex()
+{
+  for( int i = 0; i < m_list.size(); i++ )
+    {
+      m_index.insert( m_list.at(i) );
+    }
+}
+
+void FlarmAlertZones::take( Airspace* as )
+{
+  m_list.removeOne( as );
+  m_keys.remove( as->getFlarmAlertZone().Key );
+  m_expiry.remove( m_limits.take( as ), as );
+  m_index.remove( as );
+}
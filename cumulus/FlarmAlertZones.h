@@ -0,0 +1,135 @@
+/***********************************************************************
+**
+**   FlarmAlertZones.h
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+/**
+ * \class FlarmAlertZones
+ *
+ * \author Axel Pauli
+ *
+ * \brief Store of the Flarm alert zones, reported by PFLAO sentences.
+ *
+ * Every alert zone is kept as airspace object. The zones can be found by
+ * their Flarm key and are ordered by their activity limit, so that the
+ * expired zones can be taken out without scanning all zones. New and changed
+ * zones are inserted into the airspace index one by one, the index needs not
+ * to be rebuilt.
+ *
+ * The store owns the airspace objects. Zones taken out by takeExpired() or
+ * takeAll() must be deleted by the caller.
+ *
+ * \date 2026
+ *
+ * \version 1.0
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QMultiMap>
+#include <QString>
+
+#include "airspace.h"
+#include "AirspaceIndex.h"
+
+class FlarmAlertZones
+{
+ public:
+
+  /**
+   * \param index The airspace index, into that the zones are inserted.
+   */
+  FlarmAlertZones( AirspaceIndex& index );
+
+  virtual ~FlarmAlertZones();
+
+  /**
+   * \return The zone with the passed Flarm key or null, if it is unknown.
+   */
+  Airspace* find( const QString& key ) const
+  {
+    return m_keys.value( key, static_cast<Airspace *> (0) );
+  };
+
+  /**
+   * Takes over a new zone or the changed data of a known zone into the
+   * zone list, the expiry order and the airspace index.
+   */
+  void commit( Airspace* as );
+
+  /**
+   * Takes out all zones, whose activity limit is before the passed time.
+   *
+   * \param nowUtc Current time in UTC seconds since the epoch.
+   * \return The expired zones, which must be deleted by the caller.
+   */
+  QList<Airspace*> takeExpired( const quint64 nowUtc );
+
+  /**
+   * Takes out all zones.
+   *
+   * \return The zones, which must be deleted by the caller.
+   */
+  QList<Airspace*> takeAll();
+
+  /**
+   * \return The activity limit of the next expiring zone in UTC seconds or 0,
+   *         if no zone has a limit.
+   */
+  quint64 nextExpiry() const
+  {
+    return m_expiry.isEmpty() ? 0 : m_expiry.firstKey();
+  };
+
+  /**
+   * Inserts all zones again into the airspace index. Must be called after a
+   * rebuild of the index.
+   */
+  void reindex();
+
+  /**
+   * \return The zones sorted from top to bottom.
+   */
+  SortableAirspaceList* list()
+  {
+    return &m_list;
+  };
+
+  int size() const
+  {
+    return m_list.size();
+  };
+
+ private:
+
+  Q_DISABLE_COPY ( FlarmAlertZones )
+
+  /** Removes the passed zone from the list and all indexes. */
+  void take( Airspace* as );
+
+  AirspaceIndex& m_index;
+
+  /** All zones sorted from top to bottom, used for drawing. */
+  SortableAirspaceList m_list;
+
+  /** Zones by their Flarm key */
+  QHash<QString, Airspace*> m_keys;
+
+  /** Zones with an activity limit ordered by this limit */
+  QMultiMap<quint64, Airspace*> m_expiry;
+
+  /** Activity limit, under that a zone is stored in the expiry order */
+  QHash<Airspace*, quint64> m_limits;
+};
@@ -8,37 +8,50 @@
 **
 ************************************************************************
 **
-**   Copyright (c):  2023 by Axel Pauli <kflog.cumulus@gmail.com>
+**   Copyright (c):  2023-2026 by Axel Pauli <kflog.cumulus@gmail.com>
 **
 **   This file is distributed under the terms of the General Public
 **   License. See the file COPYING for more information.
 **
 ***********************************************************************/
 
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 #include <FlarmNet.h>
 #include <QtCore>
 
 #include "generalconfig.h"
 
-QHash<uint, QString> FlarmNet::m_datamap;
-QMutex FlarmNet::m_mutex;
+// Version of the binary file layout
+#define FILE_VERSION 1
+
+// Length of a decoded record of the FlarmNet text file
+#define TEXT_RECORD 86
+
+uchar* FlarmNet::m_map = 0;
+qint64 FlarmNet::m_mapSize = 0;
+
+const FlarmNet::Header* FlarmNet::m_header = 0;
+const FlarmNet::Record* FlarmNet::m_recordList = 0;
+const char*             FlarmNet::m_pool = 0;
+
+QStringList FlarmNet::m_filterList;
+int         FlarmNet::m_records = 0;
+QMutex      FlarmNet::m_mutex;
 
 void FlarmNet::unloadData()
 {
   QMutexLocker locker( &m_mutex );
-  m_datamap.clear();
+  unmapFile();
 }
 
-int FlarmNet::loadData()
+bool FlarmNet::getPaths( QString& source, QString& dest )
 {
-  // Set a global lock during execution to avoid calls in parallel.
-  QMutexLocker locker( &m_mutex );
-  QElapsedTimer t; t.start();
-  uint items = 0; // number of loaded items
-  bool start = true;
-
-  m_datamap.clear();
-
   // Check, which file the user wants to load.
   QDir dir( GeneralConfig::instance()->getUserDataDirectory() );
   QString url = GeneralConfig::instance()->getFlarmNetUrl();
@@ -47,31 +60,109 @@ int FlarmNet::loadData()
     {
       // No file shall be loaded
       qWarning() << "FlarmNet: No DB file defined for loading!";
-      return items;
+      return false;
     }
 
   QString fname = QFileInfo( url.mid( 6 ) ).fileName();
-  QString fpath = dir.absolutePath() + "/flarmNet/" + fname;
-  QFile file( fpath);
 
-  if( file.open( QIODevice::ReadOnly | QIODevice::Text) == false )
+  source = dir.absolutePath() + "/flarmNet/" + fname;
+  dest   = source + ".bin";
+  return true;
+}
+
+QStringList FlarmNet::createFilterList( const QString& filter )
+{
+  return filter.toUpper().split( QRegExp("[\\s,]+"), Qt::SkipEmptyParts );
+}
+
+int FlarmNet::loadData()
+{
+  // Set a global lock during execution to avoid calls in parallel.
+  QMutexLocker locker( &m_mutex );
+  QElapsedTimer t; t.start();
+
+  unmapFile();
+
+  QString source, dest;
+
+  if( getPaths( source, dest ) == false || mapCompiled( source, dest ) == false )
+    {
+      return 0;
+    }
+
+  // The filter is applied during the lookup, so the binary file does not
+  // depend on it. The records passing it are only counted on request.
+  m_filterList = createFilterList( GeneralConfig::instance()->getFlarmNetFilter() );
+  m_records = -1;
+
+  qDebug( "FlarmNet: %u items mapped in %lldms", m_header->records, t.elapsed() );
+  return m_header->records;
+}
+
+bool FlarmNet::mapCompiled( const QString& source, const QString& dest )
+{
+  QFileInfo sfi( source );
+  QFileInfo dfi( dest );
+
+  // The binary file is compiled, if it is missing or older than a new
+  // download of the text file.
+  bool compile = sfi.exists() &&
+                 ( dfi.exists() == false || dfi.lastModified() < sfi.lastModified() );
+
+  if( compile == false )
+    {
+      if( mapFile( dest ) == false )
+        {
+          // Missing or invalid binary file
+          compile = sfi.exists();
+        }
+      else if( sfi.exists() &&
+               ( m_header->sourceSize != sfi.size() ||
+                 m_header->sourceTime != sfi.lastModified().toMSecsSinceEpoch() ) )
+        {
+          // The binary file does not belong to the text file.
+          unmapFile();
+          compile = true;
+        }
+    }
+
+  if( compile == true &&
+      ( compileData( source, dest ) < 0 || mapFile( dest ) == false ) )
+    {
+      return false;
+    }
+
+  return m_header != 0;
+}
+
+int FlarmNet::compileData( const QString& source, const QString& dest )
+{
+  QElapsedTimer t; t.start();
+
+  QFile file( source );
+
+  if( file.open( QIODevice::ReadOnly ) == false )
     {
-      qWarning( "FlarmNet: Can't open DB file %s for writing!"
+      qWarning( "FlarmNet: Can't open DB file %s for reading!"
                 " Aborting ...",
-                fpath.toLatin1().data() );
+                source.toLatin1().data() );
 
-      return items;
+      return -1;
     }
 
-  QString fs = GeneralConfig::instance()->getFlarmNetFilter().toUpper();
-  QStringList filterList = fs.split( QRegExp("[\\s,]+"), Qt::SkipEmptyParts);
+  QFileInfo sfi( source );
 
-  QTextStream in( &file );
-  in.setCodec( "ISO 8859-15" );
+  // The string pool starts with the empty string.
+  QByteArray pool( 1, '\0' );
+  QHash<QByteArray, quint32> poolIndex;
+  poolIndex.insert( QByteArray(), 0 );
 
-  while( ! in.atEnd() )
+  QMap<quint32, Record> records;
+  bool start = true;
+
+  while( file.atEnd() == false )
     {
-      QString line = in.readLine();
+      QByteArray line = file.readLine().trimmed();
 
       if( start == true )
         {
@@ -81,14 +172,14 @@ int FlarmNet::loadData()
           continue;
         }
 
-      if( line.size() < 172 )
+      if( line.size() < 2 * TEXT_RECORD )
         {
           // ignore short line.
           qDebug() << "FlarmNet: line shorter than 172:" << line.size();
           continue;
         }
 
-      QByteArray ba = QByteArray::fromHex( line.toLatin1() );
+      QByteArray ba = QByteArray::fromHex( line.left( 2 * TEXT_RECORD ) );
 
       for( int i=0; i < ba.size(); i++ )
         {
@@ -119,156 +210,237 @@ int FlarmNet::loadData()
         ba + 76, 3, record.callsign;
         ba + 79, 7, record.frequency;
        */
-      QByteArray fdata = ba.mid( 69, 7 ).trimmed().toUpper(); // KZ
-      QString kz = QString( fdata ).toUpper();
+      QByteArray fields[4] = { ba.mid( 69, 7 ).trimmed().toUpper(), // KZ
+                               ba.mid( 48, 21 ).trimmed(), // Flugzeug Type
+                               ba.mid( 76, 3 ).trimmed(), // WKZ
+                               ba.mid( 79, 7 ).trimmed() }; // Frequenz
+      quint32 offsets[4];
 
-      if( filterList.size() > 0 )
+      for( int i = 0; i < 4; i++ )
         {
-          // Check filter for taking
-          bool takeit = false;
+          QHash<QByteArray, quint32>::const_iterator it = poolIndex.constFind( fields[i] );
 
-          for( int i=0; i < filterList.size(); i++ )
-            {
-              if( kz.startsWith( filterList.at(i) ) == true )
-                {
-                  takeit = true;
-                  break;
-                }
-            }
-
-          if( takeit == false )
+          if( it != poolIndex.constEnd() )
             {
+              offsets[i] = it.value();
               continue;
             }
+
+          offsets[i] = pool.size();
+          poolIndex.insert( fields[i], offsets[i] );
+          pool.append( fields[i] );
+          pool.append( '\0' );
         }
 
-      items++;
-      fdata.append( "|" ); // Trenner
-      fdata.append( ba.mid( 48, 21 ).trimmed() ); // Flugzeug Type
-      fdata.append( "|" ); // Trenner
-      fdata.append( ba.mid( 76, 3 ).trimmed() ); // WKZ
-      fdata.append( "|" ); // Trenner
-      fdata.append( ba.mid( 79, 7 ).trimmed() ); // Frequenz
-      m_datamap.insert( fid, fdata );
-      // qDebug() << fid << fdata;
+      // A later record replaces an earlier one with the same ID.
+      Record record = { fid, offsets[0], offsets[1], offsets[2], offsets[3] };
+      records.insert( fid, record );
     } // End of While
 
-  qDebug( "FlarmNet: %d items loaded in %lldms", items, t.elapsed() );
-  return items;
+  file.close();
+
+  Header header;
+  memcpy( header.magic, "CFNB", sizeof(header.magic) );
+  header.version    = FILE_VERSION;
+  header.records    = records.size();
+  header.poolSize   = pool.size();
+  header.sourceSize = sfi.size();
+  header.sourceTime = sfi.lastModified().toMSecsSinceEpoch();
+
+  // The file is written under another name and renamed at the end. So a
+  // mapped older file stays valid.
+  QSaveFile out( dest );
+
+  if( out.open( QIODevice::WriteOnly ) == false )
+    {
+      qWarning( "FlarmNet: Can't open file %s for writing!",
+                dest.toLatin1().data() );
+      return -1;
+    }
+
+  out.write( reinterpret_cast<const char *>( &header ), sizeof(header) );
+
+  // The map delivers the records sorted by the ID.
+  QMap<quint32, Record>::const_iterator it;
+
+  for( it = records.constBegin(); it != records.constEnd(); ++it )
+    {
+      out.write( reinterpret_cast<const char *>( &it.value() ), sizeof(Record) );
+    }
+
+  out.write( pool );
+
+  if( out.commit() == false )
+    {
+      qWarning( "FlarmNet: Can't write file %s!", dest.toLatin1().data() );
+      return -1;
+    }
+
+  qDebug( "FlarmNet: %d items with %d string bytes compiled in %lldms",
+          header.records, header.poolSize, t.elapsed() );
+
+  return header.records;
 }
 
-int FlarmNet::applyFilter( QString filter )
+bool FlarmNet::mapFile( const QString& path )
 {
-  // Set a global lock during execution to avoid calls in parallel.
-  QMutexLocker locker( &m_mutex );
-  QElapsedTimer t; t.start();
-  uint items = 0; // number of count items
-  bool start = true;
+  QByteArray name = QFile::encodeName( path );
 
-  // Check, which file the user wants to load.
-  QDir dir( GeneralConfig::instance()->getUserDataDirectory() );
-  QString url = GeneralConfig::instance()->getFlarmNetUrl();
+  int fd = open( name.data(), O_RDONLY );
 
-  if( url.isEmpty() )
+  if( fd == -1 )
     {
-      // No file shall be loaded
-      qWarning() << "FlarmNet: No DB file defined for loading!";
-      return items;
+      return false;
     }
 
-  QString fname = QFileInfo( url.mid( 6 ) ).fileName();
-  QString fpath = dir.absolutePath() + "/flarmNet/" + fname;
-  QFile file( fpath);
+  struct stat st;
 
-  if( file.open( QIODevice::ReadOnly | QIODevice::Text) == false )
+  if( fstat( fd, &st ) == -1 || st.st_size < (off_t) sizeof(Header) )
     {
-      qWarning( "FlarmNet: Can't open DB file %s for writing!"
-                " Aborting ...",
-                fpath.toLatin1().data() );
+      close( fd );
+      return false;
+    }
+
+  void* addr = mmap( 0, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
 
-      return items;
+  // The mapping stays valid after closing the descriptor.
+  close( fd );
+
+  if( addr == MAP_FAILED )
+    {
+      qWarning() << "FlarmNet: mmap failed" << strerror(errno);
+      return false;
     }
 
-  QStringList filterList = filter.split( QRegExp("[\\s,]+"), Qt::SkipEmptyParts);
+  m_map = static_cast<uchar *>( addr );
+  m_mapSize = st.st_size;
+
+  const Header* header = reinterpret_cast<const Header *>( m_map );
 
-  QTextStream in( &file );
-  in.setCodec( "ISO 8859-15" );
+  qint64 expected = sizeof(Header) + qint64( header->records ) * sizeof(Record) +
+                    header->poolSize;
 
-  while( ! in.atEnd() )
+  if( memcmp( header->magic, "CFNB", sizeof(header->magic) ) != 0 ||
+      header->version != FILE_VERSION || expected != m_mapSize ||
+      header->poolSize == 0 || m_map[m_mapSize - 1] != '\0' )
     {
-      QString line = in.readLine();
+      qWarning() << "FlarmNet: Invalid binary file" << path;
+      unmapFile();
+      return false;
+    }
 
-      if( start == true )
+  m_header = header;
+  m_recordList = reinterpret_cast<const Record *>( m_map + sizeof(Header) );
+  m_pool = reinterpret_cast<const char *>( m_recordList + header->records );
+  return true;
+}
+
+void FlarmNet::unmapFile()
+{
+  if( m_map != 0 )
+    {
+      munmap( m_map, m_mapSize );
+    }
+
+  m_map = 0;
+  m_mapSize = 0;
+  m_header = 0;
+  m_recordList = 0;
+  m_pool = 0;
+  m_records = 0;
+}
+
+const char* FlarmNet::poolString( const quint32 offset )
+{
+  // The pool ends with a zero, so every valid offset gives a string.
+  return offset < m_header->poolSize ? m_pool + offset : m_pool;
+}
+
+bool FlarmNet::passesFilter( const Record& record, const QStringList& filterList )
+{
+  if( filterList.isEmpty() )
+    {
+      return true;
+    }
+
+  const char* kz = poolString( record.registration );
+
+  for( int i=0; i < filterList.size(); i++ )
+    {
+      const QString& prefix = filterList.at(i);
+      int j = 0;
+
+      while( j < prefix.size() && kz[j] != '\0' && prefix.at(j) == QLatin1Char( kz[j] ) )
         {
-          // Magic id is expected
-          qDebug() << "FlarmNet magic" << line;
-          start = false;
-          continue;
+          j++;
         }
 
-      if( line.size() < 172 )
+      if( j == prefix.size() )
         {
-          // ignore short line.
-          qDebug() << "FlarmNet: line shorter than 172:" << line.size();
-          continue;
+          return true;
         }
+    }
+
+  return false;
+}
 
-      QByteArray ba = QByteArray::fromHex( line.toLatin1() );
+int FlarmNet::countRecords( const QStringList& filterList )
+{
+  int items = 0;
 
-      for( int i=0; i < ba.size(); i++ )
+  for( quint32 i = 0; i < m_header->records; i++ )
+    {
+      if( passesFilter( m_recordList[i], filterList ) )
         {
-          if( ba[i] > (char) 0x7e || ba[i] < ' ' )
-            {
-              ba[i] = '?';
-            }
+          items++;
         }
+    }
 
-      bool ok;
-      uint fid = ba.mid( 0, 6 ).toUInt( &ok, 16);
+  return items;
+}
 
-      if( ! ok )
-        {
-          continue;
-        }
+int FlarmNet::getRecords()
+{
+  QMutexLocker locker( &m_mutex );
 
-      /**
-        bytearray content
-                  1         2         3         4         5         6         7         8
-        01234567890123456789012345678901234567890123456789012345678901234567890123456789012345
-        3e7c78                     D-KMII               Ventus bT            D-KMII V  123.005
-        ba, 6, record.flarm_id;
-        ba + 6, 21, record.pilot;
-        ba + 27, 21, record.airfield;
-        ba + 48, 21, record.plane_type;
-        ba + 69, 7, record.registration;
-        ba + 76, 3, record.callsign;
-        ba + 79, 7, record.frequency;
-       */
-      QByteArray fdata = ba.mid( 69, 7 ).trimmed().toUpper(); // KZ
-      QString kz = QString( fdata ).toUpper();
+  if( m_header == 0 )
+    {
+      return 0;
+    }
 
-      if( filterList.size() > 0 )
-        {
-          // Check filter for taking
-          bool takeit = false;
+  if( m_records < 0 )
+    {
+      m_records = countRecords( m_filterList );
+    }
 
-          for( int i=0; i < filterList.size(); i++ )
-            {
-              if( kz.startsWith( filterList.at(i) ) == true )
-                {
-                  takeit = true;
-                  break;
-                }
-            }
+  return m_records;
+}
 
-          if( takeit == false )
-            {
-              continue;
-            }
+int FlarmNet::applyFilter( QString filter )
+{
+  // Set a global lock during execution to avoid calls in parallel.
+  QMutexLocker locker( &m_mutex );
+  QElapsedTimer t; t.start();
+
+  // A file mapped only for counting is unmapped again.
+  bool mapped = m_header != 0;
+
+  if( mapped == false )
+    {
+      QString source, dest;
+
+      if( getPaths( source, dest ) == false || mapCompiled( source, dest ) == false )
+        {
+          return 0;
         }
+    }
 
-      items++;
-    } // End of While
+  int items = countRecords( createFilterList( filter ) );
+
+  if( mapped == false )
+    {
+      unmapFile();
+    }
 
   qDebug( "FlarmNet: %d items filtered and count in %lldms", items, t.elapsed() );
   return items;
@@ -278,14 +450,50 @@ bool FlarmNet::getData( int id, QStringList &data )
 {
   QMutexLocker locker( &m_mutex );
 
-  if( m_datamap.contains( id ) )
+  if( m_header == 0 )
     {
-      // List contains KZ, Type, WKZ, Frequenz. Unknown elements are empty.
-      data = m_datamap.value( id ).split( "|", Qt::KeepEmptyParts );
-      return true;
+      return false;
     }
 
-  return false;
+  // Binary search of the ID in the sorted records
+  quint32 key = id;
+  quint32 low = 0;
+  quint32 high = m_header->records;
+
+  while( low < high )
+    {
+      quint32 mid = low + (high - low) / 2;
+
+      if( m_recordList[mid].id < key )
+        {
+          low = mid + 1;
+        }
+      else
+        {
+          high = mid;
+        }
+    }
+
+  if( low == m_header->records || m_recordList[low].id != key )
+    {
+      return false;
+    }
+
+  const Record& record = m_recordList[low];
+
+  if( passesFilter( record, m_filterList ) == false )
+    {
+      return false;
+    }
+
+  // List contains KZ, Type, WKZ, Frequenz. Unknown elements are empty.
+  data.clear();
+  data << QString::fromLatin1( poolString( record.registration ) )
+       << QString::fromLatin1( poolString( record.type ) )
+       << QString::fromLatin1( poolString( record.callsign ) )
+       << QString::fromLatin1( poolString( record.frequency ) );
+
+  return true;
 }
 
 /*---------------------- FlarmNetThread --------------------------------*/
@@ -8,7 +8,7 @@
 **
 ************************************************************************
 **
-**   Copyright (c):  2023 by Axel Pauli <kflog.cumulus@gmail.com>
+**   Copyright (c):  2023-2026 by Axel Pauli <kflog.cumulus@gmail.com>
 **
 **   This file is distributed under the terms of the General Public
 **   License. See the file COPYING for more information.
@@ -24,18 +24,25 @@
  *
  * Class for reading and accessing special data.
  *
+ * The downloaded text file is compiled once into a binary file beside it.
+ * It contains a header, the records sorted by the Flarm ID and a string
+ * pool, in which every string is stored only once. The binary file is mapped
+ * into memory and the records are found by a binary search. So nothing is
+ * read at startup and the used memory does not depend on the size of the
+ * database.
+ *
  * \see https://www.flarmnet.org
  *
- * \date 2023
+ * \date 2023-2026
  *
- * \version 1.1
+ * \version 1.2
  */
 
 #pragma once
 
-#include <QHash>
 #include <QMutex>
 #include <QString>
+#include <QStringList>
 
 class FlarmNet
 {
@@ -56,22 +63,31 @@ class FlarmNet
   };
 
   /**
-   * Loads data from a file into a hash dictionary.
+   * Compiles the text file, if the binary file is missing or older, and
+   * maps the binary file into memory.
    *
-   * @returns The number of successfully loaded items
+   * @returns The number of mapped records
    *
    */
   static int loadData();
 
   /**
-   * unloads the data hash dictionary.
+   * Unmaps the binary file.
    *
    */
   static void unloadData();
 
   /**
-   * Read the content of a compiled file and put it into the passed
-   * list.
+   * Compiles a FlarmNet text file into a binary file.
+   *
+   * @param source Path of the FlarmNet text file
+   * @param dest Path of the binary file
+   * @return The number of compiled records or -1 in case of an error
+   */
+  static int compileData( const QString& source, const QString& dest );
+
+  /**
+   * Looks up a Flarm ID and put the related data into the passed list.
    *
    * @param id identifier key
    * @param data related data fetched by key.
@@ -80,12 +96,10 @@ class FlarmNet
   static bool getData( int id, QStringList &data );
 
   /**
-   * Get number of FlarmNet records.
+   * Get number of FlarmNet records passing the filter. The records are
+   * counted at the first call after loading.
    */
-  static int getRecords()
-  {
-    return m_datamap.size();
-  }
+  static int getRecords();
 
   /**
    * Count filtered elements and return it.
@@ -94,10 +108,67 @@ class FlarmNet
 
  private:
 
+  /** Header of the binary file */
+  struct Header
+  {
+    char    magic[4];
+    quint32 version;
+    quint32 records;
+    quint32 poolSize;
+    qint64  sourceSize;
+    qint64  sourceTime;
+  };
+
+  /** Record of the binary file, the fields are offsets in the string pool */
+  struct Record
+  {
+    quint32 id;
+    quint32 registration;
+    quint32 type;
+    quint32 callsign;
+    quint32 frequency;
+  };
+
+  /** Gets the paths of the text and of the binary file. */
+  static bool getPaths( QString& source, QString& dest );
+
+  /** Maps the binary file, m_mutex must be locked. */
+  static bool mapFile( const QString& path );
+
+  /** Unmaps the binary file, m_mutex must be locked. */
+  static void unmapFile();
+
   /**
-   * A hash map containing data
+   * Compiles the text file, if the binary file is missing, older or does not
+   * belong to it, and maps the binary file. m_mutex must be locked.
    */
-  static QHash<uint, QString> m_datamap;
+  static bool mapCompiled( const QString& source, const QString& dest );
+
+  /** \return The number of mapped records passing the filter. */
+  static int countRecords( const QStringList& filterList );
+
+  /** \return A string of the pool. */
+  static const char* poolString( const quint32 offset );
+
+  /** \return True, if the registration starts with a filter prefix. */
+  static bool passesFilter( const Record& record, const QStringList& filterList );
+
+  /** \return The filter prefixes of the passed filter text. */
+  static QStringList createFilterList( const QString& filter );
+
+  /** Mapped binary file */
+  static uchar* m_map;
+  static qint64 m_mapSize;
+
+  static const Header* m_header;
+  static const Record* m_recordList;
+  static const char*   m_pool;
+
+  /** Prefixes of the registrations to be used */
+  static QStringList m_filterList;
+
+  /** Number of records passing the filter, -1 if not counted yet */
+  static int m_records;
 
   /** Mutex to ensure thread safety. */
   static QMutex m_mutex;
@@ -0,0 +1,413 @@
+/***********************************************************************
+**
+**   FlarmTraffic.cpp
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <cmath>
+
+#include "FlarmTraffic.h"
+
+// Time window in ms of the track points used for the velocity estimation
+#define VELOCITY_WINDOW 4000
+
+// Minimum time span in ms of the track points for a velocity estimation
+#define MIN_VELOCITY_SPAN 500
+
+// Maximum time in ms between two tracks used for the turn rate
+#define MAX_TURN_GAP 3000
+
+// Maximum turn rate in degrees per second
+#define MAX_TURN_RATE 30.0
+
+// Uncertainties of the extrapolation: position resolution in m, error of the
+// velocity in m/s, unknown acceleration in m/s² and the relative speed in m/s
+// assumed for a target without velocity estimation.
+#define POSITION_ERROR  2.0
+#define VELOCITY_ERROR  1.0
+#define ACCEL_ERROR     1.5
+#define UNKNOWN_SPEED  30.0
+
+void FlarmTraffic::Target::set( const FlarmBase::FlarmAcft& acft,
+                                const bool newTarget )
+{
+  m_acft = acft;
+
+  if( newTarget )
+    {
+      m_trackSize = 0;
+    }
+
+  m_trackHead = (m_trackHead + 1) % TrackLength;
+
+  TrackPoint& tp = m_track[m_trackHead];
+
+  tp.Time             = acft.TimeStamp;
+  tp.RelativeNorth    = acft.RelativeNorth;
+  tp.RelativeEast     = acft.RelativeEast;
+  tp.RelativeVertical = acft.RelativeVertical;
+  tp.Track            = acft.Track;
+  tp.GroundSpeed      = acft.GroundSpeed;
+
+  if( m_trackSize < TrackLength )
+    {
+      m_trackSize++;
+    }
+
+  estimateMotion();
+}
+
+void FlarmTraffic::Target::estimateMotion()
+{
+  const TrackPoint& last = trackPoint( 0 );
+
+  // Least squares fit of the relative position over the time window
+  double st = 0.0, stt = 0.0, sn = 0.0, stn = 0.0, se = 0.0, ste = 0.0;
+  double sv = 0.0, stv = 0.0;
+  int n = 0;
+  qint64 span = 0;
+
+  for( int i = 0; i < m_trackSize; i++ )
+    {
+      const TrackPoint& tp = trackPoint( i );
+
+      if( last.Time - tp.Time > VELOCITY_WINDOW )
+        {
+          break;
+        }
+
+      // Time relative to the last point, so the sums keep their precision.
+      double t = (tp.Time - last.Time) / 1000.0;
+
+      st  += t;
+      stt += t * t;
+      sn  += tp.RelativeNorth;
+      stn += t * tp.RelativeNorth;
+      se  += tp.RelativeEast;
+      ste += t * tp.RelativeEast;
+      sv  += tp.RelativeVertical;
+      stv += t * tp.RelativeVertical;
+
+      span = last.Time - tp.Time;
+      n++;
+    }
+
+  double d = n * stt - st * st;
+
+  m_velocityValid = n >= 2 && span >= MIN_VELOCITY_SPAN && d > 0.0;
+
+  if( m_velocityValid )
+    {
+      m_velNorth = (n * stn - st * sn) / d;
+      m_velEast  = (n * ste - st * se) / d;
+      m_climb    = (n * stv - st * sv) / d;
+    }
+  else
+    {
+      m_velNorth = m_velEast = m_climb = 0.0;
+    }
+
+  // The own velocity is the velocity of the target minus the relative
+  // velocity. It is averaged over the reports in the time window.
+  double ownNorth = 0.0, ownEast = 0.0;
+  int pairs = 0;
+
+  for( int i = 0; i + 1 < m_trackSize; i++ )
+    {
+      const TrackPoint& p0 = trackPoint( i );
+      const TrackPoint& p1 = trackPoint( i + 1 );
+
+      if( last.Time - p1.Time > VELOCITY_WINDOW )
+        {
+          break;
+        }
+
+      double dt = (p0.Time - p1.Time) / 1000.0;
+
+      if( dt <= 0.0 || p0.Track == INT_MIN || p1.Track == INT_MIN ||
+          p0.GroundSpeed == INT_MIN || p1.GroundSpeed == INT_MIN )
+        {
+          continue;
+        }
+
+      // Mean velocity of the target between both reports
+      double t0 = p0.Track * M_PI / 180.0;
+      double t1 = p1.Track * M_PI / 180.0;
+      double vNorth = (p0.GroundSpeed * cos( t0 ) + p1.GroundSpeed * cos( t1 )) / 2.0;
+      double vEast  = (p0.GroundSpeed * sin( t0 ) + p1.GroundSpeed * sin( t1 )) / 2.0;
+
+      ownNorth += vNorth - (p0.RelativeNorth - p1.RelativeNorth) / dt;
+      ownEast  += vEast - (p0.RelativeEast - p1.RelativeEast) / dt;
+      pairs++;
+    }
+
+  m_ownValid = pairs > 0;
+  m_ownNorth = m_ownValid ? ownNorth / pairs : 0.0;
+  m_ownEast  = m_ownValid ? ownEast / pairs : 0.0;
+
+  // The turn rate is taken from the report, if Flarm sends it. Otherwise it
+  // is derived from the last two tracks.
+  m_turnRate = 0.0;
+
+  if( m_acft.TurnRate != INT_MIN )
+    {
+      m_turnRate = m_acft.TurnRate;
+    }
+  else if( m_trackSize >= 2 && last.Track != INT_MIN )
+    {
+      const TrackPoint& prev = trackPoint( 1 );
+      qint64 dt = last.Time - prev.Time;
+
+      if( prev.Track != INT_MIN && dt > 0 && dt <= MAX_TURN_GAP )
+        {
+          int diff = last.Track - prev.Track;
+
+          // Take the shorter way around the circle
+          while( diff > 180 )  diff -= 360;
+          while( diff < -180 ) diff += 360;
+
+          m_turnRate = diff * 1000.0 / dt;
+        }
+    }
+
+  m_turnRate = qBound( -MAX_TURN_RATE, m_turnRate, MAX_TURN_RATE );
+}
+
+double FlarmTraffic::Target::extrapolate( const qint64 time,
+                                          FlarmBase::FlarmAcft& acft ) const
+{
+  acft = m_acft;
+
+  double dt = qBound( qint64(0), time - m_acft.TimeStamp,
+                      qint64(MaxExtrapolation) ) / 1000.0;
+
+  double dNorth, dEast;
+
+  if( m_ownValid && m_acft.Track != INT_MIN && m_acft.GroundSpeed != INT_MIN )
+    {
+      // The target follows its track with the turn rate, the own velocity
+      // is assumed to be constant.
+      double t0 = m_acft.Track * M_PI / 180.0;
+      double w  = m_turnRate * M_PI / 180.0;
+      double gs = m_acft.GroundSpeed;
+
+      if( w != 0.0 )
+        {
+          dNorth = gs / w * (sin( t0 + w * dt ) - sin( t0 ));
+          dEast  = gs / w * (cos( t0 ) - cos( t0 + w * dt ));
+        }
+      else
+        {
+          dNorth = gs * cos( t0 ) * dt;
+          dEast  = gs * sin( t0 ) * dt;
+        }
+
+      dNorth -= m_ownNorth * dt;
+      dEast  -= m_ownEast * dt;
+
+      int track = static_cast<int> (rint( m_acft.Track + m_turnRate * dt )) % 360;
+
+      acft.Track = track < 0 ? track + 360 : track;
+    }
+  else if( m_velocityValid )
+    {
+      // Stealth mode, only the relative velocity is known.
+      dNorth = m_velNorth * dt;
+      dEast  = m_velEast * dt;
+    }
+  else
+    {
+      // The last reported position is kept.
+      return POSITION_ERROR + UNKNOWN_SPEED * dt;
+    }
+
+  acft.RelativeNorth    = static_cast<int> (rint( m_acft.RelativeNorth + dNorth ));
+  acft.RelativeEast     = static_cast<int> (rint( m_acft.RelativeEast + dEast ));
+
+  if( m_velocityValid )
+    {
+      acft.RelativeVertical = static_cast<int> (rint( m_acft.RelativeVertical + m_climb * dt ));
+    }
+
+  return POSITION_ERROR + VELOCITY_ERROR * dt + 0.5 * ACCEL_ERROR * dt * dt;
+}
+
+const FlarmTraffic::Target* FlarmTraffic::Snapshot::find( const uint id ) const
+{
+  for( int i = 0; i < m_size; i++ )
+    {
+      if( m_targets[i].m_acft.ID == id )
+        {
+          return &m_targets[i];
+        }
+    }
+
+  return 0;
+}
+
+FlarmTraffic::FlarmTraffic()
+{
+  clear();
+}
+
+void FlarmTraffic::clear()
+{
+  for( int i = 0; i < HashSize; i++ )
+    {
+      m_hash[i] = -1;
+    }
+
+  // The entries are taken from the stack in ascending order.
+  for( int i = 0; i < Capacity; i++ )
+    {
+      m_free[i] = Capacity - 1 - i;
+    }
+
+  m_freeCount = Capacity;
+  m_head = m_tail = -1;
+  m_size = 0;
+}
+
+int FlarmTraffic::slot( const uint id ) const
+{
+  int s = hash( id );
+
+  // The index has always empty slots, so the probing ends.
+  while( m_hash[s] != -1 && m_targets[m_hash[s]].m_acft.ID != id )
+    {
+      s = (s + 1) & (HashSize - 1);
+    }
+
+  return s;
+}
+
+void FlarmTraffic::update( const FlarmBase::FlarmAcft& acft )
+{
+  int s = slot( acft.ID );
+  int index = m_hash[s];
+
+  if( index != -1 )
+    {
+      // Known target, move it to the tail of the update queue.
+      unlink( index );
+      append( index );
+      m_targets[index].set( acft, false );
+      return;
+    }
+
+  if( m_freeCount == 0 )
+    {
+      // Table is full, replace the oldest target.
+      remove( m_head );
+      s = slot( acft.ID );
+    }
+
+  index = m_free[--m_freeCount];
+  m_hash[s] = index;
+  m_size++;
+
+  append( index );
+  m_targets[index].set( acft, true );
+}
+
+const FlarmTraffic::Target* FlarmTraffic::find( const uint id ) const
+{
+  int index = m_hash[slot( id )];
+
+  return index == -1 ? 0 : &m_targets[index];
+}
+
+void FlarmTraffic::expire( const qint64 now, const qint64 maxAge )
+{
+  while( m_head != -1 && now - m_targets[m_head].m_acft.TimeStamp > maxAge )
+    {
+      remove( m_head );
+    }
+}
+
+void FlarmTraffic::takeSnapshot( Snapshot& snapshot ) const
+{
+  snapshot.m_size = 0;
+
+  // Newest targets first
+  for( int i = m_tail; i != -1; i = m_prev[i] )
+    {
+      snapshot.m_targets[snapshot.m_size++] = m_targets[i];
+    }
+}
+
+void FlarmTraffic::remove( const int index )
+{
+  int s = slot( m_targets[index].m_acft.ID );
+
+  m_hash[s] = -1;
+
+  // Shift the following entries of the probe sequence back, which would not
+  // be found any more behind the new gap.
+  int next = (s + 1) & (HashSize - 1);
+
+  while( m_hash[next] != -1 )
+    {
+      int home = hash( m_targets[m_hash[next]].m_acft.ID );
+
+      if( ((next - home) & (HashSize - 1)) >= ((next - s) & (HashSize - 1)) )
+        {
+          m_hash[s] = m_hash[next];
+          m_hash[next] = -1;
+          s = next;
+        }
+
+      next = (next + 1) & (HashSize - 1);
+    }
+
+  unlink( index );
+  m_free[m_freeCount++] = index;
+  m_size--;
+}
+
+void FlarmTraffic::append( const int index )
+{
+  m_prev[index] = m_tail;
+  m_next[index] = -1;
+
+  if( m_tail != -1 )
+    {
+      m_next[m_tail] = index;
+    }
+  else
+    {
+      m_head = index;
+    }
+
+  m_tail = index;
+}
+
+void FlarmTraffic::unlink( const int index )
+{
+  if( m_prev[index] != -1 )
+    {
+      m_next[m_prev[index]] = m_next[index];
+    }
+  else
+    {
+      m_head = m_next[index];
+    }
+
+  if( m_next[index] != -1 )
+    {
+      m_prev[m_next[index]] = m_prev[index];
+    }
+  else
+    {
+      m_tail = m_prev[index];
+    }
+}
@@ -0,0 +1,284 @@
+/***********************************************************************
+**
+**   FlarmTraffic.h
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+/**
+ * \class FlarmTraffic
+ *
+ * \author Axel Pauli
+ *
+ * \brief Table of the Flarm targets reported by PFLAA sentences.
+ *
+ * The table has a fixed capacity and is keyed by the 24-bit Flarm ID, so an
+ * update does not allocate memory. Every target keeps a short track history
+ * of its last relative positions in a ring buffer.
+ *
+ * The targets are linked in the order of their last update. Expiring old
+ * targets takes only the targets from the head of this queue, which are
+ * really too old. If the table is full, the oldest target is replaced.
+ *
+ * The views do not read the table, which is updated sentence by sentence.
+ * At the end of a PFLAA sequence a snapshot is taken, which all views use
+ * until the next sequence has been received.
+ *
+ * The own velocity is estimated from the reported track and speed of a
+ * target and its relative movement, the turn rate from the reported tracks.
+ * In stealth mode only the relative velocity is estimated. So the views can
+ * extrapolate the position of a target to the display time and carry it
+ * through short gaps of the reception.
+ *
+ * \date 2026
+ *
+ * \version 1.0
+ */
+
+#pragma once
+
+#include <QtGlobal>
+
+#include "flarmbase.h"
+
+class FlarmTraffic
+{
+ public:
+
+  /**
+   * Maximum number of targets in the table. It covers the large gaggles of
+   * the simulator with up to 100 targets and a crowded Flarm field.
+   */
+  static const int Capacity = 128;
+
+  /** Number of track points of a target */
+  static const int TrackLength = 16;
+
+  /** Maximum time in ms, a target is extrapolated after its last report */
+  static const int MaxExtrapolation = 6000;
+
+  /** Time in ms without report, after that a target is coasting */
+  static const int CoastTime = 1500;
+
+  /**
+   * \struct TrackPoint
+   *
+   * \brief Relative position of a target at a time.
+   */
+  struct TrackPoint
+  {
+    qint64 Time; // ms of the virtual clock
+    int    RelativeNorth;
+    int    RelativeEast;
+    int    RelativeVertical;
+    int    Track;       // 0-359 or INT_MIN in stealth mode
+    double GroundSpeed; // m/s or INT_MIN in stealth mode
+  };
+
+  /**
+   * \class Target
+   *
+   * \brief Last PFLAA data and track history of a Flarm target.
+   */
+  class Target
+  {
+   public:
+
+    Target() :
+      m_trackHead( 0 ),
+      m_trackSize( 0 ),
+      m_velocityValid( false ),
+      m_velNorth( 0.0 ),
+      m_velEast( 0.0 ),
+      m_ownValid( false ),
+      m_ownNorth( 0.0 ),
+      m_ownEast( 0.0 ),
+      m_climb( 0.0 ),
+      m_turnRate( 0.0 )
+    {
+    };
+
+    /** The last reported data of the target. */
+    const FlarmBase::FlarmAcft& acft() const
+    {
+      return m_acft;
+    };
+
+    /** \return The number of stored track points. */
+    int trackSize() const
+    {
+      return m_trackSize;
+    };
+
+    /** \return The track point i, 0 is the newest one. */
+    const TrackPoint& trackPoint( const int i ) const
+    {
+      return m_track[(m_trackHead - i + TrackLength) % TrackLength];
+    };
+
+    /**
+     * \return True, if the target was not reported within the coast time
+     * before the passed time. Its position is only extrapolated.
+     */
+    bool isCoasting( const qint64 time ) const
+    {
+      return time - m_acft.TimeStamp > CoastTime;
+    };
+
+    /**
+     * Extrapolates the target to the passed time.
+     *
+     * \param time ms of the virtual clock
+     * \param acft Returns the last reported data with the extrapolated
+     *             relative position and track.
+     * \return The uncertainty of the extrapolated position in meters.
+     */
+    double extrapolate( const qint64 time, FlarmBase::FlarmAcft& acft ) const;
+
+   private:
+
+    friend class FlarmTraffic;
+
+    void set( const FlarmBase::FlarmAcft& acft, const bool newTarget );
+
+    /** Estimates velocity and turn rate from the track history. */
+    void estimateMotion();
+
+    FlarmBase::FlarmAcft m_acft;
+
+    TrackPoint m_track[TrackLength];
+    int        m_trackHead;
+    int        m_trackSize;
+
+    /** Relative velocity in m/s, valid after two reports */
+    bool       m_velocityValid;
+    double     m_velNorth;
+    double     m_velEast;
+
+    /** Own velocity in m/s, valid if the target reports its track */
+    bool       m_ownValid;
+    double     m_ownNorth;
+    double     m_ownEast;
+
+    /** Relative climb rate in m/s */
+    double     m_climb;
+
+    /** Turn rate of the target in degrees per second */
+    double     m_turnRate;
+  };
+
+  /**
+   * \class Snapshot
+   *
+   * \brief Consistent copy of all targets at the end of a PFLAA sequence.
+   */
+  class Snapshot
+  {
+   public:
+
+    Snapshot() : m_size( 0 )
+    {
+    };
+
+    int size() const
+    {
+      return m_size;
+    };
+
+    const Target& at( const int i ) const
+    {
+      return m_targets[i];
+    };
+
+    /** \return The target with the passed ID or 0, if it is unknown. */
+    const Target* find( const uint id ) const;
+
+    void clear()
+    {
+      m_size = 0;
+    };
+
+   private:
+
+    friend class FlarmTraffic;
+
+    int    m_size;
+    Target m_targets[Capacity];
+  };
+
+  FlarmTraffic();
+
+  /** Removes all targets. */
+  void clear();
+
+  /**
+   * Inserts a new target or updates a known target. If the table is full, the
+   * target, which was not updated for the longest time, is replaced.
+   */
+  void update( const FlarmBase::FlarmAcft& acft );
+
+  /** \return The target with the passed ID or 0, if it is unknown. */
+  const Target* find( const uint id ) const;
+
+  int size() const
+  {
+    return m_size;
+  };
+
+  /**
+   * Removes all targets, which were not updated within maxAge ms before now.
+   */
+  void expire( const qint64 now, const qint64 maxAge );
+
+  /** Copies all targets into the passed snapshot. */
+  void takeSnapshot( Snapshot& snapshot ) const;
+
+ private:
+
+  Q_DISABLE_COPY ( FlarmTraffic )
+
+  /** Size of the hash index, a power of two */
+  static const int HashSize = 2 * Capacity;
+
+  /** Fibonacci hashing of the ID to the 8 bits of the hash index */
+  static int hash( const uint id )
+  {
+    return (id * 2654435761U) >> 24;
+  };
+
+  /** \return The hash index slot of the ID or the empty slot to use for it. */
+  int slot( const uint id ) const;
+
+  void remove( const int index );
+
+  /** Appends the target at the tail of the update queue. */
+  void append( const int index );
+
+  /** Removes the target from the update queue. */
+  void unlink( const int index );
+
+  Target m_targets[Capacity];
+
+  /** Index of the target in m_targets or -1 */
+  short  m_hash[HashSize];
+
+  /** Update queue, the head is the oldest target */
+  short  m_prev[Capacity];
+  short  m_next[Capacity];
+  short  m_head;
+  short  m_tail;
+
+  /** Stack of the unused target entries */
+  short  m_free[Capacity];
+  int    m_freeCount;
+
+  int    m_size;
+};
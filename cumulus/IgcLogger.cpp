@@ -166,7 +166,7 @@ void IgcLogger::slotMakeFixEntry()
                          formatTime( lastfix.time.time() ) +
                          GpsNmea::gps->getLastSatInfo().constellation;
       QStringList list;
-      list << bRecord << fRecord << QTime::currentTime().toString("hhmmss");
+      list << bRecord << fRecord << VirtualClock::currentTime().toString("hhmmss");
       _backtrack.add( list );
 
       // qDebug( "Backtrack add: backtrack.size=%d", _backtrack.size() );
@@ -188,7 +188,7 @@ void IgcLogger::slotMakeFixEntry()
           _logMode = on;
 
           // set UTC start date and time of logging
-          startLogging = QDateTime::currentDateTimeUtc();
+          startLogging = VirtualClock::currentDateTimeUtc();
           emit takeoffTime( startLogging );
 
           // If log mode was before in standby we have to write out the backtrack entries.
@@ -841,7 +841,7 @@ void IgcLogger::slotCloseLogFile()
   if( GeneralConfig::instance()->getLoggerAutostartMode() )
     {
       // Correct landing time by subtraction of stand time on earth.
-      QDateTime lt = QDateTime::currentDateTimeUtc().addSecs( -TOAL );
+      QDateTime lt = VirtualClock::currentDateTimeUtc().addSecs( -TOAL );
       emit landingTime( lt );
       Standby();
     }
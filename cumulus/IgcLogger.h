@@ -58,11 +58,11 @@
 #include <QStringList>
 #include <QTextStream>
 #include <QTime>
-#include <QElapsedTimer>
 
 #include "altitude.h"
 #include "calculator.h"
 #include "limitedlist.h"
+#include "VirtualClock.h"
 
 class QMutex;
 
@@ -378,7 +378,7 @@ private:
   QDateTime lastLoggedBRecord;
 
   /** Time stamp of the last logged F record */
-  QElapsedTimer lastLoggedFRecord;
+  VirtualTimer lastLoggedFRecord;
 
   /** Time stamp of the last logged K record */
   QDateTime lastLoggedKRecord;
@@ -0,0 +1,184 @@
+/***********************************************************************
+**
+**   KalmanVario.cpp
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <cmath>
+#include <cstring>
+
+#include "KalmanVario.h"
+
+// Initial uncertainties of a new filter in m and m/s
+#define INIT_ALTITUDE 100.0
+#define INIT_CLIMB      5.0
+#define INIT_OFFSET   100.0
+
+// Drift of the GNSS offset in m per square root of a second
+#define OFFSET_DRIFT 0.1
+
+// A longer gap between two measurements in ms restarts the filter
+#define MAX_GAP 5000
+
+// Factor of the acceleration noise, if the GNSS altitude is the only
+// measurement. The noise is raised further with the GNSS rate in Hz to the
+// power of the exponent.
+#define GNSS_ONLY_NOISE    1.5
+#define GNSS_RATE_EXPONENT 0.6
+
+// Weight of a new GNSS interval in its running average
+#define GNSS_INTERVAL_WEIGHT 0.1
+
+KalmanVario::KalmanVario() :
+  m_accelNoise( 1.0 )
+{
+  reset();
+}
+
+void KalmanVario::reset()
+{
+  m_valid = false;
+  m_time  = 0;
+  m_accel = 0.0;
+
+  m_baroTime     = 0;
+  m_gnssTime     = 0;
+  m_gnssInterval = 0.0;
+
+  memset( m_x, 0, sizeof(m_x) );
+  memset( m_p, 0, sizeof(m_p) );
+}
+
+void KalmanVario::updateBaro( const qint64 time, const double altitude,
+                              const double sigma )
+{
+  update( time, altitude, sigma, 0.0 );
+  m_baroTime = time;
+}
+
+void KalmanVario::updateGnss( const qint64 time, const double altitude,
+                              const double sigma )
+{
+  update( time, altitude, sigma, 1.0 );
+
+  if( m_gnssTime != 0 && time > m_gnssTime )
+    {
+      double interval = time - m_gnssTime;
+
+      if( m_gnssInterval == 0.0 )
+        {
+          m_gnssInterval = interval;
+        }
+      else
+        {
+          m_gnssInterval += GNSS_INTERVAL_WEIGHT * (interval - m_gnssInterval);
+        }
+    }
+
+  m_gnssTime = time;
+}
+
+double KalmanVario::rateFactor( const qint64 time ) const
+{
+  if( m_baroTime != 0 && time - m_baroTime <= MAX_GAP )
+    {
+      return 1.0;
+    }
+
+  if( m_gnssInterval <= 0.0 || m_gnssInterval >= 1000.0 )
+    {
+      return GNSS_ONLY_NOISE;
+    }
+
+  // The noisy GNSS altitude is the only measurement. A higher rate delivers
+  // more fixes in the same time, so the filter can follow faster with the
+  // same noise of the climb rate.
+  return GNSS_ONLY_NOISE * pow( 1000.0 / m_gnssInterval, GNSS_RATE_EXPONENT );
+}
+
+void KalmanVario::predict( const qint64 time )
+{
+  double dt = (time - m_time) / 1000.0;
+
+  if( dt <= 0.0 )
+    {
+      return;
+    }
+
+  m_time = time;
+
+  m_x[Altitude] += m_x[Climb] * dt + 0.5 * m_accel * dt * dt;
+  m_x[Climb]    += m_accel * dt;
+
+  // P = F * P * F', F moves the altitude by climb * dt.
+  m_p[Altitude][Altitude] += dt * (m_p[Climb][Altitude] + m_p[Altitude][Climb]) +
+                             dt * dt * m_p[Climb][Climb];
+  m_p[Altitude][Climb]    += dt * m_p[Climb][Climb];
+  m_p[Altitude][Offset]   += dt * m_p[Climb][Offset];
+  m_p[Climb][Altitude]     = m_p[Altitude][Climb];
+  m_p[Offset][Altitude]    = m_p[Altitude][Offset];
+
+  // Process noise of an unknown acceleration and of the offset drift
+  double sigma = m_accelNoise * rateFactor( time );
+  double q = sigma * sigma;
+
+  m_p[Altitude][Altitude] += q * dt * dt * dt * dt / 4.0;
+  m_p[Altitude][Climb]    += q * dt * dt * dt / 2.0;
+  m_p[Climb][Altitude]    += q * dt * dt * dt / 2.0;
+  m_p[Climb][Climb]       += q * dt * dt;
+  m_p[Offset][Offset]     += OFFSET_DRIFT * OFFSET_DRIFT * dt;
+}
+
+void KalmanVario::update( const qint64 time, const double z,
+                          const double sigma, const double h2 )
+{
+  if( m_valid && time - m_time > MAX_GAP )
+    {
+      reset();
+    }
+
+  if( m_valid == false )
+    {
+      m_valid = true;
+      m_time  = time;
+
+      m_x[Altitude] = z;
+      m_p[Altitude][Altitude] = INIT_ALTITUDE * INIT_ALTITUDE;
+      m_p[Climb][Climb]       = INIT_CLIMB * INIT_CLIMB;
+      m_p[Offset][Offset]     = INIT_OFFSET * INIT_OFFSET;
+    }
+
+  predict( time );
+
+  // The measurement vector is H = (1, 0, h2).
+  double ph[States];
+
+  for( int i = 0; i < States; i++ )
+    {
+      ph[i] = m_p[i][Altitude] + h2 * m_p[i][Offset];
+    }
+
+  double s = ph[Altitude] + h2 * ph[Offset] + sigma * sigma;
+  double y = z - (m_x[Altitude] + h2 * m_x[Offset]);
+
+  for( int i = 0; i < States; i++ )
+    {
+      double k = ph[i] / s;
+
+      m_x[i] += k * y;
+
+      for( int j = 0; j < States; j++ )
+        {
+          m_p[i][j] -= k * ph[j];
+        }
+    }
+}
@@ -0,0 +1,130 @@
+/***********************************************************************
+**
+**   KalmanVario.h
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+/**
+ * \class KalmanVario
+ *
+ * \author Axel Pauli
+ *
+ * \brief Kalman filter for the altitude and the climb rate.
+ *
+ * The filter state is the barometric altitude, the climb rate and the offset
+ * of the GNSS altitude to the barometric altitude. Barometric altitudes
+ * measure the altitude, GNSS altitudes the sum of altitude and offset. So
+ * both sources can be mixed, although they use different references. A
+ * vertical acceleration, if available, drives the prediction of the climb
+ * rate. Without it, the acceleration is modelled as noise.
+ *
+ * All times are passed in milli seconds of a monotonic clock.
+ *
+ * \date 2026
+ *
+ * \version 1.0
+ */
+
+#pragma once
+
+#include <QtGlobal>
+
+class KalmanVario
+{
+ public:
+
+  KalmanVario();
+
+  /** Forgets all measurements. */
+  void reset();
+
+  /**
+   * Sets the standard deviation in m/s² of the vertical acceleration, which
+   * is not covered by the acceleration input. If the GNSS altitude is the
+   * only measurement, the noise is raised, more with a higher GNSS rate.
+   */
+  void setAccelerationNoise( const double sigma )
+  {
+    m_accelNoise = sigma;
+  };
+
+  /**
+   * Sets the vertical acceleration in m/s², positive upwards. It is used
+   * until the next call of this method.
+   */
+  void setAcceleration( const double accel )
+  {
+    m_accel = accel;
+  };
+
+  /**
+   * Adds a barometric altitude in meters with its standard deviation.
+   */
+  void updateBaro( const qint64 time, const double altitude, const double sigma );
+
+  /**
+   * Adds a GNSS altitude in meters with its standard deviation.
+   */
+  void updateGnss( const qint64 time, const double altitude, const double sigma );
+
+  /** \return True, if the filter has got a measurement. */
+  bool isValid() const
+  {
+    return m_valid;
+  };
+
+  /** \return The barometric altitude in meters. */
+  double altitude() const
+  {
+    return m_x[Altitude];
+  };
+
+  /** \return The climb rate in m/s. */
+  double climb() const
+  {
+    return m_x[Climb];
+  };
+
+ private:
+
+  enum State { Altitude=0, Climb, Offset, States };
+
+  /** Advances the state to the passed time. */
+  void predict( const qint64 time );
+
+  /** \return The factor of the acceleration noise for the GNSS rate. */
+  double rateFactor( const qint64 time ) const;
+
+  /**
+   * Adds a measurement of the altitude plus offset * h2, h2 is 0 or 1.
+   */
+  void update( const qint64 time, const double z, const double sigma,
+               const double h2 );
+
+  bool   m_valid;
+  qint64 m_time;
+  double m_accel;
+  double m_accelNoise;
+
+  /** Time of the last baro and GNSS altitude */
+  qint64 m_baroTime;
+  qint64 m_gnssTime;
+
+  /** Running average of the GNSS interval in ms */
+  double m_gnssInterval;
+
+  /** state vector */
+  double m_x[States];
+
+  /** covariance matrix */
+  double m_p[States][States];
+};
@@ -0,0 +1,155 @@
+/***********************************************************************
+**
+**   LatencyTrace.cpp
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <algorithm>
+#include <cstring>
+
+#include <QtCore>
+
+#include "LatencyTrace.h"
+
+qint64  LatencyTrace::m_readTime = 0;
+uint    LatencyTrace::m_marked   = 0;
+quint32 LatencyTrace::m_samples[LatencyTrace::Stages][LatencyTrace::Window];
+quint32 LatencyTrace::m_count[LatencyTrace::Stages] = { 0 };
+qint64  LatencyTrace::m_lastLog  = 0;
+
+void LatencyTrace::begin( const qint64 readTime )
+{
+  log();
+
+  m_readTime = readTime;
+  m_marked   = 0;
+}
+
+void LatencyTrace::mark( const Stage stage )
+{
+  if( m_readTime == 0 || (m_marked & (1 << stage)) )
+    {
+      return;
+    }
+
+  if( stage == Painted && (m_marked & (1 << Positioned)) == 0 )
+    {
+      // A paint before the new position shows the old one.
+      return;
+    }
+
+  m_marked |= 1 << stage;
+
+  qint64 age = (now() - m_readTime) / 1000;
+
+  m_samples[stage][m_count[stage] % Window] = quint32( qBound( qint64(0), age,
+                                                               qint64(0xffffffff) ) );
+  m_count[stage]++;
+}
+
+LatencyTrace::Percentiles LatencyTrace::percentiles( const Stage stage )
+{
+  Percentiles pc;
+
+  int count = qMin( m_count[stage], quint32( Window ) );
+
+  pc.count = count;
+  pc.p50 = pc.p90 = pc.p99 = pc.max = 0;
+
+  if( count == 0 )
+    {
+      return pc;
+    }
+
+  quint32 sorted[Window];
+
+  memcpy( sorted, m_samples[stage], count * sizeof(quint32) );
+  std::sort( sorted, sorted + count );
+
+  pc.p50 = sorted[(count - 1) * 50 / 100];
+  pc.p90 = sorted[(count - 1) * 90 / 100];
+  pc.p99 = sorted[(count - 1) * 99 / 100];
+  pc.max = sorted[count - 1];
+  return pc;
+}
+
+const char* LatencyTrace::stageName( const Stage stage )
+{
+  switch( stage )
+    {
+      case Received:
+        return "Received";
+      case Parsed:
+        return "Parsed";
+      case Positioned:
+        return "Positioned";
+      case Calculated:
+        return "Calculated";
+      case Painted:
+        return "Painted";
+      default:
+        return "";
+    }
+}
+
+QString LatencyTrace::report()
+{
+  QString table = QString::asprintf( "%-10s %8s %8s %8s %8s %6s\n",
+                                     "Stage [ms]", "p50", "p90", "p99",
+                                     "max", "n" );
+
+  for( int i = 0; i < Stages; i++ )
+    {
+      Percentiles pc = percentiles( Stage(i) );
+
+      table += QString::asprintf( "%-10s %8.1f %8.1f %8.1f %8.1f %6d\n",
+                                  stageName( Stage(i) ),
+                                  pc.p50 / 1000.0, pc.p90 / 1000.0,
+                                  pc.p99 / 1000.0, pc.max / 1000.0,
+                                  pc.count );
+    }
+
+  return table;
+}
+
+void LatencyTrace::log()
+{
+  if( m_count[Received] == 0 )
+    {
+      return;
+    }
+
+  qint64 time = now();
+
+  if( m_lastLog == 0 )
+    {
+      // The first interval starts with the first sample.
+      m_lastLog = time;
+      return;
+    }
+
+  if( (time - m_lastLog) / 1000000 < LogInterval )
+    {
+      return;
+    }
+
+  m_lastLog = time;
+
+  QStringList lines = report().split( '\n', Qt::SkipEmptyParts );
+
+  qDebug() << "GPS fix latency:";
+
+  for( int i = 0; i < lines.size(); i++ )
+    {
+      qDebug() << "  " << lines.at(i).toLatin1().data();
+    }
+}
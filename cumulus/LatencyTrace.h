@@ -0,0 +1,128 @@
+/***********************************************************************
+**
+**   LatencyTrace.h
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+/**
+ * \class LatencyTrace
+ *
+ * \author Axel Pauli
+ *
+ * \brief Measures the age of a GPS fix along its processing stages.
+ *
+ * The gpsClient stamps every sentence with the monotonic clock at its read
+ * time. The stamp is passed through the shared memory ring to Cumulus. An
+ * epoch starts a new trace with the read time of its first sentence. Every
+ * stage, the fix passes, records the age of the fix once per trace, so that
+ * the age at the screen is the sum of all delays of the pipeline.
+ *
+ * The last samples of every stage are kept to calculate percentiles. They
+ * are shown in the GPS status dialog and logged once per minute.
+ *
+ * The class is used in the GUI thread only.
+ *
+ * \date 2026
+ *
+ * \version 1.0
+ */
+
+#pragma once
+
+#include <ctime>
+
+#include <QString>
+#include <QtGlobal>
+
+class LatencyTrace
+{
+ public:
+
+  /** Processing stages of a fix in their passing order. */
+  enum Stage
+  {
+    Received = 0, // taken over by GpsCon
+    Parsed,       // epoch is interpreted by GpsNmea
+    Positioned,   // position is passed to Map::slotPosition
+    Calculated,   // fix is processed by Calculator::slot_newFix
+    Painted,      // map is painted with the new position
+    Stages
+  };
+
+  /** Latency percentiles of a stage in micro seconds. */
+  struct Percentiles
+  {
+    int    count;
+    qint64 p50;
+    qint64 p90;
+    qint64 p99;
+    qint64 max;
+  };
+
+  /**
+   * \return The monotonic system time in nano seconds. The clock is the same
+   *         in all processes, so a stamp can be passed to another process.
+   */
+  static qint64 now()
+  {
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return qint64( ts.tv_sec ) * 1000000000 + ts.tv_nsec;
+  };
+
+  /**
+   * Starts the trace of a new fix. A read time of zero means unknown and
+   * disables the trace until the next call.
+   */
+  static void begin( const qint64 readTime );
+
+  /**
+   * Records the age of the traced fix at the passed stage. Every stage is
+   * recorded only once per trace, a paint only after the position stage.
+   */
+  static void mark( const Stage stage );
+
+  /** \return The percentiles over the last samples of the stage. */
+  static Percentiles percentiles( const Stage stage );
+
+  /** \return The name of the stage. */
+  static const char* stageName( const Stage stage );
+
+  /** \return A table with the percentiles of all stages in milli seconds. */
+  static QString report();
+
+ private:
+
+  enum Limits
+  {
+    Window      = 512,  // Number of samples per stage
+    LogInterval = 60000 // Log interval in milli seconds
+  };
+
+  /** Writes the percentiles into the log, if the log interval has expired. */
+  static void log();
+
+  /** Read time of the traced fix. */
+  static qint64 m_readTime;
+
+  /** Bit mask of the stages recorded for the current trace. */
+  static uint m_marked;
+
+  /** Last samples of every stage in micro seconds. */
+  static quint32 m_samples[Stages][Window];
+
+  /** Number of recorded samples of every stage. */
+  static quint32 m_count[Stages];
+
+  /** Time of the last log output. */
+  static qint64 m_lastLog;
+};
@@ -39,6 +39,7 @@
 
 #include "aboutwidget.h"
 #include "airfield.h"
+#include "AirspaceBenchmark.h"
 #include "calculator.h"
 #include "SettingsWidget.h"
 #include "generalconfig.h"
@@ -540,6 +541,9 @@ void MainWindow::slotCreateApplicationWidgets()
   connect( _globalMapContents, SIGNAL( mapDataReloaded(Map::mapLayer) ),
            Map::instance, SLOT( slotRedraw(Map::mapLayer) ) );
 
+  connect( _globalMapContents, SIGNAL( flarmAlertZonesChanged(const QRect&) ),
+           Map::instance, SLOT( slotRedrawAirspaces(const QRect&) ) );
+
   connect( _globalMapContents, SIGNAL( mapDataReloaded() ),
            viewAF, SLOT( slot_reloadList() ) );
   connect( _globalMapContents, SIGNAL( mapDataReloaded() ),
@@ -704,6 +708,12 @@ void MainWindow::slotCreateApplicationWidgets()
   connect( Flarm::instance(), SIGNAL( flarmAlertZoneInfo( FlarmBase::FlarmAlertZone& ) ),
            _globalMapContents, SLOT( slotNewFlarmAlertZoneData( FlarmBase::FlarmAlertZone& )) );
 
+  connect( Flarm::instance(), SIGNAL( flarmHotspotInfo( const ThermalDetector& ) ),
+           _globalMapContents, SLOT( slotNewFlarmHotspots( const ThermalDetector& )) );
+
+  connect( GpsNmea::gps, SIGNAL( newFix(const QDateTime&) ),
+           _globalMapContents, SLOT( slotCheckFlarmAlertZones() ) );
+
 #endif
 
   connect( viewMap, SIGNAL( toggleLDCalculation( const bool ) ),
@@ -967,6 +977,13 @@ void MainWindow::slotFinishStartUp()
         }
     }
 
+  if( AirspaceBenchmark::isRequested() )
+    {
+      // Run the synthetic airspace benchmark, it terminates Cumulus at its end.
+      AirspaceBenchmark* asb = new AirspaceBenchmark( this );
+      QTimer::singleShot( 0, asb, SLOT(slotRun()) );
+    }
+
   qDebug( "End startup Cumulus" );
 }
 
@@ -2528,6 +2545,11 @@ void MainWindow::slotReadconfig()
   // update menubar font size
   slotSetMenuFontSize();
 
+#ifdef FLARM
+  // A changed frame rate of the Flarm views is taken over without restart.
+  Flarm::instance()->getRepaintThrottle()->setFrameRate( conf->getFlarmFrameRate() );
+#endif
+
   actionViewReachpoints->setEnabled( conf->getNearestSiteCalculatorSwitch() );
 
  // Check, if reachable list is to show or not
@@ -0,0 +1,314 @@
+/***********************************************************************
+**
+**   NmeaLogger.cpp
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <QtCore>
+
+#include "LatencyTrace.h"
+#include "NmeaLogger.h"
+
+// Ring capacity, buffers some seconds of a stalled storage
+#define RING_SIZE (1 << 20)
+
+// Size of the block buffer
+#define BLOCK_SIZE (64 * 1024)
+
+// Maximum time in ms, the data stay in the block buffer
+#define WRITE_INTERVAL 5000
+
+NmeaLogger::NmeaLogger( QObject* parent, const QString& baseName,
+                        const bool compress, const qint64 maxSize ) :
+  QThread( parent ),
+  m_stop( false ),
+  m_baseName( baseName ),
+  m_compress( compress ),
+  m_maxSize( maxSize ),
+  m_startTime( LatencyTrace::now() ),
+  m_fileNo( 0 ),
+  m_fd( -1 ),
+  m_gz( 0 ),
+  m_fileSize( 0 ),
+  m_lastWrite( 0 )
+{
+  setObjectName( "NmeaLogger" );
+
+  m_ring.allocate( RING_SIZE );
+  m_buffer.reserve( BLOCK_SIZE + NmeaRing::MaxRecord );
+}
+
+NmeaLogger::~NmeaLogger()
+{
+  stop();
+}
+
+void NmeaLogger::log( const QString& sentence )
+{
+  if( m_filter.isEmpty() == false )
+    {
+      bool accepted = false;
+
+      for( int i = 0; i < m_filter.size(); i++ )
+        {
+          if( sentence.startsWith( m_filter.at(i) ) )
+            {
+              accepted = true;
+              break;
+            }
+        }
+
+      if( accepted == false )
+        {
+          return;
+        }
+    }
+
+  // The conversion to Latin-1 is done by the logger thread.
+  if( m_ring.write( reinterpret_cast<const char *>( sentence.utf16() ),
+                    sentence.size() * sizeof(ushort),
+                    LatencyTrace::now() ) == false )
+    {
+      return;
+    }
+
+  if( m_ring.takeWakeupRequest() == true )
+    {
+      m_wakeup.release();
+    }
+}
+
+void NmeaLogger::stop()
+{
+  if( isRunning() == false )
+    {
+      return;
+    }
+
+  m_stop = true;
+  m_wakeup.release();
+  wait();
+}
+
+void NmeaLogger::run()
+{
+  sigset_t sigset;
+  sigfillset( &sigset );
+
+  // deactivate all signals in this thread
+  pthread_sigmask( SIG_SETMASK, &sigset, 0 );
+
+  if( m_ring.isValid() == false || openFile() == false )
+    {
+      return;
+    }
+
+  m_lastWrite = LatencyTrace::now();
+
+  QByteArray record;
+  qint64 stamp;
+
+  while( true )
+    {
+      // The stop flag is taken before the ring is emptied, so nothing is
+      // lost, which was queued before the stop request.
+      bool stopRequest = m_stop;
+
+      while( m_ring.read( record, &stamp ) > 0 )
+        {
+          append( record, stamp );
+
+          if( m_buffer.size() >= BLOCK_SIZE )
+            {
+              writeBuffer();
+            }
+        }
+
+      if( stopRequest )
+        {
+          break;
+        }
+
+      if( m_buffer.size() > 0 &&
+          (LatencyTrace::now() - m_lastWrite) / 1000000 >= WRITE_INTERVAL )
+        {
+          writeBuffer();
+        }
+
+      if( m_ring.prepareWait() == true )
+        {
+          m_wakeup.tryAcquire( 1, WRITE_INTERVAL );
+        }
+    }
+
+  writeBuffer();
+  closeFile();
+
+  if( m_ring.dropped() > 0 )
+    {
+      qWarning() << "NmeaLogger:" << m_ring.dropped()
+                 << "sentences dropped, the storage was too slow";
+    }
+}
+
+bool NmeaLogger::openFile()
+{
+  QString fname = m_baseName;
+
+  if( m_fileNo > 0 )
+    {
+      fname += QString( "_%1" ).arg( m_fileNo );
+    }
+
+  fname += m_compress ? ".log.gz" : ".log";
+
+  QFileInfo fi( fname );
+
+  if( fi.exists() && fi.size() > 0 )
+    {
+      QFile::remove( fname + ".old" );
+      QFile::rename( fname, fname + ".old" );
+    }
+
+  QByteArray path = QFile::encodeName( fname );
+
+  m_fd = open( path.data(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+
+  if( m_fd == -1 )
+    {
+      qWarning() << "NmeaLogger: Cannot open file" << fname << strerror(errno);
+      return false;
+    }
+
+  if( m_compress )
+    {
+      // The gzip stream takes over the descriptor.
+      m_gz = gzdopen( m_fd, "wb6" );
+
+      if( m_gz == 0 )
+        {
+          qWarning() << "NmeaLogger: Cannot compress file" << fname;
+          ::close( m_fd );
+          m_fd = -1;
+          return false;
+        }
+
+      gzbuffer( m_gz, BLOCK_SIZE );
+    }
+
+  m_fileSize = 0;
+  m_fileNo++;
+  return true;
+}
+
+void NmeaLogger::closeFile()
+{
+  if( m_gz != 0 )
+    {
+      gzclose( m_gz );
+      m_gz = 0;
+      m_fd = -1;
+    }
+
+  if( m_fd != -1 )
+    {
+      ::close( m_fd );
+      m_fd = -1;
+    }
+}
+
+void NmeaLogger::append( const QByteArray& record, const qint64 stamp )
+{
+  const ushort* chars = reinterpret_cast<const ushort *>( record.constData() );
+  int length = record.size() / sizeof(ushort);
+
+  // The line end is written by the logger.
+  while( length > 0 && (chars[length - 1] == '\r' || chars[length - 1] == '\n') )
+    {
+      length--;
+    }
+
+  char time[24];
+  int timeLength = snprintf( time, sizeof(time), "%lld ",
+                             (long long) ((stamp - m_startTime) / 1000000) );
+
+  m_buffer.append( time, timeLength );
+
+  for( int i = 0; i < length; i++ )
+    {
+      m_buffer.append( chars[i] < 256 ? char( chars[i] ) : '?' );
+    }
+
+  m_buffer.append( '\n' );
+}
+
+void NmeaLogger::writeBuffer()
+{
+  m_lastWrite = LatencyTrace::now();
+
+  if( m_buffer.isEmpty() || (m_fd == -1 && m_gz == 0) )
+    {
+      m_buffer.resize( 0 );
+      return;
+    }
+
+  if( m_gz != 0 )
+    {
+      if( gzwrite( m_gz, m_buffer.constData(), m_buffer.size() ) <= 0 )
+        {
+          qWarning() << "NmeaLogger: gzwrite failed";
+        }
+
+      // Makes the written data readable after a crash.
+      gzflush( m_gz, Z_SYNC_FLUSH );
+    }
+  else
+    {
+      const char* data = m_buffer.constData();
+      int left = m_buffer.size();
+
+      while( left > 0 )
+        {
+          ssize_t done = ::write( m_fd, data, left );
+
+          if( done < 0 )
+            {
+              if( errno == EINTR )
+                {
+                  continue;
+                }
+
+              qWarning() << "NmeaLogger: write failed" << strerror(errno);
+              break;
+            }
+
+          data += done;
+          left -= done;
+        }
+    }
+
+  m_fileSize += m_buffer.size();
+  m_buffer.resize( 0 );
+
+  if( m_maxSize > 0 && m_fileSize >= m_maxSize )
+    {
+      // Continue the log session in the next file.
+      closeFile();
+      openFile();
+    }
+}
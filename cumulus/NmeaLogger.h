@@ -0,0 +1,141 @@
+/***********************************************************************
+**
+**   NmeaLogger.h
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+/**
+ * \class NmeaLogger
+ *
+ * \author Axel Pauli
+ *
+ * \brief Writes the received NMEA sentences into a log file.
+ *
+ * The GUI thread only copies a sentence into a lock free ring. A logger
+ * thread takes the sentences out of the ring, collects them in a block
+ * buffer and writes the buffer, if it is full or after a flush interval.
+ * So a slow SD card does not stall the GUI thread.
+ *
+ * Every line starts with the monotonic time in milli seconds since the start
+ * of the log session, followed by a space and the sentence. The file can be
+ * gzip compressed. If a file has reached its maximum size, the next file of
+ * the session is opened.
+ *
+ * A filter restricts the log to some sentences, e.g. to the Flarm sentences
+ * for a compact recording of the traffic. Such a log can be replayed by the
+ * NMEA simulator.
+ *
+ * \date 2026
+ *
+ * \version 1.0
+ */
+
+#pragma once
+
+#include <atomic>
+
+#include <QByteArray>
+#include <QSemaphore>
+#include <QStringList>
+#include <QString>
+#include <QThread>
+
+#include <zlib.h>
+
+#include "NmeaRing.h"
+
+class NmeaLogger : public QThread
+{
+  Q_OBJECT
+
+ private:
+
+  Q_DISABLE_COPY ( NmeaLogger )
+
+ public:
+
+  /**
+   * \param parent   Parent object.
+   * \param baseName Path of the log files without extension.
+   * \param compress Compress the log files with gzip.
+   * \param maxSize  Maximum size of the uncompressed data of a file in bytes.
+   */
+  NmeaLogger( QObject* parent, const QString& baseName,
+              const bool compress, const qint64 maxSize );
+
+  virtual ~NmeaLogger();
+
+  /**
+   * Restricts the log to the sentences, which start with one of the passed
+   * prefixes. An empty list logs all sentences. Must be set before the start.
+   */
+  void setFilter( const QStringList& prefixes )
+  {
+    m_filter = prefixes;
+  };
+
+  /**
+   * Queues a sentence for the log file. Called by the GUI thread only, it
+   * does not block.
+   */
+  void log( const QString& sentence );
+
+  /**
+   * Writes all queued sentences, closes the log file and ends the thread.
+   */
+  void stop();
+
+ protected:
+
+  void run();
+
+ private:
+
+  /** Opens the next file of the log session. */
+  bool openFile();
+
+  void closeFile();
+
+  /** Appends a record of the ring as log line to the block buffer. */
+  void append( const QByteArray& record, const qint64 stamp );
+
+  /** Writes the block buffer into the log file. */
+  void writeBuffer();
+
+  NmeaRing   m_ring;
+  QSemaphore m_wakeup;
+
+  std::atomic<bool> m_stop;
+
+  QStringList m_filter;
+
+  QString m_baseName;
+  bool    m_compress;
+  qint64  m_maxSize;
+
+  /** Monotonic start time of the log session in ns */
+  qint64  m_startTime;
+
+  /** Number of the current file in the log session */
+  int     m_fileNo;
+
+  int     m_fd;
+  gzFile  m_gz;
+
+  /** Uncompressed bytes written into the current file */
+  qint64  m_fileSize;
+
+  QByteArray m_buffer;
+
+  /** Monotonic time of the last write in ns */
+  qint64  m_lastWrite;
+};
@@ -0,0 +1,353 @@
+/***********************************************************************
+**
+**   NmeaRing.cpp
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <QtCore>
+
+#include "NmeaRing.h"
+
+// "NMR2", record with stamp
+#define RING_MAGIC 0x4e4d5232
+
+// Record header: 16 bit length and 64 bit stamp
+#define RECORD_HEADER (sizeof(quint16) + sizeof(qint64))
+
+NmeaRing::NmeaRing() :
+  m_header(0),
+  m_data(0),
+  m_mask(0),
+  m_mapSize(0),
+  m_owner(false)
+{
+}
+
+NmeaRing::~NmeaRing()
+{
+  close();
+}
+
+bool NmeaRing::create( const QString& name, const uint capacity )
+{
+  close();
+
+  if( capacity < 1024 || (capacity & (capacity - 1)) != 0 )
+    {
+      qWarning() << "NmeaRing::create(): capacity" << capacity
+                 << "is not a power of two";
+      return false;
+    }
+
+  QByteArray shmName = name.toLatin1();
+
+  // Remove a left over of a crashed session.
+  shm_unlink( shmName.data() );
+
+  int fd = shm_open( shmName.data(), O_RDWR | O_CREAT | O_EXCL, 0600 );
+
+  if( fd == -1 )
+    {
+      qWarning() << "NmeaRing::create(): shm_open" << name
+                 << "failed:" << strerror(errno);
+      return false;
+    }
+
+  if( ftruncate( fd, sizeof(Header) + capacity ) == -1 ||
+      map( fd, capacity ) == false )
+    {
+      qWarning() << "NmeaRing::create(): mapping" << name
+                 << "failed:" << strerror(errno);
+      ::close( fd );
+      shm_unlink( shmName.data() );
+      return false;
+    }
+
+  ::close( fd );
+
+  init( capacity );
+
+  m_owner = true;
+  m_name  = name;
+  return true;
+}
+
+bool NmeaRing::allocate( const uint capacity )
+{
+  close();
+
+  if( capacity < 1024 || (capacity & (capacity - 1)) != 0 )
+    {
+      qWarning() << "NmeaRing::allocate(): capacity" << capacity
+                 << "is not a power of two";
+      return false;
+    }
+
+  if( map( -1, capacity ) == false )
+    {
+      qWarning() << "NmeaRing::allocate(): mapping failed:" << strerror(errno);
+      return false;
+    }
+
+  init( capacity );
+
+  m_owner = true;
+  return true;
+}
+
+void NmeaRing::init( const uint capacity )
+{
+  m_header->capacity = capacity;
+  m_header->head.store( 0 );
+  m_header->tail.store( 0 );
+  m_header->waiting.store( 1 );
+  m_header->dropped.store( 0 );
+  m_header->magic = RING_MAGIC;
+}
+
+bool NmeaRing::attach( const QString& name )
+{
+  close();
+
+  int fd = shm_open( name.toLatin1().data(), O_RDWR, 0 );
+
+  if( fd == -1 )
+    {
+      qWarning() << "NmeaRing::attach(): shm_open" << name
+                 << "failed:" << strerror(errno);
+      return false;
+    }
+
+  struct stat st;
+
+  if( fstat( fd, &st ) == -1 || st.st_size <= (off_t) sizeof(Header) )
+    {
+      ::close( fd );
+      return false;
+    }
+
+  uint capacity = st.st_size - sizeof(Header);
+
+  bool ok = map( fd, capacity );
+
+  ::close( fd );
+
+  if( ok == false )
+    {
+      return false;
+    }
+
+  if( m_header->magic != RING_MAGIC || m_header->capacity != capacity )
+    {
+      qWarning() << "NmeaRing::attach():" << name << "is no NMEA ring";
+      close();
+      return false;
+    }
+
+  m_name = name;
+  return true;
+}
+
+bool NmeaRing::map( const int fd, const uint capacity )
+{
+  size_t size = sizeof(Header) + capacity;
+
+  // Without a file descriptor the ring is private to the process.
+  int flags = (fd == -1) ? (MAP_PRIVATE | MAP_ANONYMOUS) : MAP_SHARED;
+
+  void* addr = mmap( 0, size, PROT_READ | PROT_WRITE, flags, fd, 0 );
+
+  if( addr == MAP_FAILED )
+    {
+      return false;
+    }
+
+  m_header  = static_cast<Header *>( addr );
+  m_data    = static_cast<char *>( addr ) + sizeof(Header);
+  m_mask    = capacity - 1;
+  m_mapSize = size;
+  return true;
+}
+
+void NmeaRing::close()
+{
+  if( m_header != 0 )
+    {
+      munmap( m_header, m_mapSize );
+    }
+
+  if( m_owner && m_name.isEmpty() == false )
+    {
+      shm_unlink( m_name.toLatin1().data() );
+    }
+
+  m_header  = 0;
+  m_data    = 0;
+  m_mask    = 0;
+  m_mapSize = 0;
+  m_owner   = false;
+  m_name.clear();
+}
+
+void NmeaRing::reset()
+{
+  if( m_header == 0 )
+    {
+      return;
+    }
+
+  m_header->head.store( 0 );
+  m_header->tail.store( 0 );
+  m_header->waiting.store( 1 );
+  m_header->dropped.store( 0 );
+}
+
+void NmeaRing::copyIn( const quint32 pos, const char* src, const uint length )
+{
+  uint start = pos & m_mask;
+  uint first = qMin( length, m_mask + 1 - start );
+
+  memcpy( m_data + start, src, first );
+
+  if( first < length )
+    {
+      memcpy( m_data, src + first, length - first );
+    }
+}
+
+void NmeaRing::copyOut( const quint32 pos, char* dst, const uint length ) const
+{
+  uint start = pos & m_mask;
+  uint first = qMin( length, m_mask + 1 - start );
+
+  memcpy( dst, m_data + start, first );
+
+  if( first < length )
+    {
+      memcpy( dst + first, m_data, length - first );
+    }
+}
+
+bool NmeaRing::write( const char* data, const int length, const qint64 stamp )
+{
+  if( m_header == 0 || length <= 0 || length > MaxRecord )
+    {
+      return false;
+    }
+
+  // The positions are running counters, the ring index is masked.
+  quint32 head = m_header->head.load( std::memory_order_relaxed );
+  quint32 tail = m_header->tail.load( std::memory_order_acquire );
+
+  quint32 needed = RECORD_HEADER + length;
+
+  if( (m_mask + 1) - (head - tail) < needed )
+    {
+      m_header->dropped.fetch_add( 1, std::memory_order_relaxed );
+      return false;
+    }
+
+  quint16 len = length;
+
+  copyIn( head, (const char *) &len, sizeof(len) );
+  copyIn( head + sizeof(len), (const char *) &stamp, sizeof(stamp) );
+  copyIn( head + RECORD_HEADER, data, length );
+
+  // Publish the record to the reader.
+  m_header->head.store( head + needed, std::memory_order_release );
+  return true;
+}
+
+bool NmeaRing::takeWakeupRequest()
+{
+  if( m_header == 0 )
+    {
+      return false;
+    }
+
+  // Orders the published head before the flag check, pairs with prepareWait.
+  std::atomic_thread_fence( std::memory_order_seq_cst );
+
+  return m_header->waiting.exchange( 0 ) != 0;
+}
+
+int NmeaRing::read( QByteArray& record, qint64* stamp )
+{
+  if( m_header == 0 )
+    {
+      return 0;
+    }
+
+  quint32 tail = m_header->tail.load( std::memory_order_relaxed );
+  quint32 head = m_header->head.load( std::memory_order_acquire );
+
+  if( head == tail )
+    {
+      return 0;
+    }
+
+  quint16 len = 0;
+
+  copyOut( tail, (char *) &len, sizeof(len) );
+
+  if( len == 0 || len > MaxRecord || head - tail < RECORD_HEADER + len )
+    {
+      // Corrupted ring, drop its content.
+      qWarning() << "NmeaRing::read(): invalid record length" << len;
+      m_header->tail.store( head, std::memory_order_release );
+      return 0;
+    }
+
+  if( stamp != 0 )
+    {
+      copyOut( tail + sizeof(len), (char *) stamp, sizeof(qint64) );
+    }
+
+  record.resize( len );
+  copyOut( tail + RECORD_HEADER, record.data(), len );
+
+  // Release the space to the writer.
+  m_header->tail.store( tail + RECORD_HEADER + len, std::memory_order_release );
+  return len;
+}
+
+bool NmeaRing::prepareWait()
+{
+  if( m_header == 0 )
+    {
+      return true;
+    }
+
+  m_header->waiting.store( 1 );
+
+  // Data written before the writer has seen the flag would be lost without
+  // this check.
+  if( m_header->head.load() != m_header->tail.load( std::memory_order_relaxed ) )
+    {
+      m_header->waiting.store( 0 );
+      return false;
+    }
+
+  return true;
+}
+
+uint NmeaRing::dropped() const
+{
+  return m_header ? m_header->dropped.load( std::memory_order_relaxed ) : 0;
+}
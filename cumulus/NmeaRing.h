@@ -0,0 +1,179 @@
+/***********************************************************************
+**
+**   NmeaRing.h
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+/**
+ * \class NmeaRing
+ *
+ * \author Axel Pauli
+ *
+ * \brief Lock free shared memory ring for the GPS data transfer.
+ *
+ * The ring transports the NMEA sentences from the gpsClient process to the
+ * Cumulus process. It has exactly one writer, the gpsClient, and one reader,
+ * the Cumulus process. The head is only changed by the writer, the tail only
+ * by the reader, so no lock is necessary.
+ *
+ * The Cumulus process creates the ring as POSIX shared memory object and
+ * passes its name to the gpsClient via the command channel. The sockets
+ * remain in use for all control messages.
+ *
+ * To avoid a socket message per sentence, the reader sets a waiting flag
+ * before it goes to sleep. The writer sends a single wake up message via the
+ * forward channel only, if it finds that flag set after writing.
+ *
+ * The ring can also be allocated in private memory to pass data between two
+ * threads of one process.
+ *
+ * Every record consists of a 16 bit length and a 64 bit stamp followed by
+ * the sentence bytes. The stamp contains the monotonic read time of the
+ * sentence. Records can wrap around the ring end.
+ *
+ * \date 2026
+ *
+ * \version 1.0
+ */
+
+#pragma once
+
+#include <atomic>
+
+#include <QByteArray>
+#include <QString>
+
+class NmeaRing
+{
+ public:
+
+  enum Limits
+  {
+    DefaultCapacity = 65536, // Must be a power of two
+    MaxRecord       = 1024   // Longer sentences are dropped
+  };
+
+  NmeaRing();
+
+  virtual ~NmeaRing();
+
+  /**
+   * Creates the shared memory object with the passed name and maps it. Used
+   * by the reader side. An existing object with the same name is replaced.
+   *
+   * \return true in case of success otherwise false.
+   */
+  bool create( const QString& name, const uint capacity=DefaultCapacity );
+
+  /**
+   * Allocates a ring in private memory. Used, if writer and reader are
+   * threads of the same process.
+   *
+   * \return true in case of success otherwise false.
+   */
+  bool allocate( const uint capacity=DefaultCapacity );
+
+  /**
+   * Maps an existing shared memory object. Used by the writer side.
+   *
+   * \return true in case of success otherwise false.
+   */
+  bool attach( const QString& name );
+
+  /**
+   * Unmaps the ring. The owner removes the shared memory object too.
+   */
+  void close();
+
+  /**
+   * Empties the ring. Must only be called, if no writer is attached.
+   */
+  void reset();
+
+  bool isValid() const
+  {
+    return m_header != 0;
+  };
+
+  /** \return The name of the shared memory object. */
+  const QString& name() const
+  {
+    return m_name;
+  };
+
+  /**
+   * Appends a record to the ring.
+   *
+   * \return false, if the ring is full or the record is too long. The record
+   *         is dropped in this case.
+   */
+  bool write( const char* data, const int length, const qint64 stamp=0 );
+
+  /**
+   * Writer side: Checks, if the reader waits for a wake up. The flag is
+   * cleared by this call.
+   */
+  bool takeWakeupRequest();
+
+  /**
+   * Reads the next record into the passed buffer. The stamp of the record is
+   * returned in stamp, if it is not null.
+   *
+   * \return The length of the record or 0, if the ring is empty.
+   */
+  int read( QByteArray& record, qint64* stamp=0 );
+
+  /**
+   * Reader side: Announces, that the reader goes to sleep.
+   *
+   * \return false, if data arrived in the meantime. In this case the waiting
+   *         flag is withdrawn and the reader must read again.
+   */
+  bool prepareWait();
+
+  /** \return The number of records dropped by the writer. */
+  uint dropped() const;
+
+ private:
+
+  /** Memory layout at the begin of the shared memory object. */
+  struct Header
+  {
+    quint32 magic;
+    quint32 capacity;
+    std::atomic<quint32> head;    // written by the writer
+    std::atomic<quint32> tail;    // written by the reader
+    std::atomic<quint32> waiting; // reader waits for a wake up
+    std::atomic<quint32> dropped;
+  };
+
+  static_assert( ATOMIC_INT_LOCK_FREE == 2,
+                 "Shared memory needs lock free atomics" );
+
+  /** Maps the ring, a fd of -1 maps private memory. */
+  bool map( const int fd, const uint capacity );
+
+  /** Initializes the header of a new ring. */
+  void init( const uint capacity );
+
+  /** Copies to or from the ring, considering the wrap around. */
+  void copyIn( const quint32 pos, const char* src, const uint length );
+
+  void copyOut( const quint32 pos, char* dst, const uint length ) const;
+
+  Header* m_header;
+  char*   m_data;
+  uint    m_mask;
+  size_t  m_mapSize;
+  bool    m_owner;
+  QString m_name;
+};
@@ -0,0 +1,383 @@
+/***********************************************************************
+**
+**   NmeaSentence.cpp
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include "NmeaSentence.h"
+
+// Powers of ten used by the number parser.
+static const double pow10Table[] =
+{
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static double powerOfTen( int exp )
+{
+  double result = 1.0;
+
+  bool negative = exp < 0;
+
+  if( negative )
+    {
+      exp = -exp;
+    }
+
+  while( exp > 22 )
+    {
+      result *= 1e22;
+      exp -= 22;
+    }
+
+  result *= pow10Table[exp];
+
+  return negative ? 1.0 / result : result;
+}
+
+bool NmeaField::startsWith( const QString& prefix ) const
+{
+  if( prefix.size() > m_size )
+    {
+      return false;
+    }
+
+  const QChar* p = prefix.constData();
+
+  for( int i = 0; i < prefix.size(); i++ )
+    {
+      if( p[i].unicode() != uchar( m_data[i] ) )
+        {
+          return false;
+        }
+    }
+
+  return true;
+}
+
+int NmeaField::toInt( bool* ok ) const
+{
+  int i = 0;
+  int end = m_size;
+
+  // Ignore leading and trailing blanks.
+  while( i < end && m_data[i] == ' ' ) i++;
+  while( end > i && m_data[end-1] == ' ' ) end--;
+
+  bool negative = false;
+
+  if( i < end && ( m_data[i] == '-' || m_data[i] == '+' ) )
+    {
+      negative = m_data[i] == '-';
+      i++;
+    }
+
+  if( i == end )
+    {
+      if( ok ) *ok = false;
+      return 0;
+    }
+
+  qint64 value = 0;
+
+  for( ; i < end; i++ )
+    {
+      char c = m_data[i];
+
+      if( c < '0' || c > '9' || value > 0x7fffffffLL )
+        {
+          if( ok ) *ok = false;
+          return 0;
+        }
+
+      value = value * 10 + (c - '0');
+    }
+
+  if( negative )
+    {
+      value = -value;
+    }
+
+  if( value > 0x7fffffffLL || value < -0x80000000LL )
+    {
+      if( ok ) *ok = false;
+      return 0;
+    }
+
+  if( ok ) *ok = true;
+
+  return int( value );
+}
+
+uint NmeaField::toHex( bool* ok ) const
+{
+  int i = 0;
+  int end = m_size;
+
+  // Ignore leading and trailing blanks.
+  while( i < end && m_data[i] == ' ' ) i++;
+  while( end > i && m_data[end-1] == ' ' ) end--;
+
+  if( i == end || end - i > 8 )
+    {
+      if( ok ) *ok = false;
+      return 0;
+    }
+
+  uint value = 0;
+
+  for( ; i < end; i++ )
+    {
+      char c = m_data[i];
+      uint digit;
+
+      if( c >= '0' && c <= '9' )
+        {
+          digit = c - '0';
+        }
+      else if( c >= 'A' && c <= 'F' )
+        {
+          digit = c - 'A' + 10;
+        }
+      else if( c >= 'a' && c <= 'f' )
+        {
+          digit = c - 'a' + 10;
+        }
+      else
+        {
+          if( ok ) *ok = false;
+          return 0;
+        }
+
+      value = (value << 4) | digit;
+    }
+
+  if( ok ) *ok = true;
+
+  return value;
+}
+
+double NmeaField::toDouble( bool* ok ) const
+{
+  int i = 0;
+  int end = m_size;
+
+  // Ignore leading and trailing blanks.
+  while( i < end && m_data[i] == ' ' ) i++;
+  while( end > i && m_data[end-1] == ' ' ) end--;
+
+  bool negative = false;
+
+  if( i < end && ( m_data[i] == '-' || m_data[i] == '+' ) )
+    {
+      negative = m_data[i] == '-';
+      i++;
+    }
+
+  // The mantissa is collected as integer, to get the same rounding as the
+  // standard conversion for the usual NMEA precision.
+  quint64 mantissa = 0;
+  int scale = 0;
+  int digits = 0;
+  bool dot = false;
+
+  for( ; i < end; i++ )
+    {
+      char c = m_data[i];
+
+      if( c >= '0' && c <= '9' )
+        {
+          if( mantissa < 100000000000000000ULL )
+            {
+              mantissa = mantissa * 10 + (c - '0');
+
+              if( dot )
+                {
+                  scale--;
+                }
+            }
+          else if( ! dot )
+            {
+              // Too many digits, ignore them but keep the magnitude.
+              scale++;
+            }
+
+          digits++;
+          continue;
+        }
+
+      if( c == '.' && dot == false )
+        {
+          dot = true;
+          continue;
+        }
+
+      break;
+    }
+
+  if( digits == 0 )
+    {
+      if( ok ) *ok = false;
+      return 0.0;
+    }
+
+  if( i < end && ( m_data[i] == 'e' || m_data[i] == 'E' ) )
+    {
+      NmeaField exp( m_data + i + 1, end - i - 1 );
+      bool expOk;
+      int e = exp.toInt( &expOk );
+
+      if( expOk == false )
+        {
+          if( ok ) *ok = false;
+          return 0.0;
+        }
+
+      scale += e;
+      i = end;
+    }
+
+  if( i != end )
+    {
+      if( ok ) *ok = false;
+      return 0.0;
+    }
+
+  double value = double( mantissa );
+
+  if( scale < 0 )
+    {
+      // Division gives a correctly rounded result for exact mantissas.
+      value /= powerOfTen( -scale );
+    }
+  else if( scale > 0 )
+    {
+      value *= powerOfTen( scale );
+    }
+
+  if( ok ) *ok = true;
+
+  return negative ? -value : value;
+}
+
+NmeaSentence::NmeaSentence() :
+  m_count(0)
+{
+  m_buffer[0] = '\0';
+  m_start[0] = 0;
+}
+
+bool NmeaSentence::parse( const char* sentence, const int length )
+{
+  m_count = 0;
+
+  if( sentence == 0 || length <= 0 || length > MaxLength )
+    {
+      return false;
+    }
+
+  memcpy( m_buffer, sentence, length );
+
+  return tokenize( length );
+}
+
+bool NmeaSentence::parse( const QString& sentence )
+{
+  m_count = 0;
+
+  const int length = sentence.size();
+
+  if( length == 0 || length > MaxLength )
+    {
+      return false;
+    }
+
+  const QChar* p = sentence.constData();
+
+  for( int i = 0; i < length; i++ )
+    {
+      ushort c = p[i].unicode();
+      m_buffer[i] = ( c < 256 ) ? char( c ) : '?';
+    }
+
+  return tokenize( length );
+}
+
+bool NmeaSentence::tokenize( const int length )
+{
+  int end = length;
+
+  // Remove the checksum *hh<CR><LF>. It was already checked by the receiver.
+  for( int i = end - 1; i >= 0; i-- )
+    {
+      if( m_buffer[i] == '*' )
+        {
+          end = i;
+          break;
+        }
+    }
+
+  // Remove line end characters, if no checksum was present.
+  while( end > 0 && ( m_buffer[end-1] == '\n' || m_buffer[end-1] == '\r' ) )
+    {
+      end--;
+    }
+
+  if( end == 0 )
+    {
+      return false;
+    }
+
+  m_buffer[end] = '\0';
+
+  m_count = 1;
+  m_start[0] = 0;
+
+  for( int i = 0; i < end; i++ )
+    {
+      if( m_buffer[i] == ',' && m_count < MaxFields )
+        {
+          m_start[m_count++] = i + 1;
+        }
+    }
+
+  // End marker behind the last field, the terminating null replaces the
+  // comma.
+  m_start[m_count] = end + 1;
+
+  return true;
+}
+
+quint64 NmeaSentence::idKey( const NmeaField& id )
+{
+  quint64 key = 0;
+
+  for( int i = 0; i < id.size() && i < 8; i++ )
+    {
+      key = (key << 8) | uchar( id.data()[i] );
+    }
+
+  return key;
+}
+
+QStringList NmeaSentence::toStringList() const
+{
+  QStringList list;
+  list.reserve( m_count );
+
+  for( int i = 0; i < m_count; i++ )
+    {
+      list.append( field(i).toString() );
+    }
+
+  return list;
+}
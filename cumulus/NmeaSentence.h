@@ -0,0 +1,225 @@
+/***********************************************************************
+**
+**   NmeaSentence.h
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+/**
+ * \class NmeaSentence
+ *
+ * \author Axel Pauli
+ *
+ * \brief Allocation free NMEA sentence tokenizer.
+ *
+ * The sentence is copied into an internal byte buffer of fixed size and
+ * split at the commas. The checksum part is removed. The single fields are
+ * accessed as \ref NmeaField, which references the buffer without copying.
+ * Numbers are parsed directly from the buffer.
+ *
+ * One object should be reused for all sentences, then no memory is allocated
+ * during parsing.
+ *
+ * \date 2026
+ *
+ * \version 1.0
+ */
+
+#pragma once
+
+#include <cstring>
+
+#include <QString>
+#include <QStringList>
+
+/**
+ * \class NmeaField
+ *
+ * \brief Reference to a single field of a \ref NmeaSentence.
+ *
+ * The field is only valid as long as the sentence is not changed.
+ */
+class NmeaField
+{
+ public:
+
+  NmeaField() : m_data(""), m_size(0) {};
+
+  NmeaField( const char* data, const int size ) : m_data(data), m_size(size) {};
+
+  const char* data() const
+  {
+    return m_data;
+  };
+
+  int size() const
+  {
+    return m_size;
+  };
+
+  bool isEmpty() const
+  {
+    return m_size == 0;
+  };
+
+  char at( const int i ) const
+  {
+    return ( i >= 0 && i < m_size ) ? m_data[i] : '\0';
+  };
+
+  /**
+   * \return The part of the field starting at pos with up to n characters,
+   * like QString::mid. A negative n returns the rest of the field.
+   */
+  NmeaField mid( const int pos, const int n=-1 ) const
+  {
+    if( pos < 0 || pos >= m_size )
+      {
+        return NmeaField();
+      }
+
+    const int rest = m_size - pos;
+
+    return NmeaField( m_data + pos, ( n < 0 || n > rest ) ? rest : n );
+  };
+
+  bool operator==( const char* other ) const
+  {
+    return strlen( other ) == size_t( m_size ) &&
+           memcmp( m_data, other, m_size ) == 0;
+  };
+
+  bool operator!=( const char* other ) const
+  {
+    return ! operator==( other );
+  };
+
+  /** \return true, if the field starts with the passed Latin1 string. */
+  bool startsWith( const QString& prefix ) const;
+
+  /** \return true, if the field contains the passed character. */
+  bool contains( const char c ) const
+  {
+    return m_size > 0 && memchr( m_data, c, m_size ) != 0;
+  };
+
+  /**
+   * Parses the field as decimal integer. Leading and trailing blanks are
+   * ignored like in QString::toInt.
+   */
+  int toInt( bool* ok=0 ) const;
+
+  /**
+   * Parses the field as hexadecimal number with up to eight digits, like
+   * a Flarm ID.
+   */
+  uint toHex( bool* ok=0 ) const;
+
+  /**
+   * Parses the field as floating point number with an optional exponent.
+   */
+  double toDouble( bool* ok=0 ) const;
+
+  /** \return A copy of the field as string. */
+  QString toString() const
+  {
+    return QString::fromLatin1( m_data, m_size );
+  };
+
+ private:
+
+  const char* m_data;
+  int m_size;
+};
+
+class NmeaSentence
+{
+ public:
+
+  enum Limits
+  {
+    MaxLength = 511, // Longer sentences are rejected
+    MaxFields = 48   // Additional fields are appended to the last one
+  };
+
+  NmeaSentence();
+
+  /**
+   * Tokenizes the passed sentence. A trailing checksum *hh and line end
+   * characters are removed.
+   *
+   * \return true in case of success, false if the sentence is empty or too
+   *         long.
+   */
+  bool parse( const char* sentence, const int length );
+
+  /** Tokenizes a Latin1 sentence without creating a temporary byte array. */
+  bool parse( const QString& sentence );
+
+  /** \return The number of fields including the identifier. */
+  int size() const
+  {
+    return m_count;
+  };
+
+  /** \return The field at the passed index or an empty field. */
+  NmeaField field( const int i ) const
+  {
+    if( i < 0 || i >= m_count )
+      {
+        return NmeaField();
+      }
+
+    return NmeaField( m_buffer + m_start[i], m_start[i+1] - m_start[i] - 1 );
+  };
+
+  NmeaField operator[]( const int i ) const
+  {
+    return field( i );
+  };
+
+  /** \return The sentence identifier, e.g. $GPRMC. */
+  NmeaField id() const
+  {
+    return field( 0 );
+  };
+
+  /**
+   * \return The identifier packed into an integer, usable as key for the
+   * identifier without string allocation. Only the first 8 characters are
+   * considered.
+   */
+  quint64 idKey() const
+  {
+    return idKey( id() );
+  };
+
+  /** \return The passed identifier packed like idKey() does it. */
+  static quint64 idKey( const NmeaField& id );
+
+  /**
+   * \return All fields as string list, like QString::split would deliver it.
+   * Used for the decoders, which are not converted yet.
+   */
+  QStringList toStringList() const;
+
+ private:
+
+  /** Splits the buffer content at the commas. */
+  bool tokenize( const int length );
+
+  char m_buffer[MaxLength + 1];
+
+  /** Start offsets of the fields, the last entry marks the end. */
+  int m_start[MaxFields + 1];
+
+  int m_count;
+};
@@ -0,0 +1,66 @@
+/***********************************************************************
+**
+**   RepaintThrottle.cpp
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <QtCore>
+
+#include "RepaintThrottle.h"
+
+// Limits of the frame rate per second
+#define MIN_FRAME_RATE 1
+#define MAX_FRAME_RATE 25
+
+RepaintThrottle::RepaintThrottle( QObject* parent, const int frameRate ) :
+  QObject( parent ),
+  m_interval( 0 )
+{
+  m_timer = new QTimer( this );
+  m_timer->setSingleShot( true );
+  connect( m_timer, SIGNAL(timeout()), this, SLOT(slot_Timeout()) );
+
+  setFrameRate( frameRate );
+}
+
+RepaintThrottle::~RepaintThrottle()
+{
+}
+
+void RepaintThrottle::setFrameRate( const int frameRate )
+{
+  m_interval = 1000 / qBound( MIN_FRAME_RATE, frameRate, MAX_FRAME_RATE );
+}
+
+void RepaintThrottle::slot_Request()
+{
+  if( m_timer->isActive() )
+    {
+      // A frame is already pending, it takes this request too.
+      return;
+    }
+
+  qint64 wait = 0;
+
+  if( m_lastFrame.isValid() )
+    {
+      wait = qMax( qint64(0), m_interval - m_lastFrame.elapsed() );
+    }
+
+  m_timer->start( static_cast<int> (wait) );
+}
+
+void RepaintThrottle::slot_Timeout()
+{
+  m_lastFrame.start();
+  emit frame();
+}
@@ -0,0 +1,92 @@
+/***********************************************************************
+**
+**   RepaintThrottle.h
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+/**
+ * \class RepaintThrottle
+ *
+ * \author Axel Pauli
+ *
+ * \brief Coalesces the update requests of several views into frames.
+ *
+ * Data sources and views request a frame, when something has changed or a
+ * view wants to show the next step of an animation. All requests until the
+ * next frame are coalesced, the frames are emitted not more often than the
+ * frame rate allows. A frame is never emitted in the call of a request but
+ * from the event loop, so a burst of requests costs only one frame.
+ *
+ * \date 2026
+ *
+ * \version 1.0
+ */
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+
+class QTimer;
+
+class RepaintThrottle : public QObject
+{
+  Q_OBJECT
+
+ private:
+
+  Q_DISABLE_COPY ( RepaintThrottle )
+
+ public:
+
+  /**
+   * \param parent    Parent object.
+   * \param frameRate Maximum number of frames per second.
+   */
+  RepaintThrottle( QObject* parent, const int frameRate );
+
+  virtual ~RepaintThrottle();
+
+  /** Sets the maximum number of frames per second. */
+  void setFrameRate( const int frameRate );
+
+  /** \return The minimum time in ms between two frames. */
+  int frameInterval() const
+  {
+    return m_interval;
+  };
+
+ public slots:
+
+  /** Requests a frame. */
+  void slot_Request();
+
+ signals:
+
+  /** Emitted, if the views shall be updated. */
+  void frame();
+
+ private slots:
+
+  void slot_Timeout();
+
+ private:
+
+  /** Single shot timer until the next frame */
+  QTimer* m_timer;
+
+  /** Time since the last frame */
+  QElapsedTimer m_lastFrame;
+
+  /** Minimum time in ms between two frames */
+  int m_interval;
+};
@@ -7,7 +7,7 @@
 ************************************************************************
 **
 **   Copyright(c): 2002      by Andrè Somers,
-**                 2007-2025 by Axel Pauli
+**                 2007-2026 by Axel Pauli
 **
 **   This file is distributed under the terms of the General Public
 **   License. See the file COPYING for more information.
@@ -304,6 +304,13 @@ SettingsPageGPS::SettingsPageGPS(QWidget *parent) : QWidget(parent)
 
   saveNmeaData = new QCheckBox (tr("Save NMEA Data"), this);
   topLayout->addWidget(saveNmeaData, row, 0 );
+  hbox = new QHBoxLayout();
+  compressNmeaData = new QCheckBox (tr("Compress"), this);
+  hbox->addWidget( compressNmeaData );
+  flarmNmeaData = new QCheckBox (tr("Flarm only"), this);
+  hbox->addWidget( flarmNmeaData );
+  hbox->addStretch( 10 );
+  topLayout->addLayout( hbox, row, 1 );
   row++;
 
   topLayout->setRowStretch( row++, 10 );
@@ -519,6 +526,8 @@ void SettingsPageGPS::load()
   toggleWiFiMenu();
 
   saveNmeaData->setChecked( conf->getGpsNmeaLogState() );
+  compressNmeaData->setChecked( conf->getGpsNmeaLogCompression() );
+  flarmNmeaData->setChecked( conf->getGpsNmeaLogFlarmOnly() );
 
   updateGpsToggle();
 }
@@ -647,10 +656,20 @@ bool SettingsPageGPS::save()
   conf->setGpsWlanCB3( WiFi3CB->isChecked() );
 
   bool oldNmeaLogState = conf->getGpsNmeaLogState();
+  bool oldNmeaLogFlarmOnly = conf->getGpsNmeaLogFlarmOnly();
 
   conf->setGpsNmeaLogState( saveNmeaData->isChecked() );
+  conf->setGpsNmeaLogCompression( compressNmeaData->isChecked() );
+  conf->setGpsNmeaLogFlarmOnly( flarmNmeaData->isChecked() );
 
-  if( oldNmeaLogState != saveNmeaData->isChecked() )
+  if( oldNmeaLogState == true && saveNmeaData->isChecked() == true &&
+      oldNmeaLogFlarmOnly != flarmNmeaData->isChecked() )
+    {
+      // Restart the running log with the new sentence filter.
+      emit endNmeaLog();
+      emit startNmeaLog();
+    }
+  else if( oldNmeaLogState != saveNmeaData->isChecked() )
     {
       if( saveNmeaData->isChecked() )
         {
@@ -7,7 +7,7 @@
 ************************************************************************
 **
 **   Copyright (c):  2002      by André Somers
-**                   2008-2025 by Axel Pauli
+**                   2008-2026 by Axel Pauli
 **
 **   This file is distributed under the terms of the General Public
 **   License. See the file COPYING for more information.
@@ -21,7 +21,7 @@
  *
  * \brief Configuration settings for the GPS device.
  *
- * \date 2002-2025
+ * \date 2002-2026
  */
 #pragma once
 
@@ -196,6 +196,8 @@ class SettingsPageGPS : public QWidget
   QLabel*        label2;
   QLabel*        label3;
   QCheckBox*     saveNmeaData;
+  QCheckBox*     compressNmeaData;
+  QCheckBox*     flarmNmeaData;
   QPushButton*   GpsToggle;
 
   /** Pixmaps for GPS button. */
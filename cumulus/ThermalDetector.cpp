@@ -0,0 +1,306 @@
+/***********************************************************************
+**
+**   ThermalDetector.cpp
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <cmath>
+#include <cstdlib>
+
+#include "ThermalDetector.h"
+
+// KFLog coordinate units per meter along a meridian, 1 degree = 600000 units
+#define UNITS_PER_METER (600000.0 / 111195.0)
+
+// Time window in ms of the track points checked for circling
+#define CIRCLING_WINDOW 16000
+
+// Maximum time in ms between two track points of a circle
+#define MAX_TRACK_GAP 3000
+
+// Heading change in degrees, which is needed for circling
+#define MIN_HEADING_CHANGE 180
+
+// Minimum mean turn rate in degrees per second of a circling target
+#define MIN_TURN_RATE 9.0
+
+// Track changes in degrees against the turn direction, which are tolerated
+#define TRACK_NOISE 5
+
+// Minimum climb rate in m/s of a circling target
+#define MIN_CLIMB 0.5
+
+// Maximum radius in m of a thermal circle
+#define MAX_RADIUS 300.0
+
+// Samples within this distance in m belong to the same hotspot
+#define CLUSTER_RADIUS 400.0
+
+// Maximum weight of the former samples of a hotspot. So the hotspot follows
+// the drift of the thermal and a change of its strength.
+#define MAX_WEIGHT 20
+
+ThermalDetector::ThermalDetector()
+{
+  clear();
+}
+
+void ThermalDetector::clear()
+{
+  m_size = 0;
+  m_cursor = 0;
+  m_lastUpdate = -1;
+}
+
+bool ThermalDetector::isCircling( const FlarmTraffic::Target& target,
+                                  double& turnRate )
+{
+  const FlarmBase::FlarmAcft& acft = target.acft();
+
+  if( acft.Track == INT_MIN || acft.GroundSpeed == INT_MIN )
+    {
+      // Stealth mode, no tracks are reported.
+      return false;
+    }
+
+  const FlarmTraffic::TrackPoint& last = target.trackPoint( 0 );
+
+  int turn = 0;
+  qint64 span = 0;
+
+  for( int i = 1; i < target.trackSize(); i++ )
+    {
+      const FlarmTraffic::TrackPoint& p0 = target.trackPoint( i - 1 );
+      const FlarmTraffic::TrackPoint& p1 = target.trackPoint( i );
+
+      qint64 dt = p0.Time - p1.Time;
+
+      if( last.Time - p1.Time > CIRCLING_WINDOW || p1.Track == INT_MIN ||
+          dt <= 0 || dt > MAX_TRACK_GAP )
+        {
+          break;
+        }
+
+      int diff = p0.Track - p1.Track;
+
+      // Take the shorter way around the circle
+      while( diff > 180 )  diff -= 360;
+      while( diff < -180 ) diff += 360;
+
+      if( turn != 0 && (diff > 0) != (turn > 0) && abs( diff ) > TRACK_NOISE )
+        {
+          // The target has turned into the other direction before.
+          break;
+        }
+
+      turn += diff;
+      span = last.Time - p1.Time;
+    }
+
+  if( abs( turn ) < MIN_HEADING_CHANGE || span == 0 )
+    {
+      return false;
+    }
+
+  turnRate = turn * 1000.0 / span;
+
+  return fabs( turnRate ) >= MIN_TURN_RATE;
+}
+
+bool ThermalDetector::update( const FlarmTraffic::Snapshot& traffic,
+                              const QPoint& ownPosition,
+                              const int ownAltitude,
+                              const qint64 now )
+{
+  bool changed = expire( now );
+
+  const int count = traffic.size();
+
+  if( count == 0 )
+    {
+      m_lastUpdate = now;
+      return changed;
+    }
+
+  // The snapshot can have become smaller since the last update.
+  m_cursor %= count;
+
+  const double cosLat = cos( ownPosition.x() / 600000.0 * M_PI / 180.0 );
+
+  int analyzed = 0;
+  int i;
+
+  for( i = 0; i < count && analyzed < TargetBudget; i++ )
+    {
+      const FlarmTraffic::Target& target = traffic.at( (m_cursor + i) % count );
+      const FlarmBase::FlarmAcft& acft = target.acft();
+
+      if( acft.TimeStamp <= m_lastUpdate )
+        {
+          // Not reported since the last update, nothing new to analyze.
+          continue;
+        }
+
+      analyzed++;
+
+      double turnRate;
+
+      if( acft.ClimbRate == INT_MIN || acft.ClimbRate < MIN_CLIMB ||
+          isCircling( target, turnRate ) == false )
+        {
+          continue;
+        }
+
+      // The center of the circle is on the inner side of the track.
+      double w = fabs( turnRate ) * M_PI / 180.0;
+      double radius = qMin( acft.GroundSpeed / w, MAX_RADIUS );
+      double side = (acft.Track + (turnRate > 0.0 ? 90.0 : -90.0)) * M_PI / 180.0;
+
+      double north = acft.RelativeNorth + radius * cos( side );
+      double east  = acft.RelativeEast + radius * sin( side );
+
+      changed |= addSample( ownPosition.x() + north * UNITS_PER_METER,
+                            ownPosition.y() + east * UNITS_PER_METER / cosLat,
+                            cosLat,
+                            acft.ClimbRate,
+                            ownAltitude + acft.RelativeVertical,
+                            acft.ID,
+                            now );
+    }
+
+  m_cursor = (m_cursor + i) % count;
+  m_lastUpdate = now;
+
+  return changed;
+}
+
+bool ThermalDetector::addSample( const double latitude,
+                                 const double longitude,
+                                 const double cosLat,
+                                 const double climb,
+                                 const int altitude,
+                                 const uint id,
+                                 const qint64 now )
+{
+  int nearest = -1;
+  double nearestDist = CLUSTER_RADIUS * CLUSTER_RADIUS;
+
+  for( int i = 0; i < m_size; i++ )
+    {
+      const Hotspot& hs = m_hotspots[i];
+
+      double dNorth = (latitude - hs.Latitude) / UNITS_PER_METER;
+      double dEast  = (longitude - hs.Longitude) * cosLat / UNITS_PER_METER;
+      double dist   = dNorth * dNorth + dEast * dEast;
+
+      if( dist < nearestDist )
+        {
+          nearestDist = dist;
+          nearest = i;
+        }
+    }
+
+  if( nearest == -1 )
+    {
+      bool removed = false;
+
+      if( m_size == MaxHotspots )
+        {
+          // Replace the hotspot without samples for the longest time.
+          int oldest = 0;
+
+          for( int i = 1; i < m_size; i++ )
+            {
+              if( m_hotspots[i].LastSeen < m_hotspots[oldest].LastSeen )
+                {
+                  oldest = i;
+                }
+            }
+
+          removed = m_hotspots[oldest].isConfirmed();
+          remove( oldest );
+        }
+
+      Hotspot& hs = m_hotspots[m_size++];
+
+      hs.Latitude     = latitude;
+      hs.Longitude    = longitude;
+      hs.Climb        = climb;
+      hs.Bottom       = altitude;
+      hs.Top          = altitude;
+      hs.Samples      = 1;
+      hs.Gliders      = 1;
+      hs.GliderIds[0] = id;
+      hs.FirstSeen    = now;
+      hs.LastSeen     = now;
+
+      return removed || hs.isConfirmed();
+    }
+
+  Hotspot& hs = m_hotspots[nearest];
+
+  bool confirmed = hs.isConfirmed();
+
+  hs.Samples++;
+
+  double weight = qMin( hs.Samples, MAX_WEIGHT );
+
+  hs.Latitude  += (latitude - hs.Latitude) / weight;
+  hs.Longitude += (longitude - hs.Longitude) / weight;
+  hs.Climb     += (climb - hs.Climb) / weight;
+  hs.Bottom     = qMin( hs.Bottom, altitude );
+  hs.Top        = qMax( hs.Top, altitude );
+  hs.LastSeen   = now;
+
+  if( hs.Gliders < MaxGliders )
+    {
+      bool known = false;
+
+      for( int i = 0; i < hs.Gliders; i++ )
+        {
+          if( hs.GliderIds[i] == id )
+            {
+              known = true;
+              break;
+            }
+        }
+
+      if( known == false )
+        {
+          hs.GliderIds[hs.Gliders++] = id;
+        }
+    }
+
+  return confirmed == false && hs.isConfirmed();
+}
+
+bool ThermalDetector::expire( const qint64 now )
+{
+  bool changed = false;
+
+  for( int i = m_size - 1; i >= 0; i-- )
+    {
+      if( now - m_hotspots[i].LastSeen > MaxAge )
+        {
+          changed |= m_hotspots[i].isConfirmed();
+          remove( i );
+        }
+    }
+
+  return changed;
+}
+
+void ThermalDetector::remove( const int index )
+{
+  // The order of the hotspots does not matter.
+  m_hotspots[index] = m_hotspots[--m_size];
+}
@@ -0,0 +1,174 @@
+/***********************************************************************
+**
+**   ThermalDetector.h
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+/**
+ * \class ThermalDetector
+ *
+ * \author Axel Pauli
+ *
+ * \brief Thermal hotspots found by circling Flarm targets.
+ *
+ * A target is circling, if its reported tracks turn into the same direction
+ * by more than half a circle within the track history. If it climbs too, the
+ * center of its circle is taken as sample of a thermal. Samples near to each
+ * other are clustered into a hotspot, which keeps the averaged climb rate,
+ * the altitude band of the circling gliders, the number of different gliders
+ * and the time of the first and last sample. A hotspot is confirmed, when
+ * at least two different gliders have circled in it. Hotspots without new
+ * samples expire after a while.
+ *
+ * The detector is updated at the end of every PFLAA sequence. To keep the
+ * time per sequence fixed also in a large gaggle, only a limited number of
+ * targets is analyzed per update. The next update continues with the
+ * following targets.
+ *
+ * \date 2026
+ *
+ * \version 1.0
+ */
+
+#pragma once
+
+#include <QPoint>
+#include <QtGlobal>
+
+#include "FlarmTraffic.h"
+
+class ThermalDetector
+{
+ public:
+
+  /** Maximum number of hotspots */
+  static const int MaxHotspots = 32;
+
+  /** Maximum number of targets analyzed per update */
+  static const int TargetBudget = 12;
+
+  /** Number of different gliders remembered per hotspot */
+  static const int MaxGliders = 4;
+
+  /** Number of samples, after that a hotspot is confirmed */
+  static const int MinSamples = 3;
+
+  /**
+   * Number of different gliders, after that a hotspot is confirmed. A single
+   * glider circling for some other reason does not make a thermal.
+   */
+  static const int MinGliders = 2;
+
+  /** Time in ms, after that a hotspot without new samples expires */
+  static const int MaxAge = 15 * 60 * 1000;
+
+  /**
+   * \struct Hotspot
+   *
+   * \brief Thermal found by one or more circling gliders.
+   */
+  struct Hotspot
+  {
+    double Latitude;  // KFLog coordinates of the thermal center
+    double Longitude;
+    double Climb;     // averaged climb rate in m/s
+    int    Bottom;    // lowest altitude of a circling glider in m
+    int    Top;       // highest altitude of a circling glider in m
+    int    Samples;
+    int    Gliders;   // number of different gliders up to MaxGliders
+    uint   GliderIds[MaxGliders];
+    qint64 FirstSeen; // ms of the virtual clock
+    qint64 LastSeen;
+
+    /** \return The position in KFLog WGS84 coordinates. */
+    QPoint position() const
+    {
+      return QPoint( qRound( Latitude ), qRound( Longitude ) );
+    };
+
+    /** \return True, if enough samples of different gliders confirm the thermal. */
+    bool isConfirmed() const
+    {
+      return Samples >= MinSamples && Gliders >= MinGliders;
+    };
+  };
+
+  ThermalDetector();
+
+  /** Removes all hotspots. */
+  void clear();
+
+  /**
+   * Analyzes the targets reported since the last update and adds the
+   * circling ones to the hotspots.
+   *
+   * \param traffic     The targets of the last PFLAA sequence.
+   * \param ownPosition Own position in KFLog WGS84 coordinates.
+   * \param ownAltitude Own altitude in meters.
+   * \param now         ms of the virtual clock.
+   * \return True, if a confirmed hotspot was added or removed.
+   */
+  bool update( const FlarmTraffic::Snapshot& traffic,
+               const QPoint& ownPosition,
+               const int ownAltitude,
+               const qint64 now );
+
+  /**
+   * Removes the hotspots without new samples since MaxAge ms before now.
+   *
+   * \return True, if a confirmed hotspot was removed.
+   */
+  bool expire( const qint64 now );
+
+  int size() const
+  {
+    return m_size;
+  };
+
+  const Hotspot& at( const int i ) const
+  {
+    return m_hotspots[i];
+  };
+
+  /**
+   * Checks, if the target is circling.
+   *
+   * \param target   The target to be checked.
+   * \param turnRate Returns the mean turn rate in degrees per second.
+   * \return True, if the target is circling.
+   */
+  static bool isCircling( const FlarmTraffic::Target& target, double& turnRate );
+
+ private:
+
+  Q_DISABLE_COPY ( ThermalDetector )
+
+  /**
+   * Adds a sample to the nearest hotspot or creates a new hotspot.
+   *
+   * \return True, if a hotspot was confirmed by the sample.
+   */
+  bool addSample( const double latitude, const double longitude,
+                  const double cosLat, const double climb,
+                  const int altitude, const uint id, const qint64 now );
+
+  void remove( const int index );
+
+  Hotspot m_hotspots[MaxHotspots];
+  int     m_size;
+
+  /** Snapshot index, at which the next update starts */
+  int     m_cursor;
+
+  /** Time of the last update */
+  qint64  m_lastUpdate;
+};
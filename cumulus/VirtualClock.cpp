@@ -0,0 +1,106 @@
+/***********************************************************************
+**
+**   VirtualClock.cpp
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+#include <ctime>
+
+#include <QtCore>
+
+#include "VirtualClock.h"
+
+int       VirtualClock::m_enabled = -1;
+QDateTime VirtualClock::m_fixTime;
+qint64    VirtualClock::m_msecs   = 0;
+
+bool VirtualClock::isEnabled()
+{
+  if( m_enabled == -1 )
+    {
+      m_enabled = QCoreApplication::arguments().contains( "--virtual-clock" ) ? 1 : 0;
+
+      if( m_enabled )
+        {
+          qDebug() << "VirtualClock: Time follows the GPS fix time";
+        }
+    }
+
+  return m_enabled == 1;
+}
+
+void VirtualClock::setFixTime( const QDateTime& utc )
+{
+  if( isEnabled() == false || utc.isValid() == false )
+    {
+      return;
+    }
+
+  if( m_fixTime.isValid() )
+    {
+      qint64 delta = m_fixTime.msecsTo( utc );
+
+      if( delta > 0 )
+        {
+          m_msecs += delta;
+        }
+    }
+
+  m_fixTime = utc;
+}
+
+QDateTime VirtualClock::currentDateTimeUtc()
+{
+  if( isEnabled() && m_fixTime.isValid() )
+    {
+      return m_fixTime;
+    }
+
+  return QDateTime::currentDateTimeUtc();
+}
+
+QDateTime VirtualClock::currentDateTime()
+{
+  if( isEnabled() && m_fixTime.isValid() )
+    {
+      return m_fixTime.toLocalTime();
+    }
+
+  return QDateTime::currentDateTime();
+}
+
+QTime VirtualClock::currentTime()
+{
+  return currentDateTime().time();
+}
+
+qint64 VirtualClock::msecsSinceReference()
+{
+  if( isEnabled() )
+    {
+      return m_msecs;
+    }
+
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return qint64( ts.tv_sec ) * 1000 + ts.tv_nsec / 1000000;
+}
+
+qint64 VirtualClock::msecsOfReadTime( const qint64 readTime )
+{
+  if( readTime == 0 || isEnabled() )
+    {
+      return msecsSinceReference();
+    }
+
+  return readTime / 1000000;
+}
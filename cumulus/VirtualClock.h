@@ -0,0 +1,130 @@
+/***********************************************************************
+**
+**   VirtualClock.h
+**
+**   This file is part of Cumulus.
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli <kflog.cumulus@gmail.com>
+**
+**   This file is distributed under the terms of the General Public
+**   License. See the file COPYING for more information.
+**
+***********************************************************************/
+
+/**
+ * \class VirtualClock
+ *
+ * \author Axel Pauli
+ *
+ * \brief Clock of the flight processing, driven by the GPS fix time.
+ *
+ * Normally the clock returns the system time. If Cumulus is started with the
+ * option --virtual-clock, the clock follows the fix time of the GPS. A
+ * recorded flight can then be played faster than real time by the NMEA
+ * simulator and all time dependent calculations see the recorded time line.
+ * Until the first fix arrives, the system time is used.
+ *
+ * VirtualTimer is the counterpart of QElapsedTimer on this clock.
+ *
+ * \date 2026
+ *
+ * \version 1.0
+ */
+
+#pragma once
+
+#include <QDateTime>
+#include <QTime>
+#include <QtGlobal>
+
+class VirtualClock
+{
+ public:
+
+  /** \return True, if the clock follows the GPS fix time. */
+  static bool isEnabled();
+
+  /**
+   * Advances the virtual clock to the passed fix time. A time running
+   * backwards restarts the time line without moving the elapsed time back.
+   */
+  static void setFixTime( const QDateTime& utc );
+
+  static QDateTime currentDateTimeUtc();
+
+  static QDateTime currentDateTime();
+
+  static QTime currentTime();
+
+  /** \return A monotonic time in milli seconds, used by VirtualTimer. */
+  static qint64 msecsSinceReference();
+
+  /**
+   * Converts a read time of the gpsClient, taken from the monotonic clock in
+   * nano seconds, to the time base of msecsSinceReference(). If the read time
+   * is unknown or the clock follows the fix time, the current time is
+   * returned.
+   */
+  static qint64 msecsOfReadTime( const qint64 readTime );
+
+ private:
+
+  /** -1 = not yet checked, 0 = disabled, 1 = enabled */
+  static int m_enabled;
+
+  /** Last fix time in UTC */
+  static QDateTime m_fixTime;
+
+  /** Monotonic virtual time in milli seconds */
+  static qint64 m_msecs;
+};
+
+class VirtualTimer
+{
+ public:
+
+  VirtualTimer() : m_start( Invalid )
+  {
+  };
+
+  void start()
+  {
+    m_start = VirtualClock::msecsSinceReference();
+  };
+
+  qint64 restart()
+  {
+    qint64 now = VirtualClock::msecsSinceReference();
+    qint64 elapsed = now - m_start;
+    m_start = now;
+    return elapsed;
+  };
+
+  qint64 elapsed() const
+  {
+    return VirtualClock::msecsSinceReference() - m_start;
+  };
+
+  bool hasExpired( const qint64 timeout ) const
+  {
+    return timeout != -1 && elapsed() > timeout;
+  };
+
+  bool isValid() const
+  {
+    return m_start != Invalid;
+  };
+
+  void invalidate()
+  {
+    m_start = Invalid;
+  };
+
+ private:
+
+  static const qint64 Invalid = -Q_INT64_C(0x7fffffffffffffff) - 1;
+
+  qint64 m_start;
+};
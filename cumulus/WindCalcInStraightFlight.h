@@ -29,10 +29,10 @@
 #pragma once
 
 #include <QObject>
-#include <QElapsedTimer>
 
 #include "altitude.h"
 #include "vector.h"
+#include "VirtualClock.h"
 
 class WindCalcInStraightFlight : public QObject
 {
@@ -108,7 +108,7 @@ private:
 
   uint   nunberOfSamples;    // current number of samples
   int    deliverWind;        // time in seconds for next wind delivery
-  QElapsedTimer measurementStart; // time measurement in seconds
+  VirtualTimer measurementStart; // time measurement in seconds
   double minimumAirSpeed;    // minimum air speed to start calculation
   double deltaSpeed;         // accepted speed deviation in km/h
   double deltaHeading;       // accepted heading deviation in degrees
@@ -22,6 +22,7 @@
 #include <mapcalc.h>
 #include <speed.h>
 #include <WindStore.h>
+#include <VirtualClock.h>
 
 WindStore::WindStore( QObject* parent ) :
   QObject(parent),
@@ -52,7 +53,7 @@ void WindStore::slot_Measurement( Vector& windVector,
   // reduce altitude to a 100m interval
   wm.altitude = static_cast<int>( altitude.getMeters() );
   wm.altitude = ( wm.altitude / 100 ) * 100;
-  wm.time = QTime::currentTime();
+  wm.time = VirtualClock::currentTime();
 
   WindMeasurement& oldWm = lastWindMeasurement;
 
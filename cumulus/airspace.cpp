@@ -24,9 +24,12 @@
 #include "generalconfig.h"
 #include "mapconfig.h"
 #include "time_cu.h"
+#include "VirtualClock.h"
 
 QStringList Airspace::m_openAipTypeTranslater;
 
+QHash<QString, quint32> Airspace::m_idMap;
+
 Airspace::Airspace() :
   LineElement(),
   m_openAipType(255),
@@ -36,7 +39,10 @@ Airspace::Airspace() :
   m_airRegion(0),
   m_icaoClass( AS_Unkown ),
   m_activity( 0 ),
-  m_byNotam( false )
+  m_byNotam( false ),
+  m_id( 0 ),
+  m_filterGeneration( 0 ),
+  m_filteredOut( false )
 {
   // All Airspaces are closed regions ...
   closed = true;
@@ -64,7 +70,10 @@ Airspace::Airspace( QString name,
   m_airRegion(0),
   m_icaoClass(icaoClass),
   m_activity(activity),
-  m_byNotam(byNotam)
+  m_byNotam(byNotam),
+  m_id(0),
+  m_filterGeneration(0),
+  m_filteredOut(false)
 {
   // All Airspaces are closed regions ...
   closed = true;
@@ -443,6 +452,36 @@ QString Airspace::getOpenAipTypeAsString( const quint8 openAipType ) const
   return m_openAipTypeTranslater.at( openAipType );
 }
 
+quint32 Airspace::getId() const
+{
+  if( m_id == 0 )
+    {
+      // The info string alone is not unique, airspaces of the same type and
+      // name with equal limits can exist at different places. Flarm alert
+      // zones have no name at all.
+      const QRect bb = projPolygon.boundingRect();
+
+      QString key = QString( "%1|%2,%3,%4,%5" ).arg( getInfoString() )
+                                                 .arg( bb.left() ).arg( bb.top() )
+                                                 .arg( bb.right() ).arg( bb.bottom() );
+
+      QHash<QString, quint32>::const_iterator it = m_idMap.constFind( key );
+
+      if( it != m_idMap.constEnd() )
+        {
+          m_id = it.value();
+        }
+      else
+        {
+          // Zero is reserved for an unassigned identifier.
+          m_id = m_idMap.size() + 1;
+          m_idMap.insert( key, m_id );
+        }
+    }
+
+  return m_id;
+}
+
 QString Airspace::getInfoString() const
 {
   QString text, tempL, tempU;
@@ -714,3 +753,16 @@ void Airspace::debug()
            << "ULimit=" << m_uLimit.getMeters()
            << "LLimit=" << m_lLimit.getMeters();
 }
+
+bool FlarmBase::FlarmAlertZone::isActive() const
+{
+  quint64 secondsUtc =
+    static_cast<quint64> (VirtualClock::currentDateTimeUtc().toMSecsSinceEpoch() / 1000);
+
+  if( ActivityLimit > 0 && ActivityLimit < secondsUtc )
+    {
+      return false;
+    }
+
+  return true;
+}
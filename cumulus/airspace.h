@@ -39,6 +39,7 @@
 
 #include <QDateTime>
 #include <QElapsedTimer>
+#include <QHash>
 #include <QPolygon>
 #include <QPainter>
 #include <QPainterPath>
@@ -377,6 +378,40 @@ public:
     m_icaoClass = icaoClass;
   }
 
+  /**
+   * \return A unique integer identifier of the airspace. It is assigned at
+   * the first call from a table keyed by the info string and the projected
+   * bounding box, so an airspace keeps it, if the airspaces are reloaded.
+   */
+  quint32 getId() const;
+
+  /**
+   * \return The filter generation, for which the filter state was evaluated.
+   * Zero means, the filter state was never evaluated.
+   */
+  quint32 getFilterGeneration() const
+  {
+    return m_filterGeneration;
+  };
+
+  /**
+   * \return True, if the airspace is filtered out by the airspace filters.
+   * The value is only valid for the filter generation.
+   */
+  bool isFilteredOut() const
+  {
+    return m_filteredOut;
+  };
+
+  /**
+   * Stores the evaluated filter state of the airspace.
+   */
+  void setFilterState( const quint32 generation, const bool filteredOut ) const
+  {
+    m_filterGeneration = generation;
+    m_filteredOut = filteredOut;
+  };
+
   /**
    * Get Flarm Alert Zone.
    *
@@ -524,10 +559,27 @@ private:
    */
   FlarmBase::FlarmAlertZone m_flarmAlertZone;
 
+  /**
+   * Unique airspace identifier, zero if not yet assigned.
+   */
+  mutable quint32 m_id;
+
+  /**
+   * Compiled airspace filter state and its filter generation.
+   */
+  mutable quint32 m_filterGeneration;
+  mutable bool m_filteredOut;
+
   /**
    * OpenAip airspace type translater.
    */
   static QStringList m_openAipTypeTranslater;
+
+  /**
+   * Assigned airspace identifiers, keyed by the identity of the airspace.
+   * The table is only used by the GUI thread.
+   */
+  static QHash<QString, quint32> m_idMap;
 };
 
 /**
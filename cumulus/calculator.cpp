@@ -22,6 +22,8 @@
 
 #include <QtWidgets>
 
+#include "airspace.h"
+#include "AirspaceClearance.h"
 #include "altimeterdialog.h"
 #include "Atmosphere.h"
 #include "calculator.h"
@@ -29,6 +31,7 @@
 #include "generalconfig.h"
 #include "gliderlistwidget.h"
 #include "gpsnmea.h"
+#include "LatencyTrace.h"
 #include "layout.h"
 #include "MainWindow.h"
 #include "mapcalc.h"
@@ -41,6 +44,13 @@
 #define MAX_MCCREADY 10.0
 #define MAX_SAMPLECOUNT 600
 
+// Fixes of 60s at 20Hz, the maximum vario integration time
+#define MAX_FIXCOUNT 1200
+
+// Time constant of the turn rate smoothing in milli seconds. A 1Hz receiver
+// is not smoothed.
+#define TURN_RATE_TAU 500.0
+
 Calculator *calculator = static_cast<Calculator *> (0);
 
 extern MainWindow  *_globalMainWindow;
@@ -51,9 +61,11 @@ Calculator::Calculator( QObject* parent ) :
   QObject(parent),
   infiniteTemperature(-300.0),
   samplelist( LimitedList<FlightSample>( MAX_SAMPLECOUNT ) ),
+  fixlist( LimitedList<FlightSample>( MAX_FIXCOUNT ) ),
   m_turnRight(0),
   m_turnLeft(0),
-  m_flyStraight(0)
+  m_flyStraight(0),
+  m_turnRate(0.0)
 {
   setObjectName( "Calculator" );
   GeneralConfig *conf = GeneralConfig::instance();
@@ -282,6 +294,11 @@ void Calculator::slot_PressureAltitude( Altitude& altitude )
           calcAltitudeGain();
         }
     }
+
+  if( m_calculateVario == true )
+    {
+      m_vario->newPressureAltitude( altitude, GpsNmea::gps->getSampleTime() );
+    }
 }
 
 /** Called if a new heading has been obtained */
@@ -371,7 +388,22 @@ void Calculator::slot_AHRSInfo( const double rollAngle,
                                 const double accelarationY,
                                 const double accelarationZ )
 {
+  if( m_calculateVario == false )
+    {
+      return;
+    }
+
+  double roll  = rollAngle * M_PI / 180.0;
+  double pitch = pitchAngle * M_PI / 180.0;
 
+  // The sensor delivers the specific force in g with x forward, y right and
+  // z up. Its projection to the vertical axis minus the gravity is the
+  // vertical acceleration.
+  double up = accelarationX * sin( pitch ) -
+              accelarationY * sin( roll ) * cos( pitch ) +
+              accelarationZ * cos( roll ) * cos( pitch );
+
+  m_vario->newAcceleration( (up - 1.0) * 9.80665, GpsNmea::gps->getSampleTime() );
 }
 
 /** Called if a new waypoint has been selected. If user action is
@@ -905,9 +937,10 @@ bool Calculator::glidePath( int aLastBearing, Distance aDistance,
 
   //  qDebug("Glider=%s", _glider->type().toLatin1().data());
 
-  // we use the method described by Bob Hansen
+  // we use the method described by Bob Hansen. The best speeds are taken
+  // from the speed to fly table of the polar.
   // get best speed for zero wind V0
-  Speed speed = m_polar->bestSpeed(0.0, 0.0, lastMc);
+  Speed speed = m_polar->tableBestSpeed(0.0, 0.0, lastMc);
   //qDebug ("rough best speed: %f", speed.getKph());
 
   // wind has a negative vector!
@@ -937,7 +970,7 @@ bool Calculator::glidePath( int aLastBearing, Distance aDistance,
   Altitude givenAlt (lastAltitude - Altitude (aElevation) - minimalArrival);
 
   // improved speed for wind V1
-  speed = m_polar->bestSpeed(headwind, 0.0, lastMc);
+  speed = m_polar->tableBestSpeed(headwind, 0.0, lastMc);
   //qDebug ("improved best speed: %f", speed.getKph());
   bestSpeed = speed;
   // the ld is over ground, so we take groundspeed
@@ -991,6 +1024,63 @@ void Calculator::calcGlidePath()
       lastGlidePath = arrivalAlt;
       emit glidePath( arrivalAlt );
     }
+
+  calcFinalGlideClearance();
+}
+
+void Calculator::calcFinalGlideClearance()
+{
+  QString key = QString( "%1,%2,%3" ).arg( targetWp->name )
+                                     .arg( targetWp->taskPointIndex )
+                                     .arg( lastMc.getMps() );
+
+  if( key == m_clearanceKey && m_clearanceTimer.isValid() &&
+      m_clearanceTimer.elapsed() < 10000 )
+    {
+      return;
+    }
+
+  m_clearanceKey = key;
+  m_clearanceTimer.start();
+
+  // The result is not kept, its airspace pointers become invalid, when the
+  // map data are reloaded. Only the airspace names are stored.
+  const QList<AirspaceClearance::Leg> legs = AirspaceClearance::checkFinalGlide();
+
+  QStringList names;
+
+  for( int i = 0; i < legs.size(); i++ )
+    {
+      const QList<AirspaceClearance::Crossing>& crossings = legs.at(i).crossings;
+
+      for( int j = 0; j < crossings.size(); j++ )
+        {
+          const QString& name = crossings.at(j).airspace->getName();
+
+          if( names.contains( name ) == false )
+            {
+              names.append( name );
+            }
+        }
+    }
+
+  bool notify = false;
+
+  for( int i = 0; i < names.size(); i++ )
+    {
+      if( m_clearanceAirspaces.contains( names.at(i) ) == false )
+        {
+          notify = true;
+          break;
+        }
+    }
+
+  m_clearanceAirspaces = names;
+
+  if( notify )
+    {
+      emit taskInfo( tr("Final glide crosses %1").arg( names.join(", ") ), true );
+    }
 }
 
 /**
@@ -1215,6 +1305,11 @@ void Calculator::slot_staticPressure( const double pressure )
       lastStaticPressure = pressure;
       emit newStaticPressure( pressure );
     }
+
+  if( m_calculateVario == true )
+    {
+      m_vario->newStaticPressure( pressure, GpsNmea::gps->getSampleTime() );
+    }
 }
 
 /**
@@ -1502,6 +1597,8 @@ void Calculator::slot_settingsChanged()
  */
 void Calculator::slot_newFix( const QDateTime& newFixTime )
 {
+  LatencyTrace::mark( LatencyTrace::Calculated );
+
   // before we start making samples, let's be sure we have all the
   // data we need for that. So, we wait for the second Fix.
   if (!m_pastFirstFix)
@@ -1547,23 +1644,35 @@ void Calculator::slot_newFix( const QDateTime& newFixTime )
       sample.airspeed = airspeed.getSpeed();
     }
 
-  // add to the samplelist
-  samplelist.add(sample);
-
-  lastSample = sample;
+  // The variometer and the turn rate get every fix of the receiver.
+  fixlist.add(sample);
 
-  // start analyzing...
-  // determine if we are standing still, cruising, circling or doing something else
-  determineFlightStatus();
+  calcTurnRate();
 
   // Call variometer calculation derived from GPS altitude. Can be switched off,
   // when an external device delivers variometer information derived from a
   // baro sensor.
   if ( m_calculateVario == true )
     {
-      m_vario->newAltitude();
+      m_vario->newAltitude( GpsNmea::gps->getSampleTime() );
+    }
+
+  if( isHistorySample( sample ) == false )
+    {
+      // A high rate receiver is decimated to one sample per second for all
+      // further consumers.
+      return;
     }
 
+  // add to the samplelist
+  samplelist.add(sample);
+
+  lastSample = sample;
+
+  // start analyzing...
+  // determine if we are standing still, cruising, circling or doing something else
+  determineFlightStatus();
+
   // Call wind analyzer calculation if required. Can be switched off,
   // when an external device delivers wind information.
   if ( m_calculateWind == true )
@@ -1578,6 +1687,47 @@ void Calculator::slot_newFix( const QDateTime& newFixTime )
   emit newSample();
 }
 
+bool Calculator::isHistorySample( const FlightSample& sample ) const
+{
+  if( samplelist.count() == 0 )
+    {
+      return true;
+    }
+
+  const QDateTime& last = samplelist.at(0).time;
+
+  // The first fix of a new second is taken. So the samples keep the raster
+  // of full seconds, which is also used by the IGC logger.
+  return last.msecsTo( sample.time ) >= 1000 ||
+         last.time().second() != sample.time.time().second();
+}
+
+void Calculator::calcTurnRate()
+{
+  if( fixlist.count() < 2 )
+    {
+      return;
+    }
+
+  qint64 timeDiff = fixlist[1].time.msecsTo( fixlist[0].time );
+
+  if( timeDiff <= 0 )
+    {
+      return;
+    }
+
+  double headingDiff = MapCalc::angleDiff( fixlist[1].vector.getAngleRad(),
+                                           fixlist[0].vector.getAngleRad() ) * 180.0 / M_PI;
+
+  double rate = headingDiff * 1000.0 / timeDiff;
+
+  // Exponential smoothing, the weight of the new value grows with its time
+  // distance to the previous fix.
+  double alpha = qMin( 1.0, timeDiff / TURN_RATE_TAU );
+
+  m_turnRate += alpha * (rate - m_turnRate);
+}
+
 /** Determines the status of the flight: unknown, standstill, cruising, circlingL, circlingR */
 void Calculator::determineFlightStatus()
 {
@@ -1587,8 +1737,11 @@ void Calculator::determineFlightStatus()
 
     This can be a bit more advanced to allow for temporary changes in
     circling speed in order to better center a thermal.
+
+    The turn rate is estimated from all fixes of the receiver, see
+    calcTurnRate().
   */
-#define MINTURNANGDIFF 4 //see above
+#define MINTURNRATE 4.0 //see above
 
   if( samplelist.count() < 2 )
     {
@@ -1597,12 +1750,8 @@ void Calculator::determineFlightStatus()
       return;
     }
 
-  // get headings from the last two samples
+  // get heading from the last sample
   int lastHead = samplelist[0].vector.getAngleDeg();
-  int prevHead = samplelist[1].vector.getAngleDeg();
-
-  // calculate the heading difference between the last two samples
-  int headingDiff = MapCalc::angleDiff( prevHead, lastHead );
 
   // get the time difference between these samples
   int timediff = samplelist[1].time.secsTo(samplelist[0].time);
@@ -1610,7 +1759,7 @@ void Calculator::determineFlightStatus()
 #if 0
   qDebug() << "determineFlightStatus:"
            << "LastFlightMode=" << lastFlightMode
-           << "headingDiff=" << headingDiff
+           << "turnRate=" << m_turnRate
            << "timeDiff=" << timediff
            << "lastSpeed" << lastSpeed.getMps() << "m/s";
 #endif
@@ -1637,7 +1786,7 @@ void Calculator::determineFlightStatus()
        return;
     }
 
-  if( headingDiff > MINTURNANGDIFF )
+  if( m_turnRate > MINTURNRATE )
     {
       if( m_turnRight < 4 )  // hold down
         {
@@ -1650,13 +1799,13 @@ void Calculator::determineFlightStatus()
       if( lastFlightMode != circlingR && m_turnRight > 2 )
         {
           qDebug() << "determineFlightStatus: circlingR detected,"
-                   << "HeadingDiff=" << headingDiff
+                   << "TurnRate=" << m_turnRate
                    << "Vm/s=" << lastSpeed.getMps();
           lastFlightMode = circlingR;
           newFlightMode( lastFlightMode );
         }
     }
-  else if( headingDiff < -MINTURNANGDIFF )
+  else if( m_turnRate < -MINTURNRATE )
     {
       if( m_turnLeft < 4)
         {
@@ -1669,7 +1818,7 @@ void Calculator::determineFlightStatus()
       if( lastFlightMode != circlingL && m_turnLeft > 2 )
         {
           qDebug() << "determineFlightStatus: circlingL detected"
-                   << "HeadingDiff=" << headingDiff
+                   << "TurnRate=" << m_turnRate
                    << "Vm/s=" << lastSpeed.getMps();
           lastFlightMode = circlingL;
           newFlightMode( lastFlightMode );
@@ -1687,7 +1836,7 @@ void Calculator::determineFlightStatus()
       if( lastFlightMode != cruising  && m_flyStraight > 2 )
         {
           qDebug() << "determineFlightStatus: cruising detected"
-                   << "HeadingDiff=" << headingDiff
+                   << "TurnRate=" << m_turnRate
                    << "Vm/s=" << lastSpeed.getMps();
 
           // cruising is assumed, set heading start point
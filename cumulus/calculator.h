@@ -37,6 +37,7 @@
 #include "taskpoint.h"
 #include "vario.h"
 #include "vector.h"
+#include "VirtualClock.h"
 #include "waypoint.h"
 #include "WindStore.h"
 #include "WindCalcInStraightFlight.h"
@@ -389,10 +390,18 @@ public:
   void setPosition(const QPoint& newPos);
 
   /**
-   * Contains a list of samples from the flight
+   * Contains a list of samples from the flight. A high rate receiver is
+   * decimated to one sample per second for the history consumers like wind,
+   * flight status, trail and logger.
    */
   LimitedList<FlightSample> samplelist;
 
+  /**
+   * Contains all fixes at the rate of the receiver. Used by the variometer
+   * and the turn rate estimation.
+   */
+  LimitedList<FlightSample> fixlist;
+
   /**
    * Returns the current flight mode
    */
@@ -1031,11 +1040,29 @@ private:
    */
   void calcGlidePath();
 
+  /**
+   * Checks the final glide line for crossed airspaces. The check is repeated,
+   * if the target or the McCready setting has changed, otherwise only every
+   * 10s. A notification is emitted, if new airspaces are crossed.
+   */
+  void calcFinalGlideClearance();
+
   /**
    * Calculates the current and required LD to the selected waypoint
    */
   void calcLD();
 
+  /**
+   * Updates the smoothed turn rate from the last two fixes of the fix list.
+   */
+  void calcTurnRate();
+
+  /**
+   * \return True, if the fix starts a new second and is taken over into the
+   * sample list.
+   */
+  bool isHistorySample( const FlightSample& sample ) const;
+
   /**
    * Calculates the altitude gain.
    */
@@ -1094,6 +1121,13 @@ private: // Private attributes
   /** Contains the last known glide path information */
   Altitude lastGlidePath;
 
+  /** Target and McCready setting of the last clearance check */
+  QString m_clearanceKey;
+  /** Names of the airspaces crossed by the last clearance check */
+  QStringList m_clearanceAirspaces;
+  /** Time of the last clearance check */
+  VirtualTimer m_clearanceTimer;
+
   /** Contains the last known altitude */
   Altitude lastAltitude;
 
@@ -1223,6 +1257,11 @@ private: // Private attributes
    * Counter for straight fly for circle wind.
    */
   quint8 m_flyStraight;
+
+  /**
+   * Smoothed turn rate in degrees per second, positive in clockwise direction.
+   */
+  double m_turnRate;
 };
 
 extern Calculator* calculator;
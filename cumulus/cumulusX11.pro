@@ -107,9 +107,13 @@ HEADERS = \
     AirfieldListWidget.h \
     AirfieldSelectionList.h \
     airregion.h \
+    AirspaceBenchmark.h \
     airspace.h \
+    AirspaceClearance.h \
     AirspaceFilters.h \
     AirspaceHelper.h \
+    AirspaceIndex.h \
+    AirspaceStore.h \
     AirspaceInfo.h \
     airspacewarningdistance.h \
     altimeterdialog.h \
@@ -125,6 +129,7 @@ HEADERS = \
     elevationcolorimage.h \
     Frequency.h \
     filetools.h \
+    FlarmAlertZones.h \
     flighttask.h \
     fontdialog.h \
     generalconfig.h \
@@ -142,10 +147,12 @@ HEADERS = \
     ipc.h \
     isohypse.h \
     isolist.h \
+    KalmanVario.h \
     KRT2.h \
     KRT2Constants.h \
     KRT2Widget.h \
     layout.h \
+    LatencyTrace.h \
     limitedlist.h \
     lineelement.h \
     listviewfilter.h \
@@ -164,6 +171,9 @@ HEADERS = \
     messagehandler.h \
     messagewidget.h \
     multilayout.h \
+    NmeaLogger.h \
+    NmeaRing.h \
+    NmeaSentence.h \
     OpenAip.h \
     OpenAipPoiLoader.h \
     OpenAipLoaderThread.h \
@@ -230,6 +240,7 @@ HEADERS = \
     vario.h \
     VarioModeDialog.h \
     varspinbox.h \
+    VirtualClock.h \
     vector.h \
     waitscreen.h \
     waypointcatalog.h \
@@ -254,9 +265,13 @@ SOURCES = \
     AirfieldListWidget.cpp \
     AirfieldSelectionList.cpp \
     airregion.cpp \
+    AirspaceBenchmark.cpp \
     airspace.cpp \
+    AirspaceClearance.cpp \
     AirspaceFilters.cpp \
     AirspaceHelper.cpp \
+    AirspaceIndex.cpp \
+    AirspaceStore.cpp \
     AirspaceInfo.cpp \
     altimeterdialog.cpp \
     altitude.cpp \
@@ -269,6 +284,7 @@ SOURCES = \
     distance.cpp \
     elevationcolorimage.cpp \
     filetools.cpp \
+    FlarmAlertZones.cpp \
     flighttask.cpp \
     fontdialog.cpp \
     Frequency.cpp \
@@ -286,9 +302,11 @@ SOURCES = \
     ipc.cpp \
     isohypse.cpp \
     isolist.cpp \
+    KalmanVario.cpp \
     KRT2.cpp \
     KRT2Widget.cpp \
     layout.cpp \
+    LatencyTrace.cpp \
     lineelement.cpp \
     listviewfilter.cpp \
     ListViewTabs.cpp \
@@ -305,6 +323,9 @@ SOURCES = \
     mapview.cpp \
     messagehandler.cpp \
     messagewidget.cpp \
+    NmeaLogger.cpp \
+    NmeaRing.cpp \
+    NmeaSentence.cpp \
     OpenAip.cpp \
     OpenAipPoiLoader.cpp \
     OpenAipLoaderThread.cpp \
@@ -367,6 +388,7 @@ SOURCES = \
     vario.cpp \
     VarioModeDialog.cpp \
     varspinbox.cpp \
+    VirtualClock.cpp \
     vector.cpp \
     waitscreen.cpp \
     waypointcatalog.cpp \
@@ -393,9 +415,12 @@ flarm {
 		           FlarmNet.h \
 		           flarmdisplay.h \
 		           flarmlistview.h \
+		           FlarmTraffic.h \
 		           flarmlogbook.h \
 		           flarmradarview.h \
 		           flarmwidget.h \
+		           RepaintThrottle.h \
+		           ThermalDetector.h \
                preflightflarmpage.h \
                PreflightFlarmUsbPage.h \
                SettingsPageFlarm.h \
@@ -407,9 +432,12 @@ flarm {
 		           FlarmNet.cpp \
 		           flarmdisplay.cpp \
 		           flarmlistview.cpp \
+		           FlarmTraffic.cpp \
                flarmlogbook.cpp \
 		           flarmradarview.cpp \
 		           flarmwidget.cpp \
+		           RepaintThrottle.cpp \
+		           ThermalDetector.cpp \
                preflightflarmpage.cpp \
                PreflightFlarmUsbPage.cpp \
                SettingsPageFlarm.cpp \
@@ -488,7 +516,7 @@ QMAKE_CXXFLAGS += -fno-default-inline \
                   -fno-inline -Wextra \
                   -std=gnu++17
 
-LIBS += -lstdc++
+LIBS += -lstdc++ -lrt -lz
 
 TRANSLATIONS = locale/de/cumulus_de.ts
 
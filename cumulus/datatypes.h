@@ -53,6 +53,7 @@ Q_DECLARE_METATYPE(BtDeviceMap)
 
 #include "airfield.h"
 #include "airspace.h"
+#include "AirspaceStore.h"
 #include "ThermalPoint.h"
 #include "radiopoint.h"
 #include "singlepoint.h"
@@ -87,6 +88,14 @@ typedef QList<Airspace*>* AirspaceListPtr;
 
 Q_DECLARE_METATYPE(AirspaceListPtr)
 
+/**
+ * Special data type to return the mapped compiled airspace files to the GUI
+ * thread.
+ */
+typedef AirspaceStoreList* AirspaceStoreListPtr;
+
+Q_DECLARE_METATYPE(AirspaceStoreListPtr)
+
 //------------------------------------------------------------------------------
 
 #endif // DATA_TYPES_H
@@ -6,7 +6,7 @@
 **
 ************************************************************************
 **
-**   Copyright (c): 2010-2025 Axel Pauli
+**   Copyright (c): 2010-2026 Axel Pauli
 **
 **   This file is distributed under the terms of the General Public
 **   License. See the file COPYING for more information.
@@ -19,12 +19,27 @@
 #include <QtCore>
 
 #include "altitude.h"
+#include "calculator.h"
 #include "flarm.h"
-#include "flarmdisplay.h"
 #include "flarmaliaslist.h"
 #include "generalconfig.h"
+#include "gpsnmea.h"
 #include "layout.h"
 #include "mapconfig.h"
+#include "NmeaSentence.h"
+#include "VirtualClock.h"
+
+// Time in ms, after that a not updated Flarm target is removed. Until then
+// it is extrapolated by the views.
+#define TARGET_EXPIRE FlarmTraffic::MaxExtrapolation
+
+// Time in ms, after that the changed strength and age of the thermal hotspots
+// are published again.
+#define HOTSPOT_INTERVAL 10000
+
+FlarmTraffic           Flarm::m_traffic;
+FlarmTraffic::Snapshot Flarm::m_trafficSnapshot;
+ThermalDetector        Flarm::m_thermals;
 
 Flarm::Flarm(QObject* parent) : QObject(parent), FlarmBase()
 {
@@ -35,6 +50,14 @@ Flarm::Flarm(QObject* parent) : QObject(parent), FlarmBase()
   m_timer = new QTimer( this );
   m_timer->setSingleShot( true );
   connect( m_timer, SIGNAL(timeout()), this, SLOT(slotTimeout()) );
+
+  // Setup timer for the hotspot updates
+  m_hotspotTimer = new QTimer( this );
+  m_hotspotTimer->setSingleShot( true );
+  connect( m_hotspotTimer, SIGNAL(timeout()), this, SLOT(slotHotspotTimeout()) );
+
+  m_repaintThrottle =
+      new RepaintThrottle( this, GeneralConfig::instance()->getFlarmFrameRate() );
 }
 
 Flarm::~Flarm()
@@ -44,11 +67,11 @@ Flarm::~Flarm()
 /**
  * Extracts all items from $PFLAU sentence from Flarm device.
  */
-bool Flarm::extractPflau( const QStringList& stringList )
+bool Flarm::extractPflau( const NmeaSentence& sentence )
 {
   m_flarmStatus.valid = false;
 
-  if ( stringList[0] != "$PFLAU" || stringList.size() < 11 )
+  if ( sentence.id() != "$PFLAU" || sentence.size() < 11 )
     {
       // Checksum has to be ignored in counting.
       qWarning("$PFLAU contains too less parameters!");
@@ -65,7 +88,7 @@ bool Flarm::extractPflau( const QStringList& stringList )
 
   // RX number of received devices
   m_flarmStatus.RX = 0;
-  value = stringList[1].toShort( &ok );
+  value = sentence[1].toInt( &ok );
 
   if( ok )
     {
@@ -74,7 +97,7 @@ bool Flarm::extractPflau( const QStringList& stringList )
 
   // TX Transmission status
   m_flarmStatus.TX = 0;
-  value = stringList[2].toShort( &ok );
+  value = sentence[2].toInt( &ok );
 
   if( ok )
     {
@@ -83,7 +106,7 @@ bool Flarm::extractPflau( const QStringList& stringList )
 
   // GPS status
   m_flarmStatus.Gps = NoFix;
-  value = stringList[3].toShort( &ok );
+  value = sentence[3].toInt( &ok );
 
   if( ok )
     {
@@ -92,7 +115,7 @@ bool Flarm::extractPflau( const QStringList& stringList )
 
   // Power status
   m_flarmStatus.Power = 0;
-  value = stringList[4].toShort( &ok );
+  value = sentence[4].toInt( &ok );
 
   if( ok )
     {
@@ -100,7 +123,7 @@ bool Flarm::extractPflau( const QStringList& stringList )
     }
 
   // AlarmLevel
-  value = stringList[5].toShort( &ok );
+  value = sentence[5].toInt( &ok );
   m_flarmStatus.Alarm = No;
 
   if( ok )
@@ -108,11 +131,16 @@ bool Flarm::extractPflau( const QStringList& stringList )
       m_flarmStatus.Alarm = static_cast<enum AlarmLevel> (value);
     }
 
-  // RelativeBearing
-  m_flarmStatus.RelativeBearing = stringList[6];
+  // RelativeBearing, empty without alarm
+  m_flarmStatus.RelativeBearing = sentence[6].toInt( &ok );
+
+  if( ! ok )
+    {
+      m_flarmStatus.RelativeBearing = INT_MIN;
+    }
 
   // AlarmType
-  value = stringList[7].toShort( &ok );
+  value = sentence[7].toInt( &ok );
   m_flarmStatus.AlarmType = 0;
 
   if( ok )
@@ -121,18 +149,33 @@ bool Flarm::extractPflau( const QStringList& stringList )
     }
 
   // RelativeVertical
-  m_flarmStatus.RelativeVertical = stringList[8];
+  m_flarmStatus.RelativeVertical = sentence[8].toInt( &ok );
+
+  if( ! ok )
+    {
+      m_flarmStatus.RelativeVertical = INT_MIN;
+    }
 
   // RelativeDistance
-  m_flarmStatus.RelativeDistance = stringList[9];
+  m_flarmStatus.RelativeDistance = sentence[9].toInt( &ok );
+
+  if( ! ok )
+    {
+      m_flarmStatus.RelativeDistance = INT_MIN;
+    }
 
   // ID 6-digit hex value
-  m_flarmStatus.ID = stringList[10];
+  m_flarmStatus.ID = sentence[10].toHex( &ok );
+
+  if( ! ok )
+    {
+      m_flarmStatus.ID = NoId;
+    }
 
   m_flarmStatus.valid = true;
 
   if( m_flarmStatus.Alarm != No && m_flarmStatus.AlarmType != 0 &&
-      m_flarmStatus.RelativeBearing.isEmpty() == false &&
+      m_flarmStatus.hasRelativePosition() == true &&
       GeneralConfig::instance()->getPopupFlarmAlarms() == true )
     {
       createTrafficMessage();
@@ -146,9 +189,9 @@ bool Flarm::extractPflau( const QStringList& stringList )
  * PowerFlarms can deliver MODE-S and ADSB data. Sometimes these data are
  * incomplete.
  */
-bool Flarm::extractPflaa( const QStringList& stringList, FlarmAcft& aircraft )
+bool Flarm::extractPflaa( const NmeaSentence& sentence, FlarmAcft& aircraft )
 {
-  if ( stringList[0] != "$PFLAA" || stringList.size() < 12 )
+  if ( sentence.id() != "$PFLAA" || sentence.size() < 12 )
     {
       // Checksum has to be ignored in counting.
       qWarning("$PFLAA contains too less parameters!");
@@ -172,17 +215,17 @@ bool Flarm::extractPflaa( const QStringList& stringList, FlarmAcft& aircraft )
 
   bool ok;
 
-  aircraft.TimeStamp.start();
+  aircraft.TimeStamp = VirtualClock::msecsSinceReference();
 
   // AlarmLevel
-  aircraft.Alarm = static_cast<enum AlarmLevel> (stringList[1].toInt( &ok ));
+  aircraft.Alarm = static_cast<enum AlarmLevel> (sentence[1].toInt( &ok ));
 
   if( ! ok )
     {
       aircraft.Alarm = No;
     }
 
-  aircraft.RelativeNorth = stringList[2].toInt( &ok );
+  aircraft.RelativeNorth = sentence[2].toInt( &ok );
 
   if( ! ok )
     {
@@ -190,7 +233,7 @@ bool Flarm::extractPflaa( const QStringList& stringList, FlarmAcft& aircraft )
       return false;
     }
 
-  aircraft.RelativeEast = stringList[3].toInt( &ok );
+  aircraft.RelativeEast = sentence[3].toInt( &ok );
 
   if( ! ok )
     {
@@ -198,7 +241,7 @@ bool Flarm::extractPflaa( const QStringList& stringList, FlarmAcft& aircraft )
       return false;
     }
 
-  aircraft.RelativeVertical = stringList[4].toInt( &ok );
+  aircraft.RelativeVertical = sentence[4].toInt( &ok );
 
   if( ! ok )
     {
@@ -206,7 +249,7 @@ bool Flarm::extractPflaa( const QStringList& stringList, FlarmAcft& aircraft )
       return false;
     }
 
-  aircraft.IdType = stringList[5].toShort( &ok );
+  aircraft.IdType = sentence[5].toInt( &ok );
 
   if( ! ok )
     {
@@ -214,10 +257,17 @@ bool Flarm::extractPflaa( const QStringList& stringList, FlarmAcft& aircraft )
       return false;
     }
 
-  aircraft.ID = stringList[6];
+  // 6-digit hex value
+  aircraft.ID = sentence[6].toHex( &ok );
+
+  if( ! ok || aircraft.ID > 0xffffff )
+    {
+      aircraft.ID = NoId;
+      return false;
+    }
 
   // 0-359 or INT_MIN in stealth mode
-  aircraft.Track = stringList[7].toInt( &ok );
+  aircraft.Track = sentence[7].toInt( &ok );
 
   if( ! ok )
     {
@@ -225,7 +275,7 @@ bool Flarm::extractPflaa( const QStringList& stringList, FlarmAcft& aircraft )
     }
 
   // degrees per second or INT_MIN in stealth mode
-  aircraft.TurnRate = stringList[8].toDouble( &ok );
+  aircraft.TurnRate = sentence[8].toDouble( &ok );
 
   if( ! ok )
     {
@@ -233,7 +283,7 @@ bool Flarm::extractPflaa( const QStringList& stringList, FlarmAcft& aircraft )
     }
 
   // meters per second or INT_MIN in stealth mode
-  aircraft.GroundSpeed = stringList[9].toDouble( &ok );
+  aircraft.GroundSpeed = sentence[9].toDouble( &ok );
 
   if( ! ok )
     {
@@ -241,40 +291,23 @@ bool Flarm::extractPflaa( const QStringList& stringList, FlarmAcft& aircraft )
     }
 
   // meters per second or INT_MIN in stealth mode
-  aircraft.ClimbRate = stringList[10].toDouble( &ok );
+  aircraft.ClimbRate = sentence[10].toDouble( &ok );
 
   if( ! ok )
     {
       aircraft.ClimbRate = INT_MIN;
     }
 
-  aircraft.AcftType = stringList[11].toShort( &ok );
+  aircraft.AcftType = sentence[11].toInt( &ok );
 
   if( ! ok )
     {
       aircraft.AcftType = 0; // unknown
     }
 
-  // Check, if parsed data should be collected. In this case the data record
-  // is put or updated in the pflaaHash hash dictionary.
-  QString key = createHashKey( aircraft.IdType, aircraft.ID );
-
-  if( m_collectPflaa == true || key == FlarmDisplay::getSelectedObject() ||
-      FlarmAliasList::getAliasShowHash().contains( key ) )
-    {
-      // first check, if record is already contained in the hash.
-      if( m_pflaaHash.contains( key ) == true )
-        {
-          // update entry
-          FlarmAcft& aircraftEntry = m_pflaaHash[key];
-          aircraftEntry = aircraft;
-        }
-      else
-        {
-          // insert new entry
-          m_pflaaHash.insert( key, aircraft );
-        }
-    }
+  // All targets are collected. The table does not allocate memory and the
+  // aircraft type is needed for the traffic messages too.
+  m_traffic.update( aircraft );
 
   return true;
 }
@@ -869,65 +902,35 @@ bool Flarm::extractError(QStringList& stringList)
 
 bool Flarm::getFlarmRelativeBearing( int &relativeBearing )
 {
-  if( ! m_flarmStatus.valid && m_flarmStatus.RelativeBearing.isEmpty() )
+  if( ! m_flarmStatus.valid || m_flarmStatus.RelativeBearing == INT_MIN )
     {
       return false;
     }
 
-  bool ok;
-
-  relativeBearing = m_flarmStatus.RelativeBearing.toInt( &ok );
-
-  if( ok )
-    {
-      return true;
-    }
-  else
-    {
-      return false;
-    }
+  relativeBearing = m_flarmStatus.RelativeBearing;
+  return true;
 }
 
 bool Flarm::getFlarmRelativeVertical( int &relativeVertical )
 {
-  if( ! m_flarmStatus.valid && m_flarmStatus.RelativeVertical.isEmpty() )
+  if( ! m_flarmStatus.valid || m_flarmStatus.RelativeVertical == INT_MIN )
     {
       return false;
     }
 
-  bool ok;
-
-  relativeVertical = m_flarmStatus.RelativeVertical.toInt( &ok );
-
-  if( ok )
-    {
-      return true;
-    }
-  else
-    {
-      return false;
-    }
+  relativeVertical = m_flarmStatus.RelativeVertical;
+  return true;
 }
 
 bool Flarm::getFlarmRelativeDistance( int &relativeDistance )
 {
-  if( ! m_flarmStatus.valid && m_flarmStatus.RelativeDistance.isEmpty() )
+  if( ! m_flarmStatus.valid || m_flarmStatus.RelativeDistance == INT_MIN )
     {
       return false;
     }
 
-  bool ok;
-
-  relativeDistance = m_flarmStatus.RelativeDistance.toInt( &ok );
-
-  if( ok )
-    {
-      return true;
-    }
-  else
-    {
-      return false;
-    }
+  relativeDistance = m_flarmStatus.RelativeDistance;
+  return true;
 }
 
 /**
@@ -935,69 +938,93 @@ bool Flarm::getFlarmRelativeDistance( int &relativeDistance )
  */
 void Flarm::collectPflaaFinished()
 {
-  // Check the hash dictionary for expired data. This old data items have to
-  // be removed. Seems to be the best place, to do it after the end trigger as
-  // to trust that following methods will do that.
-  QMutableHashIterator<QString, Flarm::FlarmAcft> it(m_pflaaHash);
-
-  while( it.hasNext() )
-    {
-      it.next();
+  // Remove the targets, which were not updated for a longer time. Seems to
+  // be the best place, to do it after the end trigger as to trust that
+  // following methods will do that. Then the complete sequence is published
+  // to the views.
+  qint64 now = VirtualClock::msecsSinceReference();
 
-      // Get next aircraft
-      Flarm::FlarmAcft& acft = it.value();
+  m_traffic.expire( now, TARGET_EXPIRE );
+  m_traffic.takeSnapshot( m_trafficSnapshot );
 
-      // Make time expire check, check time unit is in milli seconds.
-      if( acft.TimeStamp.elapsed() > 3000 )
-        {
-          // Object was longer time not updated, so we do remove it from the
-          // hash. No other way available as the time expire check.
-          it.remove();
-        }
+  // The circling targets are only placed on the map with a valid own position.
+  if( GpsNmea::gps->getGpsStatus() == GpsNmea::validFix &&
+      m_thermals.update( m_trafficSnapshot,
+                         calculator->getlastPosition(),
+                         static_cast<int> (calculator->getlastAltitude().getMeters()),
+                         now ) )
+    {
+      publishHotspots();
+    }
+  else if( m_thermals.size() > 0 && m_hotspotTimer->isActive() == false )
+    {
+      m_hotspotTimer->start( HOTSPOT_INTERVAL );
     }
 
   // Start Flarm PFLAA data clearing supervision. There is no other way
   // of solution because the PFLAA sentences are only sent if other
   // aircrafts are in view of the FLARM receiver.
-  m_timer->start( 3000 );
+  m_timer->start( TARGET_EXPIRE );
 
   // Emit signal, if further processing in radar view is required.
   if( Flarm::getCollectPflaa() )
     {
       emit newFlarmPflaaData();
+      m_repaintThrottle->slot_Request();
     }
 }
 
 /** Called if timer has expired. Used for Flarm PFLAA data clearing. */
 void Flarm::slotTimeout()
 {
-  m_pflaaHash.clear();
+  m_traffic.clear();
+  m_trafficSnapshot.clear();
 
   // Emit signal, if further processing in radar view is required.
   if( Flarm::getCollectPflaa() )
     {
       emit flarmPflaaDataTimeout();
+      m_repaintThrottle->slot_Request();
     }
 }
 
-void Flarm::createTrafficMessage()
+/** Called if the hotspot timer has expired. */
+void Flarm::slotHotspotTimeout()
 {
-  bool ok;
+  // The hotspots expire also without further Flarm traffic.
+  m_thermals.expire( VirtualClock::msecsSinceReference() );
+  publishHotspots();
+}
+
+void Flarm::publishHotspots()
+{
+  m_hotspotTimer->stop();
+
+  emit flarmHotspotInfo( m_thermals );
 
+  // Strength and age of the hotspots are changing, publish them regularly.
+  if( m_thermals.size() > 0 )
+    {
+      m_hotspotTimer->start( HOTSPOT_INTERVAL );
+    }
+}
+
+void Flarm::createTrafficMessage()
+{
   if( m_flarmStatus.AlarmType >= 0x10 && m_flarmStatus.AlarmType <= 0xff )
     {
       // Alert Zone Alarm. Handled as airspace.
       return;
     }
 
-  int dir = m_flarmStatus.RelativeBearing.toInt(&ok);
-  const int SD = Layout::getIntScaledDensity();
-
-  if( ! ok )
+  if( m_flarmStatus.hasRelativePosition() == false )
     {
       return;
     }
 
+  int dir = m_flarmStatus.RelativeBearing;
+  const int SD = Layout::getIntScaledDensity();
+
   if( dir < 0 )
     {
       dir += 360;
@@ -1014,19 +1041,8 @@ void Flarm::createTrafficMessage()
   // Traffic angle for arrow picture
   int ta = (dir == 12) ? 0 : dir * 30;
 
-  int rvert = m_flarmStatus.RelativeVertical.toInt(&ok);
-
-  if( ! ok )
-    {
-      return;
-    }
-
-  int rdist = m_flarmStatus.RelativeDistance.toInt(&ok);
-
-  if( ! ok )
-    {
-      return;
-    }
+  int rvert = m_flarmStatus.RelativeVertical;
+  int rdist = m_flarmStatus.RelativeDistance;
 
   QString rverts = (rvert > 0) ? "+" : "";
   QString arrowVertical;
@@ -1072,11 +1088,11 @@ void Flarm::createTrafficMessage()
   QString acftType;
 
   // Check, if additional information of aircraft type is available
-  if( m_pflaaHash.contains( m_flarmStatus.ID ) == true )
-    {
-      FlarmAcft& aircraftEntry = m_pflaaHash[m_flarmStatus.ID];
+  const FlarmTraffic::Target* target = m_traffic.find( m_flarmStatus.ID );
 
-      acftType = FlarmBase::translateAcftType( aircraftEntry.AcftType );
+  if( target != 0 )
+    {
+      acftType = FlarmBase::translateAcftType( target->acft().AcftType );
     }
 
   // Load an arrow pixmap to show the traffic direction more in detail.
@@ -1107,7 +1123,7 @@ void Flarm::createTrafficMessage()
           "<td align=right>" + Altitude::getText( rdist, true, 0 ) + "</td></tr>";
 
   // If an alias is known, it is added to the table
-  QString alias = FlarmAliasList::getAliasHash().value( m_flarmStatus.ID ).first;
+  QString alias = FlarmAliasList::getAliasHash().value( idToString( m_flarmStatus.ID ) ).first;
 
   if( alias.isEmpty() == false )
     {
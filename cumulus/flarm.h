@@ -6,7 +6,7 @@
 **
 ************************************************************************
 **
-**   Copyright (c): 2010-2021 Axel Pauli
+**   Copyright (c): 2010-2026 Axel Pauli
 **
 **   This file is distributed under the terms of the General Public
 **   License. See the file COPYING for more information.
@@ -22,9 +22,9 @@
  *
  * This class parses Flarm sentences and provides the results to the caller.
  *
- * \date 2010-2021
+ * \date 2010-2026
  *
- * \version 1.5
+ * \version 1.6
  */
 
 #ifndef FLARM_H
@@ -35,7 +35,11 @@
 #include <QTime>
 
 #include "flarmbase.h"
+#include "FlarmTraffic.h"
+#include "RepaintThrottle.h"
+#include "ThermalDetector.h"
 
+class NmeaSentence;
 class QPoint;
 class QStringList;
 class QTimer;
@@ -67,6 +71,43 @@ class Flarm : public QObject, public FlarmBase
     return &instance;
   };
 
+  /**
+   * @return The Flarm targets of the last complete PFLAA sequence. All views
+   * read this snapshot, so they show the same state.
+   */
+  static const FlarmTraffic::Snapshot& getTraffic()
+  {
+    return m_trafficSnapshot;
+  };
+
+  /**
+   * @return The throttle, which coalesces the updates of the Flarm views.
+   * Its frames are requested, if new traffic data are available.
+   */
+  RepaintThrottle* getRepaintThrottle() const
+  {
+    return m_repaintThrottle;
+  };
+
+  /**
+   * @return The thermal hotspots found by circling Flarm targets.
+   */
+  static const ThermalDetector& getThermals()
+  {
+    return m_thermals;
+  };
+
+  /**
+   * Resets the internal stored Flarm data.
+   */
+  static void reset()
+  {
+    m_traffic.clear();
+    m_trafficSnapshot.clear();
+    m_thermals.clear();
+    FlarmBase::reset();
+  };
+
   /**
    * @param relativeBearing returns the relative bearing in degree from the
    * own position as integer -180...+180.
@@ -91,19 +132,19 @@ class Flarm : public QObject, public FlarmBase
 
   /**
    * Extracts all items from the $PFLAU sentence sent by the Flarm device.
-   * @param stringList Flarm sentence $PFLAU as string list
+   * @param sentence Flarm sentence $PFLAU split into fields
    * @return true if a valid value exists otherwise false
    */
-  bool extractPflau(const QStringList& stringList);
+  bool extractPflau( const NmeaSentence& sentence );
 
   /**
    * Extracts all items from the $PFLAA sentence sent by the Flarm device.
    *
-   * @param stringList Flarm sentence $PFLAA as string list
+   * @param sentence Flarm sentence $PFLAA split into fields
    * @param aircraft extracted aircraft data from sentence
    * @return true if a valid value exists otherwise false
    */
-  bool extractPflaa( const QStringList& stringList, FlarmAcft& aircraft );
+  bool extractPflaa( const NmeaSentence& sentence, FlarmAcft& aircraft );
 
   /**
    * Extracts all items from the $PFLAV sentence sent by the Flarm device.
@@ -199,6 +240,12 @@ class Flarm : public QObject, public FlarmBase
    */
   void flarmPflaaDataTimeout();
 
+  /**
+   * This signal is emitted, if the thermal hotspots found by circling Flarm
+   * targets have been changed.
+   */
+  void flarmHotspotInfo( const ThermalDetector& thermals );
+
   /**
    * This signal is emitted if a new Flarm error info is available.
    */
@@ -249,10 +296,31 @@ class Flarm : public QObject, public FlarmBase
   /** Called if m_timer has expired. Used for Flarm data clearing. */
   void slotTimeout();
 
+  /** Called if m_hotspotTimer has expired. Used for hotspot updates. */
+  void slotHotspotTimeout();
+
  private:
 
+  /** Publishes the thermal hotspots. */
+  void publishHotspots();
+
   /** Timer for data clearing. */
   QTimer* m_timer;
+
+  /** Timer for the periodic update of the thermal hotspots. */
+  QTimer* m_hotspotTimer;
+
+  /** Frames for the views of the Flarm traffic. */
+  RepaintThrottle* m_repaintThrottle;
+
+  /** Targets collected from the PFLAA sentences. */
+  static FlarmTraffic m_traffic;
+
+  /** Snapshot of m_traffic taken at the end of a PFLAA sequence. */
+  static FlarmTraffic::Snapshot m_trafficSnapshot;
+
+  /** Thermal hotspots found by circling targets. */
+  static ThermalDetector m_thermals;
 };
 
 #endif /* FLARM_H */
@@ -6,7 +6,7 @@
 **
 ************************************************************************
 **
-**   Copyright (c): 2010-2023 Axel Pauli
+**   Copyright (c): 2010-2026 Axel Pauli
 **
 **   This file is distributed under the terms of the General Public
 **   License. See the file COPYING for more information.
@@ -25,8 +25,6 @@ FlarmBase::FlarmData    FlarmBase::m_flarmData;
 FlarmBase::FlarmError   FlarmBase::m_flarmError;
 FlarmBase::ProtocolMode FlarmBase::m_protocolMode = text;
 
-QHash<QString, FlarmBase::FlarmAcft>      FlarmBase::m_pflaaHash;
-
 QMutex FlarmBase::m_mutex;
 
 FlarmBase::FlarmBase()
@@ -6,7 +6,7 @@
 **
 ************************************************************************
 **
-**   Copyright (c): 2010-2023 Axel Pauli
+**   Copyright (c): 2010-2026 Axel Pauli
 **
 **   This file is distributed under the terms of the General Public
 **   License. See the file COPYING for more information.
@@ -22,13 +22,15 @@
  *
  * This is the base Flarm class containing static methods and data definitions.
  *
- * \date 2010-2023
+ * \date 2010-2026
  *
- * \version 1.13
+ * \version 1.14
  */
 
 #pragma once
 
+#include <climits>
+
 #include <QDateTime>
 #include <QElapsedTimer>
 #include <QHash>
@@ -48,6 +50,11 @@ class FlarmBase
 
   virtual ~FlarmBase();
 
+  /**
+   * Value of an unknown Flarm ID. Flarm IDs have 24 bits.
+   */
+  static const uint NoId = 0xffffffff;
+
   /**
    * FLARM Alarm Level definitions.
    */
@@ -97,11 +104,11 @@ class FlarmBase
     enum    GpsStatus Gps;
     short   Power;
     enum AlarmLevel Alarm;
-    QString RelativeBearing;  // can be empty
+    int     RelativeBearing;  // INT_MIN, if empty
     short   AlarmType;
-    QString RelativeVertical; // can be empty
-    QString RelativeDistance; // can be empty
-    QString ID;               // can be empty
+    int     RelativeVertical; // INT_MIN, if empty
+    int     RelativeDistance; // INT_MIN, if empty
+    uint    ID;               // NoId, if empty
 
     FlarmStatus() :
       valid(false),
@@ -110,7 +117,11 @@ class FlarmBase
       Gps(NoFix),
       Power(0),
       Alarm(No),
-      AlarmType(0)
+      RelativeBearing(INT_MIN),
+      AlarmType(0),
+      RelativeVertical(INT_MIN),
+      RelativeDistance(INT_MIN),
+      ID(NoId)
     {};
 
     void reset()
@@ -121,12 +132,23 @@ class FlarmBase
       Gps = NoFix;
       Power = 0;
       Alarm = No;
-      RelativeBearing.clear();
+      RelativeBearing = INT_MIN;
       AlarmType = 0;
-      RelativeVertical.clear();
-      RelativeDistance.clear();
-      ID.clear();
+      RelativeVertical = INT_MIN;
+      RelativeDistance = INT_MIN;
+      ID = NoId;
     }
+
+    /**
+     * \return True, if the relative position of the most relevant object
+     * is reported.
+     */
+    bool hasRelativePosition() const
+    {
+      return RelativeBearing != INT_MIN && RelativeVertical != INT_MIN &&
+             RelativeDistance != INT_MIN;
+    }
+
     /**
      * This flag handles the validity of the structure data.
      *
@@ -291,22 +313,37 @@ class FlarmBase
    *
    * FLARM aircraft data structure. It contains the data of a PFLAA sentence.
    *
-   * \date 2010
+   * \date 2010-2026
    */
   struct FlarmAcft
   {
-    QElapsedTimer TimeStamp;  // Creation time of this structure
+    qint64  TimeStamp;   // Creation time in ms of the virtual clock
     enum AlarmLevel Alarm;
     int     RelativeNorth;
     int     RelativeEast;
     int     RelativeVertical;
     short   IdType;
-    QString ID;
+    uint    ID;          // 24-bit Flarm ID
     int     Track;       // 0-359 or INT_MIN in stealth mode
     double  TurnRate;    // degrees per second or INT_MIN in stealth mode
     double  GroundSpeed; // meters per second or INT_MIN in stealth mode
     double  ClimbRate;   // meters per second or INT_MIN in stealth mode
     short   AcftType;
+
+    FlarmAcft() :
+      TimeStamp(0),
+      Alarm(No),
+      RelativeNorth(0),
+      RelativeEast(0),
+      RelativeVertical(0),
+      IdType(0),
+      ID(NoId),
+      Track(INT_MIN),
+      TurnRate(INT_MIN),
+      GroundSpeed(INT_MIN),
+      ClimbRate(INT_MIN),
+      AcftType(0)
+    {};
   };
 
   /**
@@ -363,21 +400,13 @@ class FlarmBase
     }
 
     /**
-     * Check activity limit, if it has expired.
+     * Check activity limit, if it has expired. The limit is compared with
+     * the virtual clock, so that replayed zones are valid at their fix time.
+     * Defined in airspace.cpp, the virtual clock is not part of gpsClient.
      *
      * \return true when active otherwise false
      */
-    bool isActive()
-    {
-      quint64 secondsUtc = static_cast<quint64> (QDateTime::currentMSecsSinceEpoch() / 1000);
-
-      if( ActivityLimit > 0 && ActivityLimit < secondsUtc )
-        {
-          return false;
-        }
-
-      return true;
-    }
+    bool isActive() const;
   };
 
   /**
@@ -436,11 +465,34 @@ class FlarmBase
   };
 
   /**
-   * @return the m_pflaaHash to the caller.
+   * Converts a Flarm ID into the 6-digit hex string, which is used as key
+   * of the alias list and of the object selection.
+   *
+   * @param id 24-bit Flarm ID
+   * @return The ID as upper case hex string or an empty string for NoId.
    */
-  static const QHash<QString, FlarmAcft>& getPflaaHash()
+  static QString idToString( const uint id )
   {
-    return m_pflaaHash;
+    if( id == NoId )
+      {
+        return QString();
+      }
+
+    return QString( "%1" ).arg( id, 6, 16, QChar('0') ).toUpper();
+  };
+
+  /**
+   * Converts a hex string into a Flarm ID.
+   *
+   * @param id 6-digit hex string
+   * @return The 24-bit Flarm ID or NoId, if the string is not a hex number.
+   */
+  static uint idFromString( const QString& id )
+  {
+    bool ok;
+    uint value = id.toUInt( &ok, 16 );
+
+    return ok ? value : NoId;
   };
 
   /**
@@ -448,7 +500,6 @@ class FlarmBase
    */
   static void reset()
   {
-    m_pflaaHash.clear();
     m_flarmStatus.reset();
     m_flarmData.reset();
     m_flarmError.reset();
@@ -530,12 +581,6 @@ class FlarmBase
   /** Flag to switch on the collecting of PFLAA data. */
   static bool m_collectPflaa;
 
-  /**
-   * Hash map with collected PFLAA records. The key is a concatenation of
-   * the Flarm tags 'ID-Type' and 'ID'.
-   */
-  static QHash<QString, FlarmAcft> m_pflaaHash;
-
   /** Flarm protocol mode.  */
   static enum ProtocolMode m_protocolMode;
 
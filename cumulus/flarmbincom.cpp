@@ -6,7 +6,7 @@
 **
 ************************************************************************
 **
-**   Copyright (c):  2012-2015 by Axel Pauli (kflog.cumulus@gmail.com)
+**   Copyright (c):  2012-2026 by Axel Pauli (kflog.cumulus@gmail.com)
 **
 **   This program is free software; you can redistribute it and/or modify
 **   it under the terms of the GNU General Public License as published by
@@ -48,7 +48,11 @@ bool FlarmBinCom::ping()
   m.hdr.type = FRAME_PING;
   m.hdr.length = HDR_LENGTH;
   m.hdr.version = 0x01;
-  sendMsg(&m);
+
+  if( sendMsg(&m) == false )
+    {
+      return false;
+    }
 
   if(rcvMsg(&m, TimeoutPing) == false)
     {
@@ -75,7 +79,11 @@ bool FlarmBinCom::exit()
   m.hdr.type = FRAME_EXIT;
   m.hdr.length = HDR_LENGTH;
   m.hdr.version = 0x01;
-  sendMsg(&m);
+
+  if( sendMsg(&m) == false )
+    {
+      return false;
+    }
 
   if (rcvMsg(&m, TimeoutExit) == false)
     {
@@ -97,7 +105,11 @@ bool FlarmBinCom::setBaudRate( const int nSpeedKey )
   m.hdr.length = HDR_LENGTH + 1;
   m.hdr.version = 0x01;
   m.data[0] = nSpeedKey;
-  sendMsg(&m);
+
+  if( sendMsg(&m) == false )
+    {
+      return false;
+    }
 
   if (rcvMsg(&m, TimeoutNormal) == false)
     {
@@ -119,7 +131,11 @@ bool FlarmBinCom::selectRecord( const int nRecord )
   m.hdr.length = HDR_LENGTH + 1;
   m.hdr.version = 0x01;
   m.data[0] = nRecord;
-  sendMsg(&m);
+
+  if( sendMsg(&m) == false )
+    {
+      return false;
+    }
 
   if (rcvMsg(&m, TimeoutNormal) == false)
     {
@@ -140,7 +156,11 @@ bool FlarmBinCom::getRecordInfo( char* sData )
   m.hdr.type = FRAME_GETRECORDINFO;
   m.hdr.length = HDR_LENGTH;
   m.hdr.version = 0x01;
-  sendMsg(&m);
+
+  if( sendMsg(&m) == false )
+    {
+      return false;
+    }
 
   if (rcvMsg(&m, TimeoutNormal) == false)
     {
@@ -165,7 +185,11 @@ bool FlarmBinCom::getIGCData( char* sData, int* progress)
   m.hdr.type = FRAME_GETIGCDATA;
   m.hdr.length = HDR_LENGTH;
   m.hdr.version = 0x01;
-  sendMsg(&m);
+
+  if( sendMsg(&m) == false )
+    {
+      return false;
+    }
 
   if (rcvMsg(&m, TimeoutNormal) == false)
     {
@@ -237,20 +261,24 @@ bool FlarmBinCom::sendMsg( Message* mMsg)
   qDebug() << "S:" << dump;
 #endif
 
-  // send the stuff
-  writeChar(STARTFRAME);
+  // Escape the whole frame into a buffer, which is written as one block.
+  // Every character can be doubled by the escaping.
+  unsigned char frame[1 + 2 * (HDR_LENGTH + MAXSIZE)];
+  int length = 0;
+
+  frame[length++] = STARTFRAME;
 
   for (int i = 0; i < HDR_LENGTH; i++)
     {
-      send(header[i]);
+      length += escape(header[i], &frame[length]);
     }
 
   for (int i = 0; i < mMsg->hdr.length - HDR_LENGTH; i++)
     {
-      send(mMsg->data[i]);
+      length += escape(mMsg->data[i], &frame[length]);
     }
 
-  return false;
+  return writeData(frame, length) == length;
 }
 
 bool FlarmBinCom::rcvMsg( Message* mMsg, const int timeout )
@@ -287,10 +315,12 @@ bool FlarmBinCom::rcvMsg( Message* mMsg, const int timeout )
   mMsg->hdr.type = hdr[5];
   mMsg->hdr.crc = hdr[6] + (hdr[7] << 8);
 
-  if( (mMsg->hdr.length - HDR_LENGTH) > MAXSIZE )
+  if( mMsg->hdr.length < HDR_LENGTH ||
+      (mMsg->hdr.length - HDR_LENGTH) > MAXSIZE )
     {
       qWarning() << "FlarmBinCom::rcvMsg() buffer overflow! bs="
                   << MAXSIZE << "ds=" << (mMsg->hdr.length - HDR_LENGTH);
+      return false;
     }
 
   // receive payload
@@ -364,24 +394,37 @@ bool FlarmBinCom::rcv( unsigned char* b, const int timeout )
   return true;
 }
 
-void  FlarmBinCom::send( const unsigned char c)
+int FlarmBinCom::escape( const unsigned char c, unsigned char* out )
 {
   switch( c )
     {
       case STARTFRAME:
-        writeChar(ESCAPE);
-        writeChar(ESC_START);
-        break;
+        out[0] = ESCAPE;
+        out[1] = ESC_START;
+        return 2;
       case ESCAPE:
-        writeChar(ESCAPE);
-        writeChar(ESC_ESC);
-        break;
+        out[0] = ESCAPE;
+        out[1] = ESC_ESC;
+        return 2;
       default:
-        writeChar(c);
-        break;
+        out[0] = c;
+        return 1;
      }
 }
 
+int FlarmBinCom::writeData( const unsigned char* data, const int length )
+{
+  for( int i = 0; i < length; i++ )
+    {
+      if( writeChar(data[i]) <= 0 )
+        {
+          return -1;
+        }
+    }
+
+  return length;
+}
+
 /**
  * CRC computation. Length information in header must be correct!
  */
@@ -6,7 +6,7 @@
 **
 ************************************************************************
 **
-**   Copyright (c):  2012-2015 by Axel Pauli (kflog.cumulus@gmail.com)
+**   Copyright (c):  2012-2026 by Axel Pauli (kflog.cumulus@gmail.com)
 **
 **   This program is free software; you can redistribute it and/or modify
 **   it under the terms of the GNU General Public License as published by
@@ -25,11 +25,13 @@
  *
  * \author Flarm Technology GmbH, Axel Pauli
  *
- * \date 2012-2015
+ * \date 2012-2026
  *
  * \brief Flarm binary communication interface.
  *
- * \version 1.1
+ * A frame is escaped into a buffer and handed over as one block to the port.
+ *
+ * \version 1.2
  *
  */
 
@@ -72,6 +74,8 @@
 #define SPEED_19200         0x02
 #define SPEED_38400         0x04
 #define SPEED_57600         0x05
+#define SPEED_115200        0x06
+#define SPEED_230400        0x07
 
 typedef struct {
   unsigned short      length;      // 16 bit
@@ -114,6 +118,11 @@ class FlarmBinCom
    * 0: 4800 bps
    * ...
    * 5: 57600 bps
+   * 6: 115200 bps
+   * 7: 230400 bps
+   *
+   * The Flarm switches to the new rate after its acknowledge. A rate, which
+   * is not supported by the Flarm, is rejected.
    */
   bool setBaudRate( const int nSpeedKey );
 
@@ -149,6 +158,14 @@ class FlarmBinCom
   /** Low level read character port method. Must be implemented by the user. */
   virtual int readChar(unsigned char* b, const int timeout) = 0;
 
+  /**
+   * Low level write block port method. The default implementation writes
+   * the block character by character.
+   *
+   * \return The number of written characters or -1 in error case.
+   */
+  virtual int writeData(const unsigned char* data, const int length);
+
  private:
 
   /** Sends a message to the Flarm. */
@@ -157,8 +174,12 @@ class FlarmBinCom
   /** Receives a message from the Flarm. */
   bool rcvMsg(Message* mMsg, const int timeout);
 
-  /** Sends a character in escape mode.*/
-  void send(const unsigned char c);
+  /**
+   * Escapes a character into out, which must have space for two characters.
+   *
+   * \return The number of characters put into out.
+   */
+  int escape(const unsigned char c, unsigned char* out);
 
   /** Gets a character in escape mode.*/
   bool rcv(unsigned char* b, const int timeout);
@@ -6,7 +6,7 @@
 **
 ************************************************************************
 **
-**   Copyright (c):  2012-2021 by Axel Pauli (kflog.cumulus@gmail.com)
+**   Copyright (c):  2012-2026 by Axel Pauli (kflog.cumulus@gmail.com)
 **
 **   This program is free software; you can redistribute it and/or modify
 **   it under the terms of the GNU General Public License as published by
@@ -22,6 +22,7 @@
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/ioctl.h>
+#include <termios.h>
 
 #include <QtGui>
 
@@ -31,7 +32,9 @@
 
 FlarmBinComLinux::FlarmBinComLinux( int socket ) :
   FlarmBinCom(),
-  m_Socket(socket)
+  m_Socket(socket),
+  m_BufferPos(0),
+  m_BufferEnd(0)
 {
 }
 
@@ -41,83 +44,135 @@ FlarmBinComLinux::~FlarmBinComLinux()
 
 int FlarmBinComLinux::writeChar(const unsigned char c)
 {
-  int done = -1;
+  return writeData( &c, 1 );
+}
 
+int FlarmBinComLinux::writeData(const unsigned char* data, const int length)
+{
 #ifdef DEBUG
-  qDebug("%02X ", c);
+  for( int i = 0; i < length; i++ )
+    {
+      qDebug("%02X ", data[i]);
+    }
 #endif
 
-  while(true)
+  int written = 0;
+
+  while( written < length )
     {
-      done = write( m_Socket, &c, sizeof(c) );
+      int done = write( m_Socket, data + written, length - written );
+
+      if( done > 0 )
+        {
+          written += done;
+          continue;
+        }
 
-      if( done < 0 )
+      if( done < 0 && errno == EINTR )
         {
-          if ( errno == EINTR )
-            {
-              continue; // Ignore interrupts
-            }
+          continue; // Ignore interrupts
+        }
 
-          qDebug() << "FlarmBinComLinux::writeCharErr" << errno << strerror(errno);
+      if( done < 0 && errno != EWOULDBLOCK )
+        {
+          qDebug() << "FlarmBinComLinux::writeDataErr" << errno << strerror(errno);
+          return -1;
         }
 
-      break;
+      // The output buffer of the port is full, wait until there is space.
+      if( waitFor( false, 1000 ) <= 0 )
+        {
+          return -1;
+        }
     }
 
-  return done;
+  return written;
 }
 
 int FlarmBinComLinux::readChar(unsigned char* b, const int timeout)
 {
-  // Note, non blocking IO is set on our file descriptor.
-  int done = read( m_Socket, b, sizeof(unsigned char) );
-
-  if( done > 0 )
+  while( m_BufferPos == m_BufferEnd )
     {
-#ifdef DEBUG
-      qDebug("%02X ", *b);
-#endif
-      return true;
-    }
+      // Note, non blocking IO is set on our file descriptor. All available
+      // data are taken with one read call.
+      int done = read( m_Socket, m_Buffer, BufferSize );
 
-  if( done == 0 || (done == -1 && errno != EWOULDBLOCK) )
-    {
-      qDebug() << "FlarmBinComLinux::readCharErr" << errno << strerror(errno);
-      return false;
+      if( done > 0 )
+        {
+          m_BufferPos = 0;
+          m_BufferEnd = done;
+          break;
+        }
+
+      if( done == -1 && errno == EINTR )
+        {
+          continue;
+        }
+
+      if( done == 0 || (done == -1 && errno != EWOULDBLOCK) )
+        {
+          qDebug() << "FlarmBinComLinux::readCharErr" << errno << strerror(errno);
+          return -1;
+        }
+
+      // No data available, wait for it until timeout
+      done = waitFor( true, timeout );
+
+      if( done <= 0 )
+        {
+          // done = 0  -> Timeout, done = -1 -> Error
+          return done;
+        }
     }
 
-  // No data available, wait for it until timeout
-  int maxFds = getdtablesize();
+  *b = m_Buffer[m_BufferPos++];
+
+#ifdef DEBUG
+  qDebug("%02X ", *b);
+#endif
+
+  return 1;
+}
 
-  fd_set readFds;
-  FD_ZERO( &readFds );
-  FD_SET( m_Socket, &readFds );
+int FlarmBinComLinux::waitFor(const bool forRead, const int timeout)
+{
+  fd_set fds;
+  FD_ZERO( &fds );
+  FD_SET( m_Socket, &fds );
 
   struct timeval timerInterval;
   timerInterval.tv_sec  = timeout / 1000;
   timerInterval.tv_usec = (timeout % 1000) * 1000;
 
-  done = select( maxFds, &readFds, (fd_set *) 0, (fd_set *) 0, &timerInterval );
+  int done = select( m_Socket + 1,
+                     forRead ? &fds : (fd_set *) 0,
+                     forRead ? (fd_set *) 0 : &fds,
+                     (fd_set *) 0,
+                     &timerInterval );
 
   if( done == 0 )
     {
-      qDebug() << "FlarmBinComLinux::readChar: select() Timeout" << timeout/1000 << "s";
-      // done = 0  -> Timeout
-      return done;
+      qDebug() << "FlarmBinComLinux::waitFor: select() Timeout" << timeout/1000 << "s";
     }
-
-  if( done < 0 )
+  else if( done < 0 )
     {
-      qWarning() << "FlarmBinComLinux::readChar: select() Err" << errno << strerror(errno);
-      // done = -1 -> Error
-      return done;
+      qWarning() << "FlarmBinComLinux::waitFor: select() Err" << errno << strerror(errno);
     }
 
-  done = read( m_Socket, b, sizeof(unsigned char) );
+  return done;
+}
 
-#ifdef DEBUG
-  qDebug("%02X ", *b);
-#endif
+void FlarmBinComLinux::discardInput()
+{
+  m_BufferPos = m_BufferEnd = 0;
 
-  return done;
+  if( isatty( m_Socket ) )
+    {
+      tcflush( m_Socket, TCIFLUSH );
+      return;
+    }
+
+  // Read out all pending data of a socket.
+  while( read( m_Socket, m_Buffer, BufferSize ) > 0 )
+    ;
 }
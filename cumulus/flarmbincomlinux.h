@@ -6,7 +6,7 @@
 **
 ************************************************************************
 **
-**   Copyright (c):  2012-2015 by Axel Pauli (kflog.cumulus@gmail.com)
+**   Copyright (c):  2012-2026 by Axel Pauli (kflog.cumulus@gmail.com)
 **
 **   This program is free software; you can redistribute it and/or modify
 **   it under the terms of the GNU General Public License as published by
@@ -25,11 +25,14 @@
  *
  * \author Axel Pauli
  *
- * \date 2012-2015
+ * \date 2012-2026
  *
  * \brief Flarm binary low level port routines for Linux.
  *
- * \version 1.1
+ * The received data are read in blocks into a buffer, from which the
+ * characters are taken. A frame is written with one system call.
+ *
+ * \version 1.2
  *
  */
 
@@ -46,6 +49,12 @@ class FlarmBinComLinux : public FlarmBinCom
 
   virtual ~FlarmBinComLinux();
 
+  /**
+   * Discards all buffered and pending input data. Should be called after a
+   * broken transfer, before the communication is started again.
+   */
+  void discardInput();
+
  protected:
 
   /** Low level write character port method. */
@@ -62,10 +71,28 @@ class FlarmBinComLinux : public FlarmBinCom
    */
   virtual int readChar(unsigned char* b, const int timeout);
 
+  /** Low level write block port method. */
+  virtual int writeData(const unsigned char* data, const int length);
+
  private:
 
+  /**
+   * Waits until the socket is ready for reading or writing.
+   *
+   * \return 0 means timeout, -1 means error, 1 means ok
+   */
+  int waitFor(const bool forRead, const int timeout);
+
   /** Socket to Flarm device. */
   int m_Socket;
+
+  /** Size of the receive buffer */
+  static const int BufferSize = 4096;
+
+  /** Receive buffer and the range of the not yet taken characters */
+  unsigned char m_Buffer[BufferSize];
+  int m_BufferPos;
+  int m_BufferEnd;
 };
 
 #endif /* FLARM_BIN_COM_LINUX_H_ */
@@ -6,7 +6,7 @@
 **
 ************************************************************************
 **
-**   Copyright (c): 2010-2023 Axel Pauli
+**   Copyright (c): 2010-2026 Axel Pauli
 **
 **   This file is distributed under the terms of the General Public
 **   License. See the file COPYING for more information.
@@ -28,6 +28,7 @@
 #include "mapconfig.h"
 #include "speed.h"
 #include "vector.h"
+#include "VirtualClock.h"
 
 // Initialize static variables
 enum FlarmDisplay::Zoom FlarmDisplay::zoomLevel = FlarmDisplay::Low;
@@ -44,9 +45,10 @@ FlarmDisplay::FlarmDisplay( QWidget *parent ) :
   radius(0),
   updateInterval(1)
 {
-  updateTimer = new QTimer();
-  connect( updateTimer, SIGNAL(timeout()), SLOT(slot_UpdateDisplay()) );
-  updateTimer->start((updateInterval * 1000));
+  // All redraws are coalesced into the frames of the Flarm views. There is
+  // no own timer, a paint event with objects requests the next frame.
+  connect( Flarm::instance()->getRepaintThrottle(), SIGNAL(frame()),
+           SLOT(slot_UpdateDisplay()) );
 }
 
 FlarmDisplay::~FlarmDisplay()
@@ -204,26 +206,14 @@ void FlarmDisplay::slot_SwitchZoom( enum Zoom value )
 /** Update display */
 void FlarmDisplay::slot_UpdateDisplay()
 {
-  static QElapsedTimer lastDisplay;
-
   // Widget is hidden
   if( isVisible() == false )
     {
       return;
     }
 
-  // The display is updated every 1 seconds only.
-  // That will reduce the X-Server load.
-  if( lastDisplay.isValid() &&
-      lastDisplay.elapsed() < ((updateInterval * 1000) - 100) )
-    {
-      return;
-    }
-
-  lastDisplay.start();
-
-  // Generate a paint event for this widget, if it is visible.
-  repaint();
+  // Schedule a paint event, several updates are merged by Qt.
+  update();
 }
 
 /** Reset display to background. */
@@ -323,7 +313,7 @@ void FlarmDisplay::paintEvent( QPaintEvent *event )
   painter.drawPixmap( rect(), background );
 
   // Here starts the Flarm object analysis and drawing
-  QHash<QString, Flarm::FlarmAcft> flarmAcfts = Flarm::getPflaaHash();
+  const FlarmTraffic::Snapshot& traffic = Flarm::getTraffic();
 
   Vector& wind = calculator->getLastStoredWind();
 
@@ -367,7 +357,7 @@ void FlarmDisplay::paintEvent( QPaintEvent *event )
       painter.drawLine( centerX, centerY, centerX + xr, centerY + yr );
       painter.drawLine( centerX, centerY, centerX + xl, centerY + yl );
     }
-  else if( flarmAcfts.size() == 0 )
+  else if( traffic.size() == 0 )
     {
       // Drawing of wind is false and no Flarm objects are avaialable -> Return.
       // qDebug() << "FlarmDisplay::paintEvent: empty hash";
@@ -383,14 +373,17 @@ void FlarmDisplay::paintEvent( QPaintEvent *event )
 
   objectHash.clear();
 
-  QMutableHashIterator<QString, Flarm::FlarmAcft> it(flarmAcfts);
+  // All objects are extrapolated to the same time.
+  const qint64 now = VirtualClock::msecsSinceReference();
 
-  while( it.hasNext() )
+  for( int i = 0; i < traffic.size(); i++ )
     {
-      it.next();
-
-      // Get next aircraft
-      Flarm::FlarmAcft& acft = it.value();
+      // Get next aircraft at its extrapolated position
+      const FlarmTraffic::Target& target = traffic.at(i);
+      Flarm::FlarmAcft acft;
+      double uncertainty = target.extrapolate( now, acft );
+      bool coasting = target.isCoasting( now );
+      const QString key = Flarm::idToString( acft.ID );
 
       int north = acft.RelativeNorth;
       int east  = acft.RelativeEast;
@@ -495,7 +488,7 @@ void FlarmDisplay::paintEvent( QPaintEvent *event )
 
       QPen pen( Qt::black );
 
-      if( it.key() == selectedObject )
+      if( key == selectedObject )
         {
           // If a Flarm object is selected, we use another border color
           pen.setColor( Qt::magenta );
@@ -537,7 +530,7 @@ void FlarmDisplay::paintEvent( QPaintEvent *event )
           MapConfig::createSquare( object, is, color, 1.0, pen );
         }
 
-      if( it.key() == selectedObject )
+      if( key == selectedObject )
         {
           // If a Flarm object is selected, we draw some additional information
           QFont f = painter.font();
@@ -551,6 +544,18 @@ void FlarmDisplay::paintEvent( QPaintEvent *event )
           pen.setWidth( 4 * Layout::getIntScaledDensity() );
           painter.setPen( pen );
 
+          // Draw the track history of the selected object as dots.
+          for( int j = 1; j < target.trackSize(); j++ )
+            {
+              const FlarmTraffic::TrackPoint& tp = target.trackPoint( j );
+              QPoint point;
+
+              if( mapToScreen( tp.RelativeNorth, tp.RelativeEast, point ) )
+                {
+                  painter.drawPoint( point );
+                }
+            }
+
           // Draw the distance to the selected object
           QString text = Distance::getText( distAcft, true, -1 );
 
@@ -618,9 +623,47 @@ void FlarmDisplay::paintEvent( QPaintEvent *event )
                           centerY - north - object.size().height()/2,
                           object );
 
+      if( coasting )
+        {
+          // The object was not reported recently. A dashed circle shows the
+          // uncertainty of its extrapolated position.
+          int r = doScale ? static_cast<int> (rint(uncertainty * scale)) : 0;
+
+          r = qMax( r, object.size().width() / 2 + 2 * Layout::getIntScaledDensity() );
+
+          QPen pen( Qt::darkGray );
+          pen.setWidth( 2 * Layout::getIntScaledDensity() );
+          pen.setStyle( Qt::DashLine );
+          painter.setPen( pen );
+          painter.setBrush( Qt::NoBrush );
+          painter.drawEllipse( QPoint(centerX + east, centerY - north), r, r );
+        }
+
       // store the draw coordinates for mouse snapping
-      objectHash.insert( it.key(), QPoint(centerX + east, centerY - north) );
+      objectHash.insert( key, QPoint(centerX + east, centerY - north) );
     }
+
+  // The objects move to their extrapolated positions in the next frame.
+  Flarm::instance()->getRepaintThrottle()->slot_Request();
+}
+
+bool FlarmDisplay::mapToScreen( const int north, const int east, QPoint& point )
+{
+  double dist = sqrt( double(north) * north + double(east) * east );
+
+  if( dist > radius )
+    {
+      return false;
+    }
+
+  double alpha = atan2( ((double) north), (double) east );
+  double heading2Object = ((double) (360. - calculator->getLastHeading()) * M_PI / 180.) + (M_PI_2 - alpha);
+
+  int x = static_cast<int> (rint(cos(heading2Object) * dist * scale));
+  int y = static_cast<int> (rint(sin(heading2Object) * dist * scale));
+
+  point = QPoint( centerX + y, centerY - x );
+  return true;
 }
 
 /** Returns a color related to the current lift. */
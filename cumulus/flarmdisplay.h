@@ -6,7 +6,7 @@
 **
 ************************************************************************
 **
-**   Copyright (c): 2010-2021 Axel Pauli
+**   Copyright (c): 2010-2026 Axel Pauli
 **
 **   This file is distributed under the terms of the General Public
 **   License. See the file COPYING for more information.
@@ -22,9 +22,9 @@
  *
  * This widget shows the Flarm display view.
  *
- * \date 2010-2020
+ * \date 2010-2026
  *
- * \version 1.4
+ * \version 1.5
  */
 
 #ifndef FLARM_DISPLAY_H
@@ -38,7 +38,6 @@
 #include <QMouseEvent>
 #include <QHash>
 #include <QPoint>
-#include <QTimer>
 
 #include "generalconfig.h"
 
@@ -140,6 +139,13 @@ public:
 
 private:
 
+  /**
+   * Maps a relative position of a Flarm object to the radar screen.
+   *
+   * \return False, if the position is outside of the radar range.
+   */
+  bool mapToScreen( const int north, const int east, QPoint& point );
+
   /** Background picture according to zoom level as radar screen */
   QPixmap background;
 
@@ -174,11 +180,6 @@ private:
    * Time interval of screen update in seconds.
    */
   unsigned short updateInterval;
-
-  /**
-   * Update timer for redraw of radar.
-   */
-  QTimer* updateTimer;
 };
 
 #endif /* FLARM_DISPLAY_H */
@@ -6,12 +6,12 @@
 **
 ************************************************************************
 **
-**   Copyright (c): 2010-2023 Axel Pauli
+**   Copyright (c): 2010-2026 Axel Pauli
 **
 **   This file is distributed under the terms of the General Public
 **   License. See the file COPYING for more information.
 **
-**   V1.2
+**   V1.3
 **
 ***********************************************************************/
 
@@ -31,16 +31,48 @@
 #include "mapconfig.h"
 #include "MainWindow.h"
 
+// Minimum time in ms between two list updates, so that the values can be read
+#define LIST_INTERVAL 3000
+
+// Item data of the numeric distance in the distance column and of the
+// direction in the icon column
+#define DISTANCE_ROLE  Qt::UserRole
+#define DIRECTION_ROLE (Qt::UserRole + 1)
+
 QString FlarmListView::selectedListObject  = "";
 QString FlarmListView::selectedFlarmObject = "";
 
+/**
+ * List item, which sorts the distance column by the numeric distance.
+ */
+class FlarmListItem : public QTreeWidgetItem
+{
+ public:
+
+  FlarmListItem() : QTreeWidgetItem()
+  {
+  };
+
+  bool operator<( const QTreeWidgetItem& other ) const
+  {
+    if( treeWidget() != 0 && treeWidget()->sortColumn() == 2 )
+      {
+        return data( 2, DISTANCE_ROLE ).toDouble() <
+               other.data( 2, DISTANCE_ROLE ).toDouble();
+      }
+
+    return QTreeWidgetItem::operator<( other );
+  };
+};
+
 /**
  * Constructor
  */
 FlarmListView::FlarmListView( QWidget *parent ) :
   QWidget( parent ),
   list(0),
-  rowDelegate(0)
+  rowDelegate(0),
+  updateTimer(0)
 {
   setAttribute( Qt::WA_DeleteOnClose );
   setWindowFlags( Qt::Tool );
@@ -115,7 +147,11 @@ FlarmListView::FlarmListView( QWidget *parent ) :
   connect( cmdUnselect, SIGNAL(clicked()), this, SLOT(slot_Unselect()) );
   connect( cmdClose, SIGNAL(clicked()), this, SLOT(slot_Close()) );
 
-  connect( Flarm::instance(), SIGNAL(newFlarmPflaaData()),
+  updateTimer = new QTimer( this );
+  updateTimer->setSingleShot( true );
+  connect( updateTimer, SIGNAL(timeout()), this, SLOT(slot_Update()) );
+
+  connect( Flarm::instance()->getRepaintThrottle(), SIGNAL(frame()),
            this, SLOT(slot_Update()) );
 }
 
@@ -159,169 +195,223 @@ void FlarmListView::configRowHeight()
  */
 void FlarmListView::fillItemList( QString& object2Select )
 {
+  // The items are deleted by the list.
+  itemHash.clear();
   list->clear();
 
-  // Here starts the Flarm object analysis and drawing
-  QHash<QString, Flarm::FlarmAcft> flarmAcfts = Flarm::getPflaaHash();
+  int iconSize = QFontMetrics(font()).height() - 4;
+  list->setIconSize( QSize(iconSize, iconSize) );
+
+  updateItemList();
+
+  QTreeWidgetItem* item = itemHash.value( Flarm::idFromString( object2Select ), 0 );
 
-  if( flarmAcfts.size() == 0 )
+  if( item != 0 )
     {
-      // hash is empty
-      resizeListColumns();
-      return;
+      // This item is the current selected one.
+      list->setCurrentItem( item );
     }
+}
 
-  int iconSize = QFontMetrics(font()).height() - 4;
-  list->setIconSize( QSize(iconSize, iconSize) );
+/**
+ * Updates the items of the list with the current Flarm traffic.
+ */
+void FlarmListView::updateItemList()
+{
+  const FlarmTraffic::Snapshot& traffic = Flarm::getTraffic();
+  const int iconSize = list->iconSize().height();
 
-  QMutableHashIterator<QString, Flarm::FlarmAcft> it(flarmAcfts);
+  QHash<uint, QTreeWidgetItem*> items;
+  items.reserve( traffic.size() );
 
-  while( it.hasNext() )
+  for( int i = 0; i < traffic.size(); i++ )
     {
-      it.next();
+      const Flarm::FlarmAcft& acft = traffic.at(i).acft();
 
-      // Get next aircraft
-      Flarm::FlarmAcft& acft = it.value();
+      // Known targets keep their items, only the changed data are set.
+      QTreeWidgetItem* item = itemHash.take( acft.ID );
 
-      QStringList sl;
+      if( item == 0 )
+        {
+          item = createItem( acft );
+          list->addTopLevelItem( item );
+        }
 
-      int north = acft.RelativeNorth;
-      int east  = acft.RelativeEast;
+      setItemData( item, acft, iconSize );
+      items.insert( acft.ID, item );
+    }
 
-      double distAcft = sqrt( north*north + east*east);
+  // The remaining items belong to disappeared targets. Deleting an item
+  // removes it from the list.
+  qDeleteAll( itemHash );
+  itemHash.swap( items );
 
-      QString vertical = "";
+  list->sortItems( 2, Qt::AscendingOrder );
+  resizeListColumns();
+  lastUpdate.start();
+}
 
-      // Calculate the relative vertical separation
-      if( acft.RelativeVertical > 0 )
-        {
-          // prefix positive value with a plus sign
-          vertical = "+";
-        }
+/**
+ * Creates a new item with the data, which do not change.
+ */
+QTreeWidgetItem* FlarmListView::createItem( const FlarmBase::FlarmAcft& acft )
+{
+  const QString key = Flarm::idToString( acft.ID );
 
-      vertical += Altitude::getText( acft.RelativeVertical, true, 0 );
-
-      QString climb = "";
-
-      // Calculate climb rate, if available
-       if( acft.ClimbRate != INT_MIN )
-         {
-           Speed speed(acft.ClimbRate);
-
-           if( acft.ClimbRate > 0 )
-             {
-               // prefix positive value with a plus sign
-               climb = "+";
-             }
-
-           climb += speed.getVerticalText( false, 1 );
-         }
-
-       // Try tp map the Flarm Id to an alias name
-       const QHash<QString, QPair<QString, bool> >& aliasHash =
-           FlarmAliasList::getAliasHash();
-
-       // Try to map the Flarm Id to an alias name
-       QString actfId = acft.ID.toUpper();
-       bool look4Reg = true;
-
-       if( aliasHash.contains( actfId ) )
-         {
-           actfId = aliasHash.value( actfId ).first;
-           look4Reg = false;
-         }
-
-       // Try to load Flarmnet data
-       GeneralConfig *conf = GeneralConfig::instance();
-       QStringList fnd;
-
-       if( conf->useFlarmNet() == true )
-         {
-           bool ok;
-           uint fid = acft.ID.toUInt( &ok, 16);
-           ok = FlarmNet::getData( fid, fnd );
-
-           if( ok == true && look4Reg == true && fnd.at(0).size() > 0 )
-             {
-               // Kennzeichen instead of hex id
-               actfId = fnd.at(0);
-             }
-         }
-
-      // Add hash key as invisible column
-      sl << it.key()
-         << actfId
-         << Distance::getText( distAcft, true, -1 )
-         << vertical
-         << "";
-
-      if( acft.GroundSpeed != INT_MIN )
-        {
-          sl << Speed( acft.GroundSpeed ).getHorizontalText( false, 0 );
-        }
+  const QHash<QString, QPair<QString, bool> >& aliasHash =
+      FlarmAliasList::getAliasHash();
 
-      sl << climb;
+  // Try to map the Flarm Id to an alias name
+  QString actfId = key;
+  bool look4Reg = true;
 
-      if( fnd.size() == 4 )
-        {
-          // display other Flarm data e.g. Type, WKZ, Frequenz
-          ( fnd.at(2).size() > 0 ) ? sl << fnd.at(2) : sl << " ";
-          ( fnd.at(3).size() > 0 ) ? sl << fnd.at(3) : sl << " ";
-          ( fnd.at(1).size() > 0 ) ? sl << fnd.at(1) : sl << " ";
-        }
+  if( aliasHash.contains( actfId ) )
+    {
+      actfId = aliasHash.value( actfId ).first;
+      look4Reg = false;
+    }
 
-      QTreeWidgetItem* item = new QTreeWidgetItem( sl );
-      item->setTextAlignment( 1, Qt::AlignLeft|Qt::AlignVCenter );
-      item->setTextAlignment( 2, Qt::AlignRight|Qt::AlignVCenter );
-      item->setTextAlignment( 3, Qt::AlignRight|Qt::AlignVCenter );
-      item->setTextAlignment( 4, Qt::AlignCenter );
-      item->setTextAlignment( 5, Qt::AlignRight|Qt::AlignVCenter );
-      item->setTextAlignment( 6, Qt::AlignRight|Qt::AlignVCenter );
-      item->setTextAlignment( 7, Qt::AlignLeft|Qt::AlignVCenter );
-      item->setTextAlignment( 8, Qt::AlignLeft|Qt::AlignVCenter );
-      item->setTextAlignment( 9, Qt::AlignLeft|Qt::AlignVCenter );
+  // Try to load Flarmnet data
+  QStringList fnd;
 
-      QPixmap pixmap;
+  if( GeneralConfig::instance()->useFlarmNet() == true )
+    {
+      bool ok = FlarmNet::getData( acft.ID, fnd );
 
-      if( north == 0 && east == 0 )
+      if( ok == true && look4Reg == true && fnd.at(0).size() > 0 )
         {
-          // Special case Flarm object is above or below us. We draw a circle.
-          MapConfig::createCircle( pixmap,
-                                   iconSize,
-                                   QColor(Qt::black),
-                                   1.0 );
-        }
-      else
-        {
-          int alpha = static_cast<int> (rint(atan2( ((double) north), (double) east ) * 180. / M_PI));
-
-          // correct angle because the different coordinate systems.
-          int heading2Object = (360 - calculator->getLastHeading()) + (90 - alpha);
-
-          // qDebug() << "ID=" << it.key() << "Alpha" << alpha << "H2O=" << heading2Object;
-          MapConfig::createTriangle( pixmap,
-                                     iconSize,
-                                     QColor(Qt::black),
-                                     heading2Object,
-                                     1.0,
-                                     QColor(Qt::cyan) );
+          // Kennzeichen instead of hex id
+          actfId = fnd.at(0);
         }
+    }
 
-      QIcon qi;
-      qi.addPixmap( pixmap );
-      item->setIcon( 4, qi );
+  QTreeWidgetItem* item = new FlarmListItem;
 
-      list->addTopLevelItem( item );
+  // Add hash key as invisible column
+  item->setText( 0, key );
+  item->setText( 1, actfId );
 
-      if( object2Select == it.key() )
+  if( fnd.size() == 4 )
+    {
+      // display other Flarm data e.g. Type, WKZ, Frequenz
+      item->setText( 7, fnd.at(2).size() > 0 ? fnd.at(2) : " " );
+      item->setText( 8, fnd.at(3).size() > 0 ? fnd.at(3) : " " );
+      item->setText( 9, fnd.at(1).size() > 0 ? fnd.at(1) : " " );
+    }
+
+  item->setTextAlignment( 1, Qt::AlignLeft|Qt::AlignVCenter );
+  item->setTextAlignment( 2, Qt::AlignRight|Qt::AlignVCenter );
+  item->setTextAlignment( 3, Qt::AlignRight|Qt::AlignVCenter );
+  item->setTextAlignment( 4, Qt::AlignCenter );
+  item->setTextAlignment( 5, Qt::AlignRight|Qt::AlignVCenter );
+  item->setTextAlignment( 6, Qt::AlignRight|Qt::AlignVCenter );
+  item->setTextAlignment( 7, Qt::AlignLeft|Qt::AlignVCenter );
+  item->setTextAlignment( 8, Qt::AlignLeft|Qt::AlignVCenter );
+  item->setTextAlignment( 9, Qt::AlignLeft|Qt::AlignVCenter );
+
+  return item;
+}
+
+/**
+ * Sets the changing data of the item. The list redraws only the cells,
+ * whose data have been changed.
+ */
+void FlarmListView::setItemData( QTreeWidgetItem* item,
+                                 const FlarmBase::FlarmAcft& acft,
+                                 const int iconSize )
+{
+  int north = acft.RelativeNorth;
+  int east  = acft.RelativeEast;
+
+  double distAcft = sqrt( north*north + east*east);
+
+  item->setText( 2, Distance::getText( distAcft, true, -1 ) );
+  item->setData( 2, DISTANCE_ROLE, distAcft );
+
+  QString vertical = "";
+
+  // Calculate the relative vertical separation
+  if( acft.RelativeVertical > 0 )
+    {
+      // prefix positive value with a plus sign
+      vertical = "+";
+    }
+
+  vertical += Altitude::getText( acft.RelativeVertical, true, 0 );
+
+  item->setText( 3, vertical );
+
+  QString groundSpeed = "";
+
+  if( acft.GroundSpeed != INT_MIN )
+    {
+      groundSpeed = Speed( acft.GroundSpeed ).getHorizontalText( false, 0 );
+    }
+
+  item->setText( 5, groundSpeed );
+
+  QString climb = "";
+
+  // Calculate climb rate, if available
+  if( acft.ClimbRate != INT_MIN )
+    {
+      Speed speed(acft.ClimbRate);
+
+      if( acft.ClimbRate > 0 )
         {
-          // This item is the current selected one.
-          list->setCurrentItem( item );
+          // prefix positive value with a plus sign
+          climb = "+";
         }
+
+      climb += speed.getVerticalText( false, 1 );
     }
 
-  list->sortByColumn ( 2, Qt::AscendingOrder );
-  resizeListColumns();
+  item->setText( 6, climb );
+
+  // Direction to the object, -1 if it is above or below us
+  int direction = -1;
+
+  if( north != 0 || east != 0 )
+    {
+      int alpha = static_cast<int> (rint(atan2( ((double) north), (double) east ) * 180. / M_PI));
+
+      // correct angle because the different coordinate systems.
+      direction = ((360 - calculator->getLastHeading()) + (90 - alpha) + 720) % 360;
+    }
+
+  QVariant lastDirection = item->data( 4, DIRECTION_ROLE );
+
+  if( lastDirection.isValid() && lastDirection.toInt() == direction )
+    {
+      // The icon is still valid.
+      return;
+    }
+
+  item->setData( 4, DIRECTION_ROLE, direction );
+
+  QPixmap pixmap;
+
+  if( direction == -1 )
+    {
+      // Special case Flarm object is above or below us. We draw a circle.
+      MapConfig::createCircle( pixmap,
+                               iconSize,
+                               QColor(Qt::black),
+                               1.0 );
+    }
+  else
+    {
+      MapConfig::createTriangle( pixmap,
+                                 iconSize,
+                                 QColor(Qt::black),
+                                 direction,
+                                 1.0,
+                                 QColor(Qt::cyan) );
+    }
+
+  QIcon qi;
+  qi.addPixmap( pixmap );
+  item->setIcon( 4, qi );
 }
 
 /**
@@ -406,17 +496,24 @@ void FlarmListView::slot_Close()
  */
 void FlarmListView::slot_Update()
 {
-  static int interval = 0;
-
   if( isVisible() == false )
     {
       // widget is not visible, do nothing in this case.
       return;
     }
 
-  if( ++interval % 3 == 0 )
+  if( lastUpdate.isValid() && lastUpdate.elapsed() < LIST_INTERVAL )
     {
-      // Update all 3s the list.
-      fillItemList( selectedListObject );
+      // Update the list all 3s only. The last data are shown, when the
+      // interval has expired.
+      if( updateTimer->isActive() == false )
+        {
+          updateTimer->start( static_cast<int> (LIST_INTERVAL - lastUpdate.elapsed()) );
+        }
+
+      return;
     }
+
+  updateTimer->stop();
+  updateItemList();
 }
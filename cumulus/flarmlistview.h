@@ -6,7 +6,7 @@
 **
 ************************************************************************
 **
-**   Copyright (c): 2010 Axel Pauli
+**   Copyright (c): 2010-2026 Axel Pauli
 **
 **   This file is distributed under the terms of the General Public
 **   License. See the file COPYING for more information.
@@ -24,7 +24,12 @@
  *
  * This widget shows the Flarm object data in a list.
  *
- * \date 2010
+ * The list items are kept over the updates and are keyed by the Flarm ID.
+ * An update changes only the data of the known targets, adds the new ones
+ * and removes the disappeared ones. So the selection and the scroll position
+ * are kept too. The updates are driven by the frames of the Flarm views.
+ *
+ * \date 2010-2026
  *
  * \version $Id$
  */
@@ -32,12 +37,16 @@
 #ifndef FLARM_LIST_VIEW_H
 #define FLARM_LIST_VIEW_H
 
+#include <QElapsedTimer>
+#include <QHash>
 #include <QWidget>
 
+#include "flarmbase.h"
 #include "rowdelegate.h"
 
 class QTreeWidget;
 class QString;
+class QTimer;
 class QTreeWidget;
 class QTreeWidgetItem;
 
@@ -71,6 +80,11 @@ public:
    */
   void fillItemList( QString& object2Select );
 
+  /**
+   * Updates the items of the list with the current Flarm traffic.
+   */
+  void updateItemList();
+
   /**
    * aligns the columns to their contents
    */
@@ -131,9 +145,26 @@ signals:
 
 private:
 
+  /** Creates a new item with the data, which do not change. */
+  QTreeWidgetItem* createItem( const FlarmBase::FlarmAcft& acft );
+
+  /** Sets the changing data of the item. */
+  void setItemData( QTreeWidgetItem* item,
+                    const FlarmBase::FlarmAcft& acft,
+                    const int iconSize );
+
   QTreeWidget* list;
   RowDelegate* rowDelegate;
 
+  /** Items of the list, keyed by the Flarm ID. */
+  QHash<uint, QTreeWidgetItem*> itemHash;
+
+  /** Time since the last list update. */
+  QElapsedTimer lastUpdate;
+
+  /** Timer for an update, which was requested too early. */
+  QTimer* updateTimer;
+
   /** Hash key of the selected Flarm object in the FlarmRadarView. */
   static QString selectedFlarmObject;
 
@@ -6,7 +6,7 @@
 **
 ************************************************************************
 **
-**   Copyright (c): 2010-2023 Axel Pauli
+**   Copyright (c): 2010-2026 Axel Pauli
 **
 **   This file is distributed under the terms of the General Public
 **   License. See the file COPYING for more information.
@@ -56,9 +56,6 @@ FlarmRadarView::FlarmRadarView( QWidget *parent ) :
   display = new FlarmDisplay( this );
   topLayout->addWidget( display, 2 );
 
-  connect( Flarm::instance(), SIGNAL(newFlarmPflaaData()),
-           display, SLOT(slot_UpdateDisplay()) );
-
   connect( Flarm::instance(), SIGNAL(flarmPflaaDataTimeout()),
            display, SLOT(slot_ResetDisplay()) );
 
@@ -25,6 +25,7 @@
 #include "map.h"
 #include "mapcalc.h"
 #include "speed.h"
+#include "VirtualClock.h"
 
 #undef CUMULUS_DEBUG
 
@@ -1417,7 +1418,7 @@ int FlightTask::getFlightTime()
   if( _taskEndTime.isNull() )
     {
       // Task is not yet finished, calculate against current time.
-      return _taskStartTime.secsTo( QDateTime::currentDateTime() );
+      return _taskStartTime.secsTo( VirtualClock::currentDateTime() );
     }
 
     // Task is finished.
@@ -1513,7 +1514,7 @@ Speed FlightTask::calAverageSpeed()
 void FlightTask::setStartTime()
 {
   resetTimes();
-  _taskStartTime = QDateTime::currentDateTime();
+  _taskStartTime = VirtualClock::currentDateTime();
 
   if( tpList.size() > 0 )
     {
@@ -1525,7 +1526,7 @@ void FlightTask::setStartTime()
 /** Set the task end date and time as local time. */
 void FlightTask::setEndTime()
 {
-  _taskEndTime = QDateTime::currentDateTime();
+  _taskEndTime = VirtualClock::currentDateTime();
 
   if( tpList.size() > 0 )
     {
@@ -7,7 +7,7 @@
  ************************************************************************
  **
  **   Copyright (c):  2004      by André Somers
- **                   2007-2025 by Axel Pauli
+ **                   2007-2026 by Axel Pauli
  **
  **   This file is distributed under the terms of the General Public
  **   License. See the file COPYING for more information.
@@ -516,6 +516,9 @@ void GeneralConfig::load()
   _gpsSwitchState     = value( "SwitchState", true ).toBool();
   _gpsSyncSystemClock = value( "SyncSystemClock", false ).toBool();
   _gpsNmeaLogState    = value( "NmeaLogState", false ).toBool();
+  _gpsNmeaLogCompression = value( "NmeaLogCompression", false ).toBool();
+  _gpsNmeaLogFlarmOnly = value( "NmeaLogFlarmOnly", false ).toBool();
+  _gpsNmeaLogMaxSize  = value( "NmeaLogMaxSize", 50 ).toInt();
   _gpsIpcPort         = value( "IpcPort", 0 ).toInt();
   _gpsStartClient     = value( "StartClient", true ).toBool();
   _gpsLastFixLat      = value( "LastFixLat", 0 ).toInt();
@@ -576,6 +579,7 @@ void GeneralConfig::load()
   beginGroup("Flarm");
   _flarmAliasFileName      = value( "AliasFileName", "cumulus-flarm.txt" ).toString();
   _flarmRadarDrawWindArrow = value( "RadarDrawWindArrow", true ).toBool();
+  _flarmFrameRate          = value( "FrameRate", 5 ).toInt();
   _flarmNetUrl              = value( "DB-URL", FLARM_NET_URL ).toString();
   _flarmNetFilter           = value( "DB-Filter", "" ).toString();
   _useFlarmNet              = value( "DB-Usage", false ).toBool();
@@ -1013,6 +1017,9 @@ void GeneralConfig::save()
   setValue( "SwitchState", _gpsSwitchState );
   setValue( "SyncSystemClock", _gpsSyncSystemClock );
   setValue( "NmeaLogState", _gpsNmeaLogState );
+  setValue( "NmeaLogCompression", _gpsNmeaLogCompression );
+  setValue( "NmeaLogFlarmOnly", _gpsNmeaLogFlarmOnly );
+  setValue( "NmeaLogMaxSize", _gpsNmeaLogMaxSize );
   setValue( "IpcPort", _gpsIpcPort );
   setValue( "StartClient", _gpsStartClient );
   setValue( "LastFixLat", _gpsLastFixLat );
@@ -1067,6 +1074,7 @@ void GeneralConfig::save()
 
   beginGroup ("Flarm");
   setValue( "RadarDrawWindArrow", _flarmRadarDrawWindArrow );
+  setValue( "FrameRate", _flarmFrameRate );
   setValue( "DB-URL", _flarmNetUrl );
   setValue( "DB-Filter", _flarmNetFilter );
   setValue( "DB-Usage", _useFlarmNet );
@@ -7,7 +7,7 @@
 ************************************************************************
 **
 **   Copyright (c):  2004      by André Somers
-**                   2007-2025 by Axel Pauli
+**                   2007-2026 by Axel Pauli
 **
 **   This file is distributed under the terms of the General Public
 **   License. See the file COPYING for more information.
@@ -25,7 +25,7 @@
  * configuration options. This class is a singleton class. Use the
  * static instance method to get a reference to the instance.
  *
- * \date 2004-2025
+ * \date 2004-2026
  *
  * \version 1.16
  */
@@ -2236,6 +2236,39 @@ class GeneralConfig : protected QSettings
     _gpsNmeaLogState = newValue;
   }
 
+  /** gets Gps NMEA log compression */
+  bool getGpsNmeaLogCompression() const
+  {
+    return _gpsNmeaLogCompression;
+  }
+  /** sets Gps NMEA log compression */
+  void setGpsNmeaLogCompression(const bool newValue)
+  {
+    _gpsNmeaLogCompression = newValue;
+  }
+
+  /** gets Gps NMEA log Flarm only state */
+  bool getGpsNmeaLogFlarmOnly() const
+  {
+    return _gpsNmeaLogFlarmOnly;
+  }
+  /** sets Gps NMEA log Flarm only state */
+  void setGpsNmeaLogFlarmOnly(const bool newValue)
+  {
+    _gpsNmeaLogFlarmOnly = newValue;
+  }
+
+  /** gets Gps NMEA log maximum file size in MB */
+  int getGpsNmeaLogMaxSize() const
+  {
+    return _gpsNmeaLogMaxSize;
+  }
+  /** sets Gps NMEA log maximum file size in MB */
+  void setGpsNmeaLogMaxSize(const int newValue)
+  {
+    _gpsNmeaLogMaxSize = newValue;
+  }
+
   /** gets Gps Ipc port */
   ushort getGpsIpcPort() const;
   /** sets Gps Ipc port */
@@ -3191,6 +3224,18 @@ class GeneralConfig : protected QSettings
     _flarmRadarDrawWindArrow = flarmRadarDrawWindArrow;
   }
 
+  /** Gets the maximum frame rate of the Flarm views per second. */
+  int getFlarmFrameRate() const
+  {
+    return _flarmFrameRate;
+  }
+
+  /** Sets the maximum frame rate of the Flarm views per second. */
+  void setFlarmFrameRate( const int newValue )
+  {
+    _flarmFrameRate = newValue;
+  }
+
   // Get GPS filter index
   int getGpsFilterIndex() const
   {
@@ -3618,6 +3663,12 @@ class GeneralConfig : protected QSettings
   bool _gpsSyncSystemClock;
   // Gps NMEA log state
   bool _gpsNmeaLogState;
+  // Gps NMEA log compression
+  bool _gpsNmeaLogCompression;
+  // Gps NMEA log contains only the Flarm sentences
+  bool _gpsNmeaLogFlarmOnly;
+  // Gps NMEA log maximum file size in MB
+  int _gpsNmeaLogMaxSize;
   // Gps IPC port
   ushort _gpsIpcPort;
   // Gps client start option
@@ -3691,6 +3742,9 @@ class GeneralConfig : protected QSettings
   /** Flarm Radar wind arrow drawing. */
   bool _flarmRadarDrawWindArrow;
 
+  /** Maximum frame rate of the Flarm views per second. */
+  int _flarmFrameRate;
+
   /** Flight logbook file name */
   QString _flightLogbookFileName;
 
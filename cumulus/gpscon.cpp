@@ -37,6 +37,7 @@
 #include "signalhandler.h"
 #include "protocol.h"
 #include "ipc.h"
+#include "LatencyTrace.h"
 
 #ifdef DEBUG
 #undef DEBUG
@@ -94,6 +95,10 @@ GpsCon::GpsCon(QObject* parent, const char *pathIn) :
 
   qDebug( "IPC Server listening on %s:%d", IPC_IP, port );
 
+  // The shared memory ring for the GPS data. Without it the data are
+  // transferred via the notification socket.
+  ring.create( QString("/cumulus-nmea-%1").arg(getpid()) );
+
   // Check the start client option. It is introduced for debugging
   // purposes. If set to false, no client process will be started.
   startClient = conf->getGpsStartClientOption();
@@ -662,6 +667,9 @@ void GpsCon::slot_ListenEvent( int socket )
       // Tells the client, what GPS sentences are to be processed.
       sendGpsKeys();
 
+      // Offer the shared memory ring for the GPS data transfer.
+      sendNmeaRing();
+
       // Start the GPS receiver after a new connect to get it running.
       startGpsReceiving();
       return;
@@ -704,6 +712,9 @@ void GpsCon::getDataFromClient()
 
   // QElapsedTimer t; t.start();
 
+  // Sentences transferred via the socket, passed on as one epoch.
+  QStringList sentences;
+
   int loops = 0;
 
   while( loops++ < 250 )
@@ -741,7 +752,22 @@ void GpsCon::getDataFromClient()
       if( msg.startsWith( MSG_GPS_DATA ) )
         {
           msg = msg.right(msg.length() - strlen(MSG_GPS_DATA) - 1);
-          emit newSentence(msg);
+          sentences.append( msg );
+          continue;
+        }
+
+      if( sentences.isEmpty() == false )
+        {
+          // Keep the order of data and status messages. The forward channel
+          // carries no read time, the trace is paused.
+          LatencyTrace::begin( 0 );
+          emit newSentences( sentences, noReadTimes );
+          sentences.clear();
+        }
+
+      if( msg == MSG_RING_WAKEUP )
+        {
+          // The ring is read after the loop.
         }
       else if (msg == MSG_CON_OFF) // GPS connection has gone off
         {
@@ -789,12 +815,62 @@ void GpsCon::getDataFromClient()
         }
     }
 
+  if( sentences.isEmpty() == false )
+    {
+      LatencyTrace::begin( 0 );
+      emit newSentences( sentences, noReadTimes );
+    }
+
+  readNmeaRing();
+
   // qDebug() << "MSG_GPS_DATA Loops" << loops << t.elapsed();
 
   // remember last start time
   lastQuery.start();
 }
 
+/**
+ * Reads all GPS sentences from the shared memory ring. The sentences are
+ * collected until the end of their epoch is read.
+ */
+void GpsCon::readNmeaRing()
+{
+  if( ring.isValid() == false )
+    {
+      return;
+    }
+
+  do
+    {
+      qint64 stamp = 0;
+
+      while( ring.read( ringRecord, &stamp ) > 0 )
+        {
+          if( ringRecord == MSG_EPOCH_END )
+            {
+              if( ringEpoch.isEmpty() == false )
+                {
+                  // The age of the epoch is traced from its first sentence.
+                  LatencyTrace::begin( ringEpochTimes.first() );
+                  LatencyTrace::mark( LatencyTrace::Received );
+
+                  emit newSentences( ringEpoch, ringEpochTimes );
+                  ringEpoch.clear();
+                  ringEpochTimes.resize( 0 );
+                }
+
+              continue;
+            }
+
+          ringEpoch.append( QString::fromLatin1( ringRecord ) );
+          ringEpochTimes.append( stamp );
+        }
+    }
+  while( ring.prepareWait() == false );
+
+  // An open epoch is completed by the next wake up.
+}
+
 /**
  * Reads a client message from the socket. The protocol consists of two
  * parts. First the message length is read as unsigned integer, after that the
@@ -924,6 +1000,31 @@ void GpsCon::sendGpsKeys()
     }
 }
 
+void GpsCon::sendNmeaRing()
+{
+  QString method = "GPSCon::sendNmeaRing():";
+
+  if( ring.isValid() == false )
+    {
+      return;
+    }
+
+  // A new client is connected, left overs of a died client are removed.
+  ring.reset();
+  ringEpoch.clear();
+  ringEpochTimes.resize( 0 );
+
+  QString msg = QString("%1 %2").arg(MSG_NMEA_RING).arg(ring.name());
+
+  writeClientMessage( 0, msg.toLatin1().data() );
+  readClientMessage( 0, msg );
+
+  if( msg != MSG_POS )
+    {
+      qWarning() << method << "Client cannot attach ring, using socket transfer.";
+    }
+}
+
 #ifdef FLARM
 
 bool GpsCon::getFlarmFlightList()
@@ -29,6 +29,10 @@
  * passed in the constructor, that the gpsClient can be found. It lays in the
  * same directory as Cumulus.
  *
+ * The GPS sentences are received via a shared memory ring, if the client could
+ * attach it. The notification socket then delivers only a wake up message, when
+ * new sentences are available in the ring.
+ *
  * \date 2004-2022
  */
 
@@ -41,8 +45,10 @@
 #include <QDateTime>
 #include <QTimer>
 #include <QElapsedTimer>
+#include <QVector>
 
 #include "ipc.h"
+#include "NmeaRing.h"
 #include "datatypes.h"
 
 // Device name for NMEA simulator. This name is also taken for the named pipe.
@@ -141,6 +147,13 @@ class GpsCon : public QObject
      */
     void sendGpsKeys();
 
+    /**
+     * Passes the name of the shared memory ring to the GPS client process.
+     * If the client cannot attach it, the GPS data are further transferred
+     * via the notification socket.
+     */
+    void sendNmeaRing();
+
 #ifdef FLARM
 
     /** Requests a flight list from a Flarm device. */
@@ -162,9 +175,16 @@ class GpsCon : public QObject
 
   signals:
     /**
-     * This signal is emitted every time a new sentence has arrived.
+     * This signal is emitted with all sentences of a GPS epoch. An epoch is
+     * closed by the client, when the fix time changes or the device becomes
+     * silent. Without the shared memory ring, all sentences received
+     * together are passed as one epoch.
+     *
+     * The read times are the monotonic clock in nano seconds, when the
+     * gpsClient has read the sentences from the device. The list is empty,
+     * if the read times are unknown.
      */
-    void newSentence(const QString& sentence);
+    void newSentences(const QStringList& sentences, const QVector<qint64>& readTimes);
 
     /**
      * This signal is emitted to report a device message coming
@@ -227,6 +247,12 @@ class GpsCon : public QObject
      */
     void getDataFromClient();
 
+    /**
+     * Reads all GPS sentences from the shared memory ring and announces
+     * the waiting for new data to the client.
+     */
+    void readNmeaRing();
+
     /**
      * Triggers a connection retry in case of error.
      */
@@ -278,6 +304,21 @@ class GpsCon : public QObject
     // IPC instance to client process
     Ipc::Server server;
 
+    // Shared memory ring for the GPS data from the client process
+    NmeaRing ring;
+
+    // Receive buffer for a ring record
+    QByteArray ringRecord;
+
+    // Sentences of the current epoch, read from the ring
+    QStringList ringEpoch;
+
+    // Read times of the sentences of the current epoch
+    QVector<qint64> ringEpochTimes;
+
+    // Read times of the sentences passed by the socket, they are unknown
+    QVector<qint64> noReadTimes;
+
     // RX/TX rate of serial device
     uint ioSpeed;
 
@@ -3,7 +3,7 @@
                              -------------------
     begin                : Sat Jul 20 2002
     copyright            : (C) 2002      by André Somers,
-                               2008-2025 by Axel Pauli
+                               2008-2026 by Axel Pauli
 
     email                : kflog.cumulus@gmail.com
 
@@ -29,6 +29,7 @@
 #include <sys/time.h>
 #include <ctime>
 #include <cmath>
+#include <algorithm>
 
 #include <QtCore>
 
@@ -36,10 +37,13 @@
 #include "Atmosphere.h"
 #include "generalconfig.h"
 #include "gpsnmea.h"
+#include "LatencyTrace.h"
 #include "mapmatrix.h"
 #include "mapcalc.h"
 #include "mapview.h"
+#include "NmeaLogger.h"
 #include "speed.h"
+#include "VirtualClock.h"
 
 #ifdef FLARM
 #include "flarm.h"
@@ -55,9 +59,6 @@ GpsNmea *GpsNmea::gps = static_cast<GpsNmea *> (0);
 // number of created class instances
 short GpsNmea::instances = 0;
 
-// Dictionary with known sentence keywords
-QHash<QString, short> GpsNmea::gpsHash;
-
 // Mutex for thread synchronization
 QMutex GpsNmea::mutex;
 
@@ -67,8 +68,107 @@ QMutex GpsNmea::mutex;
 // Flarm device type query
 #define FLARM_DEVTYPE_CMD "$PFLAC,R,DEVTYPE"
 
+/**
+ * All processed sentence identifiers with their decoder numbers. This table
+ * is the only place, where the numbers are assigned. It is used by
+ * getGpsMessageKeys() and sentenceKey().
+ *
+ * NMEA Talkers:
+ * BD = Beidou Sat
+ * GP = GPS Sat
+ * GA = GALILEO Sat
+ * GL = GLONASS Sat
+ * GN = All GPS systems
+ */
+static const struct
+{
+  const char* id;
+  short key;
+} sentenceIds[] =
+{
+  { "$BDRMC", 0 }, { "$GPRMC", 0 }, { "$GARMC", 0 }, { "$GLRMC", 0 }, { "$GNRMC", 0 },
+  { "$BDGLL", 1 }, { "$GPGLL", 1 }, { "$GAGLL", 1 }, { "$GLGLL", 1 }, { "$GNGLL", 1 },
+  { "$BDGGA", 2 }, { "$GPGGA", 2 }, { "$GAGGA", 2 }, { "$GLGGA", 2 }, { "$GNGGA", 2 },
+  { "$BDGSA", 3 }, { "$GPGSA", 3 }, { "$GAGSA", 3 }, { "$GLGSA", 3 }, { "$GNGSA", 3 },
+  { "$BDGSV", 4 }, { "$GPGSV", 4 }, { "$GAGSV", 4 }, { "$GLGSV", 4 }, { "$GNGSV", 4 },
+  { "$PGRMZ", 5 },
+  { "$PCAID", 6 },
+  { "!w",     7 },
+  { "$PGCS",  8 },
+  { "$LXWP0", 9 },
+  { "$LXWP2", 10 },
+  { "$GPDTM", 11 },
+  { "$GNGNS", 12 },
+  { "$POV",   13 }, // OpenVario
+  { "$PXCV",  14 }, // XCVario
+  { "$GPVTG", 15 }, { "$GNVTG", 15 },
+  { "$HCHDM", 16 }, // Magnetic heading from XCVario
+  { "$HCHDT", 17 }, // Magnetic true heading from XCVario
+#ifdef FLARM
+  { "$PFLAA", 20 },
+  { "$PFLAU", 21 },
+  { "$PFLAV", 22 },
+  { "$PFLAE", 23 },
+  { "$PFLAC", 24 },
+  { "$PFLAR", 25 },
+  { "$PFLAI", 26 },
+  { "$PFLAO", 27 },
+  { "$PFLAQ", 28 },
+  { "$PFLAX", 29 },
+  { "$ERROR", 30 },
+#endif
+  { "$PTAS",  42 }  // Only for test purposes
+};
+
+/** Packed sentence identifier with its decoder number. */
+struct PackedSentenceId
+{
+  quint64 packed;
+  short key;
+
+  bool operator<( const PackedSentenceId& other ) const
+  {
+    return packed < other.packed;
+  };
+};
+
+/**
+ * \return The identifiers of sentenceIds packed by NmeaSentence::idKey and
+ * sorted for a binary search. Built at the first call.
+ */
+static const QVector<PackedSentenceId>& packedSentenceIds()
+{
+  static QVector<PackedSentenceId> packedIds;
+
+  if( packedIds.isEmpty() )
+    {
+      const int count = sizeof(sentenceIds) / sizeof(sentenceIds[0]);
+
+      packedIds.reserve( count );
+
+      for( int i = 0; i < count; i++ )
+        {
+          PackedSentenceId entry;
+          entry.packed = NmeaSentence::idKey( NmeaField( sentenceIds[i].id,
+                                                         strlen( sentenceIds[i].id ) ) );
+          entry.key = sentenceIds[i].key;
+          packedIds.append( entry );
+        }
+
+      std::sort( packedIds.begin(), packedIds.end() );
+    }
+
+  return packedIds;
+}
+
 GpsNmea::GpsNmea(QObject* parent) :
   QObject(parent),
+  _inEpoch(false),
+  _epochUpdates(0),
+  _emitting(false),
+  _sampleTime(0),
+  _pressureAltitudeTime(0),
+  _fixSampleTime(0),
   flarmNmeaOutInitDone(false)
 {
   if( instances > 0 )
@@ -83,9 +183,6 @@ GpsNmea::GpsNmea(QObject* parent) :
 
   resetDataObjects();
 
-  // Load desired GPS sentence identifier into the hash filter.
-  getGpsMessageKeys(gpsHash);
-
   // GPS fix supervision, is started after the first fix was received
   timeOutFix = new QTimer(this);
   connect (timeOutFix, SIGNAL(timeout()), this, SLOT(_slotTimeoutFix()));
@@ -99,7 +196,7 @@ GpsNmea::GpsNmea(QObject* parent) :
   /** BT Device name and address */
   btDevice = GeneralConfig::instance()->getGpsBtDevice();
 
-  nmeaLogFile = static_cast<QFile *> (0);
+  nmeaLogger = static_cast<NmeaLogger *> (0);
 
   if( GeneralConfig::instance()->getGpsNmeaLogState() == true )
     {
@@ -120,99 +217,23 @@ GpsNmea::~GpsNmea()
       delete connector;
     }
 
-  if( nmeaLogFile )
-    {
-      if( nmeaLogFile->isOpen() )
-        {
-          nmeaLogFile->close();
-        }
-
-      delete nmeaLogFile;
-    }
+  slot_closeNmeaLogFile();
 }
 
+/**
+ * The numbers are taken from the table sentenceIds, like in sentenceKey().
+ */
 void GpsNmea::getGpsMessageKeys( QHash<QString, short>& gpsKeys)
 {
   mutex.lock();
   gpsKeys.clear();
 
-  // Load all desired GPS sentence identifiers into the hash table NMEA Talkers
-  // BD = Beidou Sat
-  // GP = GPS Sat
-  // GA = GALILEO Sat
-  // GL = GLONASS Sat
-  // GN = All GPS systems
-  gpsKeys.insert( "$BDRMC", 0);
-  gpsKeys.insert( "$GPRMC", 0);
-  gpsKeys.insert( "$GARMC", 0);
-  gpsKeys.insert( "$GLRMC", 0);
-  gpsKeys.insert( "$GNRMC", 0);
-
-  gpsKeys.insert( "$BDGLL", 1);
-  gpsKeys.insert( "$GPGLL", 1);
-  gpsKeys.insert( "$GAGLL", 1);
-  gpsKeys.insert( "$GLGLL", 1);
-  gpsKeys.insert( "$GNGLL", 1);
-
-  gpsKeys.insert( "$BDGGA", 2);
-  gpsKeys.insert( "$GPGGA", 2);
-  gpsKeys.insert( "$GAGGA", 2);
-  gpsKeys.insert( "$GLGGA", 2);
-  gpsKeys.insert( "$GNGGA", 2);
-
-  gpsKeys.insert( "$BDGSA", 3);
-  gpsKeys.insert( "$GPGSA", 3);
-  gpsKeys.insert( "$GAGSA", 3);
-  gpsKeys.insert( "$GLGSA", 3);
-  gpsKeys.insert( "$GNGSA", 3);
-
-  gpsKeys.insert( "$BDGSV", 4);
-  gpsKeys.insert( "$GPGSV", 4);
-  gpsKeys.insert( "$GAGSV", 4);
-  gpsKeys.insert( "$GLGSV", 4);
-  gpsKeys.insert( "$GNGSV", 4);
-
-  gpsKeys.insert( "$PGRMZ", 5);
-  gpsKeys.insert( "$PCAID", 6);
-  gpsKeys.insert( "!w",     7);
-  gpsKeys.insert( "$PGCS",  8);
-  gpsKeys.insert( "$LXWP0", 9);
-  gpsKeys.insert( "$LXWP2", 10);
-  gpsKeys.insert( "$GPDTM", 11);
-
-  gpsKeys.insert( "$GNGNS", 12);
-
-  // OpenVario
-  gpsKeys.insert( "$POV", 13 );
-
-  // XCVario
-  gpsKeys.insert( "$PXCV", 14 );
-
-  gpsKeys.insert( "$GPVTG", 15 );
-  gpsKeys.insert( "$GNVTG", 15 );
-
-  // Magnetic heading from XCVario
-  gpsKeys.insert( "$HCHDM", 16 );
-
-  // Magnetic true heading from XCVario
-  gpsKeys.insert( "$HCHDT", 17 );
-
-  #ifdef FLARM
-  gpsKeys.insert( "$PFLAA", 20);
-  gpsKeys.insert( "$PFLAU", 21);
-  gpsKeys.insert( "$PFLAV", 22);
-  gpsKeys.insert( "$PFLAE", 23);
-  gpsKeys.insert( "$PFLAC", 24);
-  gpsKeys.insert( "$PFLAR", 25);
-  gpsKeys.insert( "$PFLAI", 26);
-  gpsKeys.insert( "$PFLAO", 27);
-  gpsKeys.insert( "$PFLAQ", 28);
-  gpsKeys.insert( "$PFLAX", 29);
-  gpsKeys.insert( "$ERROR", 30);
-#endif
+  const int count = sizeof(sentenceIds) / sizeof(sentenceIds[0]);
 
-  // Only for test purposes
-  gpsKeys.insert( "$PTAS", 42);
+  for( int i = 0; i < count; i++ )
+    {
+      gpsKeys.insert( sentenceIds[i].id, sentenceIds[i].key );
+    }
 
   gpsKeys.squeeze();
   mutex.unlock();
@@ -293,12 +314,10 @@ void GpsNmea::createGpsConnection()
 
   gpsObject = connector;
 
-  connect (gpsObject, SIGNAL(newSentence(const QString&)),
-           this, SLOT(slot_sentence(const QString&)) );
-
-  // Broadcasts the new NMEA sentence
-  connect (gpsObject, SIGNAL(newSentence(const QString&)),
-           this, SIGNAL(newSentence(const QString&)) );
+  // The sentences are delivered epoch by epoch. The single sentences are
+  // broadcasted by slot_sentences.
+  connect (gpsObject, SIGNAL(newSentences(const QStringList&, const QVector<qint64>&)),
+           this, SLOT(slot_sentences(const QStringList&, const QVector<qint64>&)) );
 
   // Broadcasts that a new Flarm flight list is available
   connect (gpsObject, SIGNAL(newFlarmFlightList(const QString&)),
@@ -363,6 +382,103 @@ void GpsNmea::startGpsReceiver()
     }
 }
 
+/**
+ * Maps the sentence identifier to the numbers of the table sentenceIds by a
+ * binary search over the packed identifiers. No hash key has to be created.
+ */
+short GpsNmea::sentenceKey( const NmeaField& id )
+{
+  if( id.size() > 8 )
+    {
+      // Longer identifiers are not in the table and would be cut by packing.
+      return -1;
+    }
+
+  const QVector<PackedSentenceId>& packedIds = packedSentenceIds();
+
+  PackedSentenceId wanted;
+  wanted.packed = NmeaSentence::idKey( id );
+  wanted.key = -1;
+
+  QVector<PackedSentenceId>::const_iterator it =
+    std::lower_bound( packedIds.constBegin(), packedIds.constEnd(), wanted );
+
+  if( it == packedIds.constEnd() || it->packed != wanted.packed )
+    {
+      return -1;
+    }
+
+  return it->key;
+}
+
+/**
+ * Processes all sentences of one epoch. The calculator relevant updates are
+ * emitted at the end in a defined order, so that the fix sees the position
+ * and altitude of its own epoch.
+ */
+void GpsNmea::slot_sentences( const QStringList& sentences,
+                              const QVector<qint64>& readTimes )
+{
+  _inEpoch = true;
+  _epochUpdates = 0;
+
+  for( int i = 0; i < sentences.size(); i++ )
+    {
+      _sampleTime = VirtualClock::msecsOfReadTime( i < readTimes.size() ? readTimes.at(i) : 0 );
+
+      slot_sentence( sentences.at(i) );
+
+      // Broadcasts the new NMEA sentence
+      emit newSentence( sentences.at(i) );
+    }
+
+  _inEpoch = false;
+
+  emitEpochUpdates();
+}
+
+void GpsNmea::emitEpochUpdates()
+{
+  uint updates = _epochUpdates;
+  _epochUpdates = 0;
+  _emitting = true;
+
+  if( updates & EpochSpeed )
+    {
+      emit newSpeed( _lastSpeed );
+    }
+
+  if( updates & EpochHeading )
+    {
+      emit newHeading( _lastHeading );
+    }
+
+  if( updates & EpochGnssAltitude )
+    {
+      emit newGNSSAltitude( _lastGNSSAltitude );
+    }
+
+  if( updates & EpochPressureAltitude )
+    {
+      _sampleTime = _pressureAltitudeTime;
+      emit newPressureAltitude( _lastPressureAltitude );
+    }
+
+  if( updates & EpochPosition )
+    {
+      LatencyTrace::mark( LatencyTrace::Parsed );
+      emit newPosition( _lastCoord );
+    }
+
+  if( updates & EpochFix )
+    {
+      _sampleTime = _fixSampleTime;
+      emit newFix( _lastRmcUtc );
+    }
+
+  _emitting = false;
+}
+
 /**
  * This slot is called by the GpsCon object when a new sentence has
  * arrived from the GPS receiver. The argument contains the sentence to
@@ -370,7 +486,7 @@ void GpsNmea::startGpsReceiver()
  */
 void GpsNmea::slot_sentence( const QString& sentenceIn )
 {
-  if( flarmNmeaOutInitDone == false && sentenceIn.startsWith( "$GPRMC" ) )
+  if( flarmNmeaOutInitDone == false && sentenceIn.startsWith( QLatin1String("$GPRMC") ) )
     {
       flarmNmeaOutInitDone = true;
 
@@ -384,10 +500,10 @@ void GpsNmea::slot_sentence( const QString& sentenceIn )
       sendSentence( FLARM_DEVTYPE_CMD );
     }
 
-  if( nmeaLogFile && nmeaLogFile->isOpen() )
+  if( nmeaLogger )
     {
-      // Write sentence into log file
-      nmeaLogFile->write(sentenceIn.toLatin1().data());
+      // Queue sentence for the log file
+      nmeaLogger->log( sentenceIn );
     }
 
   if( sentenceIn.isEmpty() )
@@ -404,31 +520,24 @@ void GpsNmea::slot_sentence( const QString& sentenceIn )
       return;
     }
 
-  QString sentence;
-
-  // Remove the checksum *hh<CR><LF> from the sentence. It was already checked
-  // in the receiver method.
-  int idx = sentenceIn.lastIndexOf( QChar('*') );
-
-  if( idx != -1 )
-    {
-      sentence = sentenceIn.left( idx );
-    }
-  else
+  // Split the sentence in single fields without allocating memory. The
+  // checksum *hh<CR><LF> was already checked in the receiver method and is
+  // removed. The first field contains the identifier, the rest the arguments.
+  if( nmea.parse( sentenceIn ) == false )
     {
-      sentence = sentenceIn;
+      return;
     }
 
-  // Split sentence in single parts for each comma and the checksum. The first
-  // part will contain the identifier, the rest the arguments.
-  QStringList slst = sentence.split( ",", Qt::KeepEmptyParts );
+  const short key = sentenceKey( nmea.id() );
 
-  if( ! gpsHash.contains(slst[0]) )
+  if( key < 0 )
     {
-      if( ! reportedUnknownKeys.contains(slst[0]) )
+      const quint64 idKey = nmea.idKey();
+
+      if( ! reportedUnknownKeys.contains(idKey) )
         {
-          qWarning() << "GpsNmea::slot_sentence: No Id found for" << slst[0];
-          reportedUnknownKeys.insert(slst[0]);
+          qWarning() << "GpsNmea::slot_sentence: No Id found for" << nmea.id().toString();
+          reportedUnknownKeys.insert(idKey);
         }
 
       return;
@@ -438,7 +547,7 @@ void GpsNmea::slot_sentence( const QString& sentenceIn )
 
 #ifdef FLARM
 
-  if( slst[0] == "$PFLAA" )
+  if( key == 20 ) // $PFLAA
     {
       // PFLAA receiving starts
       pflaaIsReceiving = true;
@@ -462,7 +571,7 @@ void GpsNmea::slot_sentence( const QString& sentenceIn )
 #if 0
 //aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa
 
-  if( slst[0] == "$GPRMC" )
+  if( nmea.id() == "$GPRMC" )
     {
       /**
        *   1     2    3    4      5         6            7                8
@@ -579,86 +688,86 @@ void GpsNmea::slot_sentence( const QString& sentenceIn )
 #endif
 
   // Call the decode methods for the known sentences
-  switch( gpsHash.value( slst[0] ) )
+  switch( key )
   {
     case 0: // GPRMC
-      if( slst[0].startsWith(_gpsSource) )
+      if( nmea.id().startsWith(_gpsSource) )
           {
-            __ExtractGprmc( slst );
+            __ExtractGprmc( nmea );
           }
       return;
 
     case 1: // GPGLL
-      if( slst[0].startsWith(_gpsSource) )
+      if( nmea.id().startsWith(_gpsSource) )
           {
-            __ExtractGpgll( slst );
+            __ExtractGpgll( nmea );
           }
       return;
 
     case 2: // GPGGA
-      if( slst[0].startsWith(_gpsSource) )
+      if( nmea.id().startsWith(_gpsSource) )
           {
-            __ExtractGpgga( slst );
+            __ExtractGpgga( nmea );
           }
       return;
 
     case 3: // GPGSA
-      if( slst[0].startsWith(_gpsSource) )
+      if( nmea.id().startsWith(_gpsSource) )
           {
-            __ExtractConstellation( slst );
+            __ExtractConstellation( nmea );
           }
       return;
 
     case 4: // GPGSV or GLGSV
-      // __ExtractSatsInView( slst );
+      // __ExtractSatsInView( nmea.toStringList() );
       return;
     case 5: // PGRMZ
-      __ExtractPgrmz( slst );
+      __ExtractPgrmz( nmea );
       return;
     case 6: // PCAID
-      __ExtractPcaid( slst );
+      __ExtractPcaid( nmea.toStringList() );
       return;
     case 7: // !w
-      __ExtractCambridgeW( slst );
+      __ExtractCambridgeW( nmea.toStringList() );
       return;
     case 8: // $PGCS
-      __ExtractPgcs( slst );
+      __ExtractPgcs( nmea.toStringList() );
       return;
     case 9: // $LXWP0
-      __ExtractLxwp0( slst );
+      __ExtractLxwp0( nmea );
       return;
     case 10: // $LXWP2
-      __ExtractLxwp2( slst );
+      __ExtractLxwp2( nmea.toStringList() );
       return;
     case 11: // $GPDTM
-      __ExtractGpdtm( slst );
+      __ExtractGpdtm( nmea.toStringList() );
       return;
 
     case 12: // $GNGNS
-      if( slst[0].startsWith(_gpsSource) )
+      if( nmea.id().startsWith(_gpsSource) )
           {
-            __ExtractGngns( slst );
+            __ExtractGngns( nmea );
           }
       return;
 
     case 13: // $POV,  OpenVario
-      __ExtractPov( slst );
+      __ExtractPov( nmea.toStringList() );
       return;
 
     case 14: // $PXCV, XCVario
-      __ExtractPxcv( slst );
+      __ExtractPxcv( nmea.toStringList() );
       return;
 
     case 15: // $GPVTG, $GNVTG
-      __ExtractGpvtg( slst );
+      __ExtractGpvtg( nmea );
       return;
 
     case 16: // $HCHDM compass magnetic heading
-      __ExtractHchdm( slst );
+      __ExtractHchdm( nmea.toStringList() );
       return;
 
     case 17: // $HCHDT compass true magnetic heading
-      __ExtractHchdt( slst );
+      __ExtractHchdt( nmea.toStringList() );
       return;
 
 #ifdef FLARM
@@ -666,55 +775,55 @@ void GpsNmea::slot_sentence( const QString& sentenceIn )
     case 20: // $PFLAA
       {
         Flarm::FlarmAcft aircraft;
-        Flarm::instance()->extractPflaa( slst, aircraft );
+        Flarm::instance()->extractPflaa( nmea, aircraft );
         return;
       }
 
     case 21: // $PFLAU
-      __ExtractPflau( slst );
+      __ExtractPflau( nmea );
       return;
 
     case 22: // $PFLAV
-      Flarm::instance()->extractPflav( slst );
+      Flarm::instance()->extractPflav( nmea.toStringList() );
       return;
 
     case 23: // $PFLAE
-      Flarm::instance()->extractPflae( slst );
+      Flarm::instance()->extractPflae( nmea.toStringList() );
       return;
 
     case 24: // $PFLAC
-      Flarm::instance()->extractPflac( slst );
+      Flarm::instance()->extractPflac( nmea.toStringList() );
       return;
 
     case 25: // $PFLAR
-      Flarm::instance()->extractPflar( slst );
+      Flarm::instance()->extractPflar( nmea.toStringList() );
       return;
 
     case 26: // $PFLAI
-      Flarm::instance()->extractPflai( slst );
+      Flarm::instance()->extractPflai( nmea.toStringList() );
       return;
 
     case 27: // $PFLAO
-      Flarm::instance()->extractPflao( slst );
+      Flarm::instance()->extractPflao( nmea.toStringList() );
       return;
 
     case 28: // $PFLAQ
-      Flarm::instance()->extractPflaq( slst );
+      Flarm::instance()->extractPflaq( nmea.toStringList() );
       return;
 
     case 29: // $PFLAX
-      Flarm::instance()->extractPflax( slst );
+      Flarm::instance()->extractPflax( nmea.toStringList() );
       return;
 
     case 30: // $ERROR
-      Flarm::instance()->extractError( slst );
+      Flarm::instance()->extractError( nmea.toStringList() );
       return;
 
 #endif
 
     case 42:
        // // Only for test purposes for simulating TAS in km/h
-       __ExtractTas( slst );
+       __ExtractTas( nmea.toStringList() );
        return;
 
     default:
@@ -752,37 +861,37 @@ void GpsNmea::slot_sentence( const QString& sentenceIn )
    12) Signal integrity, A=Autonomous mode
    13) Checksum, hh
 */
-void GpsNmea::__ExtractGprmc( const QStringList& slst )
+void GpsNmea::__ExtractGprmc( const NmeaSentence& sentence )
 {
-  if( slst.size() < 13 )
+  if( sentence.size() < 13 )
     {
       // Checksum has to be ignored in counting.
-      qWarning() << slst[0] << "contains too less parameters!";
+      qWarning() << sentence[0].toString() << "contains too less parameters!";
       return;
     }
 
   _gprmcSeen = true;
 
-  if( slst[2] == "A" )
+  if( sentence[2] == "A" )
     { /* Data status A=OK, V=warning */
       fixOK( "RMC" );
 
       static QTime lastUtcTime;
 
-      QTime utcTime = __ExtractTime(slst[1]);
+      QTime utcTime = __ExtractTime(sentence[1]);
 
       if( lastUtcTime == utcTime )
         {
-          // Only every second the RMC sentence is processed.
+          // Every fix time is processed only once.
           return;
         }
 
       lastUtcTime = utcTime;
 
-      __ExtractDate(slst[9]);
-      __ExtractKnotSpeed(slst[7]);
-      __ExtractCoord(slst[3],slst[4],slst[5],slst[6]);
-      __ExtractHeading(slst[8]);
+      __ExtractDate(sentence[9]);
+      __ExtractKnotSpeed(sentence[7]);
+      __ExtractCoord(sentence[3],sentence[4],sentence[5],sentence[6]);
+      __ExtractHeading(sentence[8]);
 
       if( _lastTime.isValid() && _lastDate.isValid() )
         {
@@ -797,7 +906,8 @@ void GpsNmea::__ExtractGprmc( const QStringList& slst )
 
           GeneralConfig *conf = GeneralConfig::instance();
 
-          if( updateClock && conf->getGpsSyncSystemClock() )
+          if( updateClock && conf->getGpsSyncSystemClock() &&
+              VirtualClock::isEnabled() == false )
             {
               // @AP: we make only one update to avoid confusing of running timers
               updateClock = false;
@@ -811,7 +921,14 @@ void GpsNmea::__ExtractGprmc( const QStringList& slst )
                * We do check the fix time only here in the $GPRMC sentence.
                */
               _lastRmcUtc = utc;
-              emit newFix( _lastRmcUtc );
+
+              // The fix time drives the virtual clock of a replay.
+              VirtualClock::setFixTime( utc );
+
+              if( deferUpdate( EpochFix ) == false )
+                {
+                  emit newFix( _lastRmcUtc );
+                }
             }
         }
     }
@@ -819,8 +936,8 @@ void GpsNmea::__ExtractGprmc( const QStringList& slst )
     {
       fixNOK( "RMC" );
 
-      QTime time = __ExtractTime( slst[1] );
-      QDate date = __ExtractDate( slst[9] );
+      QTime time = __ExtractTime( sentence[1] );
+      QDate date = __ExtractDate( sentence[9] );
 
       if( time.isValid() && date.isValid() )
         {
@@ -851,20 +968,20 @@ void GpsNmea::__ExtractGprmc( const QStringList& slst )
     6) Status A - Data Valid, V - Data Invalid
     7) Checksum
 */
-void GpsNmea::__ExtractGpgll( const QStringList& slst )
+void GpsNmea::__ExtractGpgll( const NmeaSentence& sentence )
 {
-  if( slst.size() < 7 )
+  if( sentence.size() < 7 )
     {
       // Checksum has to be ignored in counting.
-      qWarning() << slst[0] << "contains too less parameters!";
+      qWarning() << sentence[0].toString() << "contains too less parameters!";
       return;
     }
 
-  if (slst[6] == "A")
+  if (sentence[6] == "A")
     {
       fixOK( "GGL" );
-      __ExtractTime(slst[5]);
-      __ExtractCoord(slst[1],slst[2],slst[3],slst[4]);
+      __ExtractTime(sentence[5]);
+      __ExtractCoord(sentence[1],sentence[2],sentence[3],sentence[4]);
     }
   else
     {
@@ -903,16 +1020,16 @@ void GpsNmea::__ExtractGpgll( const QStringList& slst )
    14) Differential reference station ID, 0000-1023
    15) Checksum
 */
-void GpsNmea::__ExtractGpgga( const QStringList& slst )
+void GpsNmea::__ExtractGpgga( const NmeaSentence& sentence )
 {
-  if ( slst.size() < 15 )
+  if ( sentence.size() < 15 )
     {
       // Checksum has to be ignored in counting.
-      qWarning() << slst[0] << "contains too less parameters!";
+      qWarning() << sentence[0].toString() << "contains too less parameters!";
       return;
     }
 
-  if ( slst[6] != "0" && ! slst[6].isEmpty() )
+  if ( sentence[6] != "0" && ! sentence[6].isEmpty() )
     {
       /* a value of 0 means invalid fix and we don't need that one */
       if( _gprmcSeen == false )
@@ -924,21 +1041,21 @@ void GpsNmea::__ExtractGpgga( const QStringList& slst )
 
       static QTime lastUtcTime;
 
-      QTime utcTime = __ExtractTime(slst[1]);
+      QTime utcTime = __ExtractTime(sentence[1]);
 
       if( lastUtcTime == utcTime )
         {
-          // Only every second the GGA sentence is processed.
+          // Every fix time of the GGA sentence is processed only once.
           return;
         }
 
       lastUtcTime = utcTime;
 
-      __ExtractCoord(slst[2], slst[3], slst[4], slst[5]);
-      __ExtractAltitude(slst[9], slst[10]);
-      __ExtractSatsInView(slst[7]);
+      __ExtractCoord(sentence[2], sentence[3], sentence[4], sentence[5]);
+      __ExtractAltitude(sentence[9], sentence[10]);
+      __ExtractSatsInView(sentence[7]);
     }
-  else if( slst[6] == "0" )
+  else if( sentence[6] == "0" )
     {
       if( _gprmcSeen == false )
         {
@@ -980,32 +1097,32 @@ $GNGNS,124524.0,5227.153706,N,01335.903142,E,AA,15,0.7,37.5,43.0, ,  *54<CR><LF>
    12) Differential reference station ID, 0000-1023
    13) Checksum
  */
-void GpsNmea::__ExtractGngns( const QStringList& slst )
+void GpsNmea::__ExtractGngns( const NmeaSentence& sentence )
 {
-  if( slst.size() < 13 )
+  if( sentence.size() < 13 )
     {
       // Checksum has to be ignored in counting.
-      qWarning() << slst[0] << "contains too less parameters!";
+      qWarning() << sentence[0].toString() << "contains too less parameters!";
       return;
     }
 
-  if( slst[6].contains( "N") == false )
+  if( sentence[6].contains( 'N' ) == false )
     {
       static QTime lastUtcTime;
 
-      QTime utcTime = __ExtractTime(slst[1]);
+      QTime utcTime = __ExtractTime(sentence[1]);
 
       if( lastUtcTime == utcTime )
         {
-          // Only every second the GNS sentence is processed.
+          // Every fix time of the GNS sentence is processed only once.
           return;
         }
 
       lastUtcTime = utcTime;
 
-      __ExtractCoord(slst[2], slst[3], slst[4], slst[5]);
-      __ExtractAltitude(slst[9], QString("M"));
-      __ExtractSatsInView(slst[7]);
+      __ExtractCoord(sentence[2], sentence[3], sentence[4], sentence[5]);
+      __ExtractAltitude(sentence[9], NmeaField("M", 1));
+      __ExtractSatsInView(sentence[7]);
     }
 }
 
@@ -1038,25 +1155,25 @@ M    Manual input
 N    Data not valid
 
 */
-void GpsNmea::__ExtractGpvtg( const QStringList& slst )
+void GpsNmea::__ExtractGpvtg( const NmeaSentence& sentence )
 {
-  if ( slst.size() < 9 )
+  if ( sentence.size() < 9 )
     {
       // Checksum has to be ignored in counting.
       qWarning("$PGVTG contains too less parameters!");
       return;
     }
 
-  if( slst[2] == "T" )
+  if( sentence[2] == "T" )
     {
-      __ExtractHeading( slst[1] );
+      __ExtractHeading( sentence[1] );
     }
 
-  if( slst[4] == "M" )
+  if( sentence[4] == "M" )
     {
       bool ok = false;
 
-      double mh = slst[3].toDouble( &ok );
+      double mh = sentence[3].toDouble( &ok );
 
       if( ok == true )
         {
@@ -1065,9 +1182,9 @@ void GpsNmea::__ExtractGpvtg( const QStringList& slst )
         }
     }
 
-  if( slst[6] == "N" )
+  if( sentence[6] == "N" )
     {
-      __ExtractKnotSpeed( slst[5] );
+      __ExtractKnotSpeed( sentence[5] );
     }
 }
 
@@ -1164,9 +1281,9 @@ void GpsNmea::__ExtractHchdt( const QStringList& slst )
          3            Position fix dimensions 2 = FLARM barometric altitude
                                               3 = GPS altitude
 */
-void GpsNmea::__ExtractPgrmz( const QStringList& slst )
+void GpsNmea::__ExtractPgrmz( const NmeaSentence& sentence )
 {
-  if ( slst.size() < 4 )
+  if ( sentence.size() < 4 )
     {
       // Checksum has to be ignored in counting.
       qWarning("$PGRMZ contains too less parameters!");
@@ -1177,11 +1294,11 @@ void GpsNmea::__ExtractPgrmz( const QStringList& slst )
    * Garmin or Flarm proprietary sentence with pressure altitude information.
    * Only considered, if pressure device is Garmin or FLARM.
    */
-  if ( slst[3] == "2" &&
+  if ( sentence[3] == "2" &&
       (_pressureDevice == "Garmin" || _pressureDevice == "Flarm") )
     {
       bool ok;
-      double num = slst[1].toDouble( &ok );
+      double num = sentence[1].toDouble( &ok );
 
       if( ok )
         {
@@ -1199,16 +1316,19 @@ void GpsNmea::__ExtractPgrmz( const QStringList& slst )
               _lastPressureAltitude = altitude;
 
               // report new pressure altitude
-              emit newPressureAltitude( _lastPressureAltitude );
+              if( deferUpdate( EpochPressureAltitude ) == false )
+                {
+                  emit newPressureAltitude( _lastPressureAltitude );
+                }
             }
           }
 
         return;
       }
 
-  if ( slst[3] == "3" ) // 3=GPS altitude
+  if ( sentence[3] == "3" ) // 3=GPS altitude
     {
-      __ExtractAltitude(slst[1], slst[2]);
+      __ExtractAltitude(sentence[1], sentence[2]);
       return;
     }
 }
@@ -1278,7 +1398,10 @@ void GpsNmea::__ExtractPov( const QStringList& slst )
               _lastPressureAltitude = altitude;
 
               // report new pressure altitude
-              emit newPressureAltitude( _lastPressureAltitude );
+              if( deferUpdate( EpochPressureAltitude ) == false )
+                {
+                  emit newPressureAltitude( _lastPressureAltitude );
+                }
             }
         }
       else if( slst[i] == "Q" )
@@ -1504,7 +1627,10 @@ void GpsNmea::__ExtractPxcv( const QStringList& slst )
       _lastPressureAltitude = altitude;
 
       // report new pressure altitude
-      emit newPressureAltitude( _lastPressureAltitude );
+      if( deferUpdate( EpochPressureAltitude ) == false )
+        {
+          emit newPressureAltitude( _lastPressureAltitude );
+        }
     }
 
   // 9 - QQQQ.Q, Dynamic pressure in Pa
@@ -1680,7 +1806,10 @@ void GpsNmea::__ExtractPgcs( const QStringList& slst )
       // Store this value as pressure altitude.
       _lastPressureAltitude = res;
 
-      emit newPressureAltitude( _lastPressureAltitude );
+      if( deferUpdate( EpochPressureAltitude ) == false )
+        {
+          emit newPressureAltitude( _lastPressureAltitude );
+        }
     }
 }
 
@@ -1690,9 +1819,9 @@ void GpsNmea::__ExtractPgcs( const QStringList& slst )
   $PFLAU,<RX>,<TX>,<GPS>,<Power>,<AlarmLevel>,<RelativeBearing>,<AlarmType>,
   <RelativeVertical>,<RelativeDistance>,<ID>
   */
-void GpsNmea::__ExtractPflau( const QStringList& slst )
+void GpsNmea::__ExtractPflau( const NmeaSentence& sentence )
 {
-  bool res = Flarm::instance()->extractPflau( slst );
+  bool res = Flarm::instance()->extractPflau( sentence );
 
   if( res )
     {
@@ -1841,7 +1970,10 @@ void GpsNmea::__ExtractCambridgeW( const QStringList& stringList )
         _reportAltitude = false;
         _lastPressureAltitude = res; // store the new pressure altitude
 
-        emit newPressureAltitude( _lastPressureAltitude );
+        if( deferUpdate( EpochPressureAltitude ) == false )
+          {
+            emit newPressureAltitude( _lastPressureAltitude );
+          }
       }
     }
 
@@ -1914,13 +2046,13 @@ void GpsNmea::__ExtractCambridgeW( const QStringList& stringList )
     CS - checksum of total sentence
 */
 
-void GpsNmea::__ExtractLxwp0( const QStringList& stringList )
+void GpsNmea::__ExtractLxwp0( const NmeaSentence& sentence )
 {
   bool ok, ok1;
   Speed speed(0);
   double num = 0.0;
 
-  if ( stringList.size() < 13 )
+  if ( sentence.size() < 13 )
     {
       // Checksum has to be ignored in counting.
       qWarning("$LXWP0 contains too less parameters!");
@@ -1934,9 +2066,9 @@ void GpsNmea::__ExtractLxwp0( const QStringList& stringList )
     }
 
   // airspeed TAS in km/h
-  if( ! stringList[2].isEmpty() )
+  if( ! sentence[2].isEmpty() )
     {
-      num = stringList[2].toDouble( &ok );
+      num = sentence[2].toDouble( &ok );
 
       if( ok )
         {
@@ -1951,9 +2083,9 @@ void GpsNmea::__ExtractLxwp0( const QStringList& stringList )
     }
 
   // pressure altitude in meters
-  if( ! stringList[3].isEmpty() )
+  if( ! sentence[3].isEmpty() )
     {
-      num = stringList[3].toDouble( &ok );
+      num = sentence[3].toDouble( &ok );
 
       if( ok )
         {
@@ -1967,7 +2099,10 @@ void GpsNmea::__ExtractLxwp0( const QStringList& stringList )
               // store the new pressure altitude
               _lastPressureAltitude = altitude;
 
-              emit newPressureAltitude( _lastPressureAltitude );
+              if( deferUpdate( EpochPressureAltitude ) == false )
+                {
+                  emit newPressureAltitude( _lastPressureAltitude );
+                }
             }
         }
     }
@@ -1979,9 +2114,9 @@ void GpsNmea::__ExtractLxwp0( const QStringList& stringList )
 
   for( int i = 4; i < 10; i++ )
     {
-      if( ! stringList[i].isEmpty() )
+      if( ! sentence[i].isEmpty() )
         {
-          num = stringList[i].toDouble( &ok );
+          num = sentence[i].toDouble( &ok );
 
             if( ok )
               {
@@ -2004,13 +2139,13 @@ void GpsNmea::__ExtractLxwp0( const QStringList& stringList )
     }
 
   // heading degree of plane
-  num = __ExtractHeading( stringList[10] );
+  num = __ExtractHeading( sentence[10] );
 
   // extract wind direction in degrees
-  int windDir = static_cast<int> (rint(stringList[11].toDouble( &ok )));
+  int windDir = static_cast<int> (rint(sentence[11].toDouble( &ok )));
 
   // wind speed in km/h
-  num = stringList[12].toDouble( &ok1 );
+  num = sentence[12].toDouble( &ok1 );
   speed.setKph( num );
 
   // Wind is only emitted if a valid position fix is available.
@@ -2082,28 +2217,35 @@ void GpsNmea::__ExtractLxwp2( const QStringList& stringList )
 /**
  * This function returns a QTime from the time encoded in a MNEA sentence.
  */
-QTime GpsNmea::__ExtractTime(const QString& timeString)
+QTime GpsNmea::__ExtractTime(const NmeaField& timeString)
 {
-  if( timeString.isEmpty() && timeString.size() < 6 )
+  if( timeString.size() < 6 )
     {
-      // qWarning("Invalid GPS time %s", timeString.toLatin1().data());
+      // qWarning("Invalid GPS time %s", timeString.toString().toLatin1().data());
       return QTime();
     }
 
-  QString hh (timeString.left(2));
-  QString mm (timeString.mid(2,2));
-  QString ss (timeString.mid(4,2));
+  NmeaField hh (timeString.mid(0,2));
+  NmeaField mm (timeString.mid(2,2));
+  NmeaField ss (timeString.mid(4,2));
+
+  // High rate receivers deliver the time as hhmmss.sss. The fraction is kept,
+  // otherwise all fixes of one second would carry the same time and only the
+  // first of them would be processed.
+  int ms = 0;
+
+  if( timeString.size() > 7 && timeString.at(6) == '.' )
+    {
+      ms = qMin( qRound( timeString.mid(6).toDouble() * 1000.0 ), 999 );
+    }
 
-  // @AP: newer CF Cards can also provide milliseconds. In this case the time
-  // format is defined as hhmmss.sss. But we will not use it to avoid problems
-  // with our fixes.
-  QTime res = QTime( hh.toInt(), mm.toInt(), ss.toInt() );
+  QTime res = QTime( hh.toInt(), mm.toInt(), ss.toInt(), ms );
 
   // @AP: don't overtake invalid times. They will cause invalid fixes!
   if ( ! res.isValid() )
     {
       qWarning("GpsNmea::__ExtractTime(): Invalid time %s! Ignoring it (%s, %d)",
-               timeString.toLatin1().data(), __FILE__, __LINE__ );
+               timeString.toString().toLatin1().data(), __FILE__, __LINE__ );
       return QTime();
     }
 
@@ -2114,17 +2256,17 @@ QTime GpsNmea::__ExtractTime(const QString& timeString)
 
 /** This function returns a QDate from the date string encoded in a
     NWEA sentence as "ddmmyy". */
-QDate GpsNmea::__ExtractDate(const QString& dateString)
+QDate GpsNmea::__ExtractDate(const NmeaField& dateString)
 {
-  if( dateString.isEmpty() && dateString.size() != 6 )
+  if( dateString.size() < 6 )
     {
-      // qWarning("Invalid GPS date %s", dateString.toLatin1().data());
+      // qWarning("Invalid GPS date %s", dateString.toString().toLatin1().data());
       return QDate();
     }
 
-  QString dd (dateString.left(2));
-  QString mm (dateString.mid(2,2));
-  QString yy (dateString.right(2));
+  NmeaField dd (dateString.mid(0,2));
+  NmeaField mm (dateString.mid(2,2));
+  NmeaField yy (dateString.mid(dateString.size() - 2));
 
   /*we assume that we only use this after the year 2000, which is
     reasonable since this is made 2002 ...*/
@@ -2141,14 +2283,14 @@ QDate GpsNmea::__ExtractDate(const QString& dateString)
   else
     {
       qWarning("GpsNmea::__ExtractDate(): Invalid date %s! Ignoring it (%s, %d)",
-               dateString.toLatin1().data(), __FILE__, __LINE__ );
+               dateString.toString().toLatin1().data(), __FILE__, __LINE__ );
     }
 
   return res;
 }
 
 /** This function returns a Speed from the speed encoded in knots */
-Speed GpsNmea::__ExtractKnotSpeed(const QString& speedString)
+Speed GpsNmea::__ExtractKnotSpeed(const NmeaField& speedString)
 {
   Speed res;
 
@@ -2168,13 +2310,16 @@ Speed GpsNmea::__ExtractKnotSpeed(const QString& speedString)
   res.setKnot( speed );
   _lastSpeed = res;
 
-  emit newSpeed( _lastSpeed );
+  if( deferUpdate( EpochSpeed ) == false )
+    {
+      emit newSpeed( _lastSpeed );
+    }
   return res;
 }
 
 /** This function converts the coordinate data from the NMEA sentence to the internal QPoint format. */
-QPoint GpsNmea::__ExtractCoord(const QString& slat, const QString& slatNS,
-                               const QString& slon, const QString& slonEW)
+QPoint GpsNmea::__ExtractCoord(const NmeaField& slat, const NmeaField& slatNS,
+                               const NmeaField& slon, const NmeaField& slonEW)
 {
   /* The internal KFLog format for coordinates represents coordinates in 10.000'st of a minute.
      So, one minute corresponds to 10.000, one degree to 600.000 and one second to 167.
@@ -2194,11 +2339,11 @@ QPoint GpsNmea::__ExtractCoord(const QString& slat, const QString& slatNS,
 
   bool ok1, ok2, ok3, ok4;
 
-  lat  = slat.left(2).toInt(&ok1);
-  fLat = slat.mid(2).toFloat(&ok2);
+  lat  = slat.mid(0,2).toInt(&ok1);
+  fLat = slat.mid(2).toDouble(&ok2);
 
-  lon  = slon.left(3).toInt(&ok3);
-  fLon = slon.mid(3).toFloat(&ok4);
+  lon  = slon.mid(0,3).toInt(&ok3);
+  fLon = slon.mid(3).toDouble(&ok4);
 
   if( !ok1 || !ok2 || !ok3 || !ok4 )
     {
@@ -2229,14 +2374,18 @@ QPoint GpsNmea::__ExtractCoord(const QString& slat, const QString& slatNS,
   if ( _lastCoord != res )
     {
       _lastCoord=res;
-      emit newPosition( _lastCoord );
+
+      if( deferUpdate( EpochPosition ) == false )
+        {
+          emit newPosition( _lastCoord );
+        }
     }
 
   return _lastCoord;
 }
 
 /** Extract the heading from the NMEA sentence. */
-double GpsNmea::__ExtractHeading(const QString& headingstring)
+double GpsNmea::__ExtractHeading(const NmeaField& headingstring)
 {
   if( headingstring.isEmpty() )
     {
@@ -2253,7 +2402,11 @@ double GpsNmea::__ExtractHeading(const QString& headingstring)
     }
 
   _lastHeading = heading;
-  emit newHeading( _lastHeading );
+
+  if( deferUpdate( EpochHeading ) == false )
+    {
+      emit newHeading( _lastHeading );
+    }
 
   return heading;
 }
@@ -2289,7 +2442,7 @@ void GpsNmea::__ExtractTas( const QStringList& data )
 /**
  * Extracts the altitude from a NMEA GGA sentence.
  */
-Altitude GpsNmea::__ExtractAltitude( const QString& altitude, const QString& unit )
+Altitude GpsNmea::__ExtractAltitude( const NmeaField& altitude, const NmeaField& unit )
 {
   // qDebug("alt=%s, unit=%s", altitude.toLatin1().data(), unitAlt.toLatin1().data() );
   bool ok;
@@ -2304,7 +2457,7 @@ Altitude GpsNmea::__ExtractAltitude( const QString& altitude, const QString& uni
 
   // Check for other unit as meters, meters is the default.
   // Consider user's altitude correction
-  if ( unit.toLower() == "f" )
+  if ( unit == "f" || unit == "F" )
     {
       res.setFeet( alt );
     }
@@ -2316,7 +2469,11 @@ Altitude GpsNmea::__ExtractAltitude( const QString& altitude, const QString& uni
   if( _lastGNSSAltitude != res )
     {
       _lastGNSSAltitude = res;
-      emit newGNSSAltitude( _lastGNSSAltitude );
+
+      if( deferUpdate( EpochGnssAltitude ) == false )
+        {
+          emit newGNSSAltitude( _lastGNSSAltitude );
+        }
     }
 
   return res;
@@ -2343,16 +2500,16 @@ Altitude GpsNmea::__ExtractAltitude( const QString& altitude, const QString& uni
 
   Extracts the constellation from the NMEA sentence.
 */
-QString GpsNmea::__ExtractConstellation(const QStringList& sentence)
+QString GpsNmea::__ExtractConstellation( const NmeaSentence& sentence )
 {
   if ( sentence.size() < 18 )
     {
       // Checksum has to be ignored in counting.
-      qWarning() << sentence[0] << "contains too less parameters!";
+      qWarning() << sentence[0].toString() << "contains too less parameters!";
       return "";
     }
 
-  QString result, tmp;
+  QString result;
 
   if( sentence[2] != "" )
     {
@@ -2388,8 +2545,14 @@ QString GpsNmea::__ExtractConstellation(const QStringList& sentence)
       if( sentence[i] != "" )
         {
           _lastSatInfo.satsInUse++;
-          tmp = QString( "%1" ).arg( sentence[i], 2, QChar('0') );
-          result += tmp;
+
+          // Satellite ids are reported with two digits.
+          if( sentence[i].size() < 2 )
+            {
+              result += QLatin1Char('0');
+            }
+
+          result += QLatin1String( sentence[i].data(), sentence[i].size() );
         }
     }
 
@@ -2423,7 +2586,7 @@ QString GpsNmea::__ExtractConstellation(const QStringList& sentence)
 }
 
 /** Extracts the satellite count in view from the NMEA sentence. */
-bool GpsNmea::__ExtractSatsInView(const QString& satcount)
+bool GpsNmea::__ExtractSatsInView(const NmeaField& satcount)
 {
   bool ok;
 
@@ -2996,32 +3159,31 @@ void GpsNmea::__ExtractSatsInView( const QString& id,
  */
 void GpsNmea::slot_openNmeaLogFile()
 {
-  QString logStart = QDateTime::currentDateTime().toString( Qt::ISODate );
-  QString fname = GeneralConfig::instance()->getUserDataDirectory() +
-                  "/CumulusNmea_" + logStart + ".log";
-
-  if( nmeaLogFile == 0 )
+  if( nmeaLogger != 0 )
     {
-      QFileInfo fi(fname);
+      return;
+    }
 
-      if( fi.exists() && fi.size() > 0 )
-        {
-          QFile::remove( fname + ".old" );
-          QFile::rename ( fname, fname + ".old" );
-        }
+  GeneralConfig *conf = GeneralConfig::instance();
 
-      nmeaLogFile = new QFile(fname);
-    }
+  QString logStart = QDateTime::currentDateTime().toString( Qt::ISODate );
+  QString fname = conf->getUserDataDirectory() +
+                  (conf->getGpsNmeaLogFlarmOnly() ? "/CumulusFlarm_" : "/CumulusNmea_") +
+                  logStart;
 
-  if( !nmeaLogFile->isOpen() )
-    {
-      bool ok = nmeaLogFile->open( QIODevice::WriteOnly | QIODevice::Text );
+  nmeaLogger = new NmeaLogger( this, fname,
+                               conf->getGpsNmeaLogCompression(),
+                               qint64( conf->getGpsNmeaLogMaxSize() ) * 1024 * 1024 );
 
-      if( ! ok )
-        {
-          qWarning() << "Cannot open file" << fname;
-        }
+  if( conf->getGpsNmeaLogFlarmOnly() )
+    {
+      // Record only the traffic stream of the Flarm, it can be replayed by
+      // the NMEA simulator.
+      nmeaLogger->setFilter( QStringList() << "$PFLAU" << "$PFLAA"
+                                           << "$PFLAE" << "$PFLAO" );
     }
+
+  nmeaLogger->start( QThread::LowPriority );
 }
 
 /**
@@ -3029,14 +3191,10 @@ void GpsNmea::slot_openNmeaLogFile()
  */
 void GpsNmea::slot_closeNmeaLogFile()
 {
-  if( nmeaLogFile )
+  if( nmeaLogger )
     {
-      if( nmeaLogFile->isOpen() )
-        {
-          nmeaLogFile->close();
-        }
-
-      delete nmeaLogFile;
-      nmeaLogFile = 0;
+      nmeaLogger->stop();
+      delete nmeaLogger;
+      nmeaLogger = 0;
     }
 }
@@ -46,11 +46,16 @@
 #include <QFile>
 #include <QSet>
 #include <QMutex>
+#include <QVector>
 
 #include "speed.h"
 #include "altitude.h"
 #include "wgspoint.h"
 #include "gpscon.h"
+#include "NmeaSentence.h"
+#include "VirtualClock.h"
+
+class NmeaLogger;
 
 struct SatInfo
   {
@@ -182,6 +187,16 @@ class GpsNmea : public QObject
         return _lastUtc;
       };
 
+    /**
+     * @return the sample time of the currently processed or emitted data in
+     * the time base of VirtualClock::msecsSinceReference(). It is the read
+     * time of the sentence, that has delivered the data.
+     */
+    qint64 getSampleTime() const
+      {
+        return _inEpoch || _emitting ? _sampleTime : VirtualClock::msecsSinceReference();
+      };
+
     /**
      * @return the last known coordinate in KFLog format (x=lat, y=lon).
      */
@@ -343,6 +358,16 @@ class GpsNmea : public QObject
      */
     static void getGpsMessageKeys( QHash<QString, short>& gpsKeys );
 
+    /**
+     * Maps a sentence identifier to its decoder number.
+     *
+     * @param id sentence identifier, e.g. $GPRMC
+     *
+     * @return decoder number as used by getGpsMessageKeys or -1, if the
+     *         identifier is unknown.
+     */
+    static short sentenceKey( const NmeaField& id );
+
   public slots: // Public slots
 
     /**
@@ -352,6 +377,16 @@ class GpsNmea : public QObject
      */
     void slot_sentence(const QString& sentence);
 
+    /**
+     * This slot is called by the GpsCon object with all sentences of one
+     * GPS epoch. The position, altitude, speed, heading and fix updates are
+     * emitted only once after the whole epoch was processed.
+     *
+     * The read times of the sentences are the monotonic clock in nano seconds.
+     * They can be empty, if the read times are unknown.
+     */
+    void slot_sentences(const QStringList& sentences, const QVector<qint64>& readTimes);
+
     /**
      * This slot is called if the object needs to reset. It is
      * used to destroy the serial connection and create a new
@@ -562,24 +597,65 @@ class GpsNmea : public QObject
                       const double accelarationZ );
   private:
 
+    /** Updates, which are collected during an epoch. */
+    enum EpochUpdate
+    {
+      EpochSpeed            = 0x01,
+      EpochHeading          = 0x02,
+      EpochGnssAltitude     = 0x04,
+      EpochPressureAltitude = 0x08,
+      EpochPosition         = 0x10,
+      EpochFix              = 0x20
+    };
+
+    /**
+     * Remembers the passed update, if an epoch is processed.
+     *
+     * \return true, if the update is deferred to the end of the epoch.
+     */
+    bool deferUpdate( const EpochUpdate update )
+    {
+      if( _inEpoch == false )
+        {
+          return false;
+        }
+
+      _epochUpdates |= update;
+
+      // The sample time is restored, when the update is emitted.
+      if( update == EpochPressureAltitude )
+        {
+          _pressureAltitudeTime = _sampleTime;
+        }
+      else if( update == EpochFix )
+        {
+          _fixSampleTime = _sampleTime;
+        }
+
+      return true;
+    };
+
+    /** Emits the updates collected during an epoch. */
+    void emitEpochUpdates();
+
     /** Resets all data objects to their initial values. This is called
      *  at startup, at restart and if the GPS fix has been lost. */
     void resetDataObjects();
 
     /** Extracts GPRMC sentence. */
-    void __ExtractGprmc( const QStringList& slst );
+    void __ExtractGprmc( const NmeaSentence& sentence );
 
     /** Extracts GPGLL sentence. */
-    void __ExtractGpgll( const QStringList& slst );
+    void __ExtractGpgll( const NmeaSentence& sentence );
 
     /** Extracts GPGGA sentence. */
-    void __ExtractGpgga( const QStringList& slst );
+    void __ExtractGpgga( const NmeaSentence& sentence );
 
     /** Extracts GNGNS sentence. */
-    void __ExtractGngns( const QStringList& slst );
+    void __ExtractGngns( const NmeaSentence& sentence );
 
     /** Extracts PGRMZ sentence. */
-    void __ExtractPgrmz( const QStringList& slst );
+    void __ExtractPgrmz( const NmeaSentence& sentence );
 
     /** Extracts PCAID sentence. */
     void __ExtractPcaid( const QStringList& slst );
@@ -597,7 +673,7 @@ class GpsNmea : public QObject
     void __ExtractGpdtm( const QStringList& slst );
 
     /** Extracts GPVTG sentence. */
-    void __ExtractGpvtg( const QStringList& slst );
+    void __ExtractGpvtg( const NmeaSentence& sentence );
 
     /**
      * Extracts HCHDM sentence, magnetic compass with magnetic heading
@@ -613,25 +689,25 @@ class GpsNmea : public QObject
 
 #ifdef FLARM
     /** Extracts PFLAU sentence. */
-    void __ExtractPflau( const QStringList& slst );
+    void __ExtractPflau( const NmeaSentence& sentence );
 #endif
 
     /** This function return a QTime from the time encoded in a MNEA sentence. */
-    QTime __ExtractTime(const QString& timestring);
+    QTime __ExtractTime(const NmeaField& timestring);
     /** This function return a QDate from the date encoded in a MNEA sentence. */
-    QDate __ExtractDate(const QString& datestring);
+    QDate __ExtractDate(const NmeaField& datestring);
     /** This function return a Speed from the speed encoded in knots */
-    Speed __ExtractKnotSpeed(const QString& speedstring);
+    Speed __ExtractKnotSpeed(const NmeaField& speedstring);
     /** This function converts the coordinate data from the NMEA sentence to the internal QPoint coordinate format. */
-    QPoint __ExtractCoord(const QString& slat, const QString& slatNS, const QString& slon, const QString& slonEW);
+    QPoint __ExtractCoord(const NmeaField& slat, const NmeaField& slatNS, const NmeaField& slon, const NmeaField& slonEW);
     /** Extract the heading from the NMEA sentence. */
-    double __ExtractHeading(const QString& headingstring);
+    double __ExtractHeading(const NmeaField& headingstring);
     /** Extracts the altitude from a NMEA GGA or Gramin/Flarm PGRMZ sentence */
-    Altitude __ExtractAltitude(const QString& altitude, const QString& unit);
+    Altitude __ExtractAltitude(const NmeaField& altitude, const NmeaField& unit);
     /** Extracts the constellation from the NMEA sentence. */
-    QString __ExtractConstellation(const QStringList& sentence);
+    QString __ExtractConstellation(const NmeaSentence& sentence);
     /** Extracts the satellites in view from the NMEA sentence. */
-    bool __ExtractSatsInView(const QString& satcount);
+    bool __ExtractSatsInView(const NmeaField& satcount);
     /** Extracts satellites In View (SIV) info from a NMEA sentence. */
     void __ExtractSatsInView(const QStringList& sentence);
     /** Extracts satellites In View (SIV) info from a NMEA sentence. */
@@ -642,7 +718,7 @@ class GpsNmea : public QObject
      * Extracts speed, altitude, vario, heading, wind data from LX Navigation $LXWP0
      * sentence.
      */
-    void __ExtractLxwp0(const QStringList& stringList);
+    void __ExtractLxwp0(const NmeaSentence& sentence);
     /**
      * Extracts McCready data from LX Navigation $LXWP2 sentence.
      */
@@ -802,12 +878,30 @@ class GpsNmea : public QObject
     /** Flag to enable/disable the GPS data processing. */
     bool _enableGpsDataProcessing;
 
-    /** NMEA log file */
-    QFile* nmeaLogFile;
+    /** NMEA logger thread */
+    NmeaLogger* nmeaLogger;
 
     /** Flag to indicate the receive of GPRMC. */
     bool _gprmcSeen;
 
+    /** Flag to indicate, that the sentences of an epoch are processed. */
+    bool _inEpoch;
+
+    /** Updates collected during the current epoch, see EpochUpdate. */
+    uint _epochUpdates;
+
+    /** Flag to indicate, that the updates of an epoch are emitted. */
+    bool _emitting;
+
+    /** Read time of the current sentence, see getSampleTime(). */
+    qint64 _sampleTime;
+
+    /** Read time of the sentence with the deferred pressure altitude. */
+    qint64 _pressureAltitudeTime;
+
+    /** Read time of the sentence with the deferred fix. */
+    qint64 _fixSampleTime;
+
     /** Flag to indicate the receive of GPRMZ. */
     bool _baroAltitudeSeen;
 
@@ -824,11 +918,11 @@ class GpsNmea : public QObject
     // number of created class instances
     static short instances;
 
-    // Dictionary with known sentence keywords
-    static QHash<QString, short> gpsHash;
+    // Tokenizer reused for all received sentences
+    NmeaSentence nmea;
 
-    // Set with reported unknown GPS keys
-    QSet<QString> reportedUnknownKeys;
+    // Set with reported unknown GPS keys, see NmeaSentence::idKey
+    QSet<quint64> reportedUnknownKeys;
 
     /** Mutex for thread synchronization. */
     static QMutex mutex;
@@ -21,6 +21,7 @@
 #include "generalconfig.h"
 #include "gpsstatusdialog.h"
 #include "gpsnmea.h"
+#include "LatencyTrace.h"
 #include "layout.h"
 #include "MainWindow.h"
 
@@ -53,6 +54,11 @@ GpsStatusDialog::GpsStatusDialog(QWidget * parent) :
   connect( uTimer, SIGNAL(timeout()), this,
            SLOT(slot_updateGpsMessageDisplay()) );
 
+  lTimer = new QTimer( this );
+
+  connect( lTimer, SIGNAL(timeout()), this,
+           SLOT(slot_updateLatencyDisplay()) );
+
   elevAziDisplay = new GpsElevationAzimuthDisplay(this);
   snrDisplay     = new GpsSnrDisplay(this);
 
@@ -70,6 +76,17 @@ GpsStatusDialog::GpsStatusDialog(QWidget * parent) :
 
   nmeaBox->setFont(f);
 
+  // The fix latency percentiles are displayed as table.
+  latencyBox = new QLabel;
+  latencyBox->setTextFormat(Qt::PlainText);
+  latencyBox->setMargin(5);
+  latencyBox->setToolTip( tr("Age of the GPS fix at its processing stages") );
+
+  QFont lf = QFontDatabase::systemFont( QFontDatabase::FixedFont );
+  lf.setPixelSize(14);
+
+  latencyBox->setFont(lf);
+
   QScrollArea *nmeaScrollArea = new QScrollArea;
   nmeaScrollArea->setWidgetResizable( true );
   nmeaScrollArea->setWidget(nmeaBox);
@@ -111,6 +128,7 @@ GpsStatusDialog::GpsStatusDialog(QWidget * parent) :
 
   QVBoxLayout* topLayout = new QVBoxLayout( this );
   topLayout->addLayout( hBox, 1 );
+  topLayout->addWidget( latencyBox );
   topLayout->addLayout( nmeaBoxLayout, 2 );
 
   connect( satSource, SIGNAL(currentIndexChanged(int)),
@@ -124,6 +142,9 @@ GpsStatusDialog::GpsStatusDialog(QWidget * parent) :
   connect( save, SIGNAL(clicked()), this, SLOT(slot_SaveNmeaData()) );
 
   connect( close, SIGNAL(clicked()), this, SLOT(slot_Close()) );
+
+  slot_updateLatencyDisplay();
+  lTimer->start( 1000 );
 }
 
 GpsStatusDialog::~GpsStatusDialog()
@@ -313,6 +334,11 @@ void GpsStatusDialog::slot_updateGpsMessageDisplay()
   nmeaBox->setText(nmeaData);
 }
 
+void GpsStatusDialog::slot_updateLatencyDisplay()
+{
+  latencyBox->setText( LatencyTrace::report().trimmed() );
+}
+
 /**
  * Called if the start/stop button is pressed to start or stop NMEA display.
  */
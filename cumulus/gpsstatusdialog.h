@@ -136,6 +136,11 @@ private slots:
    */
   void slot_updateGpsMessageDisplay();
 
+  /**
+   * Called to update the fix latency display.
+   */
+  void slot_updateLatencyDisplay();
+
   /**
    * Called if close button is pressed.
    */
@@ -155,6 +160,7 @@ protected:
   GpsElevationAzimuthDisplay *elevAziDisplay;
   GpsSnrDisplay              *snrDisplay;
   QLabel                     *nmeaBox;
+  QLabel                     *latencyBox;
   QPushButton                *startStop;
   QPushButton                *save;
   QComboBox                  *satSource;
@@ -185,6 +191,9 @@ protected:
   /** GPS message display update timer. */
   QTimer *uTimer;
 
+  /** Fix latency display update timer. */
+  QTimer *lTimer;
+
   /** contains the current number of class instances */
   static int noOfInstances;
 };
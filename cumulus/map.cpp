@@ -15,6 +15,7 @@
  **
  ***********************************************************************/
 
+#include <algorithm>
 #include <ctype.h>
 #include <cstdlib>
 #include <cmath>
@@ -33,6 +34,7 @@
 #include "flarmaliaslist.h"
 #include "generalconfig.h"
 #include "gpsnmea.h"
+#include "LatencyTrace.h"
 #include "layout.h"
 #include "hwinfo.h"
 #include "map.h"
@@ -46,6 +48,7 @@
 #include "reachablelist.h"
 #include "runway.h"
 #include "singlepoint.h"
+#include "VirtualClock.h"
 #include "wgspoint.h"
 #include "whatsthat.h"
 #include "waypoint.h"
@@ -767,6 +770,9 @@ void Map::paintEvent(QPaintEvent* event)
 
       p.drawPixmap( event->rect().left(), event->rect().top(), m_pixPaintBuffer,
                     0, 0, event->rect().width(), event->rect().height() );
+
+      // The new position is on the screen.
+      LatencyTrace::mark( LatencyTrace::Painted );
     }
 #if 0
   else
@@ -803,18 +809,6 @@ void Map::p_drawAirspaces( bool reset )
 
   cuAeroMapP.begin(&m_pixAeroMap);
 
-  // Get airspace filter data
-  QHash<QString, QMultiHash<QString, QString> > asfs =
-      AirspaceFilters::getAirspaceFilters();
-
-  // AS type mapper from stored as-type to shown as-type
-  QHash<QString, QString> astMapper;
-  astMapper.insert( "Restricted", "AR" );
-  astMapper.insert( "Danger", "AD" );
-  astMapper.insert( "Prohibited", "AP" );
-  astMapper.insert( "AS-E low", "AS-El" );
-  astMapper.insert( "AS-E high", "AS-Eh" );
-
   QElapsedTimer t;
   t.start();
 
@@ -852,22 +846,28 @@ void Map::p_drawAirspaces( bool reset )
   // The border is stored as FL
   uint asBorder = (uint) rint(settings->getAirspaceDrawingBorder() * 100.0 * Distance::mFromFeet );
 
-  // Two airspace lists have to be processed.
-  SortableAirspaceList* asl[2];
+  // Two airspace lists have to be processed, the airspaces in the map area
+  // and the Flarm alert zones.
+  QVector<Airspace*> asl[2];
+
+  _globalMapContents->queryAirspaces( _globalMapMatrix->getMapBorder(),
+                                      INT_MIN,
+                                      drawingBorder ? int(asBorder) : INT_MAX,
+                                      asl[0] );
 
-  asl[0] = _globalMapContents->getAirspaceList();
-  asl[1] = _globalMapContents->getFlarmAlertZoneList();
+  std::sort( asl[0].begin(), asl[0].end(), CompareAirspaces() );
+
+  asl[1] = _globalMapContents->getFlarmAlertZoneList()->toVector();
 
   QList<Airspace*> gsAs;
   QList<qreal> gsOpacity;
 
   for( int i = 0; i < 2; i++ )
     {
-      for( int loop = 0; loop < asl[i]->size(); loop++ )
+      for( int loop = 0; loop < asl[i].size(); loop++ )
         {
           AirRegion* region = 0;
-          SortableAirspaceList* asList = asl[i];
-          Airspace* currentAirS = dynamic_cast<Airspace *> (asList->value(loop));
+          Airspace* currentAirS = asl[i].at(loop);
 
           if( currentAirS == 0 || currentAirS->isDrawable() == false )
             {
@@ -875,60 +875,17 @@ void Map::p_drawAirspaces( bool reset )
               continue;
             }
 
-          // Check airspace against airspace filters
-          // Key of AS Hash is country. Value is a multi hash where key is
-          // AS-Type and value is AS-Name
-          QString asCountry = currentAirS->getCountry();
-
-          if( asCountry.isEmpty() == true )
+          if( i == 0 && currentAirS->getTypeID() == BaseMapElement::AirFlarm )
             {
-              // Country is not set. In this case we use * as country selector.
-              // That is a workaround for openair files, which have no county
-              // definitions inside.
-              asCountry = "*";
+              // The Flarm alert zones are found by the query too but are
+              // drawn in the second pass.
+              continue;
             }
 
-          if( asfs.contains( asCountry ) == true )
+          // Check airspace against the compiled airspace filters
+          if( AirspaceFilters::isFiltered( currentAirS ) == true )
             {
-              // Country filter is defined
-              QMultiHash<QString, QString> countryFilter = asfs[asCountry];
-
-              // get AS-Type as string
-              QString asType = currentAirS->getTypeName(currentAirS->getTypeID() );
-
-              // map back displayed airspace type to stored airspace type.
-              if( astMapper.contains( asType ) == true )
-                {
-                  QString asTypeShown = astMapper.value( asType );
-                  asType = asTypeShown;
-                }
-
-              // Look for Airspace type in country filters data
-              if( countryFilter.contains( asType ) == true )
-                {
-                  QList<QString> asNames = countryFilter.values( asType );
-
-                  // get airspace name
-                  QString asName = currentAirS->getName();
-
-                  bool ignore = false;
-
-                  // Look, if airspace should be filtered out.
-                  for( int i = 0; i < asNames.size(); i++ )
-                    {
-                      if( asName.startsWith( asNames.at( i )) == true )
-                        {
-                          // filter out this airspace
-                          qDebug() << "Filter out AS " << asType << ": " << asName;
-                          ignore = true;
-                        }
-                    }
-
-                  if( ignore == true )
-                    {
-                      continue;
-                    }
-                }
+              continue;
             }
 
           if( drawingBorder == true )
@@ -1765,7 +1722,8 @@ void Map::p_drawNavigationLayer()
                    isLandable );
     }
 
-  // Second draw all collected hotspot point labels
+  // Second draw all collected hotspot point labels. The hotspots found by
+  // Flarm have a reachability and are labeled like landable points.
   for( int i = 0; i < drawnHs.size(); i++ )
     {
       p_drawLabel( &navP,
@@ -1774,7 +1732,7 @@ void Map::p_drawNavigationLayer()
                    _globalMapMatrix->map( drawnHs[i]->getPosition() ),
                    drawnHs[i]->getWGSPosition(),
                    drawnHs[i]->getElevation(),
-                   false );
+                   ReachableList::getDistance( drawnHs[i]->getWGSPosition() ).isValid() );
     }
 
   // Third draw all collected task point labels
@@ -2480,6 +2438,8 @@ void Map::slotPosition(const QPoint& newPos, const int source)
 
   if( source == Calculator::GPS )
     {
+      LatencyTrace::mark( LatencyTrace::Positioned );
+
       if( m_curGPSPos != newPos )
         {
           m_curGPSPos = newPos;
@@ -2597,27 +2557,31 @@ void Map::p_drawOtherAircraft()
   // Load selected Flarm object. It is empty in case of no selection.
   QString& selectedObject = FlarmDisplay::getSelectedObject();
 
-  bool selectedObjectFound = false;
+  // All objects are taken from the same snapshot as in the radar view.
+  const FlarmTraffic::Snapshot& traffic = Flarm::getTraffic();
 
-  if( ! selectedObject.isEmpty() && Flarm::getPflaaHash().contains(selectedObject) )
+  const FlarmTraffic::Target* selectedTarget = 0;
+
+  if( ! selectedObject.isEmpty() )
     {
-      selectedObjectFound = true;
+      selectedTarget = traffic.find( Flarm::idFromString( selectedObject ) );
     }
 
+  // The objects are drawn at their positions extrapolated to this time.
+  const qint64 now = VirtualClock::msecsSinceReference();
+
   // Check, if Flarm most relevant object is identical to selected object
-  if( selectedObjectFound )
+  if( selectedTarget != 0 )
     {
-      const Flarm::FlarmAcft& flarmAcft = Flarm::getPflaaHash().value( selectedObject );
-
-      if( status.ID == flarmAcft.ID )
+      if( status.ID == selectedTarget->acft().ID )
         {
           // Draw only selected object because both objects are identical
-          p_drawSelectedFlarmObject( flarmAcft );
+          p_drawSelectedFlarmObject( *selectedTarget, now );
         }
       else
         {
           // Draw both most relevant object and selected object
-          p_drawSelectedFlarmObject( flarmAcft );
+          p_drawSelectedFlarmObject( *selectedTarget, now );
           p_drawMostRelevantObject( status );
         }
     }
@@ -2643,11 +2607,13 @@ void Map::p_drawOtherAircraft()
               continue;
             }
 
-          if( Flarm::getPflaaHash().contains( ids[i] ) == true )
+          const FlarmTraffic::Target* target =
+              traffic.find( Flarm::idFromString( ids[i] ) );
+
+          if( target != 0 )
             {
               // ID is contained in current collected data
-              const Flarm::FlarmAcft& flarmAcft = Flarm::getPflaaHash().value( ids[i] );
-              p_drawSelectedFlarmObject( flarmAcft );
+              p_drawSelectedFlarmObject( *target, now );
             }
         }
     }
@@ -2658,26 +2624,17 @@ void Map::p_drawOtherAircraft()
  */
 void Map::p_drawMostRelevantObject( const Flarm::FlarmStatus& status )
 {
-  if( status.RelativeBearing.isEmpty() ||
-      status.RelativeVertical.isEmpty() ||
-      status.RelativeDistance.isEmpty() ||
+  if( status.hasRelativePosition() == false ||
       status.Alarm == Flarm::No )
     {
       // no valid data available resp. no alarm
       return;
     }
-  // compute true bearing to other aircraft
-  bool ok1, ok2, ok3;
 
-  int relBearing  = status.RelativeBearing.toInt( &ok1 );
-  int relVertical = status.RelativeVertical.toInt( &ok2 );
-  int relDistance = status.RelativeDistance.toInt( &ok3 );
-
-  if( ! (ok1 & ok2 & ok3) )
-    {
-      // conversion error
-      return;
-    }
+  // compute true bearing to other aircraft
+  int relBearing  = status.RelativeBearing;
+  int relVertical = status.RelativeVertical;
+  int relDistance = status.RelativeDistance;
 
   // calculate true heading to the other object
   int th = MapCalc::normalize( static_cast<int> ( GpsNmea::gps->getLastHeading()) + relBearing );
@@ -2772,8 +2729,15 @@ void Map::p_drawMostRelevantObject( const Flarm::FlarmStatus& status )
 /**
  * Draws the user selected Flarm object.
  */
-void Map::p_drawSelectedFlarmObject( const Flarm::FlarmAcft& flarmAcft )
+void Map::p_drawSelectedFlarmObject( const FlarmTraffic::Target& target,
+                                     const qint64 time )
 {
+  Flarm::FlarmAcft flarmAcft;
+  target.extrapolate( time, flarmAcft );
+
+  // An object, which was not reported recently, is marked as extrapolated.
+  const bool coasting = target.isCoasting( time );
+
   QPoint other;
   double distance = 0.0;
   int usedObjectSize;
@@ -2866,18 +2830,24 @@ void Map::p_drawSelectedFlarmObject( const Flarm::FlarmAcft& flarmAcft )
     }
 
   // add first 3 letters of id or alias name to text.
-  QString id = flarmAcft.ID.left( 3 );
+  const QString key = Flarm::idToString( flarmAcft.ID );
+  QString id = key.left( 3 );
 
   // Check, if id can be mapped to an alias name
   QHash<QString, QPair<QString, bool> >& fa = FlarmAliasList::getAliasHash();
 
-  if( fa.contains( flarmAcft.ID ) == true )
+  if( fa.contains( key ) == true )
     {
-      id = fa.value( flarmAcft.ID ).first.left( 3 );
+      id = fa.value( key ).first.left( 3 );
     }
 
   text += " " + id;
 
+  if( coasting )
+    {
+      text += "?";
+    }
+
   QRect textRect = painter.fontMetrics().boundingRect( text );
 
   int xOffset = 0;
@@ -3043,6 +3013,42 @@ void Map::slotRedraw( Map::mapLayer fromLayer )
   scheduleRedraw(fromLayer);
 }
 
+void Map::slotRedrawAirspaces( const QRect& area )
+{
+  if( _globalMapMatrix->getMapBorder().intersects( area ) )
+    {
+      scheduleRedraw( airspaces );
+    }
+}
+
+void Map::removeAirRegion( Airspace* as )
+{
+  AirRegion* region = as->getAirRegion();
+
+  if( region == 0 )
+    {
+      return;
+    }
+
+  m_airspaceRegionList.removeOne( region );
+
+  // The region resets the reference in the airspace.
+  delete region;
+}
+
+void Map::forgetAirspace( Airspace* as )
+{
+  removeAirRegion( as );
+
+  for( int i = 0; i < m_asConflicts.size(); i++ )
+    {
+      if( m_asConflicts.at(i).airspace == as )
+        {
+          m_asConflicts[i].airspace = 0;
+        }
+    }
+}
+
 /** Used to zoom the map out. Will schedule a redraw. */
 void Map::slotZoomOut()
 {
@@ -3327,30 +3333,9 @@ void Map::checkAirspace(const QPoint& pos)
   // fetch warning suppress time from configuration and compute it as milli seconds
   int warSupMS = GeneralConfig::instance()->getWarningSuppressTime() * 60 * 1000;
 
-  if( warSupMS > 0 )
-    {
-      // Tidy up suppress maps with stored conflicts, if warning suppression time
-      // is set.
-      QMutableMapIterator<QString, QElapsedTimer> it(m_insideAsMapTouchTime);
-      QMutableMapIterator<QString, QElapsedTimer> vt(m_veryNearAsMapTouchTime);
-      QMutableMapIterator<QString, QElapsedTimer> nt(m_nearAsMapTouchTime);
-
-      clearAirspaceMap( it, warSupMS );
-      clearAirspaceMap( vt, warSupMS );
-      clearAirspaceMap( nt, warSupMS );
-    }
-
   // fetch warning show time and compute it as milli seconds
   int showTime = GeneralConfig::instance()->getWarningDisplayTime() * 1000;
 
-  // maps to collect the new and the old conflicting airspaces.
-  QMap<QString, int> newInsideAsMap;
-  QMap<QString, int> allInsideAsMap;
-  QMap<QString, int> newVeryNearAsMap;
-  QMap<QString, int> allVeryNearAsMap;
-  QMap<QString, int> newNearAsMap;
-  QMap<QString, int> allNearAsMap;
-
   AltitudeCollection alt = calculator->getAltitudeCollection();
   AirspaceWarningDistance awd = GeneralConfig::instance()->getAirspaceWarningDistances();
 
@@ -3358,18 +3343,74 @@ void Map::checkAirspace(const QPoint& pos)
   Airspace::ConflictType vConflict=Airspace::none, lastVConflict=Airspace::none;
   Airspace::ConflictType conflict= Airspace::none, lastConflict= Airspace::none;
 
-  bool warn = false; // warning flag
-  QElapsedTimer timer; // time control
-  timer.start();
+  // Start a new check round. The levels of the last round are saved for the
+  // transition detection.
+  for( int i = 0; i < m_asConflicts.size(); i++ )
+    {
+      AirspaceConflict& ac = m_asConflicts[i];
+      ac.lastLevel = ac.level;
+      ac.level = Airspace::none;
+    }
+
+  // Only the airspaces around our current position are checked. They are
+  // taken from the airspace indexes with a box, which covers the near warning
+  // distance, and with an altitude window, which covers the vertical near
+  // warning distances for all altitude references used by Airspace::conflicts.
+  // The airspaces in conflict of the last round are added, so that leaving
+  // them is detected too.
+  QRect box = MapCalc::areaBox( pos, awd.horClose.getKilometers() );
+
+  double altMin = qMin( alt.gpsAltitude.getMeters(), alt.stdAltitude.getMeters() );
+  double altMax = qMax( alt.gpsAltitude.getMeters(), alt.stdAltitude.getMeters() );
+
+  altMin = qMin( altMin, alt.gndAltitude.getMeters() - alt.gndAltitudeError.getMeters() );
+  altMax = qMax( altMax, alt.gndAltitude.getMeters() + alt.gndAltitudeError.getMeters() );
+  altMax = qMax( altMax, 1.0 );
+
+  const int lower = (int) floor( altMin - qMax( awd.verAboveClose.getMeters(),
+                                                awd.verAboveVeryClose.getMeters() ) ) - 1;
+  const int upper = (int) ceil( altMax + qMax( awd.verBelowClose.getMeters(),
+                                               awd.verBelowVeryClose.getMeters() ) ) + 1;
+
+  QPolygon corners( 4 );
+  corners.setPoint( 0, _globalMapMatrix->wgsToMap( box.topLeft() ) );
+  corners.setPoint( 1, _globalMapMatrix->wgsToMap( box.topRight() ) );
+  corners.setPoint( 2, _globalMapMatrix->wgsToMap( box.bottomLeft() ) );
+  corners.setPoint( 3, _globalMapMatrix->wgsToMap( box.bottomRight() ) );
+
+  _globalMapContents->queryAirspaces( corners.boundingRect(), lower, upper,
+                                      m_asCandidates );
+
+  for( int i = 0; i < m_asConflicts.size(); i++ )
+    {
+      const AirspaceConflict& ac = m_asConflicts.at(i);
+
+      if( ac.airspace != 0 && ac.lastLevel != Airspace::none )
+        {
+          m_asCandidates.append( ac.airspace );
+        }
+    }
+
+  std::sort( m_asCandidates.begin(), m_asCandidates.end() );
+  m_asCandidates.erase( std::unique( m_asCandidates.begin(), m_asCandidates.end() ),
+                        m_asCandidates.end() );
 
   // check if there are overlaps between the region around our current position and airspaces
-  for( int loop = 0; loop < m_airspaceRegionList.count(); loop++ )
+  for( int loop = 0; loop < m_asCandidates.size(); loop++ )
     {
-      Airspace* pSpace = m_airspaceRegionList.at(loop)->m_airspace;
+      Airspace* pSpace = m_asCandidates.at(loop);
+      AirRegion* region = pSpace->getAirRegion();
 
-      if( pSpace->getTypeID() == BaseMapElement::AirFir )
+      if( region == 0 )
         {
-          // FIRs are not included in the conflict checks.
+          // Airspaces without region are not drawn and not checked.
+          continue;
+        }
+
+      if( pSpace->getTypeID() == BaseMapElement::AirFir ||
+          AirspaceFilters::isFiltered( pSpace ) == true )
+        {
+          // FIRs and filtered airspaces are not included in the conflict checks.
           continue;
         }
 
@@ -3384,7 +3425,7 @@ void Map::checkAirspace(const QPoint& pos)
         }
 
       lastVConflict = pSpace->lastVConflict();
-      lastHConflict = m_airspaceRegionList.at(loop)->currentConflict();
+      lastHConflict = region->currentConflict();
       lastConflict = (lastHConflict < lastVConflict ? lastHConflict : lastVConflict);
 
       // check for vertical conflicts at first
@@ -3399,7 +3440,7 @@ void Map::checkAirspace(const QPoint& pos)
         }
 
       // check for horizontal conflicts
-      hConflict = m_airspaceRegionList.at(loop)->conflicts(pos, awd);
+      hConflict = region->conflicts(pos, awd);
 
       // the resulting conflict is always the lesser of the two
       conflict = (hConflict < vConflict ? hConflict : vConflict);
@@ -3421,111 +3462,18 @@ void Map::checkAirspace(const QPoint& pos)
           continue;
         }
 
-      // process conflicts
-      switch (conflict)
-        {
-        case Airspace::inside:
-
-          // collect all conflicting airspaces
-          allInsideAsMap.insert( pSpace->getInfoString(), pSpace->getTypeID() );
+      // Airspaces with the same id share one state, the highest level wins.
+      AirspaceConflict& ac = airspaceConflict( pSpace );
+      ac.airspace = pSpace;
 
-          // Check, if airspace is to suppress
-          if( warSupMS > 0 )
-            {
-              if( m_insideAsMapTouchTime.contains( pSpace->getInfoString()) )
-                {
-                  // Yes suppress airspace
-                  continue;
-                }
-
-              // Add airspace to suppression control map
-              m_insideAsMapTouchTime.insert( pSpace->getInfoString(), timer );
-            }
-
-          // Check, if airspace is already known as conflict
-          if( ! m_insideAsMap.contains( pSpace->getInfoString() ) )
-            {
-              // insert new airspace text and airspace type into the map
-              newInsideAsMap.insert( pSpace->getInfoString(), pSpace->getTypeID() );
-              warn = true;
-            }
-
-          continue;
-
-        case Airspace::veryNear:
-
-          // collect all conflicting airspaces
-          allVeryNearAsMap.insert( pSpace->getInfoString(), pSpace->getTypeID() );
-
-          // Check, if airspace is to suppress
-          if( warSupMS > 0 )
-            {
-              if( m_veryNearAsMapTouchTime.contains(pSpace->getInfoString()) )
-                {
-                  // Yes suppress airspace
-                  continue;
-                }
-
-              // Add airspace to suppression control map
-              m_veryNearAsMapTouchTime.insert( pSpace->getInfoString(), timer );
-            }
-
-          // Check, if airspace is already known as conflict. A warning is setup
-          // only, if the previous state was not inside to avoid senseless alarms.
-          if( ! m_veryNearAsMap.contains( pSpace->getInfoString() ) &&
-              ! m_insideAsMap.contains( pSpace->getInfoString() ) )
-            {
-              // insert new airspace text and airspace type into the hash
-              newVeryNearAsMap.insert( pSpace->getInfoString(), pSpace->getTypeID() );
-              warn = true;
-            }
-
-          continue;
-
-        case Airspace::near:
-
-          // collect all conflicting airspaces
-          allNearAsMap.insert( pSpace->getInfoString(), pSpace->getTypeID() );
-
-          // Check, if airspace is to suppress
-          if( warSupMS > 0 )
-            {
-              if( m_nearAsMapTouchTime.contains(pSpace->getInfoString()) )
-                {
-                  // Yes suppress airspace
-                  continue;
-                }
-
-              // Add airspace to suppression control map
-              m_nearAsMapTouchTime.insert( pSpace->getInfoString(), timer );
-            }
-
-          // Check, if airspace is already known as conflict. A warning is setup
-          // only, if the previous state was not inside or very near to avoid
-          // senseless alarms.
-          if( ! m_nearAsMap.contains( pSpace->getInfoString() ) &&
-              ! m_veryNearAsMap.contains( pSpace->getInfoString() ) &&
-              ! m_insideAsMap.contains( pSpace->getInfoString() ) )
-            {
-              // insert new airspace text and airspace type into the hash
-              newNearAsMap.insert( pSpace->getInfoString(), pSpace->getTypeID() );
-              warn = true;
-            }
-
-          continue;
-
-        case Airspace::none:
-        default:
-
-          continue;
+      if( conflict > ac.level )
+        {
+          ac.level = conflict;
         }
 
     } // End of For loop
 
-  // save all conflicting airspaces for the next round
-  m_insideAsMap   = allInsideAsMap;
-  m_veryNearAsMap = allVeryNearAsMap;
-  m_nearAsMap     = allNearAsMap;
+  updateAirspaceConflictEvents( warSupMS );
 
   // redraw the airspaces if needed
   if (needAirspaceRedraw && fillingEnabled)
@@ -3538,158 +3486,212 @@ void Map::checkAirspace(const QPoint& pos)
       return;
     }
 
-  QString severity = tr("Warning");
+  // Only the airspaces with the highest new conflict level are displayed.
+  // A warning is only setup for a raised level to avoid senseless alarms.
+  int warnLevel = Airspace::none;
+
+  for( int i = 0; i < m_asConflictEvents.size(); i++ )
+    {
+      const AirspaceConflictEvent& ev = m_asConflictEvents.at(i);
+
+      if( ev.to > ev.from &&
+          m_asConflicts.at( ev.index ).suppressed == false &&
+          ev.to > warnLevel )
+        {
+          warnLevel = ev.to;
+        }
+    }
 
-  if( ! newInsideAsMap.isEmpty() )
+  if( warnLevel == Airspace::none )
     {
-      severity = tr("Alarm");
+      return;
     }
 
+  QString severity = ( warnLevel == Airspace::inside ) ? tr("Alarm") : tr("Warning");
+
   // warning text, contains only conflict changes
   QString text = "<html><table border=1 cellpadding=\"2\"><tr><th align=center>" +
                  tr("Airspace") + "&nbsp;" + severity +
                  "</th></tr>";
 
-  QString msg; // status message containing all conflicting airspaces
+  appendAirspaceConflicts( text, warnLevel, true );
 
-  // Only the airspace with the highest priority will be displayed and updated.
-  // First we do look step by step for new results according to our predefined
-  // priority.
-  if ( ! newInsideAsMap.isEmpty() )
-    {
-      // new inside has been found
-      msg += tr("Inside") + " ";
-      QMapIterator<QString, int> i(allInsideAsMap);
-      bool first = true;
+  // Pop up a warning window with all data to touched airspace
+  text += "</table></html>";
 
-      while ( i.hasNext()  )
-        {
-           i.next();
+  if( GeneralConfig::instance()->getPopupAirspaceWarnings() )
+    {
+      emit alarm( "", true );
+      WhatsThat *box = new WhatsThat( _globalMainWindow, text, showTime );
+      box->show();
+    }
+}
 
-           if( ! first )
-            {
-              msg += ", ";
-            }
-          else
-            {
-              first = false;
-            }
+Map::AirspaceConflict& Map::airspaceConflict( Airspace* as )
+{
+  const quint32 id = as->getId();
 
-          msg += Airspace::getTypeName( (BaseMapElement::objectType) i.value() );
-        }
+  // Binary search in the table sorted by airspace id.
+  int lo = 0;
+  int hi = m_asConflicts.size();
 
-      QMapIterator<QString, int> j(newInsideAsMap);
+  while( lo < hi )
+    {
+      int mid = (lo + hi) / 2;
 
-      while ( j.hasNext()  )
+      if( m_asConflicts.at(mid).id < id )
         {
-           j.next();
+          lo = mid + 1;
+        }
+      else
+        {
+          hi = mid;
+        }
+    }
 
-           text += "<tr><td align=left>"
-                + tr("Inside") + " "
-                + "</td></tr><tr><td align=left>"
-                + j.key()
-                + "</td></tr>";
-          }
+  if( lo < m_asConflicts.size() && m_asConflicts.at(lo).id == id )
+    {
+      return m_asConflicts[lo];
     }
-  else if( ! newVeryNearAsMap.isEmpty() )
+
+  AirspaceConflict ac;
+  ac.id         = id;
+  ac.airspace   = as;
+  ac.level      = Airspace::none;
+  ac.lastLevel  = Airspace::none;
+  ac.suppressed = false;
+
+  m_asConflicts.insert( lo, ac );
+  return m_asConflicts[lo];
+}
+
+void Map::updateAirspaceConflictEvents( const int suppressTime )
+{
+  // The event list keeps its capacity, no allocation in the normal case.
+  m_asConflictEvents.resize( 0 );
+
+  int kept = 0;
+
+  for( int i = 0; i < m_asConflicts.size(); i++ )
     {
-      // new very near has been found
-      msg += tr("Very Near") + " ";
+      AirspaceConflict& ac = m_asConflicts[i];
 
-      QMapIterator<QString, int> i(allVeryNearAsMap);
-      bool first = true;
+      ac.suppressed = false;
 
-      while ( i.hasNext()  )
+      bool touched = false;
+
+      for( int j = 0; j < 3; j++ )
         {
-          i.next();
+          if( ac.touchTime[j].isValid() &&
+              ( suppressTime <= 0 || ac.touchTime[j].elapsed() > suppressTime ) )
+            {
+              // Suppression time of the conflict level is expired.
+              ac.touchTime[j].invalidate();
+            }
+
+          touched |= ac.touchTime[j].isValid();
+        }
 
-          if( ! first )
+      if( ac.level != Airspace::none && suppressTime > 0 )
+        {
+          // A conflict level touched again within the suppress time is not
+          // warned again.
+          QElapsedTimer& tt = ac.touchTime[ac.level - 1];
+
+          if( tt.isValid() )
             {
-              msg += ", ";
+              ac.suppressed = true;
             }
           else
             {
-              first = false;
+              tt.start();
+              touched = true;
             }
-
-          msg += Airspace::getTypeName( (BaseMapElement::objectType) i.value() );
         }
 
-      QMapIterator<QString, int> j(newVeryNearAsMap);
-
-      while ( j.hasNext()  )
+      if( ac.level == ac.lastLevel && ac.level == Airspace::none && touched == false )
         {
-           j.next();
+          // Entry is no longer needed.
+          continue;
+        }
 
-           text += "<tr><td align=left>"
-                + tr("Very Near") + " "
-                + "</td></tr><tr><td align=left>"
-                + j.key()
-                + "</td></tr>";
-          }
-     }
-  else if ( ! newNearAsMap.isEmpty() )
-    {
-      // new near has been found
-      msg += tr("Near") + " ";
-      QMapIterator<QString, int> i(allNearAsMap);
-      bool first = true;
+      if( kept != i )
+        {
+          m_asConflicts[kept] = ac;
+        }
 
-      while ( i.hasNext()  )
+      if( ac.level != ac.lastLevel )
         {
-          i.next();
+          AirspaceConflictEvent ev;
 
-          if( ! first )
+          if( ac.lastLevel == Airspace::none )
             {
-              msg += ", ";
+              ev.kind = AirspaceConflictEvent::Enter;
+            }
+          else if( ac.level == Airspace::none )
+            {
+              ev.kind = AirspaceConflictEvent::Leave;
             }
           else
             {
-              first = false;
+              ev.kind = AirspaceConflictEvent::LevelChange;
             }
 
-          msg += Airspace::getTypeName( (BaseMapElement::objectType) i.value() );
-       }
+          ev.index = kept;
+          ev.from  = ac.lastLevel;
+          ev.to    = ac.level;
+          m_asConflictEvents.append( ev );
+        }
 
-      QMapIterator<QString, int> j(newNearAsMap);
+      kept++;
+    }
 
-      while ( j.hasNext()  )
-        {
-           j.next();
+  m_asConflicts.resize( kept );
+}
 
-           text += "<tr><td align=left>"
-                + tr("Near") + " "
-                + "</td></tr><tr><td align=left>"
-                + j.key()
-                + "</td></tr>";
-          }
+void Map::appendAirspaceConflicts( QString& text, const int level,
+                                   const bool newOnly )
+{
+  QString levelText;
+
+  switch( level )
+    {
+      case Airspace::inside:
+        levelText = tr("Inside");
+        break;
+      case Airspace::veryNear:
+        levelText = tr("Very Near");
+        break;
+      default:
+        levelText = tr("Near");
+        break;
     }
 
-  // Pop up a warning window with all data to touched airspace
-  if ( warn == true )
+  for( int i = 0; i < m_asConflicts.size(); i++ )
     {
-      text += "</table></html>";
+      const AirspaceConflict& ac = m_asConflicts.at(i);
 
-      if( GeneralConfig::instance()->getPopupAirspaceWarnings() )
+      if( ac.level != level || ac.airspace == 0 )
         {
-          emit alarm( "", true );
-          WhatsThat *box = new WhatsThat( _globalMainWindow, text, showTime );
-          box->show();
-          return;
+          continue;
         }
-    }
-}
 
-void Map::clearAirspaceMap( QMutableMapIterator<QString, QElapsedTimer>& it,
-                            int suppressTime )
-{
-  while( it.hasNext () )
-    {
-      it.next();
+      if( newOnly )
+        {
+          if( ac.lastLevel >= level || ac.suppressed )
+            {
+              continue;
+            }
 
-      if( it.value().elapsed() > suppressTime )
+          text += "<tr><td align=left>"
+                + levelText + " "
+                + "</td></tr><tr><td align=left>"
+                + ac.airspace->getInfoString()
+                + "</td></tr>";
+        }
+      else
         {
-          it.remove();
+          text += "<tr><td>" + ac.airspace->getInfoString() + "</td></tr>";
         }
     }
 }
@@ -3721,9 +3723,20 @@ void Map::slotShowAirspaceStatus()
 
   QString endTable = "</table></html>";
 
-  if( m_insideAsMap.size() == 0 &&
-       m_veryNearAsMap.size() == 0 &&
-       m_nearAsMap.size() == 0 )
+  // count the conflicts per level
+  int count[4] = { 0, 0, 0, 0 };
+
+  for( int i = 0; i < m_asConflicts.size(); i++ )
+    {
+      if( m_asConflicts.at(i).airspace != 0 )
+        {
+          count[m_asConflicts.at(i).level]++;
+        }
+    }
+
+  if( count[Airspace::inside] == 0 &&
+      count[Airspace::veryNear] == 0 &&
+      count[Airspace::near] == 0 )
     {
       text += "<tr><td align=center>" +
               tr("No Airspace violation") + " " +
@@ -3735,46 +3748,28 @@ void Map::slotShowAirspaceStatus()
       return;
     }
 
-  if( m_insideAsMap.size() )
+  if( count[Airspace::inside] )
     {
       text += "<tr><td align=center><b>" +
               tr("Inside") + "</b></td></tr>";
 
-      QMapIterator<QString, int> it(m_insideAsMap);
-
-      while (it.hasNext())
-        {
-          it.next();
-          text += "<tr><td>" + it.key() + "</td></tr>";
-        }
+      appendAirspaceConflicts( text, Airspace::inside, false );
     }
 
-  if( m_veryNearAsMap.size() )
+  if( count[Airspace::veryNear] )
     {
       text += "<tr><td align=center><b>" +
               tr("Very Near") + "</b></td></tr>";
 
-      QMapIterator<QString, int> it(m_veryNearAsMap);
-
-      while (it.hasNext())
-        {
-          it.next();
-          text += "<tr><td>" + it.key() + "</td></tr>";
-        }
+      appendAirspaceConflicts( text, Airspace::veryNear, false );
     }
 
-  if( m_nearAsMap.size() )
+  if( count[Airspace::near] )
     {
       text += "<tr><td align=center><b>" +
               tr("Near") + "</b></td></tr>";
 
-      QMapIterator<QString, int> it(m_nearAsMap);
-
-      while (it.hasNext())
-        {
-          it.next();
-          text += "<tr><td>" + it.key() + "</td></tr>";
-        }
+      appendAirspaceConflicts( text, Airspace::near, false );
     }
 
   box = new WhatsThat( this, text, showTime );
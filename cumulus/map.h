@@ -30,7 +30,6 @@
 #pragma once
 
 #include <QMap>
-#include <QMutableMapIterator>
 #include <QElapsedTimer>
 #include <QPoint>
 #include <QWidget>
@@ -45,6 +44,7 @@
 #include <QResizeEvent>
 #include <QRect>
 #include <QTime>
+#include <QVector>
 #include <QWheelEvent>
 
 #include "airspace.h"
@@ -66,6 +66,9 @@ private:
 
   Q_DISABLE_COPY ( Map )
 
+  /** The airspace benchmark measures the private airspace drawing. */
+  friend class AirspaceBenchmark;
+
 public:
 
   /**
@@ -203,8 +206,26 @@ public:
       qDeleteAll(m_airspaceRegionList);
       m_airspaceRegionList.clear();
       m_airspaceRegionList = QList<AirRegion *>();
+
+      // The airspace objects can be deleted now, the conflict states are kept.
+      for( int i = 0; i < m_asConflicts.size(); i++ )
+        {
+          m_asConflicts[i].airspace = 0;
+        }
     };
 
+  /**
+   * Removes the region of the passed airspace from the airspace region list.
+   * The region is created again at the next drawing of the airspaces.
+   */
+  void removeAirRegion( Airspace* as );
+
+  /**
+   * Removes all references to the passed airspace. Must be called before the
+   * airspace is deleted.
+   */
+  void forgetAirspace( Airspace* as );
+
 public slots:
 
   /** This slot is called, if a new wind value is available. */
@@ -221,6 +242,13 @@ public slots:
   /** Scheduled redraw of the map starting up passed layer. */
   void slotRedraw( Map::mapLayer fromLayer );
 
+  /**
+   * Scheduled redraw of the airspaces, if the passed area in projected
+   * coordinates is visible in the map. Changes outside of the map need no
+   * redraw.
+   */
+  void slotRedrawAirspaces( const QRect& area );
+
   /**
    * This slot is called to set a new position. The map object
    * determines if it is necessary to recenter the map or if
@@ -523,14 +551,28 @@ private:
   void p_drawRelBearingInfo();
 
   /**
-   * Clears all entries from the map, where the suppress time has expired.
+   * Returns the conflict state entry of the passed airspace. A new entry is
+   * inserted, if the airspace is not yet contained.
+   */
+  struct AirspaceConflict& airspaceConflict( Airspace* as );
+
+  /**
+   * Detects the conflict level transitions of the last check and collects
+   * them as events. Entries without conflict and active suppression are
+   * removed.
    *
-   * \param it Mutable iterator of the map to be cleared
+   * \param suppressTime Warning suppress time in milli seconds.
+   */
+  void updateAirspaceConflictEvents( const int suppressTime );
+
+  /**
+   * Appends all airspaces with the passed conflict level as table rows to
+   * the passed text.
    *
-   * \param suppressTime Elapsed suppress time for removing of map element.
+   * \param newOnly Appends only airspaces, which entered the level.
    */
-  void clearAirspaceMap( QMutableMapIterator<QString, QElapsedTimer>& it,
-                         int suppressTime );
+  void appendAirspaceConflicts( QString& text, const int level,
+                                const bool newOnly );
 
 #ifdef FLARM
 
@@ -546,9 +588,11 @@ private:
   void p_drawMostRelevantObject( const Flarm::FlarmStatus& status );
 
   /**
-   * Draws the user selected Flarm object.
+   * Draws the user selected Flarm object at its position extrapolated to
+   * the passed time in ms of the virtual clock.
    */
-  void p_drawSelectedFlarmObject( const Flarm::FlarmAcft& flarmAcft );
+  void p_drawSelectedFlarmObject( const FlarmTraffic::Target& target,
+                                  const qint64 time );
 
   /** Pixmaps used by Flarm for object drawing */
   QPixmap blackCircle;
@@ -693,15 +737,41 @@ protected:
 
   QPixmap m_glider[36];
 
-  /** Airspace conflicts */
-  QMap<QString, int> m_insideAsMap;   // AS Text and AS type
-  QMap<QString, int> m_veryNearAsMap; // AS Text and AS type
-  QMap<QString, int> m_nearAsMap;     // AS Text and AS type
+  /**
+   * Conflict state of an airspace, identified by its stable airspace id.
+   * The conflict levels are the values of Airspace::ConflictType.
+   */
+  struct AirspaceConflict
+  {
+    quint32   id;
+    Airspace* airspace;   // valid, if level is not none
+    quint8    level;      // level of the last check
+    quint8    lastLevel;  // level of the check before
+    bool      suppressed; // warning of the last check is suppressed
+    QElapsedTimer touchTime[3]; // touch times of near, very near and inside
+  };
+
+  /**
+   * Conflict level change of an airspace, produced by checkAirspace.
+   */
+  struct AirspaceConflictEvent
+  {
+    enum Kind { Enter, Leave, LevelChange };
+
+    Kind   kind;
+    int    index; // index in the conflict table
+    quint8 from;
+    quint8 to;
+  };
+
+  /** Airspace conflict table, sorted by airspace id. */
+  QVector<AirspaceConflict> m_asConflicts;
+
+  /** Conflict events of the last airspace check. */
+  QVector<AirspaceConflictEvent> m_asConflictEvents;
 
-  /* Airspace conflicts touch times */
-  QMap<QString, QElapsedTimer> m_insideAsMapTouchTime;   // AS Text and touch time
-  QMap<QString, QElapsedTimer> m_veryNearAsMapTouchTime; // AS Text and touch time
-  QMap<QString, QElapsedTimer> m_nearAsMapTouchTime;     // AS Text and touch time
+  /** Airspaces to be checked in the current airspace check. */
+  QVector<Airspace*> m_asCandidates;
 
   /** List of drawn cities. */
   QList<BaseMapElement *> m_drawnCityList;
@@ -14,6 +14,7 @@
  **
  ***********************************************************************/
 
+#include <climits>
 #include <cmath>
 #include <cstdlib>
 #include <unistd.h>
@@ -41,7 +42,9 @@
 #include "mapview.h"
 #include "projectionbase.h"
 #include "resource.h"
+#include "speed.h"
 #include "TaskFileManager.h"
+#include "VirtualClock.h"
 #include "waypointcatalog.h"
 #include "wgspoint.h"
 
@@ -83,6 +86,7 @@ const short MapContents::isoLevels[] =
 
 MapContents::MapContents(QObject* parent, WaitScreen* waitscreen) :
     QObject(parent),
+    flarmAlertZones(airspaceIndex),
     unloadDone(false),
     memoryFull(false),
     isFirst(true),
@@ -146,6 +150,13 @@ MapContents::MapContents(QObject* parent, WaitScreen* waitscreen) :
 
   currentTask = 0;
 
+  flarmAlertZoneTimer = new QTimer( this );
+  flarmAlertZoneTimer->setSingleShot( true );
+  flarmAlertZoneExpiry = 0;
+
+  connect( flarmAlertZoneTimer, SIGNAL(timeout()),
+           this, SLOT(slotExpireFlarmAlertZones()) );
+
   connect( this, SIGNAL(progress(int)), ws, SLOT(slot_Progress(int)) );
 
   connect( this, SIGNAL(loadingFile(const QString&)),
@@ -161,8 +172,7 @@ MapContents::~MapContents()
       delete currentTask;
     }
 
-  qDeleteAll( airspaceList );
-  qDeleteAll( flarmAlertZoneList );
+  deleteAirspaces();
 }
 
 // save the current waypoint list into a file
@@ -1993,10 +2003,10 @@ void MapContents::proofeSection()
     {
       ws->slot_SetText2( tr( "Reading Airspace Data" ) );
 
-      AirspaceHelper::loadAirspaces( airspaceList );
+      AirspaceHelper::loadAirspaces( airspaceList, airspaceStores );
 
-      // finally, sort the airspaces
-      airspaceList.sort();
+      // finally, sort and index the airspaces
+      indexAirspaces();
 
       // Look, which airfield source has to be taken.
       // int airfieldSource = GeneralConfig::instance()->getAirfieldSource();
@@ -2339,10 +2349,14 @@ void MapContents::clearList(const int listIndex)
       radioList.clear();
       break;
     case AirspaceList:
-      airspaceList.clear();
+      // The map must drop its references to the deleted airspaces.
+      Map::getInstance()->clearAirspaceRegionList();
+      deleteAirspaces();
+      // The Flarm zones are not part of the airspace list.
+      flarmAlertZones.reindex();
       break;
     case FlarmAlertZoneList:
-      flarmAlertZoneList.clear();
+      deleteFlarmAlertZones( flarmAlertZones.takeAll() );
       break;
     case ObstacleList:
       obstacleList.clear();
@@ -2399,9 +2413,9 @@ unsigned int MapContents::getListLength( const int listSelector ) const
     case RadioList:
       return radioList.count();
     case AirspaceList:
-      return airspaceList.count();
+      return getAirspaceCount();
     case FlarmAlertZoneList:
-      return flarmAlertZoneList.count();
+      return flarmAlertZones.size();
     case ObstacleList:
       return obstacleList.count();
     case ReportList:
@@ -2444,9 +2458,9 @@ BaseMapElement* MapContents::getElement(int listType, unsigned int index)
     case RadioList:
       return &radioList[index];
     case AirspaceList:
-      return airspaceList.at(index);
+      return getAirspace(index);
     case FlarmAlertZoneList:
-      return flarmAlertZoneList.at(index);
+      return flarmAlertZones.list()->at(index);
     case ObstacleList:
       return &obstacleList[index];
     case ReportList:
@@ -2528,11 +2542,11 @@ void MapContents::slotReloadMapData()
   // clear the airspace path list in map too
   Map::getInstance()->clearAirspaceRegionList();
 
-  qDeleteAll(airspaceList);
-  airspaceList = SortableAirspaceList();
+  deleteAirspaces();
 
-  qDeleteAll(flarmAlertZoneList);
-  flarmAlertZoneList = SortableAirspaceList();
+  qDeleteAll( flarmAlertZones.takeAll() );
+  flarmAlertZoneTimer->stop();
+  flarmAlertZoneExpiry = 0;
 
   cityList = QList<LineElement>();
   hydroList = QList<LineElement>();
@@ -2887,19 +2901,21 @@ void MapContents::loadAirspacesViaThread()
   // Register a special data type for return results. That must be
   // done to transfer the results between different threads.
   qRegisterMetaType<AirspaceListPtr>("AirspaceListPtr");
+  qRegisterMetaType<AirspaceStoreListPtr>("AirspaceStoreList*");
 
   // Connect the receiver of the results. It is located in this
   // thread and not in the new opened thread.
   connect( ashThread,
-           SIGNAL(loadedList( int, SortableAirspaceList* )),
+           SIGNAL(loadedList( int, SortableAirspaceList*, AirspaceStoreList* )),
            this,
-           SLOT(slotAirspaceLoadFinished( int, SortableAirspaceList* )) );
+           SLOT(slotAirspaceLoadFinished( int, SortableAirspaceList*, AirspaceStoreList* )) );
 
   ashThread->start();
 }
 
 void MapContents::slotAirspaceLoadFinished( int noOfLists,
-                                            SortableAirspaceList* airspaceListIn )
+                                            SortableAirspaceList* airspaceListIn,
+                                            AirspaceStoreList* storeListIn )
 {
   QMutexLocker locker( &m_airspaceLoadMutex );
 
@@ -2915,46 +2931,167 @@ void MapContents::slotAirspaceLoadFinished( int noOfLists,
   // Clear the airspace path list in map. They are outdated.
   Map::getInstance()->clearAirspaceRegionList();
 
-  // Take over the new loaded airspace list. The passed list must be deleted!
-  qDeleteAll(airspaceList);
-  airspaceList.clear();
+  // Take over the new loaded airspaces. The passed lists must be deleted!
+  deleteAirspaces();
+
+  // assign new airspace list and the mapped files
+  airspaceList = *airspaceListIn;
+  airspaceStores = *storeListIn;
+
+  delete airspaceListIn;
+  delete storeListIn;
+
+  // finally, sort and index the airspaces
+  indexAirspaces();
+
+  emit mapDataReloaded( Map::airspaces );
+}
+
+void MapContents::deleteAirspaces()
+{
+  airspaceIndex.clear();
+
+  qDeleteAll( airspaceList );
 
   // free all internal allocated memory in QList
   airspaceList = SortableAirspaceList();
 
-  // assign new airspace list
-  airspaceList = *airspaceListIn;
+  // The stores delete the airspace objects of their records.
+  qDeleteAll( airspaceStores );
+  airspaceStores = AirspaceStoreList();
+}
 
-  // finally, sort the airspaces
+void MapContents::indexAirspaces()
+{
   airspaceList.sort();
-  delete airspaceListIn;
+
+  // The mapped records are queried by the indexes of their files.
+  airspaceIndex.build( airspaceList );
+
+  // The Flarm zones are not part of the airspace list.
+  flarmAlertZones.reindex();
+}
+
+void MapContents::swapAirspaces( SortableAirspaceList& list,
+                                 AirspaceStoreList& stores )
+{
+  QMutexLocker locker( &m_airspaceLoadMutex );
+
+  // The airspace regions of the map refer to the former airspaces.
+  Map::getInstance()->clearAirspaceRegionList();
+
+  airspaceList.swap( list );
+  airspaceStores.swap( stores );
+
+  indexAirspaces();
 
   emit mapDataReloaded( Map::airspaces );
 }
 
-void MapContents::slotNewFlarmAlertZoneData( FlarmBase::FlarmAlertZone& faz )
+int MapContents::getAirspaceCount() const
+{
+  int count = airspaceList.size();
+
+  for( int i = 0; i < airspaceStores.size(); i++ )
+    {
+      count += airspaceStores.at(i)->count();
+    }
+
+  return count;
+}
+
+Airspace* MapContents::getAirspace( unsigned int index )
+{
+  int idx = index;
+
+  for( int i = 0; i < airspaceStores.size(); i++ )
+    {
+      AirspaceStore* store = airspaceStores.at(i);
+
+      if( idx < store->count() )
+        {
+          return store->airspace( idx );
+        }
+
+      idx -= store->count();
+    }
+
+  return airspaceList.at( idx );
+}
+
+int MapContents::queryAirspaces( const QRect& area, const int lower,
+                                 const int upper, QVector<Airspace*>& result )
 {
-  bool found = false;
+  // Airspaces without a mapped file and Flarm alert zones
+  airspaceIndex.query( area, result );
 
-  Airspace* as = static_cast<Airspace*>(0);
+  int size = 0;
 
-  // Search in the list, if Flarm alert zone is already known.
-  for( int i = 0; i < flarmAlertZoneList.size(); i++ )
+  for( int i = 0; i < result.size(); i++ )
     {
-      as = flarmAlertZoneList.at(i);
+      Airspace* as = result.at(i);
 
-      FlarmBase::FlarmAlertZone& asFaz = as->getFlarmAlertZone();
+      int asLower = as->getLowerL();
+      int asUpper = as->getUpperL();
 
-      if( asFaz.isValid() == false || asFaz.Key != faz.Key )
+      if( asUpper < asLower ||
+          as->getUpperT() == BaseMapElement::UNLTD ||
+          as->getUpperT() == BaseMapElement::NotSet )
         {
-          continue;
+          // The same normalization as in the compiled file
+          asUpper = AirspaceStore::Unlimited;
         }
 
-      found = true;
-      break;
+      if( asLower <= upper && asUpper >= lower )
+        {
+          result[size++] = as;
+        }
     }
 
-  if( found == false )
+  result.resize( size );
+
+  for( int i = 0; i < airspaceStores.size(); i++ )
+    {
+      AirspaceStore* store = airspaceStores.at(i);
+
+      store->query( area, lower, upper, airspaceRecords );
+
+      for( int j = 0; j < airspaceRecords.size(); j++ )
+        {
+          result.append( store->airspace( airspaceRecords.at(j) ) );
+        }
+    }
+
+  return result.size();
+}
+
+int MapContents::queryAirspacesOnLine( const QPoint& p1, const QPoint& p2,
+                                       QVector<Airspace*>& result )
+{
+  // Airspaces without a mapped file and Flarm alert zones
+  airspaceIndex.queryLine( p1, p2, result );
+
+  for( int i = 0; i < airspaceStores.size(); i++ )
+    {
+      AirspaceStore* store = airspaceStores.at(i);
+
+      store->queryLine( p1, p2, airspaceRecords );
+
+      for( int j = 0; j < airspaceRecords.size(); j++ )
+        {
+          result.append( store->airspace( airspaceRecords.at(j) ) );
+        }
+    }
+
+  return result.size();
+}
+
+void MapContents::slotNewFlarmAlertZoneData( FlarmBase::FlarmAlertZone& faz )
+{
+  // Search in the store, if Flarm alert zone is already known.
+  Airspace* as = flarmAlertZones.find( faz.Key );
+
+  if( as == 0 )
     {
       as = new Airspace();
       as->setTypeID( BaseMapElement::AirFlarm );
@@ -2962,12 +3099,23 @@ void MapContents::slotNewFlarmAlertZoneData( FlarmBase::FlarmAlertZone& faz )
 
   FlarmBase::FlarmAlertZone& asFaz = as->getFlarmAlertZone();
 
+  // Only a change of the zone requires an update of the index and the map.
+  bool changed = asFaz.isValid() == false ||
+                 asFaz.Bottom != faz.Bottom ||
+                 asFaz.Top != faz.Top ||
+                 asFaz.ActivityLimit != faz.ActivityLimit;
+
+  // The projected area of the old zone must be redrawn too.
+  QRect area = as->getProjectedPolygon().boundingRect();
+
   // Check, if update is necessary
   if( asFaz.isValid() == false ||
       asFaz.Radius != faz.Radius ||
       asFaz.Latitude != faz.Latitude ||
       asFaz.Longitude != faz.Longitude )
     {
+      changed = true;
+
       // The Flarm airspace object type is a circle
       QPolygon aspg;
 
@@ -2997,6 +3145,10 @@ void MapContents::slotNewFlarmAlertZoneData( FlarmBase::FlarmAlertZone& faz )
         }
 
       as->setProjectedPolygon( aspg );
+
+      // The region of the map is outdated and created again at the next
+      // drawing.
+      Map::getInstance()->removeAirRegion( as );
     }
 
   // Flarm Alert Zone
@@ -3005,6 +3157,12 @@ void MapContents::slotNewFlarmAlertZoneData( FlarmBase::FlarmAlertZone& faz )
   // Name
   as->setName( faz.ID );
 
+  if( changed == false )
+    {
+      // Repeated report of the zone.
+      return;
+    }
+
   // Botton
   Altitude botton( faz.Bottom );
   as->setLowerL( botton );
@@ -3015,13 +3173,126 @@ void MapContents::slotNewFlarmAlertZoneData( FlarmBase::FlarmAlertZone& faz )
   as->setUpperL( top );
   as->setUpperT( BaseMapElement::MSL );
 
-  if( found == false )
+  flarmAlertZones.commit( as );
+  scheduleFlarmAlertZoneExpiry();
+
+  emit flarmAlertZonesChanged( area.united( as->getProjectedPolygon().boundingRect() ) );
+}
+
+void MapContents::slotExpireFlarmAlertZones()
+{
+  // The virtual clock follows the fix time during a replay.
+  quint64 secondsUtc =
+    static_cast<quint64> (VirtualClock::currentDateTimeUtc().toMSecsSinceEpoch() / 1000);
+
+  QRect area = deleteFlarmAlertZones( flarmAlertZones.takeExpired( secondsUtc ) );
+
+  scheduleFlarmAlertZoneExpiry();
+
+  if( area.isNull() == false )
     {
-      flarmAlertZoneList.append( as );
-      flarmAlertZoneList.sort();
+      emit flarmAlertZonesChanged( area );
     }
+}
 
-  emit mapDataReloaded( Map::airspaces );
+QRect MapContents::deleteFlarmAlertZones( const QList<Airspace*>& zones )
+{
+  QRect area;
+
+  for( int i = 0; i < zones.size(); i++ )
+    {
+      Airspace* as = zones.at(i);
+
+      area = area.united( as->getProjectedPolygon().boundingRect() );
+
+      Map::getInstance()->forgetAirspace( as );
+      delete as;
+    }
+
+  return area;
+}
+
+void MapContents::slotCheckFlarmAlertZones()
+{
+  if( flarmAlertZoneExpiry == 0 || VirtualClock::isEnabled() == false )
+    {
+      // The expiry timer is used.
+      return;
+    }
+
+  quint64 secondsUtc =
+    static_cast<quint64> (VirtualClock::currentDateTimeUtc().toMSecsSinceEpoch() / 1000);
+
+  if( secondsUtc > flarmAlertZoneExpiry )
+    {
+      slotExpireFlarmAlertZones();
+    }
+}
+
+void MapContents::scheduleFlarmAlertZoneExpiry()
+{
+  quint64 next = flarmAlertZones.nextExpiry();
+
+  flarmAlertZoneExpiry = next;
+
+  if( next == 0 || VirtualClock::isEnabled() )
+    {
+      // The virtual clock advances only with the GPS fixes, so the activity
+      // limit is checked by slotCheckFlarmAlertZones.
+      flarmAlertZoneTimer->stop();
+      return;
+    }
+
+  // A zone is expired, if its activity limit is passed. Far limits are
+  // checked again after a day.
+  qint64 wait = qint64(next + 1) * 1000 -
+                VirtualClock::currentDateTimeUtc().toMSecsSinceEpoch();
+
+  flarmAlertZoneTimer->start( static_cast<int> (qBound( qint64(0), wait,
+                                                        qint64(24 * 3600 * 1000) )) );
+}
+
+void MapContents::slotNewFlarmHotspots( const ThermalDetector& thermals )
+{
+  const qint64 now = VirtualClock::msecsSinceReference();
+
+  flarmHotspotList.clear();
+
+  for( int i = 0; i < thermals.size(); i++ )
+    {
+      const ThermalDetector::Hotspot& hs = thermals.at( i );
+
+      if( hs.isConfirmed() == false )
+        {
+          continue;
+        }
+
+      WGSPoint wgsPos( hs.position() );
+      ThermalPoint tp;
+
+      tp.setName( tr("Flarm thermal") );
+      tp.setWPName( Speed( hs.Climb ).getVerticalText( true, 1 ) );
+      tp.setComment( tr("%1 glider(s), %2 - %3, last seen %4 min ago")
+                     .arg( hs.Gliders )
+                     .arg( Altitude::getText( hs.Bottom, true, 0 ) )
+                     .arg( Altitude::getText( hs.Top, true, 0 ) )
+                     .arg( (now - hs.LastSeen) / 60000 ) );
+      tp.setWGSPosition( wgsPos );
+      tp.setPosition( _globalMapMatrix->wgsToMap( wgsPos ) );
+
+      // The reachability is calculated to the lowest circling glider.
+      tp.setElevation( hs.Bottom );
+
+      tp.setType( ThermalPoint::natural );
+      tp.setCategory( ThermalPoint::Glider );
+
+      // More different gliders make the thermal more reliable.
+      tp.setReliability( ThermalPoint::poor + hs.Gliders - 1 );
+
+      flarmHotspotList.append( tp );
+    }
+
+  emit mapDataReloaded( Map::hotspots );
 }
 
 /** Special method to add the drawn objects to the return list,
@@ -3123,7 +3394,7 @@ void MapContents::drawList( QPainter* targetP,
 void MapContents::drawList( QPainter* targetP,
                             QList<ThermalPoint*> &drawnHsList )
 {
-  if( hotspotList.isEmpty() ) return;
+  if( hotspotList.isEmpty() && flarmHotspotList.isEmpty() ) return;
 
   const bool showInfo = GeneralConfig::instance()->getMapShowHotspotLabels();
 
@@ -3136,6 +3407,14 @@ void MapContents::drawList( QPainter* targetP,
           drawnHsList.append( &hotspotList[i] );
         }
     }
+
+  for (int i = 0; i < flarmHotspotList.size(); i++)
+    {
+      if( flarmHotspotList[i].drawMapElement( targetP ) && showInfo )
+        {
+          drawnHsList.append( &flarmHotspotList[i] );
+        }
+    }
 }
 
 void MapContents::drawList( QPainter* targetP,
@@ -3204,7 +3483,7 @@ void MapContents::drawList( QPainter* targetP,
 
     case HotspotList:
 
-      if( hotspotList.isEmpty() ) break;
+      if( hotspotList.isEmpty() && flarmHotspotList.isEmpty() ) break;
 
       showProgress2WaitScreen( tr("Drawing hotspots") );
 
@@ -3213,18 +3492,36 @@ void MapContents::drawList( QPainter* targetP,
           hotspotList[i].drawMapElement(targetP);
         }
 
+      for (int i = 0; i < flarmHotspotList.size(); i++)
+        {
+          flarmHotspotList[i].drawMapElement(targetP);
+        }
+
       break;
 
     case AirspaceList:
-
-      if( airspaceList.isEmpty() ) break;
-
-      showProgress2WaitScreen( tr("Drawing airspaces") );
-
-      for (int i = 0; i < airspaceList.size(); i++)
-        {
-          airspaceList.at(i)->drawMapElement(targetP);
-        }
+      {
+        QVector<Airspace*> asList;
+
+        if( queryAirspaces( _globalMapMatrix->getMapBorder(), INT_MIN, INT_MAX,
+                            asList ) == 0 )
+          {
+            break;
+          }
+
+        showProgress2WaitScreen( tr("Drawing airspaces") );
+
+        std::sort( asList.begin(), asList.end(), CompareAirspaces() );
+
+        for (int i = 0; i < asList.size(); i++)
+          {
+            // The Flarm alert zones are part of the index but drawn by the map.
+            if( asList.at(i)->getTypeID() != BaseMapElement::AirFlarm )
+              {
+                asList.at(i)->drawMapElement(targetP);
+              }
+          }
+      }
 
       break;
 
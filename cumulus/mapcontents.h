@@ -41,16 +41,21 @@
 #include <QMap>
 #include <QMutex>
 #include <QString>
+#include <QTimer>
 
 #include "airfield.h"
 #include "airspace.h"
+#include "AirspaceIndex.h"
+#include "AirspaceStore.h"
 #include "distance.h"
 #include "flarmbase.h"
+#include "FlarmAlertZones.h"
 #include "flighttask.h"
 #include "isolist.h"
 #include "map.h"
 #include "radiopoint.h"
 #include "singlepoint.h"
+#include "ThermalDetector.h"
 #include "ThermalPoint.h"
 #include "waitscreen.h"
 
@@ -143,22 +148,46 @@ class MapContents : public QObject
     BaseMapElement* getElement(int listType, unsigned int index);
 
     /**
-     * @return a pointer to the airspace list
+     * @return The number of all loaded airspaces, mapped or not.
      */
-    SortableAirspaceList* getAirspaceList()
-      {
-        return &airspaceList;
-      }
+    int getAirspaceCount() const;
 
     /**
-     * @return a pointer to the given airspace index
+     * @return a pointer to the given airspace. The airspace object of a
+     * mapped record is created at the first call.
      *
-     * @param index The list index of the  airspace.
+     * @param index The index of the airspace, the mapped records come first.
      */
-    Airspace* getAirspace(unsigned int index)
-      {
-        return static_cast<Airspace *> (airspaceList[index]);
-      };
+    Airspace* getAirspace(unsigned int index);
+
+    /**
+     * Collects all airspaces and Flarm alert zones, whose bounding box
+     * intersects the passed area in projected coordinates and whose vertical
+     * extension intersects lower...upper meters. The limits are compared in
+     * the reference of the airspace. Airspace objects are only created for
+     * the found mapped records. The result list is cleared before.
+     *
+     * @return The number of found airspaces.
+     */
+    int queryAirspaces( const QRect& area, const int lower, const int upper,
+                        QVector<Airspace*>& result );
+
+    /**
+     * Collects all airspaces and Flarm alert zones, whose bounding box
+     * touches the line from p1 to p2 in projected coordinates. The result
+     * list is cleared before.
+     *
+     * @return The number of found airspaces.
+     */
+    int queryAirspacesOnLine( const QPoint& p1, const QPoint& p2,
+                              QVector<Airspace*>& result );
+
+    /**
+     * Exchanges the loaded airspaces with the passed ones and rebuilds the
+     * airspace index. The map drops its references to the former airspaces,
+     * which are owned by the caller afterwards.
+     */
+    void swapAirspaces( SortableAirspaceList& list, AirspaceStoreList& stores );
 
     /**
      * @return a pointer to the given glider site
@@ -250,6 +279,14 @@ class MapContents : public QObject
        return hotspotList;
      };
 
+    /**
+      * @return a reference to the list of the hotspots found by Flarm
+      */
+     QList<ThermalPoint>& getFlarmHotspotList()
+     {
+       return flarmHotspotList;
+     };
+
     /**
      * @return a pointer to the SinglePoint of the given map element
      *
@@ -263,7 +300,7 @@ class MapContents : public QObject
      */
     SortableAirspaceList* getFlarmAlertZoneList()
       {
-        return &flarmAlertZoneList;
+        return flarmAlertZones.list();
       };
 
     /**
@@ -507,7 +544,8 @@ class MapContents : public QObject
      * requested airspace data have been loaded.
      */
     void slotAirspaceLoadFinished( int noOfLists,
-                                   SortableAirspaceList* airspaceListIn );
+                                   SortableAirspaceList* airspaceListIn,
+                                   AirspaceStoreList* storeListIn );
 
     /**
      * This slot is called, if a new or updated Flarm Alert Zone is available.
@@ -516,6 +554,27 @@ class MapContents : public QObject
      */
     void slotNewFlarmAlertZoneData( FlarmBase::FlarmAlertZone& faz );
 
+    /**
+     * This slot is called, if the thermal hotspots found by circling Flarm
+     * targets have been changed.
+     *
+     * \param[in] thermals The hotspots found by Flarm.
+     */
+    void slotNewFlarmHotspots( const ThermalDetector& thermals );
+
+    /**
+     * This slot is called by a timer, if the activity limit of a Flarm Alert
+     * Zone is reached. The expired zones are removed.
+     */
+    void slotExpireFlarmAlertZones();
+
+    /**
+     * This slot is called at every new GPS fix. If the virtual clock follows
+     * the fix time, the expired Flarm Alert Zones are removed here, because
+     * the expiry timer runs on the system time.
+     */
+    void slotCheckFlarmAlertZones();
+
 #ifdef INTERNET
 
     /**
@@ -591,6 +650,13 @@ class MapContents : public QObject
      */
     void mapDataReloaded( Map::mapLayer layer );
 
+    /**
+     * Emitted, if Flarm Alert Zones have been added, changed or removed.
+     *
+     * \param area The projected area covered by the old and new zones.
+     */
+    void flarmAlertZonesChanged( const QRect& area );
+
   private:
 
     /**
@@ -640,6 +706,32 @@ class MapContents : public QObject
      */
     void loadAirspacesViaThread();
 
+    /**
+     * Deletes all airspaces and closes the mapped compiled files. The map
+     * must have dropped its references to them before.
+     */
+    void deleteAirspaces();
+
+    /**
+     * Sorts the airspaces without a mapped file and builds the airspace index
+     * over them and the Flarm alert zones.
+     */
+    void indexAirspaces();
+
+    /**
+     * Removes the references of the map to the passed Flarm zones and deletes
+     * them.
+     *
+     * \return The projected area covered by the deleted zones.
+     */
+    QRect deleteFlarmAlertZones( const QList<Airspace*>& zones );
+
+    /**
+     * Saves the next activity limit of a Flarm zone and starts the expiry
+     * timer for it, if the virtual clock runs on the system time.
+     */
+    void scheduleFlarmAlertZoneExpiry();
+
 #ifdef INTERNET
 
     /**
@@ -684,7 +776,21 @@ class MapContents : public QObject
     QList<ThermalPoint> hotspotList;
 
     /**
-     * airspaceList contains all airspaces. The sort function on this
+     * flarmHotspotList contains the confirmed thermal hotspots found by
+     * circling Flarm targets.
+     */
+    QList<ThermalPoint> flarmHotspotList;
+
+    /**
+     * airspaceStores contains the mapped compiled airspace files. They are
+     * queried through their own indexes and own the airspace objects created
+     * from their records.
+     */
+    AirspaceStoreList airspaceStores;
+
+    /**
+     * airspaceList contains the airspaces, which have no mapped compiled
+     * file, because it could not be written. The sort function on this
      * list will sort the airspaces from top to bottom. This list must be stay
      * a pointer list because the cross reference to the airspace region.
      */
@@ -693,11 +799,29 @@ class MapContents : public QObject
     //  it would sort them out.
 
     /**
-     * The flarmAlertZoneList contains all Flarm airspaces. The sort function on
-     * this list will sort the airspaces from top to bottom. This list must be
-     * stay a pointer list because the cross reference to the airspace region.
+     * Spatial index over the projected airspaces of the airspaceList and the
+     * Flarm alert zones. It is rebuilt, when a new airspace list is taken
+     * over.
+     */
+    AirspaceIndex airspaceIndex;
+
+    /** Found records of one store, reused by the airspace queries. */
+    QVector<int> airspaceRecords;
+
+    /**
+     * Contains all Flarm airspaces, sorted from top to bottom and ordered by
+     * their activity limit. The zones are inserted into the airspaceIndex.
+     */
+    FlarmAlertZones flarmAlertZones;
+
+    /** Single shot timer until the next activity limit of a Flarm zone. */
+    QTimer* flarmAlertZoneTimer;
+
+    /**
+     * Next activity limit of a Flarm zone in UTC seconds of the virtual
+     * clock, zero if there is none.
      */
-    SortableAirspaceList flarmAlertZoneList;
+    quint64 flarmAlertZoneExpiry;
 
     /**
      * obstacleList contains all obstacles and groups, as well
@@ -41,6 +41,7 @@
 #include "speed.h"
 #include "time_cu.h"
 #include "VarioModeDialog.h"
+#include "VirtualClock.h"
 #include "waypointcatalog.h"
 #include "waypoint.h"
 
@@ -801,11 +802,11 @@ void MapView::show_ETA(const QTime& eta, bool immediately )
 
       if( Time::getTimeUnit() == Time::utc )
         {
-          dt = dt.currentDateTimeUtc();
+          dt = VirtualClock::currentDateTimeUtc();
         }
       else
         {
-          dt = dt.currentDateTime();
+          dt = VirtualClock::currentDateTime();
         }
 
       dt = dt.addSecs( QTime(0,0,0,0).secsTo( eta ) );
@@ -1098,7 +1099,7 @@ void MapView::slot_flightTime()
 
   if( takeoff.isValid() )
     {
-      int seconds = takeoff.secsTo( QDateTime::currentDateTime() );
+      int seconds = takeoff.secsTo( VirtualClock::currentDateTime() );
 
       QTime time( 0, 0, 0, 0 );
       time = time.addSecs( seconds );
@@ -3,7 +3,7 @@
                              -------------------
     begin                : Okt 18 2002
     copyright            : (C) 2002      by Eggert Ehmke
-                               2008-2021 by Axel Pauli
+                               2008-2026 by Axel Pauli
 
     email                : kflog.cumulus@gmail.com
 
@@ -29,6 +29,20 @@
 #include "layout.h"
 #include "polar.h"
 
+// Grid of the speed to fly table. The headwind counts negative.
+#define ST_WIND_MIN   -30.0
+#define ST_WIND_STEP    1.0
+#define ST_WINDS         61
+
+// Grid of the speed to fly table for McCready minus lift
+#define ST_NETTO_MIN   -5.0
+#define ST_NETTO_STEP   0.25
+#define ST_NETTOS        61
+
+// Smallest square of a root, which is stored in the speed to fly table.
+// Near the minimum sink the root is too steep for an interpolation.
+#define ST_MIN_SQUARE 100.0
+
 Polar::Polar() :
   _name(""),
   _v1(0),
@@ -113,6 +127,10 @@ Polar::Polar( const QString& name,
     {
       setLoad( _addLoad, _water, _bugs );
     }
+  else
+    {
+      buildSpeedTable();
+    }
 }
 
 Polar::Polar (const Polar& polar) :
@@ -136,7 +154,8 @@ Polar::Polar (const Polar& polar) :
   _addLoad (polar._addLoad),
   _wingArea(polar._wingArea),
   _seats (polar._seats),
-  _maxWater (polar._maxWater)
+  _maxWater (polar._maxWater),
+  _speedTable (polar._speedTable)
 {}
 
 Polar::~Polar()
@@ -179,6 +198,10 @@ void Polar::recalculatePolarData()
     {
       setLoad( _addLoad, _water, _bugs );
     }
+  else
+    {
+      buildSpeedTable();
+    }
 }
 
 void Polar::setLoad( int addLoad, int water, int bugs )
@@ -208,6 +231,8 @@ void Polar::setLoad( int addLoad, int water, int bugs )
   _b = _bb / B;      // positive
   _c = _cc * A * B;  // negative
   // we just increase the #sinking rate; this is not quite correct but gives reasonable results
+
+  buildSpeedTable();
 }
 
 /**
@@ -249,6 +274,70 @@ Speed Polar::bestSpeed (const Speed& wind, const Speed& lift, const Speed& mc) c
   return speed;
 }
 
+/**
+ * look up the best airspeed for given wind, lift and Mc in the speed to fly
+ * table
+ */
+Speed Polar::tableBestSpeed (const Speed& wind, const Speed& lift, const Speed& mc) const
+{
+  const double w = (wind.getMps() - ST_WIND_MIN) / ST_WIND_STEP;
+  const double n = (mc.getMps() - lift.getMps() - ST_NETTO_MIN) / ST_NETTO_STEP;
+
+  if( _speedTable.isEmpty() ||
+      ! (w >= 0.0 && w <= ST_WINDS - 1 && n >= 0.0 && n <= ST_NETTOS - 1) )
+    {
+      return bestSpeed( wind, lift, mc );
+    }
+
+  const int i = qMin( int(w), ST_WINDS - 2 );
+  const int j = qMin( int(n), ST_NETTOS - 2 );
+
+  const float* node = _speedTable.constData() + i * ST_NETTOS + j;
+
+  if( node[0] == 0.0f || node[1] == 0.0f ||
+      node[ST_NETTOS] == 0.0f || node[ST_NETTOS + 1] == 0.0f )
+    {
+      // near the minimum sink the root is calculated
+      return bestSpeed( wind, lift, mc );
+    }
+
+  const double fw = w - i;
+  const double fn = n - j;
+
+  double root = (1.0 - fw) * ((1.0 - fn) * node[0] + fn * node[1]) +
+                fw * ((1.0 - fn) * node[ST_NETTOS] + fn * node[ST_NETTOS + 1]);
+
+  // go back into the original coordinate system as in bestSpeed
+  return Speed( root - wind.getMps() );
+}
+
+void Polar::buildSpeedTable()
+{
+  if( _a == 0.0 )
+    {
+      // no valid polar, bestSpeed is used
+      _speedTable.clear();
+      return;
+    }
+
+  _speedTable.resize( ST_WINDS * ST_NETTOS );
+
+  for( int i = 0; i < ST_WINDS; i++ )
+    {
+      double wind = ST_WIND_MIN + i * ST_WIND_STEP;
+
+      for( int j = 0; j < ST_NETTOS; j++ )
+        {
+          double netto = ST_NETTO_MIN + j * ST_NETTO_STEP;
+
+          // the same equation as in bestSpeed with lift - mc = -netto
+          double temp = (wind * wind * _a - wind * _b + _c - netto) / _a;
+
+          _speedTable[i * ST_NETTOS + j] = (temp >= ST_MIN_SQUARE) ? float( sqrt( temp ) ) : 0.0f;
+        }
+    }
+}
+
 /**
   * calculate best glide ratio for given wind and lift;
   */
@@ -3,7 +3,7 @@
                              -------------------
     begin                : Okt 18 2002
     copyright            : (C) 2002      by Eggert Ehmke
-                               2008-2023 by Axel Pauli
+                               2008-2026 by Axel Pauli
 
     email                : kflog.cumulus@gmail.com
 
@@ -25,7 +25,7 @@
  *
  * \brief Class for glider polar calculations and drawing.
  *
- * \date 2002-2023
+ * \date 2002-2026
  *
  * \version 1.2
  *
@@ -34,6 +34,7 @@
 #pragma once
 
 #include <QString>
+#include <QVector>
 #include <QWidget>
 
 #include "speed.h"
@@ -78,6 +79,13 @@ class Polar
    */
   Speed bestSpeed (const Speed& wind, const Speed& lift, const Speed& mc) const;
 
+  /**
+   * look up the best airspeed for given wind, lift and McCready value in the
+   * speed to fly table. The table is interpolated linearly, values outside
+   * of it are calculated by bestSpeed.
+   */
+  Speed tableBestSpeed (const Speed& wind, const Speed& lift, const Speed& mc) const;
+
   /**
    * calculate best glide ratio
    */
@@ -267,4 +275,16 @@ class Polar
   double _wingArea;
   int    _seats;
   int    _maxWater;
+
+  /**
+   * Speed to fly table over headwind and McCready minus lift, the best speed
+   * depends on lift and McCready only by their difference. A node contains
+   * the root of bestSpeed, the best speed without the headwind. Nodes near
+   * the minimum sink, where the root is too steep for an interpolation, are
+   * zero. The table is built with every change of the polar coefficients.
+   */
+  QVector<float> _speedTable;
+
+  /** build the speed to fly table from the current polar coefficients */
+  void buildSpeedTable();
 };
@@ -27,7 +27,7 @@
 
 //------- Used by Command/Response channel -------//
 
-#define MSG_PROTOCOL   "Cumulus-GPS_Client_IPC_V1.6_Axel@kflog.org"
+#define MSG_PROTOCOL   "Cumulus-GPS_Client_IPC_V1.7_Axel@kflog.org"
 
 #define MSG_MAGIC      "\\Magic\\"
 
@@ -71,6 +71,9 @@
 // Flarm Reset is requested
 #define MSG_FLARM_RESET   "\\Flarm_Reset\\"
 
+// Shared memory ring for GPS data "Nmea_Ring" <name>
+#define MSG_NMEA_RING  "\\Nmea_Ring\\"
+
 //------- Used by Forward data channel -------//
 
 // GPS data message
@@ -92,4 +95,10 @@
 
 #define MSG_CON_ON        "#GPS_Connection_on#"
 
+// New GPS data are available in the shared memory ring.
+#define MSG_RING_WAKEUP   "#Ring_Wakeup#"
+
+// End of a GPS epoch, only used as record in the shared memory ring.
+#define MSG_EPOCH_END     "#Epoch_End#"
+
 #endif  // #ifndef _Protocol_h_
@@ -7,7 +7,7 @@
  ************************************************************************
  **
  **   Copyright (c):  2004      by Eckhard Völlm,
- **                   2008-2022 by Axel Pauli
+ **                   2008-2026 by Axel Pauli
  **
  **   This file is distributed under the terms of the General Public
  **   License. See the file COPYING for more information.
@@ -45,13 +45,43 @@ extern MapContents *_globalMapContents;
 
 // Initialize static members
 int  ReachableList::safetyAlt = 0;
-QMap<QString, int> ReachableList::arrivalAltMap;
-QMap<QString, Distance> ReachableList::distanceMap;
+QVector<ReachableList::SiteResult> ReachableList::results;
 bool ReachableList::modeAltitude = false;
 
 // Radius of reachables to be taken into account in kilometers
 #define RANGE_RADIUS 100.0;
 
+// Kilometers of one KFLog unit along a meridian
+#define KM_PER_UNIT (PI2 * RADIUS / 1000.0 / (360.0 * 600000.0))
+
+// Orders candidate numbers by their distance.
+struct CandidateDistanceLess
+{
+  const double* dist2;
+
+  bool operator()( const int c1, const int c2 ) const
+  {
+    return dist2[c1] < dist2[c2];
+  }
+};
+
+// Orders candidate numbers by their position.
+struct CandidatePositionLess
+{
+  const int* lat;
+  const int* lon;
+
+  bool operator()( const int c1, const int c2 ) const
+  {
+    if( lat[c1] != lat[c2] )
+      {
+        return lat[c1] < lat[c2];
+      }
+
+    return lon[c1] < lon[c2];
+  }
+};
+
 // number of created class instances
 short ReachableList::instances = 0;
 
@@ -127,11 +157,9 @@ void ReachableList::calculate(bool always)
     }
 }
 
-void ReachableList::addItemsToList(enum MapContents::ListID item)
+void ReachableList::addCandidates( enum MapContents::ListID item )
 {
-  Distance distance;
   QRect bbox = MapCalc::areaBox(lastPosition, _maxReach);
-  int r=0, a=0;
   //qDebug("bounding box: (%d, %d), (%d, %d) (%d x %d km)", bbox.left(),bbox.top(),bbox.right(),bbox.bottom(),0,0);
 
   if( item == MapContents::WaypointList )
@@ -142,163 +170,230 @@ void ReachableList::addItemsToList(enum MapContents::ListID item)
 
       for ( int i=0; i < wpList.count(); i++ )
         {
-          WGSPoint pt = wpList.at(i).wgsPoint;
+          const Waypoint& wp = wpList.at(i);
 
-          if (! bbox.contains(pt))
+          if (! bbox.contains(wp.wgsPoint))
             {
-              //qDebug("Not in bounding box, so ignore! (distance: %d, (%d, %d), %s)", (int)distance.getKilometers(), pt.x(),pt.y(), wpList.at(i)->name.latin1());
-              r++;
               continue;
             }
-          else
-            {
-              a++;
-              //qDebug("In bounding box, so accept! (distance: %d, %s)", (int)distance.getKilometers(), wpList.at(i)->name.latin1());
-            }
-
-          // Calculate distance and bearing
-          QPair<double, double> p =
-              MapCalc::distVinc( &lastPosition, &pt );
-
-          distance.setKilometers( p.first );
 
           bool isLandable = false;
 
-          if( wpList.at(i).rwyList.size() > 0 )
+          if( wp.rwyList.size() > 0 )
             {
-              isLandable = wpList.at(i).rwyList.at(0).isOpen();
+              isLandable = wp.rwyList.at(0).isOpen();
             }
 
-          // check if point is a potential reachable candidate at best LD
-          if ( (distance.getKilometers() > _maxReach ) ||
-               ! (isLandable ||
-                 (wpList.at(i).type == BaseMapElement::Outlanding) )  )
+          // check if point is a potential reachable candidate
+          if ( ! (isLandable || (wp.type == BaseMapElement::Outlanding) ) )
             {
               continue;
             }
 
-          // set bearing
-          int bearing = int( rint( p.second * 180. / M_PI ) );
-          Altitude altitude(0);
+          m_candidates.list.append( item );
+          m_candidates.index.append( i );
+          m_candidates.lat.append( wp.wgsPoint.x() );
+          m_candidates.lon.append( wp.wgsPoint.y() );
+        }
 
-          ReachablePoint rp( wpList[i],
-                             false,
-                             distance,
-                             bearing,
-                             altitude );
-          append(rp);
+      return;
+    }
+
+  // get number of elements in the list
+  int nr = _globalMapContents->getListLength(item);
+
+  // qDebug("No of sites: %d type %d", nr, item );
+  for (int i=0; i<nr; i++ )
+    {
+      Airfield* site = sourceSite( item, i );
+
+      if( site == 0 )
+        {
+          qWarning( "ReachableList::addCandidates: ListType %d is unknown",
+                    item );
+          break;
+        }
+
+      const WGSPoint& pos = site->getWGSPositionRef();
+
+      if (! bbox.contains(pos) )
+        {
+          continue;
         }
+
+      m_candidates.list.append( item );
+      m_candidates.index.append( i );
+      m_candidates.lat.append( pos.x() );
+      m_candidates.lon.append( pos.y() );
     }
-  else
+}
+
+Airfield* ReachableList::sourceSite( const int list, const int index ) const
+{
+  // We have to distinguish between AirfieldList, GilderSiteList and
+  // OutlandingList.
+  switch( list )
+    {
+      case MapContents::AirfieldList:
+        return _globalMapContents->getAirfield(index);
+      case MapContents::GliderfieldList:
+        return _globalMapContents->getGliderfield(index);
+      case MapContents::OutLandingList:
+        return _globalMapContents->getOutlanding(index);
+      default:
+        return static_cast<Airfield *> (0);
+    }
+}
+
+void ReachableList::calculateCandidateDistances()
+{
+  const int n = m_candidates.lat.size();
+
+  // A flat projection around the own position is precise enough to select
+  // the nearest sites. The exact distances are calculated later.
+  const double kmLat = KM_PER_UNIT;
+  const double kmLon = KM_PER_UNIT * cos( lastPosition.x() * M_PI / (180.0 * 600000.0) );
+  const double maxReach2 = _maxReach * _maxReach;
+  const int lat0 = lastPosition.x();
+  const int lon0 = lastPosition.y();
+
+  m_candidates.dist2.resize( n );
+  m_candidates.order.resize( 0 );
+
+  const int* lat = m_candidates.lat.constData();
+  const int* lon = m_candidates.lon.constData();
+  double* dist2 = m_candidates.dist2.data();
+
+  for( int i = 0; i < n; i++ )
     {
-      // get number of elements in the list
-      int nr = _globalMapContents->getListLength(item);
+      double dy = (lat[i] - lat0) * kmLat;
+      double dx = (lon[i] - lon0) * kmLon;
 
-      // qDebug("No of sites: %d type %d", nr, item );
-      for (int i=0; i<nr; i++ )
+      dist2[i] = dx * dx + dy * dy;
+    }
+
+  for( int i = 0; i < n; i++ )
+    {
+      if( dist2[i] <= maxReach2 )
         {
-          // Get specific site data from current list. We have to distinguish
-          // between AirfieldList, GilderSiteList and OutlandingList.
-          Airfield* site;
+          m_candidates.order.append( i );
+        }
+    }
+}
 
-          if( item == MapContents::AirfieldList )
-            {
-              // Fetch data from airport list
-              site = _globalMapContents->getAirfield(i);
-            }
-          else if( item == MapContents::GliderfieldList )
-            {
-              // fetch data from glider site list
-              site = _globalMapContents->getGliderfield(i);
-            }
-          else if( item == MapContents::OutLandingList )
-            {
-              // fetch data from glider site list
-              site = _globalMapContents->getOutlanding(i);
-            }
-          else
-            {
-              qWarning( "ReachableList::addItemsToList: ListType %d is unknown",
-                        item );
-              break;
-            }
+void ReachableList::selectCandidates( const int maxSites )
+{
+  QVector<int>& order = m_candidates.order;
 
-          QString siteName = site->getWPName();
-          QString siteIcao = site->getICAO();
-          QString siteDescription = site->getName();
-          QString siteCountry = site->getCountry();
-          short siteType = site->getTypeID();
-          QList<Frequency> frequencyList = site->getFrequencyList();
-          WGSPoint siteWgsPosition = site->getWGSPosition();
-          QPoint sitePosition = site->getPosition();
-          float siteElevation = site->getElevation();
-          QString siteComment = site->getComment();
-          QList<Runway> siteRwyList = site->getRunwayList();
-
-          if (! bbox.contains(siteWgsPosition) )
-            {
-              //qDebug("Not in bounding box, so ignore! (distance: %d, (%d, %d), %s)", (int)distance.getKilometers(), pt.x(),pt.y(), site->getName().latin1());
-              r++;
-              continue;
-            }
-          else
-            {
-              a++;
-              //qDebug("In bounding box, so accept! (distance: %d, %s)", (int)distance.getKilometers(), site->getName().latin1());
-            }
+  // Only the nearest sites are needed in any order, the list is sorted after
+  // the calculation of the arrival altitudes.
+  if( maxSites < order.size() )
+    {
+      CandidateDistanceLess less;
+      less.dist2 = m_candidates.dist2.constData();
 
-          // Calculate distance and bearing
-          QPair<double, double> p =
-              MapCalc::distVinc( &lastPosition, &siteWgsPosition );
+      std::nth_element( order.begin(), order.begin() + maxSites, order.end(), less );
+      order.resize( maxSites );
+    }
 
-          distance.setKilometers( p.first );
-          // qDebug("%d  %f %f", i, (float)distance.getKilometers(),_maxReach );
-          // check if point is a potential reachable candidate at best LD
-          if ( distance.getKilometers() > _maxReach )
-            {
-              continue;
-            }
+  reserve( order.size() );
+
+  for( int i = 0; i < order.size(); i++ )
+    {
+      const int c = order.at(i);
+      const int idx = m_candidates.index.at(c);
+
+      // Distance and bearing are calculated exactly by calculateDataInList.
+      Distance distance( sqrt( m_candidates.dist2.at(c) ) * 1000.0 );
+      Altitude altitude( 0 );
 
-          // set bearing
-          short bearing = short( rint( p.second * 180. / M_PI ) );
-          Altitude altitude( 0 );
-
-          // add all potential reachable points to the list, altitude is calculated later
-          ReachablePoint rp( siteName,
-                             siteIcao,
-                             siteDescription,
-                             siteCountry,
-                             true,
-                             siteType,
-                             frequencyList,
-                             siteWgsPosition,
-                             sitePosition,
-                             siteElevation,
-                             siteComment,
+      if( m_candidates.list.at(c) == MapContents::WaypointList )
+        {
+          ReachablePoint rp( _globalMapContents->getWaypointList()[idx],
+                             false,
                              distance,
-                             bearing,
-                             altitude,
-                             siteRwyList );
+                             0,
+                             altitude );
           append(rp);
+          continue;
+        }
+
+      Airfield* site = sourceSite( m_candidates.list.at(c), idx );
+
+      // add all potential reachable points to the list, altitude is calculated later
+      ReachablePoint rp( site->getWPName(),
+                         site->getICAO(),
+                         site->getName(),
+                         site->getCountry(),
+                         true,
+                         site->getTypeID(),
+                         site->getFrequencyList(),
+                         site->getWGSPosition(),
+                         site->getPosition(),
+                         site->getElevation(),
+                         site->getComment(),
+                         distance,
+                         0,
+                         altitude,
+                         site->getRunwayList() );
+      append(rp);
+    }
+}
+
+void ReachableList::addResult( const QPoint& position,
+                               const Altitude& arrivalAlt,
+                               const Distance& distance )
+{
+  SiteResult sr;
+  sr.key = positionKey( position );
+  sr.arrivalValid = arrivalAlt.isValid();
+  sr.arrivalAlt = sr.arrivalValid ? (int) arrivalAlt.getMeters() + safetyAlt : 0;
+  sr.distance = distance;
+
+  results.append( sr );
+}
+
+const ReachableList::SiteResult* ReachableList::findResult( const QPoint& position )
+{
+  const quint64 key = positionKey( position );
 
-          // qDebug("%s(%d) %f %d° %d", rp.getName().toLatin1().data(), rp.getElevation(),  rp.getDistance().getKilometers(), rp.getBearing(), (int)rp->getArrivalAlt().getMeters() );
+  // Binary search in the results sorted by the position key.
+  int lo = 0;
+  int hi = results.size();
+
+  while( lo < hi )
+    {
+      int mid = (lo + hi) / 2;
 
+      if( results.at(mid).key < key )
+        {
+          lo = mid + 1;
         }
+      else
+        {
+          hi = mid;
+        }
+    }
+
+  if( lo < results.size() && results.at(lo).key == key )
+    {
+      return &results.at(lo);
     }
-  // qDebug("accepted: %d, rejected: %d. Percent reject: %f",a,r,(100.0*r)/(a+r));
+
+  return static_cast<const SiteResult *> (0);
 }
 
 QColor ReachableList::getReachColor( const QPoint& position )
 {
-  // qDebug("name: %s: %d", (const char *)name, arrivalAltMap[name] );
+  const SiteResult* sr = findResult( position );
 
-  if ( arrivalAltMap.contains( ReachableList::coordinateString( position ) ) )
+  if ( sr != 0 && sr->arrivalValid )
     {
-      if ( arrivalAltMap[ ReachableList::coordinateString ( position ) ] > safetyAlt )
+      if ( sr->arrivalAlt > safetyAlt )
         {
           return( Qt::green );
         }
-      else if ( arrivalAltMap[ ReachableList::coordinateString ( position ) ] > 0 )
+      else if ( sr->arrivalAlt > 0 )
         {
           return( Qt::magenta );
         }
@@ -313,11 +408,11 @@ QColor ReachableList::getReachColor( const QPoint& position )
 
 int ReachableList::getArrivalAlt( const QPoint& position )
 {
-  // qDebug("name: %s: %d", (const char *)name, arrivalAltMap[name] );
+  const SiteResult* sr = findResult( position );
 
-  if ( arrivalAltMap.contains( coordinateString ( position ) ) )
+  if ( sr != 0 && sr->arrivalValid )
     {
-      return( arrivalAltMap[ coordinateString ( position ) ] - safetyAlt );
+      return( sr->arrivalAlt - safetyAlt );
     }
 
   return( -9999 );
@@ -325,11 +420,11 @@ int ReachableList::getArrivalAlt( const QPoint& position )
 
 Altitude ReachableList::getArrivalAltitude( const QPoint& position )
 {
-  // qDebug("name: %s: %d", (const char *)name, arrivalAltMap[name] );
+  const SiteResult* sr = findResult( position );
 
-  if ( arrivalAltMap.contains( coordinateString ( position ) ) )
+  if ( sr != 0 && sr->arrivalValid )
     {
-      return (Altitude( arrivalAltMap[ coordinateString ( position ) ]) - safetyAlt) ;
+      return (Altitude( sr->arrivalAlt ) - safetyAlt) ;
     }
 
   return Altitude(); //return an invalid altitude
@@ -337,11 +432,11 @@ Altitude ReachableList::getArrivalAltitude( const QPoint& position )
 
 Distance ReachableList::getDistance( const QPoint& position )
 {
-  // qDebug("name: %s: %d", (const char *)name, arrivalAltMap[name] );
+  const SiteResult* sr = findResult( position );
 
-  if ( distanceMap.contains( coordinateString ( position ) ) )
+  if ( sr != 0 )
     {
-      return( distanceMap[ coordinateString ( position ) ] );
+      return( sr->distance );
     }
 
   return Distance();    //return an invalid distance
@@ -349,13 +444,13 @@ Distance ReachableList::getDistance( const QPoint& position )
 
 ReachablePoint::reachable ReachableList::getReachable( const QPoint& position )
 {
-  // qDebug("name: %s: %d", (const char *)name, arrivalAltMap[name] );
+  const SiteResult* sr = findResult( position );
 
-  if ( arrivalAltMap.contains( coordinateString ( position ) ) )
+  if ( sr != 0 && sr->arrivalValid )
     {
-      if ( arrivalAltMap[ coordinateString ( position ) ] > safetyAlt )
+      if ( sr->arrivalAlt > safetyAlt )
         return ReachablePoint::yes;
-      else if ( arrivalAltMap[ coordinateString ( position ) ] > 0 )
+      else if ( sr->arrivalAlt > 0 )
         return ReachablePoint::belowSafety;
       else
         return ReachablePoint::no;
@@ -376,8 +471,9 @@ void ReachableList::calculateDataInList()
   // t.start();
   int counter = 0;
   setInitValues();
-  arrivalAltMap.clear();
-  distanceMap.clear();
+
+  // The results keep their capacity.
+  results.resize( 0 );
 
   for (int i = 0; i < count(); i++)
     {
@@ -419,13 +515,7 @@ void ReachableList::calculateDataInList()
           p.setArrivalAlt( arrivalAlt );
         }
 
-      if ( arrivalAlt.isValid() )
-        {
-          // add only valid altitudes to the map
-          arrivalAltMap[ coordinateString ( pt ) ] = (int) arrivalAlt.getMeters() + safetyAlt;
-        }
-
-      distanceMap[ coordinateString ( pt ) ] = distance;
+      addResult( pt, arrivalAlt, distance );
 
       if ( arrivalAlt.getMeters() > 0 )
         {
@@ -433,6 +523,10 @@ void ReachableList::calculateDataInList()
         }
     }
 
+  calculateHotspots();
+
+  std::sort( results.begin(), results.end() );
+
   // sorting of items depends on the glider selection
   if ( calculator->glider() )
     {
@@ -449,6 +543,43 @@ void ReachableList::calculateDataInList()
   emit newReachList();
 }
 
+/**
+ * Calculate distance and arrival altitude to the thermal hotspots found by
+ * Flarm. They are not added to the list of reachable sites, but the map
+ * shows their reachability.
+ */
+void ReachableList::calculateHotspots()
+{
+  QList<ThermalPoint>& hsList = _globalMapContents->getFlarmHotspotList();
+
+  for (int i = 0; i < hsList.size(); i++)
+    {
+      WGSPoint pt = hsList.at(i).getWGSPosition();
+      Altitude arrivalAlt;
+      Distance distance;
+      Speed bestSpeed;
+
+      QPair<double, double> pr =
+          MapCalc::distVinc( &lastPosition, &pt );
+
+      distance.setKilometers( pr.first );
+
+      if ( distance.getKilometers() > _maxReach )
+        {
+          continue;
+        }
+
+      short bearing = short (rint( pr.second * 180/M_PI));
+
+      // The arrival altitude is related to the lowest circling glider.
+      calculator->glidePath( bearing, distance,
+                             Altitude( hsList.at(i).getElevation() ),
+                             arrivalAlt, bestSpeed );
+
+      addResult( pt, arrivalAlt, distance );
+    }
+}
+
 void ReachableList::setInitValues()
 {
   // This info we do need from the calculator
@@ -493,26 +624,26 @@ void ReachableList::calculateNewList()
   setInitValues();
   clearLists();  // clear all lists
 
-  // Now add items of different type to the list
-  addItemsToList(MapContents::AirfieldList);
-  addItemsToList(MapContents::GliderfieldList);
-  addItemsToList(MapContents::OutLandingList);
-  addItemsToList(MapContents::WaypointList);
+  // The candidate arrays keep their capacity.
+  m_candidates.list.resize( 0 );
+  m_candidates.index.resize( 0 );
+  m_candidates.lat.resize( 0 );
+  m_candidates.lon.resize( 0 );
+
+  // Now add items of different type to the candidates
+  addCandidates(MapContents::AirfieldList);
+  addCandidates(MapContents::GliderfieldList);
+  addCandidates(MapContents::OutLandingList);
+  addCandidates(MapContents::WaypointList);
   modeAltitude = false;
-  //qDebug("Number of potential reachable sites: %d", count() );
+  //qDebug("Number of potential reachable sites: %d", m_candidates.lat.size() );
 
-  // sort list according to distances
-  std::sort(begin(), end() );
+  calculateCandidateDistances();
   removeDoubles();
-  // qDebug("Number of potential reachable sites (after pruning): %d", count() );
+  // qDebug("Number of potential reachable sites (after pruning): %d", m_candidates.order.size() );
 
-  // Remove all elements over the maximum. That are the far away elements.
-  int nr = getMaxNrOfSites();
-
-  while ( nr < size() )
-    {
-      removeFirst();
-    }
+  // Only the nearest sites up to the maximum are taken into the list.
+  selectCandidates( getMaxNrOfSites() );
 
   // qDebug("Limited Number of potential reachable sites: %d", count() );
   calculateDataInList();
@@ -536,105 +667,108 @@ void ReachableList::show()
 }
 
 /**
- * Removes double entries from the list. Double entries can occur
+ * Removes double entries from the candidates. Double entries can occur
  * when a point is a waypoint as well as an airfield. In this case,
  * the one with the higher severity or longer name is preferred.
- * This function ASSUMES THE LIST IS SORTED!
  */
 void ReachableList::removeDoubles()
 {
-  QList<int> removeList;
+  QVector<int>& order = m_candidates.order;
 
-  for (int i=count()-1; i>=1; i--)
+  if( order.size() < 2 )
     {
-      const ReachablePoint& p1 = at(i);
+      return;
+    }
 
-      for (int j=0; j<i; j++)
-        {
-          const ReachablePoint& p2 = at(j);
+  // Bring candidates at the same position together.
+  CandidatePositionLess less;
+  less.lat = m_candidates.lat.constData();
+  less.lon = m_candidates.lon.constData();
+
+  std::sort( order.begin(), order.end(), less );
 
-          //qDebug("i=%d j=%d, P1=%s, P2=%s,", i, j, p1.getWaypoint()->name.toLatin1().data(), p2.getWaypoint()->name.toLatin1().data());
+  int kept = 0;
+
+  for( int i = 0; i < order.size(); i++ )
+    {
+      const int c = order.at(i);
 
-          if ( p2.getWaypoint()->wgsPoint == p1.getWaypoint()->wgsPoint )
+      if( kept > 0 && less( order.at(kept - 1), c ) == false )
+        {
+          // Same position as the last kept candidate, keep the preferred one.
+          if( isPreferred( c, order.at(kept - 1) ) )
             {
-              //qDebug("  points are the same");
-              // ok, the points are the same. Now we choose which one to remove
-
-              if ( p2.getWaypoint()->priority != p1.getWaypoint()->priority )
-                {
-                  // the waypoint with the lower priority will be removed
-                  if ( p2.getWaypoint()->priority > p1.getWaypoint()->priority )
-                    {
-                      removeList.append(i);
-                    }
-                  else
-                    {
-                      removeList.append(j);
-                    }
-                  continue;
-                }
-
-              if ( p2.getWaypoint()->name == p1.getWaypoint()->name )
-                {
-                  // both name are identical. remove the one which has not set
-                  // the airfield origin flag.
-                  if( ! p1.isOrignAfl() )
-                     {
-                       removeList.append(i);
-                       continue;
-                     }
-
-                  if( ! p2.isOrignAfl() )
-                     {
-                       removeList.append(j);
-                       continue;
-                     }
-
-                  // both origin flags are set, remove one of the objects
-                  removeList.append(j);
-                  continue;
-                }
-
-              if ( p2.getWaypoint()->name.length() == p1.getWaypoint()->name.length() )
-                {
-                  // the lengths of the names are the same
-                  // remove the one with the lowest alphabetical value
-                  // (remember that A<a)
-                  if (p2.getWaypoint()->name > p1.getWaypoint()->name)
-                    {
-                      removeList.append(i);
-                    }
-                  else
-                    {
-                      removeList.append(j);
-                    }
-                  continue;
-                }
-
-              // if the names are not of equal length, remove the shortest.
-              if ( p2.getWaypoint()->name.length() > p1.getWaypoint()->name.length() )
-                {
-                  removeList.append(i);
-                }
-              else
-                {
-                  removeList.append(j);
-                }
-              continue;
+              order[kept - 1] = c;
             }
 
-          // qDebug("  points are NOT the same: (%d, %d) vs (%d, %d)",p1.getWaypoint()->origP.x(),p1.getWaypoint()->origP.y(),p2.getWaypoint()->origP.x(),p2.getWaypoint()->origP.y());
-        } // End of for j
-    } // End of for i
+          continue;
+        }
+
+      order[kept++] = c;
+    }
+
+  order.resize( kept );
+}
+
+bool ReachableList::isPreferred( const int c1, const int c2 ) const
+{
+  // Names and priorities are only fetched for the rare doubles.
+  const int l1 = m_candidates.list.at(c1);
+  const int l2 = m_candidates.list.at(c2);
+
+  const bool afl1 = ( l1 != MapContents::WaypointList );
+  const bool afl2 = ( l2 != MapContents::WaypointList );
 
-  // sort remove list
-  std::sort( removeList.begin(), removeList.end(), std::less<int>() );
+  QString name1;
+  QString name2;
 
-  // Start remove at the end of the list so that access index is always valid.
-  for (int i = removeList.count()-1; i >= 0; i--)
+  // Airfields are taken with a high priority to make sure they are visible.
+  int prio1 = Waypoint::High;
+  int prio2 = Waypoint::High;
+
+  if( afl1 )
+    {
+      name1 = sourceSite( l1, m_candidates.index.at(c1) )->getWPName();
+    }
+  else
+    {
+      const Waypoint& wp = _globalMapContents->getWaypointList().at( m_candidates.index.at(c1) );
+      name1 = wp.name;
+      prio1 = wp.priority;
+    }
+
+  if( afl2 )
+    {
+      name2 = sourceSite( l2, m_candidates.index.at(c2) )->getWPName();
+    }
+  else
     {
-      // qDebug("Removing point %d (%s)", removeList.at(i), at(removeList.at(i)).getWaypoint()->name.toLatin1().data());
-      // remove doubles from global list
-      removeAt( removeList.at(i) );
+      const Waypoint& wp = _globalMapContents->getWaypointList().at( m_candidates.index.at(c2) );
+      name2 = wp.name;
+      prio2 = wp.priority;
     }
+
+  if( prio1 != prio2 )
+    {
+      // the waypoint with the higher priority is kept
+      return prio1 > prio2;
+    }
+
+  if( name1 == name2 )
+    {
+      // both names are identical. Keep the one which has set the airfield
+      // origin flag.
+      return afl1 && ! afl2;
+    }
+
+  if( name1.length() == name2.length() )
+    {
+      // the lengths of the names are the same
+      // keep the one with the highest alphabetical value
+      // (remember that A<a)
+      return name1 > name2;
+    }
+
+  // if the names are not of equal length, keep the longest.
+  return name1.length() > name2.length();
 }
@@ -41,7 +41,7 @@
 #include <QObject>
 #include <QPoint>
 #include <QList>
-#include <QMap>
+#include <QVector>
 
 #include "generalconfig.h"
 #include "mapmatrix.h"
@@ -143,8 +143,7 @@ class ReachableList : public QObject, QList<ReachablePoint>
   void clearLists()
   {
     clear();
-    arrivalAltMap.clear();
-    distanceMap.clear();
+    results.resize( 0 );
   };
 
   /**
@@ -203,15 +202,40 @@ class ReachableList : public QObject, QList<ReachablePoint>
     */
   void calculateDataInList();
 
+  /**
+   * Calculates distance and arrival altitude to the thermal hotspots found
+   * by Flarm.
+   */
+  void calculateHotspots();
+
   /**
    * Sets the initial values needed for the calculation.
    */
   void setInitValues();
 
   /**
-   * adds glider, airport or waypoint site (if not out of reach) to the list
+   * Adds the glider, airport or waypoint sites within the bounding box of
+   * the maximum reach to the candidates.
+   */
+  void addCandidates( enum MapContents::ListID item );
+
+  /**
+   * Calculates the approximated distances of all candidates in one pass and
+   * puts the candidates within the maximum reach into the selection order.
+   */
+  void calculateCandidateDistances();
+
+  /**
+   * Selects the nearest candidates up to the passed number and adds them to
+   * the list.
    */
-  void addItemsToList(enum MapContents::ListID item);
+  void selectCandidates( const int maxSites );
+
+  /**
+   * \return The airfield, glider field or outlanding site of the passed
+   * source list.
+   */
+  Airfield* sourceSite( const int list, const int index ) const;
 
   /**
    * print list via qDebug interface
@@ -219,18 +243,54 @@ class ReachableList : public QObject, QList<ReachablePoint>
   void show();
 
   /**
-   * Removes double entries from the list. Double entries can occur
+   * Removes double entries from the candidates. Double entries can occur
    * when a point is a waypoint as well as an airfield. In this case,
    * the one with the higher severity or longer name is preferred.
-   * This function ASSUMES THE LIST IS SORTED!
    */
   void removeDoubles();
 
-  static QString coordinateString(const QPoint& position)
+  /**
+   * \return True, if candidate c1 is preferred to candidate c2 at the same
+   * position.
+   */
+  bool isPreferred( const int c1, const int c2 ) const;
+
+  /**
+   * \return A key, which identifies the passed position.
+   */
+  static quint64 positionKey( const QPoint& position )
+  {
+    return (quint64( quint32( position.x() ) ) << 32) | quint32( position.y() );
+  };
+
+  /**
+   * Calculation result of a site.
+   */
+  struct SiteResult
   {
-    return QString("%1.%2").arg(position.x()).arg(position.y());
+    quint64  key;
+    int      arrivalAlt;   // arrival altitude in m plus safety altitude
+    bool     arrivalValid;
+    Distance distance;
+
+    bool operator < ( const SiteResult& other ) const
+    {
+      return key < other.key;
+    };
   };
 
+  /**
+   * Appends the result of a site to the results.
+   */
+  static void addResult( const QPoint& position, const Altitude& arrivalAlt,
+                         const Distance& distance );
+
+  /**
+   * \return The result of the site at the passed position or null, if the
+   * site has not been calculated.
+   */
+  static const SiteResult* findResult( const QPoint& position );
+
   QPoint      lastCalculationPosition; // position at last calculation
   QPoint      lastPosition;
   double      lastAltitude;
@@ -246,8 +306,25 @@ class ReachableList : public QObject, QList<ReachablePoint>
   static bool modeAltitude;
   static int safetyAlt;
 
-  static QMap<QString, int> arrivalAltMap;
-  static QMap<QString, Distance> distanceMap;
+  /**
+   * Results of the last calculation sorted by the position key. Map drawing
+   * looks up every drawn site, a binary search is used for it.
+   */
+  static QVector<SiteResult> results;
+
+  /**
+   * Candidates of a new list as structure of arrays. The arrays keep their
+   * capacity, so a new calculation needs no allocations for them.
+   */
+  struct
+  {
+    QVector<quint8> list;  // MapContents::ListID of the source list
+    QVector<int>    index; // index in the source list
+    QVector<int>    lat;   // WGS position in KFLog coordinates
+    QVector<int>    lon;
+    QVector<double> dist2; // approximated squared distance in km²
+    QVector<int>    order; // candidate numbers in selection order
+  } m_candidates;
 
   // number of created class instances
   static short instances;
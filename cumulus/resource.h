@@ -97,7 +97,7 @@
 #define FILE_VERSION_MAP_C      103
 
 // Version definition for compiled airspace files.
-#define FILE_VERSION_AIRSPACE_C 6
+#define FILE_VERSION_AIRSPACE_C 9
 
 // Version definition for compiled airfield files.
 #define FILE_VERSION_AIRFIELD_C 7
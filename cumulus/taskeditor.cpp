@@ -17,6 +17,7 @@
 #include <HelpBrowser.h>
 #include <QtWidgets>
 
+#include "AirspaceClearance.h"
 #include "distance.h"
 #include "flighttask.h"
 #include "generalconfig.h"
@@ -189,6 +190,13 @@ TaskEditor::TaskEditor( QWidget* parent,
   editButton->setIconSize(QSize(Layout::getButtonSize(12), Layout::getButtonSize(12)));
   editButton->setToolTip(tr("Edit selected waypoint"));
   headlineLayout->addWidget(editButton);
+  headlineLayout->addSpacing(10 * Scaling);
+
+  airspaceButton = new QPushButton;
+  airspaceButton->setIcon( QIcon(GeneralConfig::instance()->loadPixmap("airspace.xpm")) );
+  airspaceButton->setIconSize(QSize(Layout::getButtonSize(12), Layout::getButtonSize(12)));
+  airspaceButton->setToolTip(tr("Check task legs for airspaces"));
+  headlineLayout->addWidget(airspaceButton);
   totalLayout->addWidget( taskList, 2, 0 );
 
   // contains the task editor buttons
@@ -315,6 +323,8 @@ TaskEditor::TaskEditor( QWidget* parent,
            this, SLOT(slotSetTaskPointsDefaultSchema()));
   connect( editButton, SIGNAL(clicked()),
            this, SLOT(slotEditTaskPoint()));
+  connect( airspaceButton, SIGNAL(clicked()),
+           this, SLOT(slotCheckAirspaces()));
 
   connect( helpButton, SIGNAL(pressed()), SLOT(slotHelp()));
 
@@ -847,6 +857,7 @@ void TaskEditor::enableCommandButtons()
       delButton->setEnabled( false );
       editButton->setEnabled (false);
       defaultButton->setEnabled (false);
+      airspaceButton->setEnabled (false);
     }
   else if( tpList.size() == 1 )
     {
@@ -857,6 +868,7 @@ void TaskEditor::enableCommandButtons()
       delButton->setEnabled( true );
       editButton->setEnabled (true);
       defaultButton->setEnabled (false);
+      airspaceButton->setEnabled (false);
     }
   else
     {
@@ -865,6 +877,7 @@ void TaskEditor::enableCommandButtons()
       delButton->setEnabled( true );
       editButton->setEnabled( true );
       defaultButton->setEnabled( true );
+      airspaceButton->setEnabled( true );
 
       if( taskList->topLevelItemCount() && taskList->currentItem() == 0 )
         {
@@ -1002,6 +1015,27 @@ void TaskEditor::slotSetTaskPointsDefaultSchema()
     }
 }
 
+void TaskEditor::slotCheckAirspaces()
+{
+  // Every leg is checked from the planning altitude with the current glider
+  // polar and MacCready setting.
+  Altitude startAlt = AirspaceClearance::planningAltitude( tpList );
+
+  QList<AirspaceClearance::Leg> legs =
+    AirspaceClearance::checkTask( tpList, startAlt );
+
+  QString text = tr("Leg start altitude %1").arg( startAlt.getText( true, 0 ) ) +
+                 "<br><br>" + AirspaceClearance::createReport( legs );
+
+  QMessageBox mb( AirspaceClearance::crossingCount( legs ) ?
+                  QMessageBox::Warning : QMessageBox::Information,
+                  tr( "Airspaces" ),
+                  text,
+                  QMessageBox::Ok,
+                  this );
+  mb.exec();
+}
+
 void TaskEditor::slotWpEdited( Waypoint &editedWp )
 {
   QTreeWidgetItem *item = taskList->currentItem();
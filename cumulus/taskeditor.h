@@ -126,6 +126,9 @@ signals:
   /** Called to reset all task points to their task figure default schema. */
   void slotSetTaskPointsDefaultSchema();
 
+  /** Called to check the task legs for crossed airspaces. */
+  void slotCheckAirspaces();
+
   /**
    * Called to check the item selection. If item Total is called, the selection
    * is reset to the previous row.
@@ -214,6 +217,7 @@ signals:
   QPushButton* delButton;
   QPushButton* editButton;
   QPushButton* defaultButton;
+  QPushButton* airspaceButton;
 
   /** Buttons for opening selection lists. */
   QPushButton* afButton;
@@ -22,6 +22,7 @@
 #include "singlepoint.h"
 #include "taskline.h"
 #include "taskpointtypes.h"
+#include "VirtualClock.h"
 #include "waypoint.h"
 
 /**
@@ -275,7 +276,7 @@ class TaskPoint : public SinglePoint
     */
    void setPassTime()
    {
-     m_passedDateTime = QDateTime::currentDateTime();
+     m_passedDateTime = VirtualClock::currentDateTime();
    }
 
    /**
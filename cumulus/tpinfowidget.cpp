@@ -36,6 +36,7 @@
 #include "gpsnmea.h"
 #include "sonne.h"
 #include "time_cu.h"
+#include "VirtualClock.h"
 
 extern MapContents*  _globalMapContents;
 extern Calculator*   calculator;
@@ -318,7 +319,7 @@ void TPInfoWidget::prepareSwitchText( const int currentTpIndex,
       display += "<td>&nbsp;&nbsp;" + tr("Duration") + "</td><td align=\"left\"><b>" +
         qtime.toString() + "</b></td></tr>";
 
-      QDateTime eta( QDateTime::currentDateTime() );
+      QDateTime eta( VirtualClock::currentDateTime() );
 
       eta = eta.addSecs( time2Next );
 
@@ -441,7 +442,7 @@ void TPInfoWidget::prepareSwitchText( const int currentTpIndex,
           display += "<td>&nbsp;&nbsp;" + tr("Duration") + "</td><td align=\"left\"><b>" +
                 qtime.toString() + "</b></td></tr>";
 
-          QDateTime eta( QDateTime::currentDateTime() );
+          QDateTime eta( VirtualClock::currentDateTime() );
 
           eta = eta.addSecs( time2Final );
 
@@ -602,7 +603,7 @@ void TPInfoWidget::prepareArrivalInfoText( Waypoint *wp )
       display += "<tr><td>&nbsp;&nbsp;" + tr("Duration") + "</td><td align=\"left\"><b>" +
         qtime.toString() + "</b></td></tr>";
 
-      QDateTime eta( QDateTime::currentDateTime() );
+      QDateTime eta( VirtualClock::currentDateTime() );
 
       eta = eta.addSecs( time2Target );
 
@@ -729,7 +730,7 @@ void TPInfoWidget::prepareArrivalInfoText( Waypoint *wp )
         display += "<tr><td>&nbsp;&nbsp;" + tr("Duration") + "</td><td align=\"left\"><b>" +
                     qtime.toString() + "</b></td></tr>";
 
-        QDateTime eta( QDateTime::currentDateTime() );
+        QDateTime eta( VirtualClock::currentDateTime() );
 
         QString etaString;
 
@@ -20,16 +20,40 @@
 
 #include "vario.h"
 #include "altitude.h"
+#include "Atmosphere.h"
 #include "calculator.h"
 #include "generalconfig.h"
 
+// Standard deviations of the measurements in m
+#define SIGMA_BARO   0.5
+#define SIGMA_GNSS   3.0
+#define SIGMA_ENERGY 1.0
+
+// Standard deviations of the not measured vertical acceleration in m/s²
+// for the default integration time. The energy altitude follows the speed
+// changes faster.
+#define ACCEL_NOISE        1.0
+#define ACCEL_NOISE_AHRS   0.5
+#define ACCEL_NOISE_ENERGY 2.0
+
+// Maximum age in ms of the static pressure and the acceleration
+#define MAX_INPUT_AGE 2000
+
+// A change of the fix delay in ms, that is taken over at once
+#define MAX_FIX_DELAY_JUMP 1000
+
+// Rise of the fix delay in ms per fix, to follow a clock drift
+#define FIX_DELAY_DRIFT 1
+
 Vario::Vario(QObject* parent) :
   QObject(parent),
   m_intTime(3000),
   m_TEKOn(false),
-  m_energyAlt(0.0),
   m_TekAdjust(0.0),
-  m_sampleList( LimitedList<AltSample>( 61 ) )
+  m_pressureTime(0),
+  m_accelTime(0),
+  m_fixDelay(0),
+  m_fixDelayValid(false)
 {
   GeneralConfig *conf = GeneralConfig::instance();
 
@@ -46,206 +70,138 @@ Vario::~Vario()
   m_timeOut.stop();
 }
 
-void Vario::newAltitude()
+void Vario::prepare( const qint64 time )
 {
   // Start or restart the timer to supervise the calling of this
   // method. If the timer expires the variometer is set to zero.
   m_timeOut.setSingleShot( true );
   m_timeOut.start( m_intTime + 2500 );
 
-  int max = calculator->samplelist.count();
+  // A longer integration time of the user gives a smoother vario.
+  double scale = double( INT_TIME * 1000 ) / qMax( m_intTime, qint64(1000) );
 
-  if( max < 10 )
+  if( m_accelTime != 0 && time - m_accelTime <= MAX_INPUT_AGE )
     {
-      // to less samples in the list
-      return;
+      m_altFilter.setAccelerationNoise( ACCEL_NOISE_AHRS * scale );
     }
-
-  int i = 1; // index for list access
-  double sum = 0.0;
-
-  bool resultAvailable = false;
-
-  // Step through the list. Note, the list is inverse ordered, last sample at
-  // first position.
-  QDateTime startTime = calculator->samplelist.at( 0 ).time;
-
-  while( i < max )
+  else
     {
-      double energyAlt1 = 0.0;
-      double energyAlt2 = 0.0;
-      const FlightSample *sample1 = &calculator->samplelist.at( i - 1 );
-      const FlightSample *sample2 = &calculator->samplelist.at( i );
-
-      // calculate energy altitude for both samples
-      if( m_TEKOn )
-        {
-          double speed1 = sample1->airspeed.getMps();
-          double speed2 = sample2->airspeed.getMps();
-
-          if( (calculator->currentFlightMode() != Calculator::circlingL &&
-               calculator->currentFlightMode() != Calculator::circlingR) ||
-               speed1 == 0.0 || speed2 == 0.0 )
-            {
-              // If we do not circling or the calculated airspeed is zero
-              // we do take the ground speed as basis.
-              Vector v1 = sample1->vector;
-              Vector v2 = sample1->vector;
-              speed1 = v1.getSpeed().getMps();
-              speed2 = v2.getSpeed().getMps();
-            }
-
-          energyAlt1  = (speed1 * speed1) / (2 * 9.81);
-          energyAlt2  = (speed2 * speed2) / (2 * 9.81);
-        }
-
-      // if( i == 2 )
-      // qDebug("Airspeed %f, EnergyAltitude %f, TekAdj %f",sample1->airspeed.getKph(), energyAlt1, _TekAdjust );
-
-      int timeDist = sample2->time.msecsTo( startTime );
-
-      if( timeDist > m_intTime )
-        {
-          // time difference to big
-          break;
-        }
-
-      i++;
-
-      double diff = (sample1->altitude.getMeters() + energyAlt1 * m_TekAdjust) -
-                    (sample2->altitude.getMeters() + energyAlt2 * m_TekAdjust);
-
-      int elapsed = sample2->time.msecsTo( sample1->time );
-
-      sum += (1000.0 * diff / (double) elapsed);
+      m_altFilter.setAcceleration( 0.0 );
+      m_altFilter.setAccelerationNoise( ACCEL_NOISE * scale );
+    }
 
-      resultAvailable = true;
+  m_energyFilter.setAccelerationNoise( ACCEL_NOISE_ENERGY * scale );
+}
 
-      // qDebug("Vario: max=%d, i=%d, diff=%f, elapsed=%dms, sum=%f",
-      //	max, i, diff, elapsed, sum );
+void Vario::emitLift()
+{
+  if( m_altFilter.isValid() == false )
+    {
+      return;
     }
 
-  Speed lift;
+  double climb = m_altFilter.climb();
 
-  if( resultAvailable )
+  if( m_TEKOn && m_energyFilter.isValid() )
     {
-      lift.setMps( sum / (i - 1) );
+      climb += m_energyFilter.climb() * m_TekAdjust;
     }
 
-  // qDebug ("New vario=%s, samples=%d", lift.getTextVertical(true, 3).latin1(), i );
-  emit newVario( lift );
+  emit newVario( Speed( climb ) );
 }
 
-void Vario::newPressureAltitude( const Altitude& altitude, const Speed& tas )
+void Vario::newAltitude( const qint64 readTime )
 {
-  // static QTime zeit = QTime::currentTime();
-
-  // qDebug() << "Alt=" << altitude.getMeters() << "ZeitSpanne=" << zeit.restart();
-
-  // Start or restart the timer to supervise the calling of this
-  // method. If the timer expires the variometer is set to zero.
-  m_timeOut.setSingleShot( true );
-  m_timeOut.start( 5000 );
-
-  // That is the minimum altitude difference, which must be reached to
-  // say the difference is acceptable. The unit is m/s.
-  const double limit = 0.35;
-
-  AltSample sample;
-
-  sample.altitude  = altitude.getMeters();
-  sample.tas       = tas.getMps();
-  sample.timeStamp = QDateTime::currentMSecsSinceEpoch();
-
-  // Add the new sample to the list.
-  m_sampleList.add( sample );
-
-  // qDebug() << "m_sampleList.count()=" << m_sampleList.count();
-
-  if( m_sampleList.count() < 5 )
+  if( calculator->fixlist.count() == 0 )
     {
-      // Too less samples in the list.
       return;
     }
 
-  int i = 1; // index for list access
-  int max = m_sampleList.count();
-  double lift = 0.0;
+  FlightSample& sample = calculator->fixlist[0];
+
+  qint64 time = fixTime( sample.time, readTime );
 
-  bool resultAvailable = false;
+  prepare( time );
 
-  // Step through the list. Note, the list is inverse ordered, last sample at
-  // first position.
-  qint64 elapsedTime = 0;
+  m_altFilter.updateGnss( time, sample.GNSSAltitude.getMeters(), SIGMA_GNSS );
 
-  while( i < max )
+  if( m_TEKOn )
     {
-      double energyAlt1 = 0.0;
-      double energyAlt2 = 0.0;
+      double speed = sample.airspeed.getMps();
 
-      const AltSample& sample1 = m_sampleList.at( i - 1 );
-      const AltSample& sample2 = m_sampleList.at( i );
+      if( (calculator->currentFlightMode() != Calculator::circlingL &&
+           calculator->currentFlightMode() != Calculator::circlingR) ||
+           speed <= 0.0 )
+        {
+          // If we do not circling or the calculated airspeed is zero
+          // we do take the ground speed as basis.
+          speed = sample.vector.getSpeed().getMps();
+        }
 
-      double tas1 = sample1.tas;
-      double tas2 = sample2.tas;
+      m_energyFilter.updateBaro( time, (speed * speed) / (2 * 9.81), SIGMA_ENERGY );
+    }
 
-      qint64 timeDist = sample1.timeStamp - sample2.timeStamp;
+  emitLift();
+}
 
-      elapsedTime += timeDist;
+void Vario::newPressureAltitude( const Altitude& altitude, const qint64 time )
+{
+  if( m_pressureTime != 0 && time - m_pressureTime <= MAX_INPUT_AGE )
+    {
+      // The static pressure delivers the same altitude with a higher resolution.
+      return;
+    }
 
-      if( elapsedTime > m_intTime )
-        {
-          // The defined time period is reached, leave loop.
-          break;
-        }
+  prepare( time );
 
-      i++;
-      double altDiff;
+  m_altFilter.updateBaro( time, altitude.getMeters(), SIGMA_BARO );
 
-      if( m_TEKOn && tas1 > 0.0 && tas2 > 0.0 )
-        {
-          energyAlt1  = (tas1 * tas1) / (2 * 9.81) * m_TekAdjust;
-          energyAlt2  = (tas2 * tas2) / (2 * 9.81) * m_TekAdjust;
+  emitLift();
+}
 
-          altDiff = (((sample1.altitude + energyAlt1) -
-                      (sample2.altitude + energyAlt2)) / (double) timeDist) * 1000.0;
-        }
-      else
-        {
-          altDiff = ((sample1.altitude - sample2.altitude) / (double) timeDist) * 1000.0;
-#if 0
-          qDebug() << "i=" << (i-2)
-                   << "timeDist" << timeDist << " ms"
-                   << "A1=" << sample1.altitude
-                   << "A2=" << sample2.altitude
-                   << "AltDiff=" << altDiff;
-#endif
-        }
+void Vario::newStaticPressure( const double pressure, const qint64 time )
+{
+  m_pressureTime = time;
 
-      if( fabs( altDiff ) > limit )
-        {
-          // If the altitude difference to low, we ignore that value in the
-          // calculation. That is done to filter out noise values.
-          lift += altDiff;
-        }
+  prepare( time );
 
-      // qDebug() << "lastI=" << (i-1) << "lift=" << lift;
+  m_altFilter.updateBaro( time, Atmosphere::calcAltitude( pressure ), SIGMA_BARO );
 
-      resultAvailable = true;
+  emitLift();
+}
+
+void Vario::newAcceleration( const double accel, const qint64 time )
+{
+  m_accelTime = time;
+  m_altFilter.setAcceleration( accel );
+}
 
-      // qDebug( "Vario: max=%d, i=%d, diff=%f, elapsed=%lldms, lift=%f",
-      //         max, i, (sample1.altitude - sample2.altitude), elapsedTime, lift );
+qint64 Vario::fixTime( const QDateTime& utc, const qint64 readTime )
+{
+  if( utc.isValid() == false )
+    {
+      m_fixDelayValid = false;
+      return readTime;
     }
 
-  Speed lifting;
+  // The read time of a fix is its fix time plus the transfer delay. The
+  // smallest delay maps the fix times to the time base of the read times
+  // without the transfer jitter. It rises slowly to follow a clock drift.
+  qint64 delay = readTime - utc.toMSecsSinceEpoch();
 
-  if( resultAvailable )
+  if( m_fixDelayValid == false ||
+      delay < m_fixDelay ||
+      delay - m_fixDelay > MAX_FIX_DELAY_JUMP )
+    {
+      m_fixDelay = delay;
+      m_fixDelayValid = true;
+    }
+  else
     {
-      lifting.setMps( lift / (double) (i - 1) );
+      m_fixDelay += FIX_DELAY_DRIFT;
     }
 
-  // qDebug ("New vario=%f, samples=%d", lifting.getMps(), i );
-  emit newVario( lifting );
+  return utc.toMSecsSinceEpoch() + m_fixDelay;
 }
 
 /** This slot is called by the internal timer, to signal a
@@ -254,7 +210,8 @@ void Vario::slotTimeout()
 {
   // Reset all to defaults, due to no new data have arrived over the
   // whole integration period and the measurement is senseless now.
-  m_sampleList.clear();
+  m_altFilter.reset();
+  m_energyFilter.reset();
   Speed lift;
   emit newVario( lift );
 }
@@ -23,19 +23,24 @@
  *
  * \brief Variometer calculations.
  *
- * This class executes the variometer calculations.
+ * This class executes the variometer calculations. The climb rate is
+ * estimated by a Kalman filter, which fuses the barometric altitude, the GNSS
+ * altitude and the vertical acceleration of an AHRS, if available. The total
+ * energy compensation is derived from a second filter over the energy
+ * altitude.
  *
- *\date 2002-2013
+ *\date 2002-2026
  */
 
 #ifndef VARIO_H
 #define VARIO_H
 
+#include <QDateTime>
 #include <QObject>
 #include <QTimer>
 
 #include "altitude.h"
-#include "limitedlist.h"
+#include "KalmanVario.h"
 #include "speed.h"
 
 /** Default integration time in seconds for variometer calculation. */
@@ -56,16 +61,31 @@ public:
   virtual ~Vario();
 
   /**
-   * Called to signal that a new altitude value is available. That triggers the
+   * Called to signal that a new GNSS fix is available. That triggers the
    * variometer calculation.
+   *
+   * All times are the read times of the data in the time base of
+   * VirtualClock::msecsSinceReference(). The GNSS altitude is stamped with
+   * its fix time, mapped to that time base.
    */
-  void newAltitude();
+  void newAltitude( const qint64 readTime );
 
   /**
    * Called to signal that a new pressure altitude value is available.
-   *  That triggers the variometer calculation.
+   * It is ignored, if the static pressure is delivered too.
+   */
+  void newPressureAltitude( const Altitude& altitude, const qint64 time );
+
+  /**
+   * Called to signal that a new static pressure in hPa is available.
    */
-  void newPressureAltitude( const Altitude& altitude, const Speed& tas );
+  void newStaticPressure( const double pressure, const qint64 time );
+
+  /**
+   * Called to signal that a new vertical acceleration in m/s² is available,
+   * positive upwards and without gravity.
+   */
+  void newAcceleration( const double accel, const qint64 time );
 
 public slots:
 
@@ -104,26 +124,28 @@ private:
   QTimer  m_timeOut; // calling supervision timer
   qint64  m_intTime; // integration time in ms
   bool    m_TEKOn;   // TEK compensated Mode
-  double  m_energyAlt; // v*v/2g
   double  m_TekAdjust; // adjust TEK Compensation
 
-  class AltSample
-  {
-   public:
+  KalmanVario m_altFilter;    // barometric and GNSS altitude
+  KalmanVario m_energyFilter; // energy altitude v*v/2g
+
+  qint64 m_pressureTime; // time of the last static pressure in ms
+  qint64 m_accelTime;    // time of the last acceleration in ms
+
+  qint64 m_fixDelay;      // smallest delay of the fix read time in ms
+  bool   m_fixDelayValid; // the fix delay is known
 
-    AltSample() :
-      altitude(0.0),
-      tas(0.0),
-      timeStamp(0)
-    {};
+  /** Sets up the altitude filter for a measurement at the passed time. */
+  void prepare( const qint64 time );
 
-    double altitude;  // unit is meters
-    double tas;       // unit is meters per second
-    qint64 timeStamp; // unit is milliseconds since the epoch
-  };
+  /** Emits the lift of the filters. */
+  void emitLift();
 
-  // List of altitude samples
-  LimitedList<AltSample> m_sampleList;
+  /**
+   * Maps the UTC fix time to the time base of the read times. Without a
+   * valid fix time, the read time is returned.
+   */
+  qint64 fixTime( const QDateTime& utc, const qint64 readTime );
 
 private slots:
 
@@ -0,0 +1,184 @@
+/***********************************************************************
+**
+**   NmeaLineBuffer.cpp
+**
+**   This file is part of Cumulus
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli (kflog.cumulus@gmail.com)
+**
+**   This program is free software; you can redistribute it and/or modify
+**   it under the terms of the GNU General Public License as published by
+**   the Free Software Foundation; either version 2 of the License, or
+**   (at your option) any later version.
+**
+***********************************************************************/
+
+#include <cstring>
+
+#include "NmeaLineBuffer.h"
+
+#define MASK (NmeaLineBuffer::Capacity - 1)
+
+NmeaLineBuffer::NmeaLineBuffer()
+{
+  clear();
+}
+
+void NmeaLineBuffer::clear()
+{
+  m_read      = 0;
+  m_scan      = 0;
+  m_write     = 0;
+  m_discarded = 0;
+  m_skip      = false;
+}
+
+char* NmeaLineBuffer::writeSpace( int& size )
+{
+  quint32 start = m_write & MASK;
+  quint32 free  = Capacity - (m_write - m_read);
+
+  size = qMin( free, quint32( Capacity - start ) );
+
+  return m_buffer + start;
+}
+
+void NmeaLineBuffer::commit( const int bytes )
+{
+  if( bytes > 0 )
+    {
+      m_write += bytes;
+    }
+}
+
+bool NmeaLineBuffer::nextLine( const char*& line, int& length )
+{
+  while( m_scan != m_write )
+    {
+      // Scan the contiguous part up to the write position or buffer end.
+      quint32 start = m_scan & MASK;
+      quint32 count = qMin( m_write - m_scan, quint32( Capacity - start ) );
+
+      const char* nl = static_cast<const char *>( memchr( m_buffer + start, '\n', count ) );
+
+      if( nl == 0 )
+        {
+          m_scan += count;
+
+          if( m_scan - m_read > MaxLine )
+            {
+              // Overlong line or trash, skip it up to the next line end.
+              if( m_skip == false )
+                {
+                  m_discarded++;
+                }
+
+              m_read = m_scan;
+              m_skip = true;
+            }
+
+          continue;
+        }
+
+      m_scan += (nl - (m_buffer + start)) + 1;
+
+      quint32 first = m_read;
+      length = m_scan - m_read;
+      m_read = m_scan;
+
+      if( m_skip )
+        {
+          m_skip = false;
+          continue;
+        }
+
+      if( length > MaxLine )
+        {
+          m_discarded++;
+          continue;
+        }
+
+      if( length == 1 || (length == 2 && m_buffer[first & MASK] == '\r') )
+        {
+          // empty line
+          continue;
+        }
+
+      quint32 index = first & MASK;
+
+      if( index + length <= quint32( Capacity ) )
+        {
+          line = m_buffer + index;
+        }
+      else
+        {
+          // The line wraps around the buffer end.
+          int part = Capacity - index;
+          memcpy( m_line, m_buffer + index, part );
+          memcpy( m_line + part, m_buffer, length - part );
+          line = m_line;
+        }
+
+      return true;
+    }
+
+  return false;
+}
+
+static int hexValue( const char c )
+{
+  if( c >= '0' && c <= '9' ) return c - '0';
+  if( c >= 'A' && c <= 'F' ) return c - 'A' + 10;
+  if( c >= 'a' && c <= 'f' ) return c - 'a' + 10;
+
+  return -1;
+}
+
+bool NmeaLineBuffer::verifyCheckSum( const char* line, const int length )
+{
+  int end = length;
+
+  while( end > 0 && (line[end-1] == '\n' || line[end-1] == '\r') )
+    {
+      end--;
+    }
+
+  // Search the last asterisk, it is followed by two hex digits.
+  int star = end - 1;
+
+  while( star >= 0 && line[star] != '*' )
+    {
+      star--;
+    }
+
+  if( star < 0 || end - star - 1 < 2 )
+    {
+      return false;
+    }
+
+  int high = hexValue( line[star+1] );
+  int low  = hexValue( line[star+2] );
+
+  if( high < 0 || low < 0 )
+    {
+      return false;
+    }
+
+  uchar sum = 0;
+
+  for( int i = 1; i < star; i++ )
+    {
+      uchar c = (uchar) line[i];
+
+      if( c == '$' || c == '!' ) // Start sign will not to be considered
+        {
+          continue;
+        }
+
+      sum ^= c;
+    }
+
+  return sum == uchar( (high << 4) | low );
+}
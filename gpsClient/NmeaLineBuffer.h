@@ -0,0 +1,110 @@
+/***********************************************************************
+**
+**   NmeaLineBuffer.h
+**
+**   This file is part of Cumulus
+**
+************************************************************************
+**
+**   Copyright (c):  2026 by Axel Pauli (kflog.cumulus@gmail.com)
+**
+**   This program is free software; you can redistribute it and/or modify
+**   it under the terms of the GNU General Public License as published by
+**   the Free Software Foundation; either version 2 of the License, or
+**   (at your option) any later version.
+**
+***********************************************************************/
+
+/**
+ * \class NmeaLineBuffer
+ *
+ * \author Axel Pauli
+ *
+ * \brief Circular receive buffer for NMEA lines.
+ *
+ * The device data are read directly into the buffer. Every byte is scanned
+ * only once for the line end. A complete line is delivered as view into the
+ * buffer, only a line wrapping around the buffer end is copied. Consumed
+ * lines are released by moving the read position, nothing is moved in the
+ * buffer.
+ *
+ * Lines longer than MaxLine are discarded up to their line end.
+ *
+ * \date 2026
+ *
+ * \version 1.0
+ */
+
+#pragma once
+
+#include <QtGlobal>
+
+class NmeaLineBuffer
+{
+ public:
+
+  enum Limits
+  {
+    Capacity = 4096, // Must be a power of two
+    MaxLine  = 512   // Includes the line end
+  };
+
+  NmeaLineBuffer();
+
+  /** Discards all buffered data. */
+  void clear();
+
+  /**
+   * Returns the contiguous free space of the buffer, usable as target of a
+   * read call. The read bytes must be announced by commit().
+   */
+  char* writeSpace( int& size );
+
+  /** Announces the number of bytes written into the write space. */
+  void commit( const int bytes );
+
+  /**
+   * Delivers the next complete line including its line end. The view is
+   * valid until the next call of nextLine(), commit() or clear().
+   *
+   * \return false, if no complete line is available.
+   */
+  bool nextLine( const char*& line, int& length );
+
+  /** \return The number of buffered bytes not yet delivered. */
+  int size() const
+  {
+    return m_write - m_read;
+  };
+
+  /** \return The number of discarded overlong lines. */
+  quint32 discarded() const
+  {
+    return m_discarded;
+  };
+
+  /**
+   * Verifies the checksum *hh of the passed line in place. Trailing line
+   * end characters are ignored.
+   *
+   * \return true, if the checksum is present and valid.
+   */
+  static bool verifyCheckSum( const char* line, const int length );
+
+ private:
+
+  char m_buffer[Capacity];
+
+  /** Copy of a line wrapping around the buffer end. */
+  char m_line[MaxLine];
+
+  /** Running positions, the buffer index is masked. */
+  quint32 m_read;
+  quint32 m_scan;
+  quint32 m_write;
+
+  quint32 m_discarded;
+
+  /** Set while the rest of an overlong line is skipped. */
+  bool m_skip;
+};
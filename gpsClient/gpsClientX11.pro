@@ -37,14 +37,19 @@ CONFIG += flarm
 
 HEADERS = \
   gpsclient.h \
+  NmeaLineBuffer.h \
   ../cumulus/ipc.h \
+  ../cumulus/LatencyTrace.h \
+  ../cumulus/NmeaRing.h \
   ../cumulus/protocol.h \
   ../cumulus/signalhandler.h
 
 SOURCES = \
   gpsclient.cpp \
   gpsmain.cpp \
+  NmeaLineBuffer.cpp \
   ../cumulus/ipc.cpp \
+  ../cumulus/NmeaRing.cpp \
   ../cumulus/signalhandler.cpp
 
 bluetooth {
@@ -70,4 +75,4 @@ DESTDIR = .
 TARGET = gpsClient
 INCLUDEPATH += ../cumulus
 
-LIBS += -lstdc++
+LIBS += -lstdc++ -lrt
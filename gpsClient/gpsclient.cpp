@@ -18,6 +18,8 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/ioctl.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
 #include <fcntl.h>
 #include <unistd.h>
 
@@ -33,6 +35,7 @@
 #include "gpscon.h"
 #include "protocol.h"
 #include "ipc.h"
+#include "LatencyTrace.h"
 
 #ifdef FLARM
 #include "flarmbase.h"
@@ -63,6 +66,50 @@
 // Define connection lost timeout in milli seconds
 #define TO_CONLOST  10000
 
+// Silence of the device in milli seconds, which closes an epoch
+#define EPOCH_IDLE  50
+
+// Maximum duration of an epoch in milli seconds, used for devices
+// delivering no fix time
+#define EPOCH_MAX_AGE  1000
+
+// Minimum time in milli seconds between two reports of dropped sentences
+#define DROP_REPORT_INTERVAL  1000
+
+// Poll interval of the connection supervision in milli seconds, used when
+// no deadline can be determined
+#define TO_POLL  1000
+
+// Maximum number of events taken over by one epoll_wait call
+#define MAX_EVENTS  16
+
+#ifdef FLARM
+
+// Number of tries to restart a broken Flarm IGC transfer
+#define FLARM_RETRIES  3
+
+// Time in milli seconds, the Flarm needs to switch its baud rate
+#define FLARM_SWITCH_DELAY  100
+
+// Baud rates of the Flarm binary mode and their speed keys, highest first
+static const struct
+{
+  uint bps;
+  int  key;
+}
+flarmSpeeds[] =
+{
+  { 230400, SPEED_230400 },
+  { 115200, SPEED_115200 },
+  {  57600, SPEED_57600 },
+  {  38400, SPEED_38400 },
+  {  19200, SPEED_19200 },
+  {   9600, SPEED_9600 },
+  {   4800, SPEED_4800 }
+};
+
+#endif
+
 GpsClient::GpsClient( const ushort portIn )
 {
   device           = "";
@@ -73,13 +120,32 @@ GpsClient::GpsClient( const ushort portIn )
   so1              = 0;
   so2              = 0;
   flarmFd          = -1;
+  flarmSpeed       = 0;
   forwardGpsData   = true;
   connectionLost   = true;
   shutdown         = false;
-  datapointer      = databuffer;
-  dbsize           = 0;
   badSentences     = 0;
   activateTimeout  = false;
+  ringPending      = false;
+  ringDrops        = 0;
+  readTime         = 0;
+  epochTime[0]     = '\0';
+  epollFd          = epoll_create1( EPOLL_CLOEXEC );
+  timerFd          = timerfd_create( CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC );
+
+  if( epollFd == -1 || timerFd == -1 )
+    {
+      qCritical() << "GpsClient: Cannot create event loop, errno="
+                  << errno << "," << strerror(errno)
+                  << "Fatal error, terminate process!";
+
+      setShutdownFlag(true);
+      return;
+    }
+
+  // The supervision timer runs always, it is disabled by an invalid last time.
+  watchSource( timerFd, SourceTimer );
+  armController();
 
   // establish a connection to the server
   if( ipcPort )
@@ -105,237 +171,388 @@ GpsClient::GpsClient( const ushort portIn )
       // Set forward channel to non blocking IO
       int fc = clientForward.getSock();
       fcntl( fc, F_SETFL, O_NONBLOCK );
+
+      // The command channel uses blocking IO and is read message by message,
+      // therefore it is watched level triggered.
+      watchSource( clientData.getSock(), SourceIpc, false );
     }
 }
 
 GpsClient::~GpsClient()
 {
   closeGps();
+  ring.close();
   clientData.closeSock();
   clientForward.closeSock();
+
+  if( timerFd != -1 )
+    {
+      close( timerFd );
+    }
+
+  if( epollFd != -1 )
+    {
+      close( epollFd );
+    }
 }
 
 /**
- * Return all currently used read file descriptors as mask, usable by the
- * select call
+ * Adds a file descriptor to the event loop. The kind of the source and the
+ * descriptor are stored in the event data, so that an event can be assigned
+ * without searching.
  */
-fd_set *GpsClient::getReadFdMask()
+bool GpsClient::watchSource( const int sfd, const SourceKind kind,
+                             const bool edgeTriggered )
 {
-  // Reset file descriptor mask bits
-  FD_ZERO( &fdMask );
+  if( sfd == -1 || epollFd == -1 )
+    {
+      return false;
+    }
 
-  if( fd != -1 ) // serial device
+  struct epoll_event ev;
+
+  memset( &ev, 0, sizeof(ev) );
+
+  ev.events   = EPOLLIN | (edgeTriggered ? EPOLLET : 0);
+  ev.data.u64 = (quint64( kind ) << 32) | quint32( sfd );
+
+  if( epoll_ctl( epollFd, EPOLL_CTL_ADD, sfd, &ev ) == -1 )
+    {
+      qWarning() << "GpsClient::watchSource(): epoll_ctl() returns with Errno="
+                 << errno << "," << strerror(errno);
+      return false;
+    }
+
+  return true;
+}
+
+/**
+ * Removes a file descriptor from the event loop. Must be called before the
+ * descriptor is closed.
+ */
+void GpsClient::unwatchSource( const int sfd )
+{
+  if( sfd == -1 || epollFd == -1 )
     {
-      FD_SET( fd, &fdMask );
+      return;
     }
 
-  if( ipcPort ) // command data channel to server
+  // The event argument is ignored but must be non null for older kernels.
+  struct epoll_event ev;
+
+  epoll_ctl( epollFd, EPOLL_CTL_DEL, sfd, &ev );
+}
+
+/**
+ * Arms the supervision timer for the next toController() call. The deadline
+ * is derived from the last data reception. A restart of the last time only
+ * moves the deadline later, so an early expiration calls the controller
+ * without effect and arms the timer again.
+ */
+void GpsClient::armController()
+{
+  qint64 delay = TO_POLL;
+
+  if( last.isValid() )
     {
-      int sfd = clientData.getSock();
+      qint64 deadline = TO_CONLOST + 1;
+
+#ifdef FLARM
 
-      if( sfd != -1 )
+      if( activateTimeout )
         {
-          FD_SET( sfd, &fdMask );
+          deadline = 130000;
         }
-    }
 
-  // WiFi socket 1
-  if( so1 != nullptr and so1->isOpen() == true )
-    {
-      int sd1 = so1->socketDescriptor();
+#endif
+
+      delay = deadline - last.elapsed();
 
-      if( sd1 != -1 )
+      if( delay <= 0 )
         {
-          FD_SET( sd1, &fdMask );
+          // The controller did nothing, poll as before.
+          delay = TO_POLL;
         }
     }
 
-  // WiFi socket 2
-  if( so2 != nullptr and so2->isOpen() == true )
+  struct itimerspec ts;
+
+  memset( &ts, 0, sizeof(ts) );
+
+  ts.it_value.tv_sec  = delay / 1000;
+  ts.it_value.tv_nsec = (delay % 1000) * 1000000;
+
+  if( timerfd_settime( timerFd, 0, &ts, 0 ) == -1 )
+    {
+      qWarning() << "GpsClient::armController(): timerfd_settime() returns with Errno="
+                 << errno << "," << strerror(errno);
+    }
+}
+
+/**
+ * Waits for events of all input sources and processes them.
+ */
+bool GpsClient::processEvents( const int maxWait )
+{
+  int timeout = maxWait;
+
+  // A short timeout closes an open GPS epoch, when the device becomes
+  // silent.
+  int epochWait = epochTimeout();
+
+  if( epochWait >= 0 && epochWait < timeout )
     {
-      int sd2 = so2->socketDescriptor();
+      timeout = epochWait;
+    }
+
+  struct epoll_event events[MAX_EVENTS];
+
+  int n = epoll_wait( epollFd, events, MAX_EVENTS, timeout );
 
-      if( sd2 != -1 )
+  if( n == -1 )
+    {
+      if( errno == EINTR )
         {
-          FD_SET( sd2, &fdMask );
+          return true; // interrupted call, ignore it
         }
+
+      qCritical() << "GpsClient::processEvents(): epoll_wait() returns with Errno="
+                  << errno << "," << strerror(errno);
+      return false;
     }
 
-  return &fdMask;
-}
+  if( n == 0 )
+    {
+      // The device is silent, pass the open epoch to Cumulus.
+      closeEpoch();
+      return true;
+    }
 
-// Processes incoming read events. They can come from the server or
-// from the GPS device.
-void GpsClient::processEvent( fd_set *fdMask )
-{
-  if( ipcPort )
+  for( int i = 0; i < n && shutdown == false; i++ )
     {
-      int sfd = clientData.getSock();
+      int sfd = int( events[i].data.u64 & 0xffffffff );
 
-      if( sfd != -1 && FD_ISSET( sfd, fdMask ) )
+      switch( events[i].data.u64 >> 32 )
         {
-          int loops = 0;
+          case SourceIpc:
+            readServerMessages();
+            break;
 
-          // Try to process several messages from the client in order. That
-          // is more effective as to wait for a new select call.
-          while( loops++ < 32 )
-            {
-              readServerMsg();
+          case SourceDevice:
 
-              if( shutdown == true )
-                {
-                  break;
-                }
+            // A former event of the same batch can have closed the device.
+            if( sfd == fd )
+              {
+                handleDeviceEvent();
+              }
 
-              // Check, if more bytes are available in the receiver buffer because we
-              // use blocking IO.
-              int bytes = 0;
+            break;
 
-              // Number of bytes currently in the socket receiver buffer.
-              if( ioctl( sfd, FIONREAD, &bytes) == -1 )
-                {
-                  qWarning() << "GpsClient::processEvent():"
-                              << "ioctl() returns with Errno="
-                              << errno
-                              << "," << strerror(errno);
-                  break;
-                }
+          case SourceSocket:
+            handleSocketEvent( sfd );
+            break;
 
-              if( bytes <= 0 )
+          case SourceTimer:
+            {
+              uint64_t expirations;
+
+              if( read( timerFd, &expirations, sizeof(expirations) ) > 0 )
                 {
-                  break;
+                  toController();
                 }
+
+              armController();
+              break;
             }
+
+          default:
+            break;
         }
     }
 
-  if( fd != -1 && FD_ISSET( fd, fdMask ) )
+  // Devices without fix time would never close an epoch.
+  if( ringPending && epochStart.elapsed() >= EPOCH_MAX_AGE )
     {
-      if( readGpsData() == false )
-        {
-          // problem occurred, likely buffer overrun. we do restart the GPS
-          // receiving.
-          int error = errno; // Save errno
-          closeGps();
-
-          if( error == ECONNREFUSED )
-            {
-              // BT devices can reject a connection try. If we don't return here
-              // we run in an endless loop.
-              setShutdownFlag(true);
-            }
-          else
-            {
-              sleep(3);
-              // reopen connection
-              openGps( device.data(), ioSpeedDevice );
-              last.start(); // set next retry time point
-            }
-        }
+      closeEpoch();
     }
 
-  // Look, if WiFi sockets are used.
-  int sd1 = -1;
-  int sd2 = -1;
+  // Drops of the last second are reported also, if no further drop occurs.
+  reportRingDrops();
 
-  if( so1 != nullptr )
-    {
-      sd1 = so1->socketDescriptor();
-    }
+  return true;
+}
 
-  if( so2 != nullptr )
+/**
+ * Reads all pending messages of the server command channel.
+ */
+void GpsClient::readServerMessages()
+{
+  int sfd = clientData.getSock();
+
+  if( sfd == -1 )
     {
-      sd2 = so2->socketDescriptor();
+      return;
     }
 
-  // WiFi socket 1
-  if( sd1 != -1 && FD_ISSET( sd1, fdMask ) )
+  int loops = 0;
+
+  // Try to process several messages from the client in order. That
+  // is more effective as to wait for a new event.
+  while( loops++ < 32 )
     {
-      if( readNmeaSocketData( so1, so1Data ) == false )
-        {
-          // Error occurred, we close the socket and try a reconnect.
-          closeGps();
+      readServerMsg();
 
-          if( so1->error() == QAbstractSocket::ConnectionRefusedError )
-            {
-              // TCP devices can reject a connection try. If we don't return here
-              // we run in an endless loop.
-               setShutdownFlag(true);
-            }
+      if( shutdown == true )
+        {
+          break;
         }
-    }
 
-  // WiFi socket 2
-  if( sd2 != -1 && FD_ISSET( sd2, fdMask ) )
-    {
-      if( readNmeaSocketData( so2, so2Data ) == false )
+      // Check, if more bytes are available in the receiver buffer because we
+      // use blocking IO.
+      int bytes = 0;
+
+      // Number of bytes currently in the socket receiver buffer.
+      if( ioctl( sfd, FIONREAD, &bytes) == -1 )
         {
-          // Error occur red, we close the socket and try a reconnect.
-          closeGps();
+          qWarning() << "GpsClient::readServerMessages():"
+                      << "ioctl() returns with Errno="
+                      << errno
+                      << "," << strerror(errno);
+          break;
+        }
 
-          if( so2->error() == QAbstractSocket::ConnectionRefusedError )
-            {
-              // TCP devices can reject a connection try. If we don't return here
-              // we run in an endless loop.
-              setShutdownFlag( true );
-            }
+      if( bytes <= 0 )
+        {
+          break;
         }
     }
 }
 
 /**
- * Reads NMEA data from the connected GPS device via tty, BT or pipe.
+ * Handles a read event of the GPS device.
  */
-bool GpsClient::readGpsData()
+void GpsClient::handleDeviceEvent()
 {
-  if( fd == -1 ) // no connection is active
+  if( readGpsData() == true )
     {
-      return false;
+      return;
     }
 
-  // First check, if enough space is available in the receiver buffer.
-  // If we read only trash for a while we can run in a dead lock.
-  int freeSpace = sizeof(databuffer) - dbsize;
+  // problem occurred, likely buffer overrun. we do restart the GPS
+  // receiving.
+  int error = errno; // Save errno
+  closeGps();
 
-  if( freeSpace < 10 )
+  if( error == ECONNREFUSED )
+    {
+      // BT devices can reject a connection try. If we don't return here
+      // we run in an endless loop.
+      setShutdownFlag(true);
+    }
+  else
     {
-      // Reset buffer pointer because the minimal free buffer space is
-      // reached. That will discard all already read data but we never
-      // read a end of line. That is our emergency break.
-      datapointer = databuffer;
-      dbsize = 0;
+      sleep(3);
+      // reopen connection
+      openGps( device.data(), ioSpeedDevice );
+      last.start(); // set next retry time point
     }
+}
 
-  // all available GPS data lines are read successive
-  int bytes = 0;
+/**
+ * Handles a read event of a NMEA socket.
+ */
+void GpsClient::handleSocketEvent( const int sfd )
+{
+  QTcpSocket* socket = nullptr;
+  QStringList* socketData = nullptr;
 
-  bytes = read( fd, datapointer, sizeof(databuffer) - dbsize -1 );
+  if( so1 != nullptr && so1->socketDescriptor() == sfd )
+    {
+      socket = so1;
+      socketData = &so1Data;
+    }
+  else if( so2 != nullptr && so2->socketDescriptor() == sfd )
+    {
+      socket = so2;
+      socketData = &so2Data;
+    }
 
-  if( bytes == 0 ) // Nothing read, should normally not happen
+  if( socket == nullptr )
     {
-      qWarning() << "GpsClient::readGpsData(): 0 bytes read!";
-      return false;
+      // A former event of the same batch has closed the socket.
+      return;
     }
 
-  if( bytes == -1 )
+  if( readNmeaSocketData( socket, *socketData ) == true )
     {
-      qWarning() << "GpsClient::readGpsData(): Read error"
-                 << errno << "," << strerror(errno);
+      return;
+    }
+
+  // Error occurred, we close the socket and try a reconnect.
+  QAbstractSocket::SocketError error = socket->error();
+
+  closeGps();
+
+  if( error == QAbstractSocket::ConnectionRefusedError )
+    {
+      // TCP devices can reject a connection try. If we don't return here
+      // we run in an endless loop.
+      setShutdownFlag( true );
+    }
+}
 
-      forwardDeviceError( QObject::tr("Device") + " " +
-                          device + " " + QObject::tr("reported error") + " " +
-                          strerror(errno) );
+/**
+ * Reads NMEA data from the connected GPS device via tty, BT or pipe.
+ */
+bool GpsClient::readGpsData()
+{
+  if( fd == -1 ) // no connection is active
+    {
       return false;
     }
 
-  if( bytes > 0 )
+  // The data are read directly into the free space of the receive buffer.
+  // Overlong lines are discarded by the buffer, so there is always space.
+  // The device is watched edge triggered, therefore it is read until no
+  // more data are available.
+  while( true )
     {
-      dbsize      += bytes;
-      datapointer += bytes;
+      int space = 0;
+      char *target = receiveBuffer.writeSpace( space );
+
+      int bytes = read( fd, target, space );
+
+      if( bytes == 0 ) // End of file, the device has been disconnected
+        {
+          qWarning() << "GpsClient::readGpsData(): 0 bytes read!";
+          return false;
+        }
+
+      if( bytes == -1 )
+        {
+          if( errno == EINTR )
+            {
+              continue;
+            }
+
+          if( errno == EAGAIN || errno == EWOULDBLOCK )
+            {
+              break; // all data read
+            }
+
+          qWarning() << "GpsClient::readGpsData(): Read error"
+                     << errno << "," << strerror(errno);
+
+          forwardDeviceError( QObject::tr("Device") + " " +
+                              device + " " + QObject::tr("reported error") + " " +
+                              strerror(errno) );
+          return false;
+        }
+
+      readTime = LatencyTrace::now();
 
-      databuffer[dbsize] = '\0'; // terminate buffer with a null
+      receiveBuffer.commit( bytes );
 
-      // qDebug() << "GPS Data:" << databuffer;
       readSentenceFromBuffer();
 
 #ifdef FLARM
@@ -422,6 +639,8 @@ bool GpsClient::readNmeaSocketData( QTcpSocket* socket,
   // of a Qt mainloop.
   socket->waitForReadyRead(0);
 
+  readTime = LatencyTrace::now();
+
   do
     {
       // read NMEA sentence, it ends with crlf
@@ -458,11 +677,7 @@ bool GpsClient::readNmeaSocketData( QTcpSocket* socket,
       // AP 2018: we forward all sentences now.
       if( forwardGpsData == true )
         {
-          QByteArray ba;
-          ba.append( MSG_GPS_DATA );
-          ba.append( ' ' );
-          ba.append( buffer );
-          writeForwardMsg( ba.data() );
+          forwardSentence( buffer );
         }
 
     }  while( bytes > 0 );
@@ -514,6 +729,7 @@ bool GpsClient::openGps( const char *deviceIn, const uint ioSpeedIn )
   device          = deviceIn;
   ioSpeedDevice   = ioSpeedIn;
   ioSpeedTerminal = getBaudrate(ioSpeedIn);
+  flarmSpeed      = 0;
   badSentences    = 0;
   unknownsReported.clear();
 
@@ -526,10 +742,8 @@ bool GpsClient::openGps( const char *deviceIn, const uint ioSpeedIn )
       return false;
     }
 
-  // reset buffer pointer
-  datapointer = databuffer;
-  dbsize      = 0;
-  memset( databuffer, 0, sizeof(databuffer) );
+  // reset receive buffer
+  receiveBuffer.clear();
 
   if( fd != -1 )
     {
@@ -574,6 +788,7 @@ bool GpsClient::openGps( const char *deviceIn, const uint ioSpeedIn )
           return false;
         }
 
+      watchSource( fd, SourceDevice );
       return true;
     }
 
@@ -682,6 +897,7 @@ bool GpsClient::openGps( const char *deviceIn, const uint ioSpeedIn )
       fcntl(fd, F_SETFL, O_NONBLOCK); // NON blocking io is requested
     }
 
+  watchSource( fd, SourceDevice );
   return true;
 }
 
@@ -744,6 +960,7 @@ bool GpsClient::openNmeaSockets()
           return false;
         }
 
+      watchSource( so1->socketDescriptor(), SourceSocket );
       last.start(); // store time point for supervision control
       qDebug() << "WiFi-1 connected to" << so1Data[0] << ":" << so1Data[1];
     }
@@ -770,6 +987,7 @@ bool GpsClient::openNmeaSockets()
           return false;
         }
 
+      watchSource( so2->socketDescriptor(), SourceSocket );
       qDebug() << "WiFi-2 connected to" << so2Data[0] << ":" << so2Data[1];
     }
 
@@ -783,44 +1001,23 @@ bool GpsClient::openNmeaSockets()
  */
 void GpsClient::readSentenceFromBuffer()
 {
-  char *start = databuffer;
-  char *end   = 0;
+  const char *record = 0;
+  int length = 0;
 
-  while(strlen(start))
+  // The records are views into the receive buffer, they are not null
+  // terminated.
+  while( receiveBuffer.nextLine( record, length ) )
     {
-      // Search for a newline in the receiver buffer.
-      // That is the normal end of a GPS sentence.
-      if( ! (end = strchr( start, '\n' )) )
-        {
-          // No newline in the receiver buffer, wait for more characters
-          return;
-        }
-
-      if( start == end )
-        {
-          // skip newline and start at next position with a new search
-          start++;
-          continue;
-        }
-
-      // found a complete record in the buffer, it will be extracted now
-      char *record = (char *) malloc( end-start + 2 );
-
-      memset( record, 0, end-start + 2 );
-      strncpy( record, start, end-start + 1);
-
       const char* pflau = "$PFLAU";
 
       // Look, if data from Flarm have been received. If yes remember fd.
-      if( strlen(record) > strlen(pflau) )
+      if( length > (int) strlen(pflau) &&
+          strncmp( record, pflau, strlen(pflau) ) == 0 )
         {
-          if( strncmp( record, pflau, strlen(pflau) ) == 0 )
-            {
-              flarmFd = fd;
-            }
+          flarmFd = fd;
         }
 
-      if( verifyCheckSum( record ) == true )
+      if( verifyCheckSum( record, length ) == true )
         {
           // Set Flarm back to text mode.
           FlarmBase::setProtocolMode( FlarmBase::text );
@@ -831,32 +1028,13 @@ void GpsClient::readSentenceFromBuffer()
           // AP 2018: we forward all sentences now.
           if( forwardGpsData == true )
             {
-              QByteArray ba;
-              ba.append( MSG_GPS_DATA );
-              ba.append( ' ' );
-              ba.append( record );
-              writeForwardMsg( ba.data() );
+              forwardSentence( record, length );
             }
         }
 
 #ifdef DEBUG_NMEA
-      qDebug() << "GpsClient::read():" << record;
+      qDebug() << "GpsClient::read():" << QByteArray( record, length );
 #endif
-
-      free(record);
-      record = 0;
-
-      // remove queued record from receive buffer
-      memmove( databuffer, end+1,
-               databuffer + sizeof(databuffer)-1 - end );
-
-      datapointer -= (end+1 - databuffer);
-
-      dbsize -= ( end+1 - databuffer);
-
-      start = databuffer;
-
-      end = 0;
     }
 }
 
@@ -890,6 +1068,7 @@ void GpsClient::closeGps()
           //tcsetattr( fd, TCSANOW, &oldtio );
         }
 
+      unwatchSource( fd );
       close( fd );
       fd = -1;
     }
@@ -910,6 +1089,8 @@ void GpsClient::closeTcpSockets()
 
   if( so1 != nullptr )
     {
+      unwatchSource( so1->socketDescriptor() );
+
       if( so1->openMode() != QIODevice::NotOpen )
         {
           so1->close();
@@ -921,6 +1102,8 @@ void GpsClient::closeTcpSockets()
 
   if( so2 != nullptr )
     {
+      unwatchSource( so2->socketDescriptor() );
+
       if( so2->openMode() != QIODevice::NotOpen )
         {
           so2->close();
@@ -972,50 +1155,26 @@ bool GpsClient::checkGpsMessageFilter( const char *sentence )
  * @returns true (success) or false (error occurred)
  */
 bool GpsClient::verifyCheckSum( const char *sentence )
+{
+  return verifyCheckSum( sentence, strlen( sentence ) );
+}
+
+bool GpsClient::verifyCheckSum( const char *sentence, const int length )
 {
   // Filter out wrong data messages read in from the GPS port. Known messages
   // do start with a dollar sign or an exclamation mark.
   // Note: Flarm sends several debug text messages after a restart not starting
   // with a dollar sign or an exclamation mark.
-  if( sentence[0] != '$' && sentence[0] != '!' )
+  if( length == 0 || (sentence[0] != '$' && sentence[0] != '!') )
     {
-      qWarning() << "GpsClient::CheckSumError:" << sentence;
+      qWarning() << "GpsClient::CheckSumError:" << QByteArray( sentence, length );
       badSentences++;
       return false;
     }
 
   badSentences = 0;
 
-  for( int i = strlen(sentence) - 1; i >= 0; i-- )
-    {
-      if( sentence[i] == '*' )
-        {
-          if( (strlen(sentence) - 1 - i) < 2 )
-            {
-              // too less characters
-              return false;
-            }
-
-          char checkBytes[3];
-          checkBytes[0] = sentence[i+1];
-          checkBytes[1] = sentence[i+2];
-          checkBytes[2] = '\0';
-
-          uchar checkSum = (uchar) QString( checkBytes ).toUShort( 0, 16 );
-
-          if( checkSum == calcCheckSum( sentence ) )
-            {
-              return true;
-            }
-          else
-            {
-              return false;
-            }
-        }
-    }
-
-  qWarning() << "GpsClient::CheckSumError, missing *cs:" << sentence;
-  return false;
+  return NmeaLineBuffer::verifyCheckSum( sentence, length );
 }
 
 /** Calculate check sum over NMEA record. */
@@ -1323,6 +1482,21 @@ void GpsClient::readServerMsg()
       // qDebug() << "GPS-Keys:" << gpsMessageFilter;
       writeServerMsg( MSG_POS );
     }
+  else if( MSG_NMEA_RING == args[0] && args.count() == 2 )
+    {
+      // Cumulus provides a shared memory ring for the GPS data.
+      if( ring.attach( args[1] ) == true )
+        {
+          ringPending = false;
+          epochTime[0] = '\0';
+          writeServerMsg( MSG_POS );
+        }
+      else
+        {
+          // Continue with the forward channel.
+          writeServerMsg( MSG_NEG );
+        }
+    }
   else if( MSG_SHD == args[0] )
     {
       // Shutdown is requested by the server. This message will not be
@@ -1427,19 +1601,187 @@ void GpsClient::writeForwardMsg( const char *msg )
 }
 
 /**
- * Translates the baud rate to a terminal speed definition.
+ * Extracts the fix time of the GNSS position sentences RMC, GGA, GLL and GNS.
+ *
+ * \return true, if the sentence contains a fix time.
  */
-uint GpsClient::getBaudrate(int rate)
+static bool extractFixTime( const char *sentence, const int length,
+                            char *time, const int size )
 {
-  switch (rate)
+  if( length < 7 || sentence[0] != '$' )
     {
-    case 600:
-      return B600;
-    case 1200:
-      return B1200;
-    case 2400:
-      return B2400;
-    case 4800:
+      return false;
+    }
+
+  // The talker id is ignored, e.g. $GPRMC, $GNRMC.
+  const char *type = sentence + 3;
+  int field = 0;
+
+  if( strncmp( type, "RMC,", 4 ) == 0 || strncmp( type, "GGA,", 4 ) == 0 ||
+      strncmp( type, "GNS,", 4 ) == 0 )
+    {
+      field = 1;
+    }
+  else if( strncmp( type, "GLL,", 4 ) == 0 )
+    {
+      field = 5;
+    }
+  else
+    {
+      return false;
+    }
+
+  const char *p = sentence;
+  const char *end = sentence + length;
+
+  for( int i = 0; i < field && p != 0; i++ )
+    {
+      p = static_cast<const char *>( memchr( p, ',', end - p ) );
+
+      if( p != 0 )
+        {
+          p++;
+        }
+    }
+
+  if( p == 0 )
+    {
+      return false;
+    }
+
+  int len = 0;
+
+  while( p + len < end && strchr( ",*\r\n", p[len] ) == 0 )
+    {
+      len++;
+    }
+
+  if( len == 0 || len >= size )
+    {
+      return false;
+    }
+
+  memcpy( time, p, len );
+  time[len] = '\0';
+  return true;
+}
+
+/**
+ * Forwards a GPS sentence to Cumulus. The shared memory ring is used, if
+ * it is attached, otherwise the forward channel.
+ */
+void GpsClient::forwardSentence( const char *sentence )
+{
+  forwardSentence( sentence, strlen( sentence ) );
+}
+
+void GpsClient::forwardSentence( const char *sentence, const int length )
+{
+  if( ring.isValid() )
+    {
+      char time[sizeof(epochTime)];
+
+      if( extractFixTime( sentence, length, time, sizeof(time) ) == true )
+        {
+          if( ringPending && strcmp( time, epochTime ) != 0 )
+            {
+              // A new fix time starts a new epoch.
+              closeEpoch();
+            }
+
+          strcpy( epochTime, time );
+        }
+
+      if( ring.write( sentence, length, readTime ) == true )
+        {
+          if( ringPending == false )
+            {
+              ringPending = true;
+              epochStart.start();
+            }
+        }
+      else
+        {
+          // The reader is behind, we discard the sentence like the forward
+          // channel does it. A slow reader drops many sentences, so they are
+          // only counted here.
+          ringDrops++;
+          reportRingDrops();
+        }
+
+      return;
+    }
+
+  QByteArray ba;
+  ba.append( MSG_GPS_DATA );
+  ba.append( ' ' );
+  ba.append( sentence, length );
+  writeForwardMsg( ba.data() );
+}
+
+void GpsClient::reportRingDrops()
+{
+  if( ringDrops == 0 ||
+      ( ringDropReport.isValid() && ringDropReport.elapsed() < DROP_REPORT_INTERVAL ) )
+    {
+      return;
+    }
+
+  qWarning() << "GpsClient::forwardSentence(): Ring is full,"
+             << ringDrops << "sentence(s) dropped!";
+
+  ringDrops = 0;
+  ringDropReport.start();
+}
+
+/**
+ * Returns the time in ms, the main loop shall wait for further data of
+ * the open epoch or -1, if no epoch is open.
+ */
+int GpsClient::epochTimeout() const
+{
+  return ringPending ? EPOCH_IDLE : -1;
+}
+
+/**
+ * Closes the open epoch in the shared memory ring and sends a wake up
+ * message to Cumulus, if the reader is waiting for data.
+ */
+void GpsClient::closeEpoch()
+{
+  if( ringPending == false )
+    {
+      return;
+    }
+
+  ringPending = false;
+
+  if( ring.write( MSG_EPOCH_END, strlen( MSG_EPOCH_END ) ) == false )
+    {
+      // The reader finds the end at the next epoch.
+      qWarning() << "GpsClient::closeEpoch(): Ring is full, drop epoch end!";
+    }
+
+  if( ring.takeWakeupRequest() == true )
+    {
+      writeForwardMsg( MSG_RING_WAKEUP );
+    }
+}
+
+/**
+ * Translates the baud rate to a terminal speed definition.
+ */
+uint GpsClient::getBaudrate(int rate)
+{
+  switch (rate)
+    {
+    case 600:
+      return B600;
+    case 1200:
+      return B1200;
+    case 2400:
+      return B2400;
+    case 4800:
       return B4800;
     case 9600:
       return B9600;
@@ -1560,11 +1902,7 @@ bool GpsClient::flarmBinMode( QString* errorInfo )
 
   // Forward $PFLAX sentence to the Cumulus main process to signal switch to
   // Flarm's binary protocol.
-  QByteArray ba;
-  ba.append( MSG_GPS_DATA );
-  ba.append( ' ' );
-  ba.append( buf );
-  writeForwardMsg( ba.data() );
+  forwardSentence( buf );
 
   qDebug() << "$PFLAX Ok send to Cumulus.";
 
@@ -1648,6 +1986,12 @@ void GpsClient::getFlarmFlightList()
       return;
     }
 
+  if( flarmRaiseBaudRate( fbc ) == false )
+    {
+      flarmFlightListError( "Flarm not reachable!" );
+      return;
+    }
+
   // read out flight header records
   int recNo = 0;
   char buffer[MAXSIZE];
@@ -1687,6 +2031,8 @@ void GpsClient::getFlarmFlightList()
         }
     }
 
+  flarmRestoreBaudRate( fbc );
+
   QByteArray ba( MSG_FLARM_FLIGHT_LIST_RES );
 
   if( flights == 0 )
@@ -1731,18 +2077,6 @@ void GpsClient::getFlarmIgcFiles( QString& args )
   // Switch off timeout control
   last.invalidate();
 
-  FlarmBinComLinux fbc( flarmFd );
-
-  if( flarmBinMode() == false )
-    {
-      flarmFlightDowloadInfo( "Error" );
-      return;
-    }
-
-  // read out flights
-  char buffer[MAXSIZE];
-  int progress = 0;
-
   // Check, if the download directory exists. Here we take the directory element
   // from the list.
   QDir igcDir( idxList.takeFirst() );
@@ -1756,89 +2090,328 @@ void GpsClient::getFlarmIgcFiles( QString& args )
         }
     }
 
-  QElapsedTimer dlTime;
+  FlarmBinComLinux fbc( flarmFd );
 
-  for( int idx = 0; idx < idxList.size(); idx++ )
+  if( flarmBinMode() == false || flarmRaiseBaudRate( fbc ) == false )
     {
-      dlTime.start();
-      downloadTimeControl.start();
+      flarmFlightDowloadInfo( "Error" );
+      return;
+    }
 
+  bool ok = true;
+
+  for( int idx = 0; idx < idxList.size() && ok; idx++ )
+    {
       // Select the flight to be downloaded
       int recNo = idxList.at(idx).toInt();
-      QStringList flightData;
 
-      if( fbc.selectRecord(recNo ) == true )
+      for( int tries = 0; ; tries++ )
         {
-          // read flight header data
-          if( fbc.getRecordInfo( buffer ) )
-            {
-              flightData = QString( buffer ).split("|");
-            }
-          else
+          bool broken = false;
+
+          ok = flarmDownloadFlight( fbc, recNo, igcDir.absolutePath(), broken );
+
+          if( ok || broken == false || tries == FLARM_RETRIES )
             {
-              // Entry not available, although select answered positive!
-              // Not conform to the specification.
-              flarmFlightDowloadInfo( "Error" );
-              return;
+              break;
             }
 
-          // Open an IGC file for writing download data.
-          QFile f( igcDir.absolutePath() + "/" + flightData.at(0) );
+          // The Flarm can only restart a record from its begin. All records
+          // completed before are kept.
+          qWarning() << "getFlarmIgcFiles(): Transfer of record" << recNo
+                     << "broken, restarting it";
 
-          if( ! f.open( QIODevice::WriteOnly ) )
+          // The progress report restarts the supervision of the GUI too.
+          flarmFlightDowloadProgress( recNo, 0 );
+
+          if( flarmReconnect( fbc ) == false )
             {
-              // could not open file ...
-              qWarning() << "Cannot open file: " << f.fileName();
-              flarmFlightDowloadInfo( "Error open file" );
-              return;
+              break;
             }
+        }
+    }
 
-          int lastProgress = -1;
-          bool eof = false;
+  flarmRestoreBaudRate( fbc );
 
-          while( fbc.getIGCData(buffer, &progress) )
-            {
-              if( lastProgress != progress || downloadTimeControl.elapsed() >= 10000 )
-                {
-                  // After a certain time a progress must be reported otherwise
-                  // the GUI thread runs in a timeout.
-                  downloadTimeControl.start();
+  flarmFlightDowloadInfo( ok ? "Finished" : "Error" );
+}
 
-                  // That eliminates a lot of intermediate steps
-                  flarmFlightDowloadProgress(recNo, progress);
-                  lastProgress = progress;
-                }
+bool GpsClient::flarmDownloadFlight( FlarmBinComLinux& fbc,
+                                     const int recNo,
+                                     const QString& dir,
+                                     bool& broken )
+{
+  char buffer[MAXSIZE];
+  int progress = 0;
 
-              if( buffer[strlen(buffer) - 1] == 0x1A )
-                {
-                  // EOF was send by the Flarm, remove it from the data stream.
-                   buffer[strlen(buffer) - 1] = '\0';
-                   eof = true;
-                 }
+  QElapsedTimer dlTime;
+  dlTime.start();
+  downloadTimeControl.start();
 
-              f.write(buffer);
+  broken = false;
 
-              if( eof )
-                {
-                  break;
-                }
+  if( fbc.selectRecord( recNo ) == false || fbc.getRecordInfo( buffer ) == false )
+    {
+      // No answer or entry not available, although select answered positive!
+      qWarning() << "flarmDownloadFlight(): Cannot select record" << recNo;
+      broken = true;
+      return false;
+    }
+
+  QStringList flightData = QString( buffer ).split("|");
+  QString fileName = dir + "/" + flightData.at(0);
+
+  if( isCompleteIgcFile( fileName ) )
+    {
+      // The flight was completely downloaded before.
+      qDebug() << flightData.at(0) << "is already downloaded";
+      flarmFlightDowloadProgress( recNo, 100 );
+      return true;
+    }
+
+  // Open a part file for writing download data. It is renamed, when the
+  // download is complete.
+  QFile f( fileName + ".part" );
+
+  if( ! f.open( QIODevice::WriteOnly ) )
+    {
+      // could not open file ...
+      qWarning() << "Cannot open file: " << f.fileName();
+      return false;
+    }
+
+  int lastProgress = -1;
+  bool eof = false;
+
+  while( fbc.getIGCData(buffer, &progress) )
+    {
+      if( lastProgress != progress || downloadTimeControl.elapsed() >= 10000 )
+        {
+          // After a certain time a progress must be reported otherwise
+          // the GUI thread runs in a timeout.
+          downloadTimeControl.start();
+
+          // That eliminates a lot of intermediate steps
+          flarmFlightDowloadProgress(recNo, progress);
+          lastProgress = progress;
+        }
+
+      int length = strlen(buffer);
+
+      if( length == 0 )
+        {
+          // The Flarm has no more data of this record.
+          eof = true;
+          break;
+        }
+
+      if( buffer[length - 1] == 0x1A )
+        {
+          // EOF was send by the Flarm, remove it from the data stream.
+          buffer[--length] = '\0';
+          eof = true;
+        }
+
+      f.write( buffer, length );
+
+      if( eof )
+        {
+          break;
+        }
+    }
+
+  f.close();
+
+  if( eof == false )
+    {
+      // Transfer broken due to timeout or transmission error
+      broken = true;
+      return false;
+    }
+
+  // An incomplete file of a former download is replaced.
+  if( QFile::exists( fileName ) )
+    {
+      QFile::remove( fileName );
+    }
+
+  if( f.rename( fileName ) == false )
+    {
+      qWarning() << "Cannot rename file: " << f.fileName();
+      return false;
+    }
+
+  qDebug() << flightData.at(0) << "downloaded in"
+           << (dlTime.elapsed() / 1000.0) << "s";
+
+  return true;
+}
+
+bool GpsClient::isCompleteIgcFile( const QString& fileName )
+{
+  QFile f( fileName );
+
+  if( f.open( QIODevice::ReadOnly ) == false )
+    {
+      return false;
+    }
+
+  // The G-record has some lines of 20 hex digits, the end of the file
+  // is sufficient to find it.
+  const qint64 tailSize = 1024;
+
+  if( f.size() > tailSize )
+    {
+      f.seek( f.size() - tailSize );
+    }
+
+  QList<QByteArray> lines = f.readAll().split( '\n' );
+
+  f.close();
+
+  for( int i = lines.size() - 1; i >= 0; i-- )
+    {
+      QByteArray line = lines.at(i).trimmed();
+
+      if( line.isEmpty() == false )
+        {
+          // The last record must be a G-record.
+          return line.startsWith( 'G' );
+        }
+    }
+
+  return false;
+}
+
+bool GpsClient::flarmReconnect( FlarmBinComLinux& fbc )
+{
+  // Give the Flarm time to finish a pending answer, which is discarded.
+  usleep( 500000 );
+  fbc.discardInput();
+
+  for( int i = 0; i < 3; i++ )
+    {
+      if( fbc.ping() == true )
+        {
+          return true;
+        }
+    }
+
+  if( flarmSpeed == 0 )
+    {
+      return false;
+    }
+
+  // The Flarm can have fallen back to the configured baud rate.
+  setTerminalSpeed( ioSpeedTerminal );
+  flarmSpeed = 0;
+  fbc.discardInput();
+
+  for( int i = 0; i < 3; i++ )
+    {
+      if( fbc.ping() == true )
+        {
+          return flarmRaiseBaudRate( fbc );
+        }
+    }
+
+  return false;
+}
+
+bool GpsClient::flarmRaiseBaudRate( FlarmBinComLinux& fbc )
+{
+  if( flarmFd != fd || isatty( fd ) == 0 || flarmSpeed != 0 )
+    {
+      // Bluetooth and TCP connections have no baud rate.
+      return true;
+    }
+
+  for( uint i = 0; i < sizeof(flarmSpeeds) / sizeof(flarmSpeeds[0]); i++ )
+    {
+      const uint bps = flarmSpeeds[i].bps;
+
+      if( bps <= ioSpeedDevice )
+        {
+          // The configured rate is the fastest one.
+          return true;
+        }
+
+      if( fbc.setBaudRate( flarmSpeeds[i].key ) == false )
+        {
+          // Rate is not supported by the Flarm.
+          continue;
+        }
+
+      // The Flarm has switched after its acknowledge.
+      usleep( FLARM_SWITCH_DELAY * 1000 );
+      setTerminalSpeed( getBaudrate( bps ) );
+      fbc.discardInput();
+
+      for( int j = 0; j < 3; j++ )
+        {
+          if( fbc.ping() == true )
+            {
+              qDebug() << "GpsClient::flarmRaiseBaudRate(): Flarm uses"
+                       << bps << "bps";
+
+              flarmSpeed = bps;
+              return true;
             }
+        }
+
+      // The serial port seems not to work with this rate. Check, if the
+      // Flarm is still reachable with the configured rate.
+      qWarning() << "GpsClient::flarmRaiseBaudRate(): No answer at"
+                 << bps << "bps";
+
+      setTerminalSpeed( ioSpeedTerminal );
+      fbc.discardInput();
+
+      if( fbc.ping() == false )
+        {
+          return false;
+        }
+    }
+
+  return true;
+}
 
-          f.close();
+void GpsClient::flarmRestoreBaudRate( FlarmBinComLinux& fbc )
+{
+  if( flarmSpeed == 0 )
+    {
+      return;
+    }
 
-          if( eof == false )
+  for( uint i = 0; i < sizeof(flarmSpeeds) / sizeof(flarmSpeeds[0]); i++ )
+    {
+      if( flarmSpeeds[i].bps == ioSpeedDevice )
+        {
+          if( fbc.setBaudRate( flarmSpeeds[i].key ) == false )
             {
-              // Abort downloads due to timeout error
-              flarmFlightDowloadInfo( "Error" );
-              return;
+              qWarning() << "GpsClient::flarmRestoreBaudRate(): Flarm rejects"
+                         << ioSpeedDevice << "bps";
             }
 
-          qDebug() << flightData.at(0) << "downloaded in"
-                   << (dlTime.elapsed() / 1000.0) << "s";
+          usleep( FLARM_SWITCH_DELAY * 1000 );
+          break;
         }
-     }
+    }
+
+  setTerminalSpeed( ioSpeedTerminal );
+  fbc.discardInput();
+  flarmSpeed = 0;
+}
+
+bool GpsClient::setTerminalSpeed( const uint speed )
+{
+  // All data must be sent with the former speed.
+  tcdrain( fd );
+
+  cfsetispeed( &newtio, speed );
+  cfsetospeed( &newtio, speed );
 
-  flarmFlightDowloadInfo( "Finished" );
+  return tcsetattr( fd, TCSANOW, &newtio ) == 0;
 }
 
 void GpsClient::flarmFlightDowloadInfo( QString info )
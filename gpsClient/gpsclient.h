@@ -35,7 +35,15 @@
  *
  * The communication between this client class and the Cumulus main
  * process is realized via two sockets. One socket for NMEA data message
- * transfer and a second socket for command exchange.
+ * transfer and a second socket for command exchange. If Cumulus provides a
+ * shared memory ring, the NMEA data are passed through it and the data
+ * socket transports only a wake up message per GPS epoch. An epoch ends,
+ * when the fix time of the sentences changes or the device becomes silent.
+ *
+ * All input sources are watched by one epoll instance. Device and socket
+ * data are watched edge triggered and read until the kernel buffer is empty.
+ * The connection supervision is driven by a timer, which expires at the
+ * next possible timeout of the device.
  */
 
 #pragma once
@@ -53,6 +61,12 @@
 #include <QElapsedTimer>
 
 #include "ipc.h"
+#include "NmeaRing.h"
+#include "NmeaLineBuffer.h"
+
+#ifdef FLARM
+class FlarmBinComLinux;
+#endif
 
 //++++++++++++++++++++++ CLASS GpsClient +++++++++++++++++++++++++++
 
@@ -74,26 +88,21 @@ public:
   virtual ~GpsClient();
 
   /**
-   * Processes incoming read events. They can come from the server or
-   * from the GPS device.
+   * Waits for events of all input sources and processes them. The sources
+   * are the server command channel, the GPS device, the NMEA sockets and the
+   * supervision timer.
+   *
+   * \param maxWait Maximum wait time in milli seconds.
    *
-   * \param fdMaskIn A mask of file descriptors ready for read.
+   * \return false in case of a fatal error of the event loop.
    */
-  void processEvent( fd_set *fdMaskIn );
+  bool processEvents( const int maxWait );
 
   /**
    * Send a device error message to Cumulus.
    */
   void forwardDeviceError( QString error );
 
-  /**
-   * Returns all currently used read file descriptors as mask, usable by the
-   * select call.
-   *
-   * \return A file descriptor set to be checked for read events.
-   */
-  fd_set *getReadFdMask();
-
   /**
    * Reads NMEA data from the connected GPS device via tty, BT or pipe.
    *
@@ -155,6 +164,14 @@ public:
    */
   bool verifyCheckSum( const char *sentence );
 
+  /**
+   * Verify the checksum of the passed sentence view, which needs not to be
+   * null terminated.
+   *
+   * @returns true (success) or false (error occurred)
+   */
+  bool verifyCheckSum( const char *sentence, const int length );
+
   /**
    * Check GPS message key, if it shall be processed or filtered out.
    *
@@ -178,6 +195,18 @@ public:
     return shutdown;
   };
 
+  /**
+   * \return The time in ms, the main loop shall wait for further data of
+   * the open epoch or -1, if no epoch is open.
+   */
+  int epochTimeout() const;
+
+  /**
+   * Closes the open epoch in the shared memory ring and sends a wake up
+   * message to Cumulus, if the reader is waiting for data.
+   */
+  void closeEpoch();
+
   /**
    * \return The current used non socket device.
    */
@@ -195,12 +224,61 @@ public:
   // client IPC instance.
   //----------------------------------------------------------------------
 
+  /** Kinds of the input sources watched by the event loop. */
+  enum SourceKind
+  {
+    SourceIpc = 1,
+    SourceDevice,
+    SourceSocket,
+    SourceTimer
+  };
+
+  /**
+   * Adds a file descriptor to the event loop. Data sources are watched edge
+   * triggered and must be read until no more data are available.
+   */
+  bool watchSource( const int sfd, const SourceKind kind, const bool edgeTriggered=true );
+
+  /** Removes a file descriptor from the event loop before it is closed. */
+  void unwatchSource( const int sfd );
+
+  /** Arms the supervision timer for the next toController() call. */
+  void armController();
+
+  /** Reads all pending messages of the server command channel. */
+  void readServerMessages();
+
+  /** Handles a read event of the GPS device. */
+  void handleDeviceEvent();
+
+  /** Handles a read event of a NMEA socket. */
+  void handleSocketEvent( const int sfd );
+
   void readServerMsg();
 
   void writeServerMsg( const char *msg );
 
   void writeForwardMsg( const char *msg );
 
+  /**
+   * Forwards a GPS sentence to Cumulus. The shared memory ring is used, if
+   * it is attached, otherwise the forward channel.
+   */
+  void forwardSentence( const char *sentence );
+
+  /**
+   * Forwards a sentence view to Cumulus, which needs not to be null
+   * terminated.
+   */
+  void forwardSentence( const char *sentence, const int length );
+
+  /**
+   * Logs the number of sentences dropped because of a full ring, at most
+   * once per second.
+   */
+  void reportRingDrops();
+
+
   uint getBaudrate( int rate );
 
   void readSentenceFromBuffer();
@@ -240,6 +318,50 @@ public:
    */
   bool flarmReset();
 
+  /**
+   * Downloads a flight record into an IGC file of the passed directory. The
+   * data are written into a part file, which is renamed after the end of
+   * the record has been received. A complete IGC file of the record in the
+   * directory is not downloaded again, an incomplete one is replaced.
+   *
+   * \param fbc    Binary interface to the Flarm.
+   * \param recNo  Number of the flight record.
+   * \param dir    Download directory.
+   * \param broken Set to true, if the transfer was broken.
+   *
+   * \return True on success otherwise false.
+   */
+  bool flarmDownloadFlight( FlarmBinComLinux& fbc, const int recNo,
+                            const QString& dir, bool& broken );
+
+  /**
+   * Checks, if the passed IGC file is complete. A complete Flarm IGC file
+   * ends with the G-record, the security record.
+   */
+  static bool isCompleteIgcFile( const QString& fileName );
+
+  /**
+   * Tries to reach the Flarm again in binary mode after a broken transfer.
+   */
+  bool flarmReconnect( FlarmBinComLinux& fbc );
+
+  /**
+   * Switches the Flarm and the serial port to the highest baud rate, which
+   * both do support. Nothing is done, if the Flarm is not connected via a
+   * serial port.
+   *
+   * \return True, if the Flarm is reachable in binary mode.
+   */
+  bool flarmRaiseBaudRate( FlarmBinComLinux& fbc );
+
+  /**
+   * Switches the Flarm and the serial port back to the configured baud rate.
+   */
+  void flarmRestoreBaudRate( FlarmBinComLinux& fbc );
+
+  /** Sets the speed of the serial port to the passed terminal speed. */
+  bool setTerminalSpeed( const uint speed );
+
 #endif
 
   //----------------------------------------------------------------------
@@ -255,12 +377,11 @@ public:
   // RX/TX rate of serial device
   uint ioSpeedTerminal, ioSpeedDevice;
 
-  // data buffers and pointers
-  char* datapointer;
-
-  char  databuffer[1024];
+  // receive buffer for the device data
+  NmeaLineBuffer receiveBuffer;
 
-  int   dbsize;
+  // monotonic time of the last read, passed with every sentence
+  qint64 readTime;
 
   // file descriptor to TTY GPS device
   int fd;
@@ -286,8 +407,11 @@ public:
   // Socket port for IPC to server process
   ushort ipcPort;
 
-  // read file descriptor set in use by GPS and IPC
-  fd_set fdMask;
+  // epoll instance watching all input sources
+  int epollFd;
+
+  // one shot timer for the connection supervision
+  int timerFd;
 
   // IPC instance to server process as data channel
   Ipc::Client clientData;
@@ -295,6 +419,24 @@ public:
   // IPC instance to server process as message forward channel
   Ipc::Client clientForward;
 
+  // Shared memory ring for GPS data to the server process
+  NmeaRing ring;
+
+  // Sentences were written into the ring since the last epoch end
+  bool ringPending;
+
+  // Fix time of the open epoch as contained in the sentences
+  char epochTime[16];
+
+  // Start of the open epoch
+  QElapsedTimer epochStart;
+
+  // Sentences dropped because of a full ring since the last report
+  int ringDrops;
+
+  // Time of the last report of dropped sentences
+  QElapsedTimer ringDropReport;
+
   // used as timeout control supervision for the GPS device connection
   QElapsedTimer last;
 
@@ -328,5 +470,8 @@ public:
 
   /** Timeout control for Flarm IGC download. */
   QElapsedTimer downloadTimeControl;
+
+  /** Baud rate of the Flarm binary mode, 0 means the configured rate. */
+  uint flarmSpeed;
 };
 
@@ -139,8 +139,6 @@ int main( int argc, char* argv[] )
   // GPS client module, manages the connection to the GPS and to cumulus
   GpsClient *client = new GpsClient( ipcPort );
 
-  struct timeval timerInterval;
-
   // ==========================================================================
   // main loop of Gps Client process
   // ==========================================================================
@@ -167,49 +165,15 @@ int main( int argc, char* argv[] )
           break;
         }
 
-      int maxFds = getdtablesize();  // getdtablehi() better but not provided
-
-      // get all session file descriptors
-      fd_set *readFds = client->getReadFdMask();
-
-      // main loop timeout set to one second
-      timerInterval.tv_sec  =  1;
-      timerInterval.tv_usec =  0;
-
-      // Wait for read events or timeout
-
-      int result = select( maxFds, readFds, (fd_set *) 0,
-                          (fd_set *) 0, &timerInterval );
-
-      if( result == -1 ) // Select returned with error
-        {
-          if( errno == EINTR )
-            {
-              continue; // interrupted select call, ignore it
-            }
-          else
-            {
-              // other error occurred, report it
-              cerr << "Fatal Error of select call, errno=" << errno
-                   << ", " << strerror(errno)
-                   << "\n +++ TERMINATE PROCESS +++" << endl;
-              break;
-            }
-        }
-
-      else if( result > 0 ) // read event occurred
-        {
-          // call gps client for event processing
-          client->processEvent( readFds );
-        }
-      else if( result == 0 ) // timeout, do low prioritized things
+      // Wait for events of all input sources and process them. The
+      // timeout control is driven by a timer of the event loop.
+      if( client->processEvents( 1000 ) == false )
         {
+          cerr << "Fatal Error of the event loop"
+               << "\n +++ TERMINATE PROCESS +++" << endl;
+          break;
         }
 
-      // call timeout control at last after all events have been
-      // processed
-      client->toController();
-
     } // End of while
 
   if( !strcmp(client->getDevice(), NMEASIM_DEVICE) )
@@ -0,0 +1,256 @@
+/***************************************************************************
+                          Gaggle.cpp - description
+                             -------------------
+    begin                : 18.10.2026
+
+    copyright            : (C) 2026 by Axel Pauli
+
+    email                : kflog.cumulus@gmail.com
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <cmath>
+
+#include <QtCore>
+
+#include "Gaggle.h"
+#include "sentence.h"
+
+// Meters per degree along a meridian
+#define METERS_PER_DEGREE 111195.0
+
+// Number of gliders sharing a thermal
+#define GLIDERS_PER_THERMAL 15
+
+// Maximum distance in m of a thermal from the gaggle center
+#define THERMAL_SPREAD 2000.0
+
+// Altitude band in m, in which the gliders are staggered
+#define ALTITUDE_BAND 300.0
+
+// A glider within this distance in m of its thermal starts to circle
+#define THERMAL_RADIUS 120.0
+
+// Mean time in s, a glider circles in a thermal
+#define CIRCLING_TIME 300.0
+
+// Flarm range in m, gliders beyond are not reported
+#define FLARM_RANGE 6000.0
+
+// Speed in m/s and sink rate in m/s of a gliding glider
+#define GLIDE_SPEED 35.0
+#define GLIDE_SINK  -1.0
+
+// Sink rate in m/s of a circling glider
+#define CIRCLING_SINK 0.8
+
+Gaggle::Gaggle( const int count, const double lat, const double lon,
+                const float altitude ) :
+  m_random( 1 ),
+  m_lat( lat ),
+  m_lon( lon ),
+  m_altitude( altitude )
+{
+  std::uniform_real_distribution<double> unit( 0.0, 1.0 );
+
+  int thermals = qMax( 1, (count + GLIDERS_PER_THERMAL - 1) / GLIDERS_PER_THERMAL );
+
+  for( int i = 0; i < thermals; i++ )
+    {
+      Thermal t;
+
+      // The first thermal is at the center, there the own glider starts.
+      double dist = i == 0 ? 0.0 : THERMAL_SPREAD * sqrt( unit( m_random ) );
+      double dir  = 2.0 * M_PI * unit( m_random );
+
+      t.north = dist * cos( dir );
+      t.east  = dist * sin( dir );
+      t.climb = 1.0 + 3.0 * unit( m_random );
+      t.top   = altitude + ALTITUDE_BAND * (1.0 + 2.0 * unit( m_random ));
+
+      m_thermals.push_back( t );
+    }
+
+  for( int i = 0; i < count; i++ )
+    {
+      Member m;
+
+      m.id       = 0xA00000 + i;
+      m.altitude = altitude + ALTITUDE_BAND * (2.0 * unit( m_random ) - 1.0);
+      m.speed    = GLIDE_SPEED;
+      m.turnRate = 0.0;
+      m.climb    = GLIDE_SINK;
+      m.thermal  = i % thermals;
+
+      const Thermal& t = m_thermals[m.thermal];
+
+      // Place the glider somewhere around its thermal.
+      double dir = 2.0 * M_PI * unit( m_random );
+      m.north = t.north + THERMAL_RADIUS * cos( dir );
+      m.east  = t.east + THERMAL_RADIUS * sin( dir );
+      m.track = dir * 180.0 / M_PI;
+
+      if( i % 5 == 4 )
+        {
+          // Every fifth glider is on the way to another thermal.
+          leaveThermal( m );
+        }
+      else
+        {
+          enterThermal( m );
+        }
+
+      m_members.push_back( m );
+    }
+}
+
+void Gaggle::enterThermal( Member& m )
+{
+  std::uniform_real_distribution<double> unit( 0.0, 1.0 );
+
+  const Thermal& t = m_thermals[m.thermal];
+
+  // Bank angle and direction differ from glider to glider.
+  m.speed    = 22.0 + 6.0 * unit( m_random );
+  m.turnRate = (14.0 + 8.0 * unit( m_random )) * (unit( m_random ) < 0.5 ? -1.0 : 1.0);
+  m.climb    = t.climb - CIRCLING_SINK;
+
+  // Start on the circle around the thermal center, which is nearest to the
+  // glider.
+  double radius = m.speed / (fabs( m.turnRate ) * M_PI / 180.0);
+  double dir    = atan2( m.east - t.east, m.north - t.north );
+
+  m.north = t.north + radius * cos( dir );
+  m.east  = t.east + radius * sin( dir );
+  m.track = dir * 180.0 / M_PI + (m.turnRate > 0.0 ? 90.0 : -90.0);
+}
+
+void Gaggle::leaveThermal( Member& m )
+{
+  if( m_thermals.size() > 1 )
+    {
+      std::uniform_int_distribution<int> other( 1, m_thermals.size() - 1 );
+
+      m.thermal = (m.thermal + other( m_random )) % m_thermals.size();
+    }
+
+  m.speed    = GLIDE_SPEED;
+  m.turnRate = 0.0;
+  m.climb    = GLIDE_SINK;
+}
+
+void Gaggle::move( const double seconds )
+{
+  std::uniform_real_distribution<double> unit( 0.0, 1.0 );
+
+  for( size_t i = 0; i < m_members.size(); i++ )
+    {
+      Member& m = m_members[i];
+
+      const Thermal& t = m_thermals[m.thermal];
+
+      if( m.turnRate == 0.0 )
+        {
+          // Glide straight to the next thermal.
+          m.track = atan2( t.east - m.east, t.north - m.north ) * 180.0 / M_PI;
+
+          double t0 = m.track * M_PI / 180.0;
+
+          m.north += m.speed * cos( t0 ) * seconds;
+          m.east  += m.speed * sin( t0 ) * seconds;
+
+          if( hypot( t.north - m.north, t.east - m.east ) < THERMAL_RADIUS )
+            {
+              enterThermal( m );
+            }
+        }
+      else
+        {
+          // Fly an exact arc, so the glider stays on its circle.
+          double t0 = m.track * M_PI / 180.0;
+          double w  = m.turnRate * M_PI / 180.0;
+
+          m.north += m.speed / w * (sin( t0 + w * seconds ) - sin( t0 ));
+          m.east  += m.speed / w * (cos( t0 ) - cos( t0 + w * seconds ));
+          m.track += m.turnRate * seconds;
+
+          // Leave the thermal at its top or after a while.
+          if( m.altitude > t.top ||
+              unit( m_random ) < seconds / CIRCLING_TIME )
+            {
+              leaveThermal( m );
+            }
+        }
+
+      m.track = fmod( m.track, 360.0 );
+
+      if( m.track < 0.0 )
+        {
+          m.track += 360.0;
+        }
+
+      m.altitude += m.climb * seconds;
+    }
+}
+
+void Gaggle::send( const double lat, const double lon, const float altitude,
+                   const int fd )
+{
+  // Own position relative to the gaggle center
+  double ownNorth = (lat - m_lat) * METERS_PER_DEGREE;
+  double ownEast  = (lon - m_lon) * METERS_PER_DEGREE * cos( lat * M_PI / 180.0 );
+
+  QStringList pflaa;
+
+  for( size_t i = 0; i < m_members.size(); i++ )
+    {
+      const Member& m = m_members[i];
+
+      double north = m.north - ownNorth;
+      double east  = m.east - ownEast;
+
+      if( hypot( north, east ) > FLARM_RANGE )
+        {
+          continue;
+        }
+
+      QString id = QString( "%1" ).arg( m.id, 6, 16, QChar('0') ).toUpper();
+
+      int track = qRound( m.track ) % 360;
+
+      if( track < 0 )
+        {
+          track += 360;
+        }
+
+      // Like Flarm, the turn rate is not reported.
+      pflaa << QString( "PFLAA,0,%1,%2,%3,2,%4,%5,,%6,%7,1" )
+               .arg( qRound( north ) )
+               .arg( qRound( east ) )
+               .arg( qRound( m.altitude - altitude ) )
+               .arg( id )
+               .arg( track )
+               .arg( qRound( m.speed ) )
+               .arg( m.climb, 0, 'f', 1 );
+    }
+
+  // The status is sent before the targets, no alarm is raised.
+  QString pflau = QString( "PFLAU,%1,1,2,1,0,,0,,," ).arg( pflaa.size() );
+
+  Sentence sentence;
+  sentence.send( pflau, fd );
+
+  for( int i = 0; i < pflaa.size(); i++ )
+    {
+      sentence.send( pflaa[i], fd );
+    }
+}
@@ -0,0 +1,125 @@
+/***************************************************************************
+                          Gaggle.h - description
+                             -------------------
+    begin                : 18.10.2026
+
+    copyright            : (C) 2026 by Axel Pauli
+
+    email                : kflog.cumulus@gmail.com
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef GAGGLE_H_
+#define GAGGLE_H_
+
+#include <random>
+#include <vector>
+
+#include <QtGlobal>
+
+/**
+ * \class Gaggle
+ *
+ * \author Axel Pauli
+ *
+ * \brief Generates the Flarm traffic of a synthetic gaggle.
+ *
+ * The gliders of the gaggle circle in some thermals around the start
+ * position, staggered in altitude, or glide between the thermals. After
+ * every move of the own glider a $PFLAU sentence and a $PFLAA sentence for
+ * every glider within the Flarm range are written, like a Flarm device does
+ * it. So Cumulus can be tested under the load of a large gaggle.
+ *
+ * The gaggle is created by a random generator with a fixed seed, every run
+ * produces the same traffic.
+ *
+ * \date 2026
+ *
+ * \version 1.0
+ *
+*/
+
+class Gaggle
+{
+  public:
+
+    /**
+     * Constructor of class.
+     *
+     * \param count    Number of gliders in the gaggle.
+     * \param lat      Latitude of the gaggle center in degrees.
+     * \param lon      Longitude of the gaggle center in degrees.
+     * \param altitude Mean altitude of the gaggle in meters.
+     */
+    Gaggle( const int count, const double lat, const double lon,
+            const float altitude );
+
+    /**
+     * Moves all gliders of the gaggle.
+     *
+     * \param seconds Time since the last move.
+     */
+    void move( const double seconds );
+
+    /**
+     * Writes the Flarm sentences of the gaggle relative to the own position.
+     *
+     * \param lat      Own latitude in degrees.
+     * \param lon      Own longitude in degrees.
+     * \param altitude Own altitude in meters.
+     * \param fd       File descriptor, used to write the sentences out.
+     */
+    void send( const double lat, const double lon, const float altitude,
+               const int fd );
+
+  private:
+
+    /** A glider of the gaggle in meters relative to the gaggle center. */
+    struct Member
+    {
+      uint   id;
+      double north;
+      double east;
+      double altitude;
+      double track;    // degrees
+      double speed;    // m/s
+      double turnRate; // degrees per second, 0 in a glide
+      double climb;    // m/s
+      int    thermal;  // index of the thermal or -1 in a glide
+    };
+
+    /** A thermal in meters relative to the gaggle center. */
+    struct Thermal
+    {
+      double north;
+      double east;
+      double climb; // m/s
+      double top;   // altitude in m, at which the gliders leave
+    };
+
+    /** Lets a gliding member circle in its thermal. */
+    void enterThermal( Member& m );
+
+    /** Lets a circling member leave its thermal into a glide. */
+    void leaveThermal( Member& m );
+
+    std::mt19937 m_random;
+
+    std::vector<Member>  m_members;
+    std::vector<Thermal> m_thermals;
+
+    double m_lat;
+    double m_lon;
+    float  m_altitude;
+};
+
+#endif
@@ -25,6 +25,7 @@
 
 #include "altitude.h"
 #include "IgcPlay.h"
+#include "PlayClock.h"
 #include "sentence.h"
 #include "speed.h"
 
@@ -81,6 +82,14 @@ int IgcPlay::startPlaying( const QString& startPoint,
   bool firstBRecord = true;
   bool startPositionFound = false;
 
+  PlayClock clock( m_factor );
+
+  // Sentences are only echoed in real time play.
+  Sentence::setEcho( clock.isWarp() == false );
+
+  // Recorded play time in ms, advanced by the B-Record time differences.
+  qint64 playTime = 0;
+
   uint lineNo = 0;
   uint bRecord = 0;
 
@@ -212,10 +221,13 @@ int IgcPlay::startPlaying( const QString& startPoint,
 
       int timeDiff = qtime0.secsTo( qtime1 );
 
-      qDebug() << "--Line=" << lineNo
-	       << "B-Record=" << bRecord
-	       << "Time=" << qtime1.toString(("HH:mm:ss"))
-	       << "TimeDiff=" << timeDiff;
+      if( clock.isWarp() == false )
+        {
+          qDebug() << "--Line=" << lineNo
+                   << "B-Record=" << bRecord
+                   << "Time=" << qtime1.toString(("HH:mm:ss"))
+                   << "TimeDiff=" << timeDiff;
+        }
 
       // Check time difference, if negative, make it positive
       if( timeDiff < 0 )
@@ -381,10 +393,14 @@ int IgcPlay::startPlaying( const QString& startPoint,
       sentence.send( rmz, m_fifo );
 
       // make a break defined by m_factor
-      usleep( timeDiff * 1000000 / m_factor);
+      playTime += timeDiff * 1000;
+      clock.waitUntil( playTime );
     }
 
   file.close();
+
+  qDebug() << "Played" << bRecord << "B-Records," << playTime / 1000
+           << "s recorded in" << clock.elapsed() / 1000.0 << "s";
   return 0;
 }
 
@@ -32,7 +32,8 @@
  *
  * This class reads IGC sentence data from a file, convert it to GPS NMEA and
  * writes it into a fifo. The time difference between to recorded IGC records
- * is automatically waited before the next record is processed.
+ * is automatically waited before the next record is processed. The wait is
+ * shortened by the play factor, a factor of 0 plays without any wait.
  *
  * \date 2014
  *
@@ -66,7 +67,8 @@ class IgcPlay
      *
      * \param skip Lines to be skipped in the file to be played.
      *
-     * \param playFactor Factor which is applied to playing time.
+     * \param playFactor Factor which is applied to playing time. 0 means as
+     *                   fast as the reader takes the data.
      *
      */
     int startPlaying( const QString& startPoint,
@@ -23,9 +23,13 @@
 
 #include <QtCore>
 
+#include <zlib.h>
+
 #include "NmeaPlay.h"
+#include "PlayClock.h"
 
-int NmeaPlay::startPlaying( const int skip, const int pause )
+int NmeaPlay::startPlaying( const int skip, const int pause,
+                            const int playFactor )
 {
   int m_skip = skip;
   m_pause = pause;
@@ -36,19 +40,28 @@ int NmeaPlay::startPlaying( const int skip, const int pause )
       return -1;
     }
 
-  QFile file(m_fileName);
+  // The zlib reads compressed and plain files.
+  gzFile file = gzopen( QFile::encodeName( m_fileName ).data(), "rb" );
 
-  if( ! file.open(QIODevice::ReadOnly) )
+  if( file == 0 )
     {
       qWarning() << "Play::startPlaying: Cannot open file" << m_fileName;
       return -1;
     }
 
-  QTextStream inStream(&file);
+  char buffer[1024];
+
+  PlayClock clock( playFactor );
+
+  // Recorded play time in ms, advanced by the pause after every fix or taken
+  // from the time stamps of a Cumulus NMEA log.
+  qint64 playTime = 0;
+  qint64 firstStamp = -1;
+  uint lines = 0;
 
-  while( ! inStream.atEnd() )
+  while( gzgets( file, buffer, sizeof(buffer) ) != 0 )
     {
-      QString line = inStream.readLine().trimmed();
+      QString line = QString::fromLatin1( buffer ).trimmed();
 
       if( m_skip > 0 )
         {
@@ -61,20 +74,68 @@ int NmeaPlay::startPlaying( const int skip, const int pause )
           continue;
         }
 
+      // A Cumulus NMEA log starts every line with a time stamp in ms.
+      qint64 stamp = -1;
+
+      if( line.at(0).isDigit() )
+        {
+          int space = line.indexOf( ' ' );
+          bool ok = false;
+
+          if( space > 0 )
+            {
+              stamp = line.left( space ).toLongLong( &ok );
+            }
+
+          if( ok == false )
+            {
+              continue;
+            }
+
+          line = line.mid( space + 1 );
+        }
+
+      if( stamp >= 0 )
+        {
+          if( firstStamp < 0 )
+            {
+              firstStamp = stamp;
+            }
+
+          // Play the sentence at its recorded time.
+          playTime = stamp - firstStamp;
+          clock.waitUntil( playTime );
+        }
+
       line += "\r\n";
 
       ssize_t written = write( m_fifo, line.toLatin1().data(), line.length() );
 
-      std::cout << line.toLatin1().data();
+      if( written < 0 )
+        {
+          break;
+        }
+
+      lines++;
 
-      if( line.startsWith("$GPRMC") || line.startsWith("$GNRMC") )
+      if( clock.isWarp() == false )
+        {
+          std::cout << line.toLatin1().data();
+        }
+
+      if( stamp < 0 && (line.startsWith("$GPRMC") || line.startsWith("$GNRMC")) )
         {
           // make a break after this sentence
-          usleep( m_pause * 1000 );
+          playTime += m_pause;
+          clock.waitUntil( playTime );
         }
     }
 
-  file.close();
+  gzclose( file );
+
+  std::cout << "Played " << lines << " lines, "
+            << playTime / 1000 << " s recorded in "
+            << clock.elapsed() / 1000.0 << " s" << std::endl;
 
   return 0;
 }
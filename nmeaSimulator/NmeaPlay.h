@@ -35,7 +35,11 @@
  *
  * This class reads NMEA GPS sentence data from a file and writes it into
  * a fifo. After every written $GPRMC sentence a pause is made. The read
- * data file must contain such $GPRMC sentences!
+ * data file must contain such $GPRMC sentences! The pause is shortened by
+ * the play factor, a factor of 0 plays without any pause.
+ *
+ * A NMEA log of Cumulus starts every line with a time stamp. Such a log is
+ * played at the recorded times instead, it can also be gzip compressed.
  *
  * \date 2012
  *
@@ -68,8 +72,11 @@ class NmeaPlay
      *
      * \param pause Pause after each $GPRMC sentence in ms. Default is 1000ms.
      *
+     * \param playFactor Factor which is applied to playing time. 0 means as
+     *                   fast as the reader takes the data.
      */
-    int startPlaying( const int skip=0, const int pause=1000 );
+    int startPlaying( const int skip=0, const int pause=1000,
+                      const int playFactor=1 );
 
     void setFileName( QString& newFileName )
     {
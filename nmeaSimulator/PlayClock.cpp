@@ -0,0 +1,66 @@
+/***************************************************************************
+                          PlayClock.cpp - description
+                             -------------------
+    begin                : 18.10.2026
+
+    copyright            : (C) 2026 by Axel Pauli
+
+    email                : kflog.cumulus@gmail.com
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <cerrno>
+#include <ctime>
+
+#include "PlayClock.h"
+
+PlayClock::PlayClock( const int factor ) :
+  m_factor( factor < 0 ? 1 : factor ),
+  m_start( 0 )
+{
+}
+
+qint64 PlayClock::now()
+{
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return qint64( ts.tv_sec ) * 1000000000 + ts.tv_nsec;
+}
+
+qint64 PlayClock::elapsed() const
+{
+  return m_start ? (now() - m_start) / 1000000 : 0;
+}
+
+void PlayClock::waitUntil( const qint64 recordedMs )
+{
+  if( m_start == 0 )
+    {
+      m_start = now();
+    }
+
+  if( m_factor == 0 )
+    {
+      return;
+    }
+
+  qint64 target = m_start + recordedMs * 1000000 / m_factor;
+
+  struct timespec ts;
+  ts.tv_sec  = target / 1000000000;
+  ts.tv_nsec = target % 1000000000;
+
+  // Sleep until the absolute time point, a signal continues the sleep.
+  while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, 0 ) == EINTR )
+    {
+    }
+}
@@ -0,0 +1,77 @@
+/***************************************************************************
+                          PlayClock.h - description
+                             -------------------
+    begin                : 18.10.2026
+
+    copyright            : (C) 2026 by Axel Pauli
+
+    email                : kflog.cumulus@gmail.com
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef PLAY_CLOCK_H_
+#define PLAY_CLOCK_H_
+
+#include <QtGlobal>
+
+/**
+ * \class PlayClock
+ *
+ * \author Axel Pauli
+ *
+ * \brief Paces the play of recorded data.
+ *
+ * The clock maps the recorded time of the played data to the wall clock.
+ * Every wait is done against the absolute start of the play, so the sleep
+ * and write times do not accumulate to a drift. A factor of N plays N times
+ * faster than real time. A factor of 0 does not wait at all, the play runs
+ * as fast as the reader takes the data out of the pipe.
+ *
+ * \date 2026
+ *
+ * \version 1.0
+ *
+*/
+
+class PlayClock
+{
+  public:
+
+    PlayClock( const int factor=1 );
+
+    /**
+     * Waits until the recorded time is reached on the play time line. The
+     * first call defines the start of the play.
+     *
+     * \param recordedMs Recorded time in milli seconds since the play start.
+     */
+    void waitUntil( const qint64 recordedMs );
+
+    /** \return True, if the play runs without any pause. */
+    bool isWarp() const
+    {
+      return m_factor == 0;
+    };
+
+    /** \return The wall clock time in milli seconds since the play start. */
+    qint64 elapsed() const;
+
+  private:
+
+    /** \return The monotonic time in nano seconds. */
+    static qint64 now();
+
+    int    m_factor; // play factor, 0 means no pause
+    qint64 m_start;  // monotonic start time of the play in ns
+};
+
+#endif
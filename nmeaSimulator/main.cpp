@@ -14,6 +14,7 @@
                                2013 Axel Pauli ttySx enabled as additional device
                                2014 Axel Pauli IGC Play option added
                                2021 Axel Pauli Option circle radius replaced by roll angle
+                               2026 Axel Pauli Option gaggle added
 
     email                : kflog.cumulus@gmail.com
 
@@ -64,6 +65,7 @@
 #include "vector.h"
 #include "glider.h"
 #include "gpgsa.h"
+#include "Gaggle.h"
 #include "IgcPlay.h"
 #include "NmeaPlay.h"
 #include "sentence.h"
@@ -88,6 +90,7 @@ static    int    playFactor = 1; // default play factor
 static    int    skip=0;      // lines to be skipped in the file
 static    QString igcStartTime; // time position in file where to start the IGC playing
 static    QString confFile;   // configuration file name
+static    int    gaggleSize=0;    // number of simulated Flarm targets
 
 static    QString sentences[10];
 
@@ -369,7 +372,7 @@ void scanConfig( QString cfg )
       bool ok;
       playFactor = cfg.mid(7).toInt(&ok);
 
-      if( ! ok )
+      if( ! ok || playFactor < 0 )
         {
           playFactor = 1;
         }
@@ -378,6 +381,16 @@ void scanConfig( QString cfg )
     {
       igcStartTime = cfg.mid(6);
     }
+  else if( cfg.startsWith("gaggle=") )
+    {
+      bool ok;
+      gaggleSize = cfg.mid(7).toInt(&ok);
+
+      if( ! ok || gaggleSize < 0 )
+        {
+          gaggleSize = 0;
+        }
+    }
   else
     {
       cerr << "Unknown parameter: '"
@@ -409,6 +422,7 @@ void safeConfig()
   fprintf(file,"start=%s\n", igcStartTime.toLatin1().data() );
   fprintf(file,"skip=%d\n", skip );
   fprintf(file,"factor=%d\n", playFactor );
+  fprintf(file,"gaggle=%d\n", gaggleSize );
 
   for( int i = 0; i < 10; i++ )
     {
@@ -475,6 +489,8 @@ int main(int argc, char **argv)
            << "            pos:  Fixed Position e.g. standstill in a wave (climb works)"<< endl
            << "            gpos: Fixed Position on ground "<< endl
            << "            nplay: Plays a recorded NMEA file. GPRMC is required to be contained!" << endl
+           << "                   A Cumulus NMEA log (.log or .log.gz) is played at its recorded times." << endl
+           << "                   A Flarm only log of Cumulus is played in the same way." << endl
            << "            iplay: Plays a recorded IGC file." << endl
            << "            params:"<< endl
            << "              lat=dd:mm:ss[N|S]  or lat=dd.mmmm  Initial Latitude" << endl
@@ -493,7 +509,9 @@ int main(int argc, char **argv)
            << "              file=[path to file]: to be played" << endl
            << "              skip=[number]: lines to be skipped in the play file" << endl
            << "              start=[HHMMSS]: goto B-Record start time in the IGC play file" << endl
-           << "              factor=[number]: time factor used by IGC file play, default is 1" << endl
+           << "              factor=[number]: time factor used by NMEA and IGC file play, default is 1" << endl
+           << "                               0 plays as fast as the reader takes the data (pipe only)" << endl
+           << "              gaggle=[number]: Flarm targets of a gaggle around the start position, default is 0" << endl
            << "            Note: all values can also be specified as float, like 110.5 " << endl << endl
            << "Example: " << prog << " str lat=48:31:48N lon=009:24:00E speed=125 winddir=270" << endl << endl
            << "NMEA output is written into named pipe '" << device.toLatin1().data() << "'." << endl
@@ -575,11 +593,12 @@ int main(int argc, char **argv)
       cout << "File:      " << playFile.toLatin1().data() << endl;
       cout << "Skip:      " << skip << endl;
       cout << "Pause:     " << Pause << " ms" << endl;
+      cout << "Factor:    " << playFactor << endl;
       cout << "Device:    " << device.toLatin1().data() << endl;
 
       NmeaPlay play( playFile, fifo );
 
-      play.startPlaying(skip, Pause);
+      play.startPlaying(skip, Pause, playFactor);
 
       close( fifo );
 
@@ -618,6 +637,7 @@ int main(int argc, char **argv)
   cout << "Time:       " << Time << " sec" << endl;
   cout << "Pause:      " << Pause << " ms" << endl;
   cout << "Device:     " << device.toLatin1().data() << endl;
+  cout << "Gaggle:     " << gaggleSize << " Flarm targets" << endl;
 
   for( int i = 0; i < 10; i++ )
     {
@@ -637,6 +657,8 @@ int main(int argc, char **argv)
   myGl.setFd( fifo );
   myGl.setCircle( rollangle, direction );
 
+  Gaggle gaggle( gaggleSize, lat, lon, altitude );
+
   // @AP: This is used for the GSA output simulation
   uint gsa = 0;
   QStringList satIds;
@@ -677,6 +699,12 @@ int main(int argc, char **argv)
       if( mode == "gpos" )
         myGl.FixedPosGround();
 
+      if( gaggleSize > 0 )
+        {
+          gaggle.move( Pause / 1000.0 );
+          gaggle.send( lat, lon, altitude, fifo );
+        }
+
       // GSA output simulation
       if( ! (gsa % 40) )
         {
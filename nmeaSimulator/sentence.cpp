@@ -26,6 +26,8 @@
 
 using namespace std;
 
+bool Sentence::echo = true;
+
 Sentence::Sentence()
 {
 }
@@ -58,7 +60,11 @@ int Sentence::send( QString& sentence, int fd )
 
   int sent = write( fd, string.toLatin1().data(), string.length() );
 
-  cout << string.toLatin1().data();
+  if( echo )
+    {
+      cout << string.toLatin1().data();
+    }
+
   return sent;
 }
 
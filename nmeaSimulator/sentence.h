@@ -37,8 +37,19 @@ public:
    */
   int send( QString& sentence, int fd );
 
+  /**
+   * Switches the echo of the sent sentences to stdout on or off. A fast
+   * play is slowed down by the echo.
+   */
+  static void setEcho( const bool enable )
+  {
+    echo = enable;
+  };
+
 private:
 
+  static bool echo;
+
   uint calcCheckSum (int pos, const QString& sentence);
 };
 
@@ -1,7 +1,7 @@
 ################################################################################
 # NMEA Simulator project file of Cumulus for qmake
 #
-# (c) 2008-2014 Axel Pauli
+# (c) 2008-2026 Axel Pauli
 #
 # This template generates a makefile for the NMEA Simulator binary.
 #
@@ -23,9 +23,11 @@ HEADERS     = \
     gpgga.h \
     gprmc.h \
     gpgsa.h \
+    Gaggle.h \
     pgrmz.h \
     IgcPlay.h \
     NmeaPlay.h \
+    PlayClock.h \
     sentence.h \
     ../cumulus/distance.h \
     ../cumulus/altitude.h \
@@ -37,9 +39,11 @@ SOURCES     = \
     gpgga.cpp \
     gprmc.cpp \
     gpgsa.cpp \
+    Gaggle.cpp \
     pgrmz.cpp \
     IgcPlay.cpp \
     NmeaPlay.cpp \
+    PlayClock.cpp \
     sentence.cpp \
     main.cpp \
     ../cumulus/distance.cpp \
@@ -51,4 +55,4 @@ TARGET = nmeaSimu
 DESTDIR     = .
 INCLUDEPATH += ../cumulus
 
-LIBS += -lstdc++ -lm
+LIBS += -lstdc++ -lm -lz